@@ -23,6 +23,7 @@
 #define HYPERTABLE_APPLICATIONQUEUE_H
 
 #include <cassert>
+#include <cstring>
 #include <list>
 
 #include <boost/thread/condition.hpp>
@@ -33,6 +34,7 @@
 #include "Common/HashMap.h"
 #include "Common/ReferenceCount.h"
 #include "Common/StringExt.h"
+#include "Common/Time.h"
 
 #include "ApplicationHandler.h"
 
@@ -42,40 +44,217 @@ namespace Hypertable {
    * Provides application work queue and worker threads.  It maintains a queue
    * of requests and a pool of threads that pull requests off the queue and
    * carry them out.
+   *
+   * Requests of the same thread group are kept in per-group FIFOs (one for
+   * urgent and one for normal requests).  A group sits on a ready list
+   * while it has queued requests and none of its requests is running, so
+   * the next request to carry out is always at the front of the urgent or
+   * the normal ready list and dequeueing takes constant time, regardless
+   * of how many requests are waiting behind a busy group.
    */
   class ApplicationQueue : public ReferenceCount {
+  public:
+
+    enum { HISTOGRAM_BUCKETS = 32 };
+
+    /**
+     * Histogram with power-of-two buckets.  Bucket 0 counts zero values,
+     * bucket i counts values in [2^(i-1), 2^i) and the last bucket also
+     * counts everything larger.
+     */
+    struct Histogram {
+      Histogram() { memset(buckets, 0, sizeof(buckets)); }
+      void add(uint64_t value) {
+        size_t i = 0;
+        while (value && i < HISTOGRAM_BUCKETS - 1) {
+          value >>= 1;
+          i++;
+        }
+        buckets[i]++;
+      }
+      uint64_t buckets[HISTOGRAM_BUCKETS];
+    };
+
+    struct Stats {
+      Stats() : urgent_depth(0), depth(0), groups(0), dispatched(0),
+                expired(0) { }
+      size_t urgent_depth;        // urgent requests currently queued
+      size_t depth;               // normal requests currently queued
+      size_t groups;              // thread groups with outstanding requests
+      uint64_t dispatched;
+      uint64_t expired;
+      Histogram depth_histogram;  // queue depth seen by each add()
+      Histogram wait_histogram;   // microseconds from add() to dispatch
+    };
+
+  private:
 
-    class UsageRec {
+    class WorkRec;
+    typedef std::list<WorkRec *> WorkQueue;
+
+    /**
+     * Requests of one thread group.  Requests without a thread group each
+     * get a private GroupRec that is not entered in the group map.
+     */
+    class GroupRec {
     public:
-      UsageRec() : thread_group(0), running(false), outstanding(1) { return; }
+      GroupRec(uint64_t group) : thread_group(group), running(false),
+          outstanding(0), on_urgent_ready(false), on_ready(false) { }
       uint64_t thread_group;
       bool     running;
-      int      outstanding;
+      int      outstanding;       // queued plus running requests
+      WorkQueue urgent_queue;
+      WorkQueue queue;
+      bool     on_urgent_ready;
+      bool     on_ready;
+      std::list<GroupRec *>::iterator urgent_ready_iter;
+      std::list<GroupRec *>::iterator ready_iter;
     };
 
-    typedef hash_map<uint64_t, UsageRec *> UsageRecMap;
+    typedef std::list<GroupRec *> GroupList;
+    typedef hash_map<uint64_t, GroupRec *> GroupRecMap;
 
     class WorkRec {
     public:
-      WorkRec(ApplicationHandler *ah) : handler(ah), usage(0) { return; }
+      WorkRec(ApplicationHandler *ah) : handler(ah), group(0) { return; }
       ~WorkRec() { delete handler; }
       ApplicationHandler   *handler;
-      UsageRec             *usage;
+      GroupRec             *group;
+      HiResTime             enqueued;
     };
 
-    typedef std::list<WorkRec *> WorkQueue;
-
+    /** Queue state, all of it protected by mutex */
     class ApplicationQueueState {
     public:
-      ApplicationQueueState() : shutdown(false), paused(false) { return; }
-      WorkQueue           queue;
-      WorkQueue           urgent_queue;
-      UsageRecMap         usage_map;
-      Mutex               queue_mutex;
-      Mutex               usage_mutex;
+      ApplicationQueueState() : urgent_depth(0), depth(0), shutdown(false),
+                                paused(false) { return; }
+
+      void enqueue(WorkRec *rec, bool urgent) {
+        GroupRec *group = rec->group;
+        group->outstanding++;
+        if (urgent) {
+          group->urgent_queue.push_back(rec);
+          urgent_depth++;
+        }
+        else {
+          group->queue.push_back(rec);
+          depth++;
+        }
+        if (!group->running)
+          make_ready(group);
+        stats.depth_histogram.add(urgent_depth + depth);
+      }
+
+      /**
+       * Returns the next request to carry out and marks its group running,
+       * or returns 0 if no request is runnable.  Expired requests found on
+       * the way are moved to dropped, for the caller to delete outside of
+       * the lock.
+       */
+      WorkRec *dequeue(WorkQueue &dropped) {
+        WorkRec *rec;
+        while (!urgent_ready.empty())
+          if ((rec = take(urgent_ready.front(), true, dropped)) != 0)
+            return rec;
+        while (!paused && !ready.empty())
+          if ((rec = take(ready.front(), false, dropped)) != 0)
+            return rec;
+        return 0;
+      }
+
+      /** Called when a request returned by dequeue() has been carried out */
+      void complete(GroupRec *group) {
+        group->running = false;
+        if (--group->outstanding == 0)
+          release(group);
+        else
+          make_ready(group);
+      }
+
+      GroupList           urgent_ready;
+      GroupList           ready;
+      GroupRecMap         group_map;
+      size_t              urgent_depth;
+      size_t              depth;
+      Stats               stats;
+      Mutex               mutex;
       boost::condition    cond;
       bool                shutdown;
       bool                paused;
+
+    private:
+      WorkRec *take(GroupRec *group, bool urgent, WorkQueue &dropped) {
+        WorkQueue &queue = urgent ? group->urgent_queue : group->queue;
+
+        while (!queue.empty()) {
+          WorkRec *rec = queue.front();
+          queue.pop_front();
+          if (urgent)
+            urgent_depth--;
+          else
+            depth--;
+          if (rec->handler->expired()) {
+            group->outstanding--;
+            stats.expired++;
+            dropped.push_back(rec);
+            continue;
+          }
+          group->running = true;
+          unready(group);
+          stats.dispatched++;
+          stats.wait_histogram.add(wait_micros(rec->enqueued));
+          return rec;
+        }
+
+        // every queued request of this priority had expired
+        if (urgent) {
+          urgent_ready.erase(group->urgent_ready_iter);
+          group->on_urgent_ready = false;
+        }
+        else {
+          ready.erase(group->ready_iter);
+          group->on_ready = false;
+        }
+        if (group->outstanding == 0)
+          release(group);
+        return 0;
+      }
+
+      void make_ready(GroupRec *group) {
+        if (!group->urgent_queue.empty() && !group->on_urgent_ready) {
+          group->urgent_ready_iter = urgent_ready.insert(urgent_ready.end(),
+                                                         group);
+          group->on_urgent_ready = true;
+        }
+        if (!group->queue.empty() && !group->on_ready) {
+          group->ready_iter = ready.insert(ready.end(), group);
+          group->on_ready = true;
+        }
+      }
+
+      void unready(GroupRec *group) {
+        if (group->on_urgent_ready) {
+          urgent_ready.erase(group->urgent_ready_iter);
+          group->on_urgent_ready = false;
+        }
+        if (group->on_ready) {
+          ready.erase(group->ready_iter);
+          group->on_ready = false;
+        }
+      }
+
+      void release(GroupRec *group) {
+        if (group->thread_group != 0)
+          group_map.erase(group->thread_group);
+        delete group;
+      }
+
+      static uint64_t wait_micros(const HiResTime &start) {
+        HiResTime now;
+        int64_t micros = ((int64_t)now.sec - (int64_t)start.sec) * 1000000LL
+                         + ((int64_t)now.nsec - (int64_t)start.nsec) / 1000;
+        return micros > 0 ? (uint64_t)micros : 0;
+      }
     };
 
     class Worker {
@@ -84,87 +263,36 @@ namespace Hypertable {
       Worker(ApplicationQueueState &qstate) : m_state(qstate) { return; }
 
       void operator()() {
-        WorkRec *rec = 0;
-        WorkQueue::iterator iter;
+        WorkRec *rec;
+        WorkQueue dropped;
 
         while (true) {
 
-          {  // !!! maybe ditch this block specifier
-            ScopedLock lock(m_state.queue_mutex);
-
-            while ((m_state.paused || m_state.queue.empty()) &&
-                   m_state.urgent_queue.empty()) {
+          {
+            ScopedLock lock(m_state.mutex);
+            while ((rec = m_state.dequeue(dropped)) == 0) {
               if (m_state.shutdown)
-                return;
+                break;
               m_state.cond.wait(lock);
             }
+          }
 
-            {
-              ScopedLock ulock(m_state.usage_mutex);
-
-              rec = 0;
-
-              iter = m_state.urgent_queue.begin();
-              while (iter != m_state.urgent_queue.end()) {
-                rec = (*iter);
-                if (rec->handler->expired()) {
-                  iter = m_state.urgent_queue.erase(iter);
-                  continue;
-                }
-                if (rec->usage == 0 || !rec->usage->running) {
-                  if (rec->usage)
-                    rec->usage->running = true;
-                  m_state.urgent_queue.erase(iter);
-                  break;
-                }
-                rec = 0;
-                iter++;
-              }
-
-              if (rec == 0 && !m_state.paused) {
-                iter = m_state.queue.begin();
-                while (iter != m_state.queue.end()) {
-                  rec = (*iter);
-                  if (rec->handler->expired()) {
-                    iter = m_state.queue.erase(iter);
-                    continue;
-                  }
-                  if (rec->usage == 0 || !rec->usage->running) {
-                    if (rec->usage)
-                      rec->usage->running = true;
-                    m_state.queue.erase(iter);
-                    break;
-                  }
-                  rec = 0;
-                  iter++;
-                }
-              }
-            }
-            if (rec == 0) {
-              if (m_state.shutdown)
-                return;
-              m_state.cond.wait(lock);
-              if (m_state.shutdown)
-                return;
-            }
+          while (!dropped.empty()) {
+            delete dropped.front();
+            dropped.pop_front();
           }
 
-          if (rec) {
-            rec->handler->run();
-            if (rec->usage) {
-              ScopedLock ulock(m_state.usage_mutex);
-              rec->usage->running = false;
-              rec->usage->outstanding--;
-              if (rec->usage->outstanding == 0) {
-                m_state.usage_map.erase(rec->usage->thread_group);
-                delete rec->usage;
-              }
-            }
-            delete rec;
+          if (rec == 0)
+            return;
+
+          rec->handler->run();
+
+          {
+            ScopedLock lock(m_state.mutex);
+            m_state.complete(rec->group);
           }
+          delete rec;
         }
-
-        HT_INFO("thread exit");
       }
 
     private:
@@ -205,6 +333,7 @@ namespace Hypertable {
      * completion of the shutdown.
      */
     void shutdown() {
+      ScopedLock lock(m_state.mutex);
       m_state.shutdown = true;
       m_state.cond.notify_all();
     }
@@ -223,12 +352,12 @@ namespace Hypertable {
     }
 
     void stop() {
-      ScopedLock lock(m_state.queue_mutex);
+      ScopedLock lock(m_state.mutex);
       m_state.paused = true;
     }
 
     void start() {
-      ScopedLock lock(m_state.queue_mutex);
+      ScopedLock lock(m_state.mutex);
       m_state.paused = false;
       m_state.cond.notify_all();
     }
@@ -241,35 +370,35 @@ namespace Hypertable {
      * object
      */
     void add(ApplicationHandler *app_handler) {
-      UsageRecMap::iterator uiter;
+      HT_ASSERT(app_handler);
+
+      GroupRecMap::iterator uiter;
       uint64_t thread_group = app_handler->get_thread_group();
       WorkRec *rec = new WorkRec(app_handler);
-      rec->usage = 0;
 
-      HT_ASSERT(app_handler);
+      ScopedLock lock(m_state.mutex);
 
-      if (thread_group != 0) {
-        ScopedLock ulock(m_state.usage_mutex);
-        if ((uiter = m_state.usage_map.find(thread_group))
-            != m_state.usage_map.end()) {
-          rec->usage = (*uiter).second;
-          rec->usage->outstanding++;
-        }
-        else {
-          rec->usage = new UsageRec();
-          rec->usage->thread_group = thread_group;
-          m_state.usage_map[thread_group] = rec->usage;
-        }
+      if (thread_group == 0)
+        rec->group = new GroupRec(0);
+      else if ((uiter = m_state.group_map.find(thread_group))
+               != m_state.group_map.end())
+        rec->group = (*uiter).second;
+      else {
+        rec->group = new GroupRec(thread_group);
+        m_state.group_map[thread_group] = rec->group;
       }
 
-      {
-        ScopedLock lock(m_state.queue_mutex);
-        if (app_handler->is_urgent())
-          m_state.urgent_queue.push_back(rec);
-        else
-          m_state.queue.push_back(rec);
-        m_state.cond.notify_one();
-      }
+      m_state.enqueue(rec, app_handler->is_urgent());
+      m_state.cond.notify_one();
+    }
+
+    /** Returns queue depths and the depth and wait time histograms */
+    void get_stats(Stats &stats) {
+      ScopedLock lock(m_state.mutex);
+      stats = m_state.stats;
+      stats.urgent_depth = m_state.urgent_depth;
+      stats.depth = m_state.depth;
+      stats.groups = m_state.group_map.size();
     }
   };
 
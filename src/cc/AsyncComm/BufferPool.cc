@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "BufferPool.h"
+
+using namespace Hypertable;
+
+
+BufferPool::BufferPool(size_t max_pooled_bytes)
+  : m_max_pooled_bytes(max_pooled_bytes) {
+  for (size_t i=0; i<CLASS_COUNT; i++)
+    m_free_lists[i] = 0;
+}
+
+
+BufferPool::~BufferPool() {
+  for (size_t i=0; i<CLASS_COUNT; i++) {
+    while (m_free_lists[i]) {
+      Header *header = m_free_lists[i];
+      m_free_lists[i] = header->next;
+      free(header);
+    }
+  }
+}
+
+
+uint8_t *BufferPool::allocate(size_t len) {
+  size_t size_class = 0;
+  size_t size = (size_t)1 << MIN_CLASS_BITS;
+  Header *header;
+  void *mem;
+
+  while (size < len && size_class < CLASS_COUNT) {
+    size <<= 1;
+    size_class++;
+  }
+
+  if (size_class == OVERSIZED)
+    size = len;
+
+  {
+    ScopedLock lock(m_mutex);
+    m_stats.allocations++;
+    if (size_class == OVERSIZED)
+      m_stats.oversized++;
+    else if ((header = m_free_lists[size_class]) != 0) {
+      m_free_lists[size_class] = header->next;
+      m_stats.hits++;
+      m_stats.pooled_buffers--;
+      m_stats.pooled_bytes -= size;
+      return (uint8_t *)header + ALIGNMENT;
+    }
+  }
+
+  if (posix_memalign(&mem, ALIGNMENT, ALIGNMENT + size) != 0)
+    throw std::bad_alloc();
+
+  header = (Header *)mem;
+  header->next = 0;
+  header->size_class = size_class;
+  return (uint8_t *)mem + ALIGNMENT;
+}
+
+
+void BufferPool::release(uint8_t *buf) {
+  Header *header = (Header *)(buf - ALIGNMENT);
+
+  if (header->size_class != OVERSIZED) {
+    size_t size = (size_t)1 << (MIN_CLASS_BITS + header->size_class);
+    ScopedLock lock(m_mutex);
+    if (m_stats.pooled_bytes + size <= m_max_pooled_bytes) {
+      header->next = m_free_lists[header->size_class];
+      m_free_lists[header->size_class] = header;
+      m_stats.pooled_buffers++;
+      m_stats.pooled_bytes += size;
+      return;
+    }
+  }
+
+  free(header);
+}
+
+
+void BufferPool::get_stats(Stats &stats) {
+  ScopedLock lock(m_mutex);
+  stats = m_stats;
+}
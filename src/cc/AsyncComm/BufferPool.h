@@ -0,0 +1,93 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BUFFERPOOL_H
+#define HYPERTABLE_BUFFERPOOL_H
+
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+
+namespace Hypertable {
+
+  /**
+   * Size-classed pool of message buffers.  Each reactor owns one and reads
+   * inbound message payloads into buffers taken from it; the Event holding
+   * the payload hands the buffer back when its last reference goes away,
+   * which may happen on any thread.
+   *
+   * Size classes are powers of two from 512 bytes to 2MB.  Buffers are
+   * aligned on a cache line.  Released buffers are kept on per-class free
+   * lists as long as the total number of pooled bytes stays below the
+   * configured limit, otherwise they are freed.  Larger requests are served
+   * straight from the heap.
+   */
+  class BufferPool : public ReferenceCount {
+  public:
+
+    struct Stats {
+      Stats() : allocations(0), hits(0), oversized(0), pooled_buffers(0),
+                pooled_bytes(0) { }
+      uint64_t allocations;     // calls to allocate()
+      uint64_t hits;            // allocations served from a free list
+      uint64_t oversized;       // allocations larger than the largest class
+      uint64_t pooled_buffers;  // buffers currently on free lists
+      uint64_t pooled_bytes;    // bytes currently on free lists
+    };
+
+    /**
+     * @param max_pooled_bytes limit on the bytes kept on the free lists
+     */
+    BufferPool(size_t max_pooled_bytes);
+    ~BufferPool();
+
+    /** Returns a buffer of at least len bytes */
+    uint8_t *allocate(size_t len);
+
+    /** Returns buf, which must come from allocate(), to the pool */
+    void release(uint8_t *buf);
+
+    void get_stats(Stats &stats);
+
+  private:
+    enum {
+      ALIGNMENT = 64,
+      MIN_CLASS_BITS = 9,
+      CLASS_COUNT = 13,
+      OVERSIZED = CLASS_COUNT
+    };
+
+    /** Sits in the cache line in front of every buffer */
+    struct Header {
+      Header  *next;            // free list link
+      size_t   size_class;
+    };
+
+    Mutex     m_mutex;
+    size_t    m_max_pooled_bytes;
+    Header   *m_free_lists[CLASS_COUNT];
+    Stats     m_stats;
+  };
+
+  typedef intrusive_ptr<BufferPool> BufferPoolPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_BUFFERPOOL_H
@@ -34,15 +34,19 @@ extern "C" {
 #endif
 #include <errno.h>
 #include <fcntl.h>
+#include <ifaddrs.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <arpa/inet.h>
+#include <unistd.h>
 }
 
+#include "Common/Config.h"
 #include "Common/Error.h"
 #include "Common/InetAddr.h"
 #include "Common/FileUtils.h"
@@ -81,6 +85,22 @@ Comm::Comm() {
 
   ReactorFactory::get_reactor(m_timer_reactor_ptr);
   m_handler_map_ptr = ReactorRunner::ms_handler_map_ptr;
+
+  struct ifaddrs *ifaddrs;
+  if (getifaddrs(&ifaddrs) == 0) {
+    for (struct ifaddrs *ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
+      if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET)
+        m_local_addrs.insert(
+            ((struct sockaddr_in *)ifa->ifa_addr)->sin_addr.s_addr);
+    }
+    freeifaddrs(ifaddrs);
+  }
+  else
+    HT_WARNF("getifaddrs: %s", strerror(errno));
+
+  if (Config::properties)
+    set_unix_socket_dir(Config::properties->get_str("Comm.UnixSocketDir",
+                                                    String()));
 }
 
 
@@ -115,6 +135,10 @@ Comm::connect(struct sockaddr_in &addr,
   if (m_handler_map_ptr->contains_handler(addr))
     return Error::COMM_ALREADY_CONNECTED;
 
+  if (is_local_address(addr) &&
+      connect_unix_socket(addr, default_handler_ptr) == Error::OK)
+    return Error::OK;
+
   if ((sd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0) {
     HT_ERRORF("socket: %s", strerror(errno));
     return Error::COMM_SOCKET_ERROR;
@@ -155,12 +179,58 @@ Comm::listen(struct sockaddr_in &addr, ConnectionHandlerFactoryPtr &chf_ptr) {
 }
 
 
+void Comm::set_unix_socket_dir(const String &dir) {
+  ScopedLock lock(m_unix_mutex);
+
+  if (!dir.empty() && dir[0] != '/' && !System::install_dir.empty())
+    m_unix_socket_dir = System::install_dir + "/" + dir;
+  else
+    m_unix_socket_dir = dir;
+
+  if (!m_unix_socket_dir.empty() && !FileUtils::exists(m_unix_socket_dir) &&
+      !FileUtils::mkdirs(m_unix_socket_dir)) {
+    HT_WARNF("Unable to create Unix socket directory %s, connections over "
+             "Unix domain sockets are off", m_unix_socket_dir.c_str());
+    m_unix_socket_dir.clear();
+  }
+}
+
+
 int Comm::set_alias(const sockaddr_in &addr, const sockaddr_in &alias) {
-  ScopedLock lock(ms_mutex);
   return m_handler_map_ptr->set_alias(addr, alias);
 }
 
 
+int Comm::set_payload_checksum(const sockaddr_in &addr, bool enable) {
+  IOHandlerDataPtr data_handler;
+
+  if (!m_handler_map_ptr->lookup_data_handler(addr, data_handler))
+    return Error::COMM_NOT_CONNECTED;
+
+  data_handler->set_payload_checksum(enable);
+  return Error::OK;
+}
+
+
+void Comm::set_compressor(CommCompressorPtr &compressor, size_t min_size,
+                          bool enable) {
+  IOHandlerData::ms_compressor = compressor;
+  IOHandlerData::ms_compression_min_size = min_size;
+  IOHandlerData::ms_compression = enable;
+}
+
+
+int Comm::set_compression(const sockaddr_in &addr, bool enable) {
+  IOHandlerDataPtr data_handler;
+
+  if (!m_handler_map_ptr->lookup_data_handler(addr, data_handler))
+    return Error::COMM_NOT_CONNECTED;
+
+  data_handler->set_compression(enable);
+  return Error::OK;
+}
+
+
 void
 Comm::listen(struct sockaddr_in &addr, ConnectionHandlerFactoryPtr &chf_ptr,
              DispatchHandlerPtr &default_handler_ptr) {
@@ -198,13 +268,15 @@ Comm::listen(struct sockaddr_in &addr, ConnectionHandlerFactoryPtr &chf_ptr,
                                                  m_handler_map_ptr, chf_ptr);
   m_handler_map_ptr->insert_handler(accept_handler);
   accept_handler->start_polling();
+
+  if (addr.sin_addr.s_addr == INADDR_ANY || is_local_address(addr))
+    listen_unix_socket(addr, chf_ptr, default_handler_ptr);
 }
 
 
 int
 Comm::send_request(const sockaddr_in &addr, uint32_t timeout_ms,
                    CommBufPtr &cbuf_ptr, DispatchHandler *resp_handler) {
-  ScopedLock lock(ms_mutex);
   IOHandlerDataPtr data_handler;
   int error = Error::OK;
 
@@ -225,6 +297,8 @@ Comm::send_request(const sockaddr_in &addr, uint32_t timeout_ms,
   }
 
   cbuf_ptr->header.timeout_ms = timeout_ms;
+  data_handler->compress_payload(cbuf_ptr.get());
+  cbuf_ptr->set_payload_checksum(data_handler->get_payload_checksum());
   cbuf_ptr->write_header_and_reset();
 
   if ((error = data_handler->send_message(cbuf_ptr, timeout_ms, resp_handler))
@@ -236,7 +310,6 @@ Comm::send_request(const sockaddr_in &addr, uint32_t timeout_ms,
 
 
 int Comm::send_response(struct sockaddr_in &addr, CommBufPtr &cbuf_ptr) {
-  ScopedLock lock(ms_mutex);
   IOHandlerDataPtr data_handler;
   int error = Error::OK;
 
@@ -246,6 +319,8 @@ int Comm::send_response(struct sockaddr_in &addr, CommBufPtr &cbuf_ptr) {
   }
 
   cbuf_ptr->header.flags &= CommHeader::FLAGS_MASK_REQUEST;
+  data_handler->compress_payload(cbuf_ptr.get());
+  cbuf_ptr->set_payload_checksum(data_handler->get_payload_checksum());
 
   cbuf_ptr->write_header_and_reset();
 
@@ -315,7 +390,6 @@ Comm::create_datagram_receive_socket(struct sockaddr_in *addr, int tos,
 int
 Comm::send_datagram(struct sockaddr_in &addr, struct sockaddr_in &send_addr,
                     CommBufPtr &cbuf_ptr) {
-  ScopedLock lock(ms_mutex);
   IOHandlerDatagramPtr dg_handler;
   int error = Error::OK;
 
@@ -360,7 +434,6 @@ Comm::set_timer_absolute(boost::xtime expire_time, DispatchHandler *handler) {
 int
 Comm::get_local_address(struct sockaddr_in addr,
                         struct sockaddr_in *local_addr) {
-  ScopedLock lock(ms_mutex);
   IOHandlerDataPtr data_handler;
 
   if (!m_handler_map_ptr->lookup_data_handler(addr, data_handler)) {
@@ -432,3 +505,143 @@ Comm::connect_socket(int sd, struct sockaddr_in &addr,
 
   return Error::OK;
 }
+
+
+/**
+ * Connects to the Unix domain socket standing in for the port of addr.
+ * Returns an error if there is none, in which case the caller falls back
+ * to TCP.
+ */
+int
+Comm::connect_unix_socket(struct sockaddr_in &addr,
+                          DispatchHandlerPtr &default_handler_ptr) {
+  String path = unix_socket_path(ntohs(addr.sin_port));
+  struct sockaddr_un unix_addr;
+  struct sockaddr_in local_addr;
+  IOHandlerPtr handler;
+  IOHandlerData *data_handler;
+  int sd;
+
+  if (path.empty() || path.length() >= sizeof(unix_addr.sun_path))
+    return Error::COMM_CONNECT_ERROR;
+
+  memset(&unix_addr, 0, sizeof(unix_addr));
+  unix_addr.sun_family = AF_UNIX;
+  strcpy(unix_addr.sun_path, path.c_str());
+
+  if ((sd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    HT_ERRORF("socket(AF_UNIX): %s", strerror(errno));
+    return Error::COMM_SOCKET_ERROR;
+  }
+
+  // A local connect completes (or fails) right away, so it is done before
+  // the socket is made non-blocking
+  while (::connect(sd, (struct sockaddr *)&unix_addr, sizeof(unix_addr)) < 0) {
+    if (errno == EINTR)
+      continue;
+    HT_DEBUGF("connecting to %s: %s, falling back to TCP", path.c_str(),
+              strerror(errno));
+    ::close(sd);
+    return Error::COMM_CONNECT_ERROR;
+  }
+
+  FileUtils::set_flags(sd, O_NONBLOCK);
+
+#if defined(__APPLE__)
+  int one = 1;
+  if (setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)) < 0)
+    HT_WARNF("setsockopt(SO_NOSIGPIPE) failure: %s", strerror(errno));
+#endif
+
+  // the peer is on this host, so its IP address stands in for ours
+  memset(&local_addr, 0, sizeof(local_addr));
+  local_addr.sin_family = AF_INET;
+  local_addr.sin_addr = addr.sin_addr;
+
+  handler = data_handler = new IOHandlerData(sd, addr, default_handler_ptr);
+  data_handler->set_unix_socket(local_addr);
+  m_handler_map_ptr->insert_handler(data_handler);
+
+  // write readiness delivers CONNECTION_ESTABLISHED, as for TCP
+  data_handler->start_polling();
+  data_handler->add_poll_interest(Reactor::READ_READY|Reactor::WRITE_READY);
+
+  HT_DEBUGF("Connected to %s over %s", InetAddr::format(addr).c_str(),
+            path.c_str());
+  return Error::OK;
+}
+
+
+/**
+ * Listens on the Unix domain socket standing in for the port of addr, in
+ * addition to the TCP listener.  Failing to do so is not fatal since
+ * clients fall back to TCP.
+ */
+void
+Comm::listen_unix_socket(struct sockaddr_in &addr,
+                         ConnectionHandlerFactoryPtr &chf_ptr,
+                         DispatchHandlerPtr &default_handler_ptr) {
+  String path = unix_socket_path(ntohs(addr.sin_port));
+  struct sockaddr_un unix_addr;
+  struct sockaddr_in listener_addr;
+  IOHandlerPtr handler;
+  IOHandlerAccept *accept_handler;
+  int sd;
+
+  if (path.empty())
+    return;
+
+  if (path.length() >= sizeof(unix_addr.sun_path)) {
+    HT_WARNF("Unix socket path %s too long", path.c_str());
+    return;
+  }
+
+  memset(&unix_addr, 0, sizeof(unix_addr));
+  unix_addr.sun_family = AF_UNIX;
+  strcpy(unix_addr.sun_path, path.c_str());
+
+  listener_addr = IOHandlerAccept::unix_listener_address(ntohs(addr.sin_port));
+  if (m_handler_map_ptr->contains_handler(listener_addr))
+    return;
+
+  if ((sd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    HT_WARNF("socket(AF_UNIX): %s", strerror(errno));
+    return;
+  }
+
+  FileUtils::set_flags(sd, O_NONBLOCK);
+
+  // the TCP bind succeeded, so a socket left at path is stale
+  unlink(path.c_str());
+
+  if (bind(sd, (const sockaddr *)&unix_addr, sizeof(unix_addr)) < 0 ||
+      ::listen(sd, 1000) < 0) {
+    HT_WARNF("listening on %s: %s", path.c_str(), strerror(errno));
+    ::close(sd);
+    return;
+  }
+
+  handler = accept_handler = new IOHandlerAccept(sd, listener_addr,
+      default_handler_ptr, m_handler_map_ptr, chf_ptr, true);
+  accept_handler->set_local_address(addr);
+  m_handler_map_ptr->insert_handler(accept_handler);
+  accept_handler->start_polling();
+}
+
+
+bool Comm::is_local_address(const sockaddr_in &addr) {
+  uint32_t net = ntohl(addr.sin_addr.s_addr) >> 24;
+
+  // Unix domain socket peers are numbered within 0.0.0.0/8
+  if (net == 127 || net == 0)
+    return true;
+  return m_local_addrs.count(addr.sin_addr.s_addr) > 0;
+}
+
+
+String Comm::unix_socket_path(uint16_t port) {
+  ScopedLock lock(m_unix_mutex);
+  if (m_unix_socket_dir.empty())
+    return String();
+  return format("%s/comm.%u.sock", m_unix_socket_dir.c_str(), (unsigned)port);
+}
@@ -22,11 +22,15 @@
 #ifndef HYPERTABLE_COMMENGINE_H
 #define HYPERTABLE_COMMENGINE_H
 
+#include <set>
+
 #include "Common/Mutex.h"
 #include "Common/ReferenceCount.h"
+#include "Common/String.h"
 
 #include "DispatchHandler.h"
 #include "CommBuf.h"
+#include "CommCompressor.h"
 #include "ConnectionHandlerFactory.h"
 #include "HandlerMap.h"
 
@@ -57,7 +61,10 @@ namespace Hypertable {
      * and associates with it a default dispatch handler.
      * CONNECTION_ESTABLISHED and DISCONNECT events are delivered to the
      * default dispatch handler.  The argument addr is used to subsequently
-     * refer to the connection.
+     * refer to the connection.  If addr is an address of this host and the
+     * server listens on a Unix domain socket as well (see
+     * set_unix_socket_dir()), the connection is made over that socket
+     * instead, which is transparent to the caller.
      *
      * @param addr IP address and port to connect to
      * @param default_handler_ptr smart pointer to default dispatch handler
@@ -81,6 +88,20 @@ namespace Hypertable {
     int connect(struct sockaddr_in &addr, struct sockaddr_in &local_addr,
                 DispatchHandlerPtr &default_handler_ptr);
 
+    /**
+     * Sets the directory that holds the Unix domain sockets standing in for
+     * the TCP ports of this host.  Servers listening on an address of this
+     * host also listen on the socket <dir>/comm.<port>.sock, and connections
+     * to an address of this host go through that socket when it exists.
+     * An empty dir turns this off.  The initial setting comes from the
+     * Comm.UnixSocketDir property.  Affects subsequent calls to connect()
+     * and listen() only.
+     *
+     * @param dir socket directory, relative paths are taken relative to
+     *        the installation directory
+     */
+    void set_unix_socket_dir(const String &dir);
+
     /**
      * Sets an alias for a TCP connection
      *
@@ -89,6 +110,46 @@ namespace Hypertable {
      */
     int set_alias(const sockaddr_in &addr, const sockaddr_in &alias);
 
+    /**
+     * Turns crc32c checksums on the payloads of messages sent over a TCP
+     * connection on or off.  The receiver verifies the checksum of every
+     * message that carries one (see CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM),
+     * so each side can choose independently.  The initial setting comes from
+     * the Comm.PayloadChecksum property.
+     *
+     * @param addr connection identifier (remote address)
+     * @param enable true to send payload checksums
+     * @return Error::OK or Error::COMM_NOT_CONNECTED
+     */
+    int set_payload_checksum(const sockaddr_in &addr, bool enable);
+
+    /**
+     * Installs the compressor for message payloads.  From then on this
+     * process tells its peers that it takes compressed payloads (see
+     * CommHeader::FLAGS_BIT_REQUEST_ACCEPTS_COMPRESSED) and decompresses
+     * them before they are delivered.  Payloads of at least min_size bytes
+     * sent over a connection are compressed once the peer has said that it
+     * takes them and if compression is on for the connection.  This should
+     * be called once, before any connections are established.
+     *
+     * @param compressor payload compressor
+     * @param min_size smallest payload that is compressed
+     * @param enable initial compression setting of new connections
+     */
+    void set_compressor(CommCompressorPtr &compressor, size_t min_size,
+                        bool enable);
+
+    /**
+     * Turns compression of the payloads of messages sent over a TCP
+     * connection on or off.  Has no effect unless a compressor is
+     * installed.
+     *
+     * @param addr connection identifier (remote address)
+     * @param enable true to compress payloads
+     * @return Error::OK or Error::COMM_NOT_CONNECTED
+     */
+    int set_compression(const sockaddr_in &addr, bool enable);
+
     /**
      * Tells the communication subsystem to listen for connection requests on
      * the address given by the addr argument.  New connections will be
@@ -188,6 +249,17 @@ namespace Hypertable {
     int get_local_address(struct sockaddr_in addr,
                           struct sockaddr_in *local_addr);
 
+    /**
+     * Checks whether a remote address is on this host, i.e. whether it is
+     * the loopback address, an address of one of the interfaces of this
+     * host, or the address that stands for the peer of a Unix domain
+     * socket connection.
+     *
+     * @param addr remote address
+     * @return true if addr is on this host
+     */
+    bool is_local_address(const sockaddr_in &addr);
+
     /**
      * Creates a local socket for receiving datagrams and assigns a default
      * dispatch handler to handle events on this socket.  This socket can also
@@ -262,11 +334,24 @@ namespace Hypertable {
     int connect_socket(int sd, struct sockaddr_in &addr,
                        DispatchHandlerPtr &default_handler_ptr);
 
+    int connect_unix_socket(struct sockaddr_in &addr,
+                            DispatchHandlerPtr &default_handler_ptr);
+
+    void listen_unix_socket(struct sockaddr_in &addr,
+                            ConnectionHandlerFactoryPtr &chf_ptr,
+                            DispatchHandlerPtr &default_handler_ptr);
+
+    /** Socket path standing in for port, empty if turned off */
+    String unix_socket_path(uint16_t port);
+
     static atomic_t ms_next_request_id;
 
     static Mutex   ms_mutex;
     HandlerMapPtr  m_handler_map_ptr;
     ReactorPtr     m_timer_reactor_ptr;
+    Mutex          m_unix_mutex;
+    String         m_unix_socket_dir;
+    std::set<uint32_t> m_local_addrs;
   };
 
 } // namespace Hypertable
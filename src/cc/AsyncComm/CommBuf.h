@@ -22,16 +22,23 @@
 #ifndef HYPERTABLE_COMMBUF_H
 #define HYPERTABLE_COMMBUF_H
 
+#include <algorithm>
 #include <string>
+#include <vector>
+
+#include <sys/uio.h>
 
 #include <boost/shared_ptr.hpp>
 
 #include "Common/ByteString.h"
+#include "Common/Checksum.h"
+#include "Common/DynamicBuffer.h"
 #include "Common/Logger.h"
 #include "Common/ReferenceCount.h"
 #include "Common/Serialization.h"
 #include "Common/StaticBuffer.h"
 
+#include "CommCompressor.h"
 #include "CommHeader.h"
 
 namespace Hypertable {
@@ -66,10 +73,29 @@ namespace Hypertable {
    *   error = m_comm->send_response(m_event_ptr->addr, cbp);
    * </pre>
    *
+   * Instead of a single extended buffer, the payload can be given as a
+   * chain of segments that reference memory owned elsewhere (e.g. cache
+   * blocks).  Each segment holds a reference on the owner of its memory,
+   * which is dropped when the CommBuf is destroyed after the last byte
+   * has been written to the socket.
    */
   class CommBuf : public ReferenceCount {
   public:
 
+    /**
+     * A piece of the extended payload.  The memory [base, base+len) must
+     * stay valid and unchanged for as long as pin is held.
+     */
+    struct Segment {
+      Segment() : base(0), len(0) { }
+      Segment(const uint8_t *b, uint32_t l, ReferenceCount *p)
+        : base(b), len(l), pin(p) { }
+      const uint8_t *base;
+      uint32_t len;
+      intrusive_ptr<ReferenceCount> pin;
+    };
+    typedef std::vector<Segment> SegmentVector;
+
     /**
      * This constructor initializes the CommBuf object by allocating a
      * primary buffer of length len and writing the header into it.
@@ -79,7 +105,8 @@ namespace Hypertable {
      * @param hdr comm header
      * @param len the length of the primary buffer to allocate
      */
-    CommBuf(CommHeader &hdr, uint32_t len=0) : header(hdr), ext_ptr(0) {
+    CommBuf(CommHeader &hdr, uint32_t len=0)
+      : header(hdr), ext_ptr(0), segment(0), segment_ptr(0) {
       len += header.encoded_length();
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
@@ -99,7 +126,7 @@ namespace Hypertable {
      * @param buffer extended buffer
      */
     CommBuf(CommHeader &hdr, uint32_t len, StaticBuffer &buffer)
-      : ext(buffer), header(hdr) {
+      : ext(buffer), header(hdr), segment(0), segment_ptr(0) {
       len += header.encoded_length();
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
@@ -107,6 +134,116 @@ namespace Hypertable {
       ext_ptr = ext.base;
     }
 
+    /**
+     * This constructor initializes the CommBuf object by allocating a
+     * primary buffer of length len and writing the header into it.  The
+     * payload that follows the primary buffer is the concatenation of
+     * segments, whose contents are taken over (segments is left empty).
+     * The total length written into the header is len plus the lengths
+     * of all segments.
+     *
+     * @param hdr comm header
+     * @param len the length of the primary buffer to allocate
+     * @param segments extended payload segments
+     */
+    CommBuf(CommHeader &hdr, uint32_t len, SegmentVector &segments)
+      : header(hdr), ext_ptr(0), segment(0) {
+      uint32_t total = 0;
+      len += header.encoded_length();
+      data.set(new uint8_t [len], len, true);
+      data_ptr = data.base + header.encoded_length();
+      ext_segments.swap(segments);
+      for (size_t i=0; i<ext_segments.size(); i++)
+        total += ext_segments[i].len;
+      header.set_total_length(len+total);
+      segment_ptr = ext_segments.empty() ? 0 : ext_segments[0].base;
+    }
+
+    /**
+     * Appends segments covering the payload (primary buffer after the
+     * header, extended buffer and segments) to segments.  They pin this
+     * CommBuf, so the payload can be sent as part of another message
+     * without being copied.
+     *
+     * @param segments vector to append the segments to
+     */
+    void get_payload_segments(SegmentVector &segments) {
+      size_t header_len = header.encoded_length();
+      if (data.size > header_len)
+        segments.push_back(Segment(data.base + header_len,
+                                   data.size - header_len, this));
+      if (ext.base != 0 && ext.size > 0)
+        segments.push_back(Segment(ext.base, ext.size, this));
+      for (size_t i=0; i<ext_segments.size(); i++)
+        segments.push_back(ext_segments[i]);
+    }
+
+    /**
+     * Replaces the payload with its compressed form and sets
+     * FLAGS_BIT_COMPRESSED.  The primary buffer is cut back to the header
+     * and the compressed payload becomes the extended buffer.  If the
+     * payload does not compress, or is compressed already, the message is
+     * left unchanged.  Must be called after the payload is complete and
+     * before set_payload_checksum().
+     *
+     * @param compressor payload compressor
+     * @return true if the payload was replaced
+     */
+    bool compress_payload(CommCompressor *compressor) {
+      if (header.flags & CommHeader::FLAGS_BIT_COMPRESSED)
+        return false;
+
+      size_t header_len = header.encoded_length();
+      DynamicBuffer input(header.total_len - header_len);
+      DynamicBuffer output;
+      uint8_t *compressed;
+      size_t len;
+
+      input.add_unchecked(data.base + header_len, data.size - header_len);
+      if (ext.base != 0)
+        input.add_unchecked(ext.base, ext.size);
+      for (size_t i=0; i<ext_segments.size(); i++)
+        input.add_unchecked(ext_segments[i].base, ext_segments[i].len);
+
+      if (!compressor->compress(input, output))
+        return false;
+
+      data.set(new uint8_t [header_len], header_len, true);
+      data_ptr = data.base + header_len;
+      compressed = output.release(&len);
+      ext.set(compressed, len, true);
+      ext_ptr = ext.base;
+      ext_segments.clear();
+      segment = 0;
+      segment_ptr = 0;
+      header.flags |= CommHeader::FLAGS_BIT_COMPRESSED;
+      header.set_total_length(header_len + len);
+      return true;
+    }
+
+    /**
+     * Computes the crc32c of the payload (primary buffer after the header,
+     * extended buffer and segments) into the header and sets
+     * FLAGS_BIT_PAYLOAD_CHECKSUM, or clears the flag if enable is false.
+     * Must be called after the payload is complete and before
+     * write_header_and_reset().
+     */
+    void set_payload_checksum(bool enable) {
+      if (!enable) {
+        header.flags &= CommHeader::FLAGS_MASK_PAYLOAD_CHECKSUM;
+        header.payload_checksum = 0;
+        return;
+      }
+      uint32_t crc = crc32c(data.base + header.encoded_length(),
+                            data.size - header.encoded_length());
+      if (ext.base != 0)
+        crc = crc32c_update(crc, ext.base, ext.size);
+      for (size_t i=0; i<ext_segments.size(); i++)
+        crc = crc32c_update(crc, ext_segments[i].base, ext_segments[i].len);
+      header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM;
+      header.payload_checksum = crc;
+    }
+
     /**
      * Encodes the header at the beginning of the primary buffer and
      * resets the primary and extended data pointers to point to the
@@ -120,6 +257,80 @@ namespace Hypertable {
       header.encode(&buf);
       data_ptr = data.base;
       ext_ptr = ext.base;
+      segment = 0;
+      segment_ptr = ext_segments.empty() ? 0 : ext_segments[0].base;
+    }
+
+    /**
+     * Fills vec with the unwritten portions of the message, in order, up
+     * to max entries (at least one).  A message with more parts than fit
+     * in vec is written with several calls.
+     *
+     * @param vec iovec array to fill
+     * @param max number of entries in vec
+     * @param lenp address of variable to hold the total length of vec
+     * @return number of entries filled in
+     */
+    int fill_iovec(struct iovec *vec, int max, size_t *lenp) {
+      int count = 0;
+      size_t remaining = data.size - (data_ptr - data.base);
+      *lenp = 0;
+      if (remaining > 0) {
+        vec[count].iov_base = (void *)data_ptr;
+        vec[count++].iov_len = remaining;
+        *lenp += remaining;
+      }
+      if (ext.base != 0 && count < max) {
+        remaining = ext.size - (ext_ptr - ext.base);
+        if (remaining > 0) {
+          vec[count].iov_base = (void *)ext_ptr;
+          vec[count++].iov_len = remaining;
+          *lenp += remaining;
+        }
+      }
+      for (size_t i=segment; i<ext_segments.size() && count<max; i++) {
+        const uint8_t *ptr = (i == segment) ? segment_ptr : ext_segments[i].base;
+        remaining = ext_segments[i].len - (ptr - ext_segments[i].base);
+        if (remaining > 0) {
+          vec[count].iov_base = (void *)ptr;
+          vec[count++].iov_len = remaining;
+          *lenp += remaining;
+        }
+      }
+      return count;
+    }
+
+    /**
+     * Marks len more bytes of the message as written.
+     *
+     * @param len number of bytes written
+     * @return true if the entire message has been written
+     */
+    bool advance(size_t len) {
+      size_t remaining = data.size - (data_ptr - data.base);
+      size_t n = std::min(len, remaining);
+      data_ptr += n;
+      len -= n;
+      if (ext.base != 0) {
+        remaining = ext.size - (ext_ptr - ext.base);
+        n = std::min(len, remaining);
+        ext_ptr += n;
+        len -= n;
+        if (ext_ptr < ext.base + ext.size)
+          return false;
+      }
+      while (segment < ext_segments.size()) {
+        remaining = ext_segments[segment].len
+                    - (segment_ptr - ext_segments[segment].base);
+        if (len < remaining) {
+          segment_ptr += len;
+          return false;
+        }
+        len -= remaining;
+        if (++segment < ext_segments.size())
+          segment_ptr = ext_segments[segment].base;
+      }
+      return data_ptr == data.base + data.size;
     }
 
     /**
@@ -264,11 +475,14 @@ namespace Hypertable {
 
     StaticBuffer data;
     StaticBuffer ext;
+    SegmentVector ext_segments;
     CommHeader header;
 
   protected:
     uint8_t *data_ptr;
     const uint8_t *ext_ptr;
+    size_t segment;
+    const uint8_t *segment_ptr;
   };
 
   typedef intrusive_ptr<CommBuf> CommBufPtr;
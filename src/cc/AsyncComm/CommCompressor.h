@@ -0,0 +1,67 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_COMMCOMPRESSOR_H
+#define HYPERTABLE_COMMCOMPRESSOR_H
+
+#include "Common/DynamicBuffer.h"
+#include "Common/ReferenceCount.h"
+
+namespace Hypertable {
+
+  /**
+   * Abstract base class for message payload compressors.  AsyncComm has no
+   * codecs of its own; the application installs one with
+   * Comm::set_compressor().  Payloads are compressed by the threads that
+   * send them and decompressed by the reactor threads, so implementations
+   * must be safe to call concurrently.
+   */
+  class CommCompressor : public ReferenceCount {
+  public:
+    virtual ~CommCompressor() { }
+
+    /**
+     * Compresses input into output.
+     *
+     * @param input payload to compress
+     * @param output receives the compressed payload
+     * @return false if the payload does not get any smaller
+     */
+    virtual bool compress(const DynamicBuffer &input,
+                          DynamicBuffer &output) = 0;
+
+    /**
+     * Decompresses a payload produced by compress() on the peer.  Throws
+     * an exception if the payload is corrupt.
+     *
+     * @param data compressed payload
+     * @param len length of compressed payload
+     * @param output receives the original payload
+     */
+    virtual void decompress(const uint8_t *data, size_t len,
+                            DynamicBuffer &output) = 0;
+  };
+
+  typedef intrusive_ptr<CommCompressor> CommCompressorPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_COMMCOMPRESSOR_H
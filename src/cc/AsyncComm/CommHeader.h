@@ -35,11 +35,23 @@ namespace Hypertable {
     static const uint16_t FLAGS_BIT_REQUEST          = 0x0001;
     static const uint16_t FLAGS_BIT_IGNORE_RESPONSE  = 0x0002;
     static const uint16_t FLAGS_BIT_URGENT           = 0x0004;
+    /** payload was compressed with the sender's CommCompressor */
+    static const uint16_t FLAGS_BIT_COMPRESSED       = 0x0008;
+    /**
+     * The sender takes compressed payloads.  There is one bit for requests
+     * and one for responses because older versions copy the flags of a
+     * request into its response.
+     */
+    static const uint16_t FLAGS_BIT_REQUEST_ACCEPTS_COMPRESSED  = 0x0010;
+    static const uint16_t FLAGS_BIT_RESPONSE_ACCEPTS_COMPRESSED = 0x0020;
+    /** payload_checksum holds the crc32c of the payload */
     static const uint16_t FLAGS_BIT_PAYLOAD_CHECKSUM = 0x8000;
 
     static const uint16_t FLAGS_MASK_REQUEST          = 0xFFFE;
     static const uint16_t FLAGS_MASK_IGNORE_RESPONSE  = 0xFFFD;
     static const uint16_t FLAGS_MASK_URGENT           = 0xFFFB;
+    static const uint16_t FLAGS_MASK_COMPRESSED       = 0xFFF7;
+    static const uint16_t FLAGS_MASK_ACCEPTS_COMPRESSED = 0xFFCF;
     static const uint16_t FLAGS_MASK_PAYLOAD_CHECKSUM = 0x7FFF;
 
     CommHeader()
@@ -61,7 +73,8 @@ namespace Hypertable {
     void set_total_length(uint32_t len) { total_len = len; }
 
     void initialize_from_request_header(CommHeader &req_header) {
-      flags = req_header.flags;
+      flags = req_header.flags & FLAGS_MASK_COMPRESSED
+              & FLAGS_MASK_ACCEPTS_COMPRESSED;
       id = req_header.id;
       gid = req_header.gid;
       command = req_header.command;
@@ -33,7 +33,8 @@ using namespace Hypertable;
  *
  */
 DispatchHandlerSynchronizer::DispatchHandlerSynchronizer()
-  : m_receive_queue(), m_mutex(), m_cond() {
+  : m_receive_queue(), m_mutex(), m_cond(), m_notify_mutex(0),
+    m_notify_cond(0) {
   return;
 }
 
@@ -43,6 +44,21 @@ DispatchHandlerSynchronizer::DispatchHandlerSynchronizer()
  *
  */
 void DispatchHandlerSynchronizer::handle(EventPtr &event_ptr) {
+  // Once the event is queued, the waiter may destroy this object, so the
+  // notify members are copied first and not touched afterwards
+  Mutex *notify_mutex = m_notify_mutex;
+  boost::condition *notify_cond = m_notify_cond;
+
+  if (notify_mutex) {
+    ScopedLock notify_lock(*notify_mutex);
+    {
+      ScopedLock lock(m_mutex);
+      m_receive_queue.push(event_ptr);
+      m_cond.notify_one();
+    }
+    notify_cond->notify_all();
+    return;
+  }
   ScopedLock lock(m_mutex);
   m_receive_queue.push(event_ptr);
   m_cond.notify_one();
@@ -68,3 +84,13 @@ bool DispatchHandlerSynchronizer::wait_for_reply(EventPtr &event_ptr) {
 
   return false;
 }
+
+
+
+/**
+ *
+ */
+bool DispatchHandlerSynchronizer::has_reply() {
+  ScopedLock lock(m_mutex);
+  return !m_receive_queue.empty();
+}
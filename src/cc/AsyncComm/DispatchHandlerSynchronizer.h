@@ -95,10 +95,36 @@ namespace Hypertable {
      */
     bool wait_for_reply(EventPtr &event_ptr);
 
+    /**
+     * Returns true if a reply has been received and not yet consumed,
+     * i.e. the next call to wait_for_reply will not block.
+     */
+    bool has_reply();
+
+    /**
+     * Registers an additional condition variable that gets signalled
+     * (notify_all) whenever an event is put on the queue.  This allows a
+     * client to wait on several synchronizers at once.  The event is
+     * enqueued while holding the supplied mutex, so checking has_reply
+     * under that mutex cannot miss a wakeup.  Must be called before any
+     * request is sent with this handler.  The mutex and condition must
+     * outlive this handler; the handler does not touch itself after the
+     * event is enqueued, but signals cond while holding mutex.
+     *
+     * @param mutex mutex protecting the condition
+     * @param cond condition variable to signal
+     */
+    void set_notify(Mutex *mutex, boost::condition *cond) {
+      m_notify_mutex = mutex;
+      m_notify_cond = cond;
+    }
+
   private:
     std::queue<EventPtr> m_receive_queue;
     Mutex                m_mutex;
     boost::condition     m_cond;
+    Mutex               *m_notify_mutex;
+    boost::condition    *m_notify_cond;
   };
 
 } // namespace Hypertable
@@ -29,6 +29,7 @@
 #include "Common/String.h"
 #include "Common/ReferenceCount.h"
 
+#include "BufferPool.h"
 #include "CommHeader.h"
 
 namespace Hypertable {
@@ -60,10 +61,14 @@ namespace Hypertable {
     Event(Type ct, int err=0) : type(ct), error(err), payload(0),
         payload_len(0), thread_group(0) { }
 
-    /** Destroys event.  Deallocates message data
+    /** Destroys event.  Deallocates message data, or returns it to
+     * payload_pool if it came from there
      */
     ~Event() {
-      delete [] payload;
+      if (payload_pool)
+        payload_pool->release((uint8_t *)payload);
+      else
+        delete [] payload;
     }
 
     /** Loads header object from serialized buffer.  This method
@@ -107,6 +112,9 @@ namespace Hypertable {
     /** Length of the message */
     size_t payload_len;
 
+    /** Pool the payload was allocated from, null if allocated with new[] */
+    BufferPoolPtr payload_pool;
+
     /** Thread group to which this message belongs.  Used to serialize
      * messages destined for the same object.  This value is created in
      * the constructor and is the combination of the socked descriptor from
@@ -37,46 +37,65 @@
 
 #include "IOHandlerData.h"
 #include "IOHandlerDatagram.h"
+#include "ReactorFactory.h"
 
 namespace Hypertable {
 
+  /**
+   * Maps addresses to I/O handlers.  The map is split into one shard per
+   * reactor.  A connection is owned by the reactor that its address hashes
+   * to (see ReactorFactory::get_reactor) and is entered into that
+   * reactor's shard, so lookups, inserts and removals for connections of
+   * different reactors never contend for the same lock.  An alias lives in
+   * the shard its own address hashes to.
+   */
   class HandlerMap : public ReferenceCount {
 
   public:
 
+    HandlerMap(size_t shard_count)
+      : m_shards(new Shard [shard_count]), m_shard_count(shard_count) { }
+
+    virtual ~HandlerMap() { delete [] m_shards; }
+
     void insert_handler(IOHandler *handler) {
-      ScopedLock lock(m_mutex);
-      assert(m_handler_map.find(handler->get_address()) == m_handler_map.end());
-      m_handler_map[handler->get_address()] = handler;
+      Shard &shard = get_shard(handler->get_address());
+      ScopedLock lock(shard.mutex);
+      assert(shard.handler_map.find(handler->get_address())
+             == shard.handler_map.end());
+      shard.handler_map[handler->get_address()] = handler;
     }
 
     int set_alias(const sockaddr_in &addr, const sockaddr_in &alias) {
-      ScopedLock lock(m_mutex);
-      SockAddrMap<IOHandlerPtr>::iterator iter;
-
-      if (m_handler_map.find(alias) != m_handler_map.end())
-        return Error::COMM_CONFLICTING_ADDRESS;
-
-      if ((iter = m_handler_map.find(addr)) == m_handler_map.end())
-        return Error::COMM_NOT_CONNECTED;
+      Shard &shard = get_shard(addr);
+      Shard &alias_shard = get_shard(alias);
 
-      (*iter).second->set_alias(alias);
-      m_handler_map[alias] = (*iter).second;
+      if (&shard == &alias_shard) {
+        ScopedLock lock(shard.mutex);
+        return set_alias(shard, addr, alias_shard, alias);
+      }
 
-      return Error::OK;
+      // lock in shard order so concurrent calls can't deadlock
+      Shard &first = (&shard < &alias_shard) ? shard : alias_shard;
+      Shard &second = (&shard < &alias_shard) ? alias_shard : shard;
+      ScopedLock lock1(first.mutex);
+      ScopedLock lock2(second.mutex);
+      return set_alias(shard, addr, alias_shard, alias);
     }
 
     bool contains_handler(const sockaddr_in &addr) {
-      ScopedLock lock(m_mutex);
-      return lookup_handler(addr);
+      Shard &shard = get_shard(addr);
+      ScopedLock lock(shard.mutex);
+      return shard.handler_map.find(addr) != shard.handler_map.end();
     }
 
     bool lookup_data_handler(const sockaddr_in &addr,
                              IOHandlerDataPtr &io_handler_data) {
-      ScopedLock lock(m_mutex);
-      IOHandler *handler = lookup_handler(addr);
-      if (handler) {
-        io_handler_data = dynamic_cast<IOHandlerData *>(handler);
+      Shard &shard = get_shard(addr);
+      ScopedLock lock(shard.mutex);
+      SockAddrMap<IOHandlerPtr>::iterator iter = shard.handler_map.find(addr);
+      if (iter != shard.handler_map.end()) {
+        io_handler_data = dynamic_cast<IOHandlerData *>((*iter).second.get());
         if (io_handler_data)
           return true;
       }
@@ -84,19 +103,21 @@ namespace Hypertable {
     }
 
     void insert_datagram_handler(IOHandler *handler) {
-      ScopedLock lock(m_mutex);
-      HT_ASSERT(m_datagram_handler_map.find(handler->get_local_address())
-                == m_datagram_handler_map.end());
-      m_datagram_handler_map[handler->get_local_address()] = handler;
+      Shard &shard = get_shard(handler->get_local_address());
+      ScopedLock lock(shard.mutex);
+      HT_ASSERT(shard.datagram_handler_map.find(handler->get_local_address())
+                == shard.datagram_handler_map.end());
+      shard.datagram_handler_map[handler->get_local_address()] = handler;
     }
 
     bool lookup_datagram_handler(const sockaddr_in &addr,
                                  IOHandlerDatagramPtr &io_handler_dg) {
-      ScopedLock lock(m_mutex);
+      Shard &shard = get_shard(addr);
+      ScopedLock lock(shard.mutex);
       SockAddrMap<IOHandlerPtr>::iterator iter =
-          m_datagram_handler_map.find(addr);
+          shard.datagram_handler_map.find(addr);
 
-      if (iter == m_handler_map.end())
+      if (iter == shard.datagram_handler_map.end())
         return false;
 
       io_handler_dg = (IOHandlerDatagram *)(*iter).second.get();
@@ -104,42 +125,48 @@ namespace Hypertable {
       return true;
     }
 
-    bool remove_handler(const sockaddr_in &addr, IOHandlerPtr &handler) {
+    /**
+     * Removes the handler for addr, along with its alias, and parks it
+     * until purge_handler() is called.  All shards are locked for the
+     * removal, so no other thread can look the handler up under one of its
+     * addresses or set an alias for it once the other address is gone.
+     */
+    bool decomission_handler(const sockaddr_in &addr, IOHandlerPtr &handler) {
       SockAddrMap<IOHandlerPtr>::iterator iter;
+      bool datagram = false;
 
-      if ((iter = m_handler_map.find(addr)) != m_handler_map.end()) {
-        handler = (*iter).second;
-        m_handler_map.erase(iter);
-        struct sockaddr_in alias;
-        handler->get_alias(&alias);
+      lock_all();
 
-        if (alias.sin_port != 0) {
-          if ((iter = m_handler_map.find(alias)) != m_handler_map.end())
-            m_handler_map.erase(iter);
-          else {
-            HT_ERRORF("Unable to find mapping for alias (%s) in HandlerMap",
-                      InetAddr::format(alias).c_str());
-          }
-        }
-      }
-      else if ((iter = m_datagram_handler_map.find(addr))
-                != m_datagram_handler_map.end()) {
+      Shard &shard = get_shard(addr);
+      if ((iter = shard.handler_map.find(addr)) != shard.handler_map.end())
         handler = (*iter).second;
-        m_datagram_handler_map.erase(iter);
+      else if ((iter = shard.datagram_handler_map.find(addr))
+               != shard.datagram_handler_map.end()) {
+        handler = (*iter).second;
+        shard.datagram_handler_map.erase(iter);
+        datagram = true;
       }
-      else
+      else {
+        unlock_all();
         return false;
-      return true;
-    }
+      }
 
-    bool decomission_handler(const sockaddr_in &addr, IOHandlerPtr &handler) {
-      ScopedLock lock(m_mutex);
+      if (!datagram) {
+        struct sockaddr_in alias;
 
-      if (remove_handler(addr, handler)) {
-        m_decomissioned_handlers.insert(handler);
-        return true;
+        // addr may be the alias, so drop both mappings
+        handler->get_alias(&alias);
+        erase_mapping(handler->get_address(), handler);
+        if (alias.sin_port != 0 && !erase_mapping(alias, handler)) {
+          HT_ERRORF("Unable to find mapping for alias (%s) in HandlerMap",
+                    InetAddr::format(alias).c_str());
+        }
       }
-      return false;
+
+      get_shard(handler->get_address()).decomissioned_handlers.insert(handler);
+
+      unlock_all();
+      return true;
     }
 
     bool decomission_handler(const sockaddr_in &addr) {
@@ -148,52 +175,116 @@ namespace Hypertable {
     }
 
     void purge_handler(IOHandler *handler) {
-      ScopedLock lock(m_mutex);
-      m_decomissioned_handlers.erase(handler);
-      if (m_decomissioned_handlers.empty())
-        m_cond.notify_all();
+      Shard &shard = get_shard(handler->get_address());
+      ScopedLock lock(shard.mutex);
+      shard.decomissioned_handlers.erase(handler);
+      if (shard.decomissioned_handlers.empty())
+        shard.cond.notify_all();
     }
 
     void decomission_all(std::set<IOHandler *> &handlers) {
-      ScopedLock lock(m_mutex);
       SockAddrMap<IOHandlerPtr>::iterator iter;
 
-      // TCP handlers
-      for (iter = m_handler_map.begin(); iter != m_handler_map.end(); ++iter) {
-        m_decomissioned_handlers.insert((*iter).second);
-        handlers.insert((*iter).second.get());
+      for (size_t i=0; i<m_shard_count; i++) {
+        Shard &shard = m_shards[i];
+        ScopedLock lock(shard.mutex);
+
+        // TCP handlers (aliases show up again in their own shard, but
+        // std::set weeds out the duplicates)
+        for (iter = shard.handler_map.begin();
+             iter != shard.handler_map.end(); ++iter)
+          handlers.insert((*iter).second.get());
+        shard.handler_map.clear();
+
+        // UDP handlers
+        for (iter = shard.datagram_handler_map.begin();
+             iter != shard.datagram_handler_map.end(); ++iter)
+          handlers.insert((*iter).second.get());
+        shard.datagram_handler_map.clear();
       }
-      m_handler_map.clear();
 
-      // UDP handlers
-      for (iter = m_datagram_handler_map.begin();
-           iter != m_datagram_handler_map.end(); ++iter) {
-        m_decomissioned_handlers.insert((*iter).second);
-        handlers.insert((*iter).second.get());
-      }
-      m_datagram_handler_map.clear();
+      foreach(IOHandler *handler, handlers)
+        park(handler);
     }
 
     void wait_for_empty() {
-      ScopedLock lock(m_mutex);
-      if (!m_decomissioned_handlers.empty())
-        m_cond.wait(lock);
+      for (size_t i=0; i<m_shard_count; i++) {
+        ScopedLock lock(m_shards[i].mutex);
+        if (!m_shards[i].decomissioned_handlers.empty())
+          m_shards[i].cond.wait(lock);
+      }
     }
 
   private:
 
-    IOHandler *lookup_handler(const sockaddr_in &addr) {
-      SockAddrMap<IOHandlerPtr>::iterator iter = m_handler_map.find(addr);
-      if (iter == m_handler_map.end())
-        return 0;
-      return (*iter).second.get();
+    struct Shard {
+      Mutex                      mutex;
+      boost::condition           cond;
+      SockAddrMap<IOHandlerPtr>  handler_map;
+      SockAddrMap<IOHandlerPtr>  datagram_handler_map;
+      std::set<IOHandlerPtr, ltiohp>  decomissioned_handlers;
+    };
+
+    /**
+     * Locks every shard, in shard order like set_alias() does
+     */
+    void lock_all() {
+      for (size_t i=0; i<m_shard_count; i++)
+        m_shards[i].mutex.lock();
+    }
+
+    void unlock_all() {
+      for (size_t i=m_shard_count; i>0; i--)
+        m_shards[i-1].mutex.unlock();
+    }
+
+    /**
+     * Drops the mapping of addr if it maps to handler; the caller holds
+     * all shard locks
+     */
+    bool erase_mapping(const sockaddr_in &addr, IOHandlerPtr &handler) {
+      Shard &shard = get_shard(addr);
+      SockAddrMap<IOHandlerPtr>::iterator iter = shard.handler_map.find(addr);
+      bool found = false;
+      if (iter != shard.handler_map.end() && (*iter).second == handler) {
+        shard.handler_map.erase(iter);
+        found = true;
+      }
+      return found;
+    }
+
+    /**
+     * Holds on to a decomissioned handler until purge_handler() is called
+     * for it.  Handlers are kept in the shard of their own address.
+     */
+    void park(IOHandler *handler) {
+      Shard &shard = get_shard(handler->get_address());
+      ScopedLock lock(shard.mutex);
+      shard.decomissioned_handlers.insert(handler);
+    }
+
+    int set_alias(Shard &shard, const sockaddr_in &addr,
+                  Shard &alias_shard, const sockaddr_in &alias) {
+      SockAddrMap<IOHandlerPtr>::iterator iter;
+
+      if (alias_shard.handler_map.find(alias) != alias_shard.handler_map.end())
+        return Error::COMM_CONFLICTING_ADDRESS;
+
+      if ((iter = shard.handler_map.find(addr)) == shard.handler_map.end())
+        return Error::COMM_NOT_CONNECTED;
+
+      (*iter).second->set_alias(alias);
+      alias_shard.handler_map[alias] = (*iter).second;
+
+      return Error::OK;
+    }
+
+    Shard &get_shard(const sockaddr_in &addr) {
+      return m_shards[ReactorFactory::hash_address(addr) % m_shard_count];
     }
 
-    Mutex                      m_mutex;
-    boost::condition           m_cond;
-    SockAddrMap<IOHandlerPtr>  m_handler_map;
-    SockAddrMap<IOHandlerPtr>  m_datagram_handler_map;
-    std::set<IOHandlerPtr, ltiohp>  m_decomissioned_handlers;
+    Shard  *m_shards;
+    size_t  m_shard_count;
   };
   typedef boost::intrusive_ptr<HandlerMap> HandlerMapPtr;
 
@@ -58,7 +58,7 @@ namespace Hypertable {
 
     IOHandler(int sd, const sockaddr_in &addr, DispatchHandlerPtr &dhp)
       : m_free_flag(0), m_addr(addr), m_sd(sd), m_dispatch_handler_ptr(dhp) {
-      ReactorFactory::get_reactor(m_reactor_ptr);
+      ReactorFactory::get_reactor(addr, m_reactor_ptr);
       m_poll_interest = 0;
       socklen_t namelen = sizeof(m_local_addr);
       getsockname(m_sd, (sockaddr *)&m_local_addr, &namelen);
@@ -152,6 +152,14 @@ namespace Hypertable {
       memcpy(addrp, &m_local_addr, sizeof(struct sockaddr_in));
     }
 
+    /**
+     * Overrides the local address, for Unix domain sockets which have no
+     * IP address of their own
+     */
+    void set_local_address(const sockaddr_in &addr) {
+      memcpy(&m_local_addr, &addr, sizeof(m_local_addr));
+    }
+
     void set_alias(const sockaddr_in &alias) {
       memcpy(&m_alias, &alias, sizeof(m_alias));
     }
@@ -26,7 +26,9 @@ using namespace std;
 
 extern "C" {
 #include <errno.h>
+#include <fcntl.h>
 #include <netinet/tcp.h>
+#include <sys/un.h>
 }
 
 #define HT_DISABLE_LOG_DEBUG 1
@@ -41,6 +43,8 @@ extern "C" {
 #include "ReactorFactory.h"
 using namespace Hypertable;
 
+atomic_t IOHandlerAccept::ms_next_unix_peer = ATOMIC_INIT(0);
+
 
 /**
  *
@@ -66,19 +70,32 @@ bool IOHandlerAccept::handle_event(struct epoll_event *event, clock_t ) {
 bool IOHandlerAccept::handle_incoming_connection() {
   int sd;
   struct sockaddr_in addr;
-  socklen_t addr_len = sizeof(sockaddr_in);
+  struct sockaddr_un unix_addr;
+  socklen_t addr_len;
   int one = 1;
   IOHandlerData *data_handler;
 
   while (true) {
 
-    if ((sd = accept(m_sd, (struct sockaddr *)&addr, &addr_len)) < 0) {
+    if (m_unix_socket) {
+      addr_len = sizeof(unix_addr);
+      sd = accept(m_sd, (struct sockaddr *)&unix_addr, &addr_len);
+    }
+    else {
+      addr_len = sizeof(addr);
+      sd = accept(m_sd, (struct sockaddr *)&addr, &addr_len);
+    }
+
+    if (sd < 0) {
       if (errno == EAGAIN)
         break;
       HT_ERRORF("accept() failure: %s", strerror(errno));
       break;
     }
 
+    if (m_unix_socket)
+      unix_peer_address(&addr);
+
     HT_DEBUGF("Just accepted incoming connection, fd=%d (%s:%d)",
               m_sd, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
 
@@ -86,7 +103,8 @@ bool IOHandlerAccept::handle_incoming_connection() {
     FileUtils::set_flags(sd, O_NONBLOCK);
 
 #if defined(__linux__)
-    if (setsockopt(sd, SOL_TCP, TCP_NODELAY, &one, sizeof(one)) < 0)
+    if (!m_unix_socket &&
+        setsockopt(sd, SOL_TCP, TCP_NODELAY, &one, sizeof(one)) < 0)
       HT_WARNF("setsockopt(TCP_NODELAY) failure: %s", strerror(errno));
 #elif defined(__APPLE__)
     if (setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)) < 0)
@@ -108,6 +126,8 @@ bool IOHandlerAccept::handle_incoming_connection() {
     m_handler_factory_ptr->get_instance(dhp);
 
     data_handler = new IOHandlerData(sd, addr, dhp);
+    if (m_unix_socket)
+      data_handler->set_unix_socket(m_local_addr);
 
     IOHandlerPtr handler(data_handler);
     m_handler_map_ptr->insert_handler(data_handler);
@@ -118,3 +138,22 @@ bool IOHandlerAccept::handle_incoming_connection() {
 
   return false;
  }
+
+
+sockaddr_in IOHandlerAccept::unix_listener_address(uint16_t port) {
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(0x00FFFFFF);
+  addr.sin_port = htons(port);
+  return addr;
+}
+
+
+void IOHandlerAccept::unix_peer_address(sockaddr_in *addr) {
+  uint32_t peer = (uint32_t)atomic_inc_return(&ms_next_unix_peer);
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl((peer - 1) % 0x00FFFFFE + 1);
+  addr->sin_port = m_addr.sin_port;
+}
@@ -23,6 +23,8 @@
 #ifndef HYPERTABLE_IOHANDLERACCEPT_H
 #define HYPERTABLE_IOHANDLERACCEPT_H
 
+#include "Common/atomic.h"
+
 #include "HandlerMap.h"
 #include "IOHandler.h"
 #include "ConnectionHandlerFactory.h"
@@ -36,10 +38,16 @@ namespace Hypertable {
 
   public:
 
+    /**
+     * @param unix_socket whether sd is a Unix domain socket; the
+     *        connections accepted on it are given made-up peer addresses
+     *        (see unix_peer_address())
+     */
     IOHandlerAccept(int sd, sockaddr_in &addr, DispatchHandlerPtr &dhp,
-                    HandlerMapPtr &hmap, ConnectionHandlerFactoryPtr &chfp)
+                    HandlerMapPtr &hmap, ConnectionHandlerFactoryPtr &chfp,
+                    bool unix_socket = false)
       : IOHandler(sd, addr, dhp), m_handler_map_ptr(hmap),
-        m_handler_factory_ptr(chfp) {
+        m_handler_factory_ptr(chfp), m_unix_socket(unix_socket) {
       return;
     }
 
@@ -58,9 +66,23 @@ namespace Hypertable {
 
     bool handle_incoming_connection();
 
+    /**
+     * Returns the address identifying the Unix domain socket listener for
+     * port.  Connections over Unix domain sockets are identified by
+     * addresses in 0.0.0.0/8, which no TCP peer can have; the listener gets
+     * 0.255.255.255 and its connections 0.0.0.1 onwards, all with the
+     * port of the listener.
+     */
+    static sockaddr_in unix_listener_address(uint16_t port);
+
   private:
+    void unix_peer_address(sockaddr_in *addr);
+
     HandlerMapPtr m_handler_map_ptr;
     ConnectionHandlerFactoryPtr m_handler_factory_ptr;
+    bool m_unix_socket;
+
+    static atomic_t ms_next_unix_peer;
   };
 
   typedef intrusive_ptr<IOHandlerAccept> IOHandlerAcceptPtr;
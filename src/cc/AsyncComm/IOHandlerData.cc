@@ -21,7 +21,9 @@
 
 #include "Common/Compat.h"
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <iostream>
 using namespace std;
 
@@ -35,6 +37,7 @@ extern "C" {
 #endif
 }
 
+#include "Common/Checksum.h"
 #include "Common/Error.h"
 #include "Common/FileUtils.h"
 #include "Common/InetAddr.h"
@@ -43,6 +46,11 @@ extern "C" {
 #include "IOHandlerData.h"
 using namespace Hypertable;
 
+bool IOHandlerData::ms_payload_checksum = false;
+CommCompressorPtr IOHandlerData::ms_compressor;
+size_t IOHandlerData::ms_compression_min_size = 0;
+bool IOHandlerData::ms_compression = false;
+
 #if defined(__linux__)
 
 namespace {
@@ -82,12 +90,23 @@ namespace {
     return n - nleft;
   }
 
+  /**
+   * Writes the iovecs with a single sendmsg call, retrying on EINTR.  flags
+   * is passed on to sendmsg (MSG_MORE when more data follows right away).
+   */
   ssize_t
-  et_socket_writev(int fd, const iovec *vector, int count, int *errnop) {
+  et_socket_sendmsg(int fd, const iovec *vector, int count, int flags,
+                    int *errnop) {
+    struct msghdr msg;
     ssize_t nwritten;
-    while ((nwritten = ::writev(fd, vector, count)) <= 0) {
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (iovec *)vector;
+    msg.msg_iovlen = count;
+
+    while ((nwritten = ::sendmsg(fd, &msg, flags)) <= 0) {
       if (errno == EINTR) {
-        nwritten = 0; /* and call write() again */
+        nwritten = 0; /* and call sendmsg() again */
         continue;
       }
       *errnop = errno;
@@ -327,7 +346,12 @@ void IOHandlerData::handle_message_header(clock_t arrival_clocks) {
   m_event->load_header(m_sd, m_message_header, header_len);
   m_event->arrival_clocks = arrival_clocks;
 
-  m_message = new uint8_t [m_event->header.total_len - header_len];
+  // the event owns the payload from here on and returns it to the
+  // reactor's pool when it is destroyed
+  m_message = m_reactor_ptr->get_receive_pool()->allocate(
+      m_event->header.total_len - header_len);
+  m_event->payload = m_message;
+  m_event->payload_pool = m_reactor_ptr->get_receive_pool();
   m_message_ptr = m_message;
   m_message_remaining = m_event->header.total_len - header_len;
   m_message_header_remaining = 0;
@@ -339,6 +363,51 @@ void IOHandlerData::handle_message_header(clock_t arrival_clocks) {
 void IOHandlerData::handle_message_body() {
   DispatchHandler *dh = 0;
 
+  // a corrupt message fails the connection (see handle_event()), which
+  // also fails the request it may be a response to
+  if (m_event->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM) {
+    size_t len = m_event->header.total_len - m_event->header.header_len;
+    uint32_t checksum = crc32c(m_message, len);
+    if (checksum != m_event->header.payload_checksum) {
+      uint32_t expected = m_event->header.payload_checksum;
+      delete m_event;
+      reset_incoming_message_state();
+      HT_THROWF(Error::COMM_PAYLOAD_CHECKSUM_MISMATCH, "from %s: %u != %u",
+                InetAddr::format(m_addr).c_str(), checksum, expected);
+    }
+  }
+
+  m_event->payload_len = m_event->header.total_len
+                         - m_event->header.header_len;
+
+  if (m_event->header.flags & CommHeader::FLAGS_BIT_COMPRESSED) {
+    DynamicBuffer payload;
+    try {
+      if (!ms_compressor)
+        HT_THROW(Error::COMM_BAD_HEADER, "no compressor installed");
+      ms_compressor->decompress(m_message, m_event->payload_len, payload);
+    }
+    catch (Exception &e) {
+      delete m_event;
+      reset_incoming_message_state();
+      HT_THROW2F(e.code(), e, "decompressing payload from %s",
+                 InetAddr::format(m_addr).c_str());
+    }
+    // the decompressed payload replaces the pooled buffer
+    m_event->payload_pool->release(m_message);
+    m_event->payload_pool = 0;
+    m_event->payload = payload.release(&m_event->payload_len);
+  }
+
+  if (m_event->header.flags & CommHeader::FLAGS_BIT_REQUEST) {
+    if (m_event->header.flags
+        & CommHeader::FLAGS_BIT_REQUEST_ACCEPTS_COMPRESSED)
+      atomic_set(&m_peer_accepts_compressed, 1);
+  }
+  else if (m_event->header.flags
+           & CommHeader::FLAGS_BIT_RESPONSE_ACCEPTS_COMPRESSED)
+    atomic_set(&m_peer_accepts_compressed, 1);
+
   if ((m_event->header.flags & CommHeader::FLAGS_BIT_REQUEST) == 0 &&
       (m_event->header.id == 0
       || (dh = m_reactor_ptr->remove_request(m_event->header.id)) == 0)) {
@@ -347,15 +416,10 @@ void IOHandlerData::handle_message_body() {
                "=%d,total_len=%d)", m_event->header.id, m_event->header.version,
                m_event->header.total_len);
     }
-    delete [] m_message;
     delete m_event;
   }
-  else {
-    m_event->payload = m_message;
-    m_event->payload_len = m_event->header.total_len
-                           - m_event->header.header_len;
+  else
     deliver_event( m_event, dh );
-  }
 
   reset_incoming_message_state();
 }
@@ -393,7 +457,8 @@ bool IOHandlerData::handle_write_readiness() {
       HT_ERRORF("setsockopt(SO_RCVBUF) failed - %s", strerror(errno));
     }
 
-    if (getsockname(m_sd, (struct sockaddr *)&m_local_addr, &name_len) < 0) {
+    if (!m_unix_socket &&
+        getsockname(m_sd, (struct sockaddr *)&m_local_addr, &name_len) < 0) {
       HT_ERRORF("getsockname(%d) failed - %s", m_sd, strerror(errno));
       return true;
     }
@@ -415,6 +480,26 @@ bool IOHandlerData::handle_write_readiness() {
 }
 
 
+void IOHandlerData::compress_payload(CommBuf *cbuf) {
+  CommHeader &header = cbuf->header;
+
+  header.flags &= CommHeader::FLAGS_MASK_ACCEPTS_COMPRESSED;
+  if (!ms_compressor)
+    return;
+
+  header.flags |= (header.flags & CommHeader::FLAGS_BIT_REQUEST)
+      ? CommHeader::FLAGS_BIT_REQUEST_ACCEPTS_COMPRESSED
+      : CommHeader::FLAGS_BIT_RESPONSE_ACCEPTS_COMPRESSED;
+
+  // m_peer_accepts_compressed is set by the reactor thread and read here
+  // by the sending threads; a stale value only means that a message goes
+  // out uncompressed
+  if (m_compression && atomic_read(&m_peer_accepts_compressed)
+      && header.total_len - header.encoded_length() >= ms_compression_min_size)
+    cbuf->compress_payload(ms_compressor.get());
+}
+
+
 int
 IOHandlerData::send_message(CommBufPtr &cbp, uint32_t timeout_ms,
                             DispatchHandler *disp_handler) {
@@ -433,6 +518,12 @@ IOHandlerData::send_message(CommBufPtr &cbp, uint32_t timeout_ms,
 
   m_send_queue.push_back(cbp);
 
+  // If messages were already queued, the socket was full and the reactor
+  // flushes the queue as soon as it becomes writable again; messages sent
+  // in the meantime are coalesced into that write
+  if (!initially_empty)
+    return Error::OK;
+
   if ((error = flush_send_queue()) != Error::OK)
     return error;
 
@@ -440,156 +531,136 @@ IOHandlerData::send_message(CommBufPtr &cbp, uint32_t timeout_ms,
     add_poll_interest(Reactor::WRITE_READY);
     //HT_INFO("Adding Write interest");
   }
-  else if (!initially_empty && m_send_queue.empty()) {
-    remove_poll_interest(Reactor::WRITE_READY);
-    //HT_INFO("Removing Write interest");
-  }
 
   return Error::OK;
 }
 
 
 
+namespace {
+  /**
+   * Maximum number of iovecs handed to a single write call.  Queued
+   * messages are gathered until this many iovecs are filled; a message
+   * with more extended segments than this is written with several calls.
+   */
+  const int MAX_SEND_IOVECS = IOV_MAX;
+}
+
+
+size_t
+IOHandlerData::gather_send_queue(struct iovec *vec, int *countp,
+                                 size_t *lens, bool *morep) {
+  std::list<CommBufPtr>::iterator iter = m_send_queue.begin();
+  size_t messages = 0;
+  int count = 0;
+
+  while (iter != m_send_queue.end() && count < MAX_SEND_IOVECS) {
+    count += (*iter)->fill_iovec(vec + count, MAX_SEND_IOVECS - count,
+                                 &lens[messages++]);
+    ++iter;
+  }
+
+  *countp = count;
+  *morep = iter != m_send_queue.end();
+  return messages;
+}
+
+
+size_t
+IOHandlerData::consume_send_queue(size_t nwritten, const size_t *lens,
+                                  size_t messages) {
+  size_t completed = 0;
+
+  for (size_t i=0; i<messages; i++) {
+    size_t len = std::min(nwritten, lens[i]);
+
+    // partially written, or segments beyond MAX_SEND_IOVECS still to go
+    if (!m_send_queue.front()->advance(len))
+      break;
+
+    // buffer written successfully, now remove from queue (destroys buffer
+    // and releases the memory pinned by its segments)
+    m_send_queue.pop_front();
+    nwritten -= len;
+    completed++;
+  }
+
+  return completed;
+}
+
 #if defined(__linux__)
 
 int IOHandlerData::flush_send_queue() {
-  ssize_t nwritten, towrite, remaining;
-  struct iovec vec[2];
+  ssize_t nwritten;
+  size_t towrite;
+  struct iovec vec[MAX_SEND_IOVECS];
+  size_t lens[MAX_SEND_IOVECS];
+  size_t messages, completed = 0, syscalls = 0;
   int count;
+  bool more;
   int error = 0;
 
   while (!m_send_queue.empty()) {
 
-    CommBufPtr &cbp = m_send_queue.front();
-
-    count = 0;
+    messages = gather_send_queue(vec, &count, lens, &more);
     towrite = 0;
-    remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
-    if (remaining > 0) {
-      vec[0].iov_base = (void *)cbp->data_ptr;
-      vec[0].iov_len = remaining;
-      towrite = remaining;
-      ++count;
-    }
-    if (cbp->ext.base != 0) {
-      remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
-      if (remaining > 0) {
-        vec[count].iov_base = (void *)cbp->ext_ptr;
-        vec[count].iov_len = remaining;
-        towrite += remaining;
-        ++count;
-      }
-    }
+    for (size_t i=0; i<messages; i++)
+      towrite += lens[i];
 
-    nwritten = et_socket_writev(m_sd, vec, count, &error);
+    // hold back a partial segment if the rest of the queue follows
+    nwritten = et_socket_sendmsg(m_sd, vec, count, more ? MSG_MORE : 0,
+                                 &error);
+    syscalls++;
     if (nwritten == (ssize_t)-1) {
       if (error == EAGAIN)
-        return Error::OK;
-      HT_WARNF("FileUtils::writev(%d, len=%d) failed : %s", m_sd, (int)towrite,
-               strerror(errno));
+        break;
+      m_reactor_ptr->record_sends(completed, syscalls);
+      HT_WARNF("sendmsg(%d, len=%d) failed : %s", m_sd, (int)towrite,
+               strerror(error));
       return Error::COMM_BROKEN_CONNECTION;
     }
-    else if (nwritten < towrite) {
-      if (nwritten == 0) {
-        if (error == EAGAIN)
-          break;
-        if (error) {
-          HT_WARNF("FileUtils::writev(%d, len=%d) failed : %s", m_sd,
-                   (int)towrite, strerror(error));
-          return Error::COMM_BROKEN_CONNECTION;
-        }
-        continue;
-      }
-      remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
-      if (remaining > 0) {
-        if (nwritten < remaining) {
-          cbp->data_ptr += nwritten;
-          if (error == EAGAIN)
-            break;
-          error = 0;
-          continue;
-        }
-        else {
-          nwritten -= remaining;
-          cbp->data_ptr += remaining;
-        }
-      }
-      if (cbp->ext.base != 0) {
-        cbp->ext_ptr += nwritten;
-        if (error == EAGAIN)
-          break;
-        error = 0;
-        continue;
-      }
-    }
 
-    // buffer written successfully, now remove from queue (destroys buffer)
-    m_send_queue.pop_front();
+    completed += consume_send_queue(nwritten, lens, messages);
   }
 
+  m_reactor_ptr->record_sends(completed, syscalls);
   return Error::OK;
 }
 
 #elif defined(__APPLE__)
 
 int IOHandlerData::flush_send_queue() {
-  ssize_t nwritten, towrite, remaining;
-  struct iovec vec[2];
+  ssize_t nwritten;
+  size_t towrite;
+  struct iovec vec[MAX_SEND_IOVECS];
+  size_t lens[MAX_SEND_IOVECS];
+  size_t messages, completed = 0, syscalls = 0;
   int count;
+  bool more;
 
   while (!m_send_queue.empty()) {
 
-    CommBufPtr &cbp = m_send_queue.front();
-
-    count = 0;
+    messages = gather_send_queue(vec, &count, lens, &more);
     towrite = 0;
-    remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
-    if (remaining > 0) {
-      vec[0].iov_base = (void *)cbp->data_ptr;
-      vec[0].iov_len = remaining;
-      towrite = remaining;
-      ++count;
-    }
-    if (cbp->ext.base != 0) {
-      remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
-      if (remaining > 0) {
-        vec[count].iov_base = (void *)cbp->ext_ptr;
-        vec[count].iov_len = remaining;
-        towrite += remaining;
-        ++count;
-      }
-    }
+    for (size_t i=0; i<messages; i++)
+      towrite += lens[i];
 
     nwritten = FileUtils::writev(m_sd, vec, count);
+    syscalls++;
     if (nwritten == (ssize_t)-1) {
+      m_reactor_ptr->record_sends(completed, syscalls);
       HT_WARNF("FileUtils::writev(%d, len=%d) failed : %s", m_sd, (int)towrite,
                strerror(errno));
       return Error::COMM_BROKEN_CONNECTION;
     }
-    else if (nwritten < towrite) {
-      if (nwritten == 0)
-        break;
-      remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
-      if (remaining > 0) {
-        if (nwritten < remaining) {
-          cbp->data_ptr += nwritten;
-          break;
-        }
-        else {
-          nwritten -= remaining;
-          cbp->data_ptr += remaining;
-        }
-      }
-      if (cbp->ext.base != 0) {
-        cbp->ext_ptr += nwritten;
-        break;
-      }
-    }
 
-    // buffer written successfully, now remove from queue (destroys buffer)
-    m_send_queue.pop_front();
+    completed += consume_send_queue(nwritten, lens, messages);
+
+    if ((size_t)nwritten < towrite)
+      break;
   }
 
+  m_reactor_ptr->record_sends(completed, syscalls);
   return Error::OK;
 }
 
@@ -45,8 +45,10 @@ namespace Hypertable {
   public:
 
     IOHandlerData(int sd, struct sockaddr_in &addr, DispatchHandlerPtr &dhp)
-      : IOHandler(sd, addr, dhp), m_send_queue() {
+      : IOHandler(sd, addr, dhp), m_payload_checksum(ms_payload_checksum),
+        m_compression(ms_compression), m_unix_socket(false), m_send_queue() {
       m_connected = false;
+      atomic_set(&m_peer_accepts_compressed, 0);
       reset_incoming_message_state();
     }
 
@@ -60,11 +62,44 @@ namespace Hypertable {
       m_message_remaining = 0;
     }
 
+    /**
+     * Marks this as a connection over a Unix domain socket.  local_addr
+     * stands in for the local address, which such a socket doesn't have.
+     */
+    void set_unix_socket(const sockaddr_in &local_addr) {
+      m_unix_socket = true;
+      set_local_address(local_addr);
+    }
+
     int send_message(CommBufPtr &, uint32_t timeout_ms = 0,
                      DispatchHandler * = 0);
 
     int flush_send_queue();
 
+    /** Whether outgoing messages carry a crc32c of their payload */
+    bool get_payload_checksum() { return m_payload_checksum; }
+    void set_payload_checksum(bool enable) { m_payload_checksum = enable; }
+
+    /** Initial payload checksum setting of new connections */
+    static bool ms_payload_checksum;
+
+    /** Whether outgoing payloads are compressed once the peer takes them */
+    bool get_compression() { return m_compression; }
+    void set_compression(bool enable) { m_compression = enable; }
+
+    /**
+     * Sets the compression flags of an outgoing message and compresses its
+     * payload if compression is on, the peer has said it takes compressed
+     * payloads and the payload is at least ms_compression_min_size bytes.
+     */
+    void compress_payload(CommBuf *cbuf);
+
+    /** Payload compressor, none if null (see Comm::set_compressor()) */
+    static CommCompressorPtr ms_compressor;
+    static size_t ms_compression_min_size;
+    /** Initial compression setting of new connections */
+    static bool ms_compression;
+
 #if defined(__APPLE__)
     virtual bool handle_event(struct kevent *event, clock_t arrival_clocks);
 #elif defined(__linux__)
@@ -81,6 +116,23 @@ namespace Hypertable {
     void handle_message_body();
     void handle_disconnect(int error = Error::OK);
 
+    /**
+     * Fills vec with the unwritten parts of as many queued messages as fit.
+     * lens receives the number of bytes gathered for each of them and
+     * *morep is set if messages are left over.  Returns the number of
+     * messages gathered.
+     */
+    size_t gather_send_queue(struct iovec *vec, int *countp, size_t *lens,
+                             bool *morep);
+
+    /**
+     * Advances the messages of a gathered batch by the nwritten bytes that
+     * were written and removes the completed ones from the send queue.
+     * Returns the number of messages completed.
+     */
+    size_t consume_send_queue(size_t nwritten, const size_t *lens,
+                              size_t messages);
+
     bool                m_connected;
     Mutex               m_mutex;
     Event              *m_event;
@@ -91,6 +143,10 @@ namespace Hypertable {
     uint8_t            *m_message;
     uint8_t            *m_message_ptr;
     size_t              m_message_remaining;
+    bool                m_payload_checksum;
+    bool                m_compression;
+    atomic_t            m_peer_accepts_compressed;
+    bool                m_unix_socket;
     std::list<CommBufPtr> m_send_queue;
   };
 
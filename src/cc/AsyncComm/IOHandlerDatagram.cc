@@ -215,6 +215,7 @@ int IOHandlerDatagram::flush_send_queue() {
                                            - send_rec.second->data.base);
     assert(tosend > 0);
     assert(send_rec.second->ext.base == 0);
+    assert(send_rec.second->ext_segments.empty());
 
     nsent = FileUtils::sendto(m_sd, send_rec.second->data_ptr, tosend,
                               (sockaddr *)&send_rec.first,
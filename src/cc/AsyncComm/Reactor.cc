@@ -56,7 +56,11 @@ const int Reactor::WRITE_READY  = 0x02;
 /**
  *
  */
-Reactor::Reactor() : m_mutex(), m_interrupt_in_progress(false) {
+Reactor::Reactor(uint32_t timer_tick_millis, size_t receive_pool_bytes)
+  : m_mutex(), m_timer_wheel(timer_tick_millis),
+    m_request_cache(m_timer_wheel), m_interrupt_in_progress(false),
+    m_next_wakeup_tick(0), m_pending_requests(0),
+    m_receive_pool(new BufferPool(receive_pool_bytes)) {
   struct sockaddr_in addr;
 
 #if defined(__linux__)
@@ -127,82 +131,200 @@ Reactor::Reactor() : m_mutex(), m_interrupt_in_progress(false) {
   }
 #endif
 
-  memset(&m_next_wakeup, 0, sizeof(m_next_wakeup));
+}
+
+
+Reactor::~Reactor() {
+  std::vector<TimerWheel::Entry *> entries;
+
+  poll_loop_interrupt();
+  while (m_pending_requests) {
+    PendingRequest *req = m_pending_requests;
+    m_pending_requests = req->next;
+    delete req;
+  }
+
+  // requests are freed by the request cache
+  m_timer_wheel.clear(entries);
+  foreach(TimerWheel::Entry *entry, entries)
+    if (entry->type == TIMER_ENTRY)
+      delete static_cast<TimerNode *>(entry);
+}
+
+
+void Reactor::add_request(uint32_t id, IOHandler *handler, DispatchHandler *dh,
+                          boost::xtime &expire) {
+  PendingRequest *req = new PendingRequest;
+  PendingRequest *head;
+
+  req->id = id;
+  req->handler = handler;
+  req->dh = dh;
+  req->expire = expire;
+
+  do {
+    head = m_pending_requests;
+    req->next = head;
+  } while (__sync_val_compare_and_swap(&m_pending_requests, head, req) != head);
+
+  // The CAS above is a full barrier and schedule_wakeup() publishes
+  // m_next_wakeup_tick before checking for pending requests, so either we
+  // see the reactor's latest wakeup here or the reactor sees our request.
+  // Requests expiring in the same tick as the wakeup (or later) don't need
+  // to disturb the reactor.
+  uint64_t next_wakeup = m_next_wakeup_tick;
+  if (next_wakeup == 0 || m_timer_wheel.expire_tick(expire) < next_wakeup) {
+    ScopedLock lock(m_mutex);
+    poll_loop_interrupt();
+  }
+}
+
+
+void Reactor::record_sends(uint64_t messages, uint64_t syscalls) {
+  if (messages)
+    __sync_fetch_and_add(&m_send_stats.messages, messages);
+  if (syscalls)
+    __sync_fetch_and_add(&m_send_stats.syscalls, syscalls);
+}
+
+
+void Reactor::get_send_stats(SendStats &stats) {
+  stats.messages = __sync_fetch_and_add(&m_send_stats.messages, 0);
+  stats.syscalls = __sync_fetch_and_add(&m_send_stats.syscalls, 0);
+}
+
+
+void Reactor::add_timer(ExpireTimer &timer) {
+  ScopedLock lock(m_mutex);
+  TimerNode *node = new TimerNode;
+  node->type = TIMER_ENTRY;
+  node->handler = timer.handler;
+  m_timer_wheel.insert(node, timer.expire_time);
+  if (m_next_wakeup_tick == 0 || node->tick < m_next_wakeup_tick)
+    poll_loop_interrupt();
+}
+
+
+DispatchHandler *Reactor::remove_request(uint32_t id) {
+  ScopedLock lock(m_mutex);
+  DispatchHandler *dh = m_request_cache.remove(id);
+  if (dh == 0 && m_pending_requests) {
+    drain_pending_requests();
+    dh = m_request_cache.remove(id);
+  }
+  return dh;
+}
+
+
+void Reactor::cancel_requests(IOHandler *handler, int32_t error) {
+  ScopedLock lock(m_mutex);
+  drain_pending_requests();
+  m_request_cache.purge_requests(handler, error);
+}
+
+
+/**
+ * Moves requests handed off by add_request() into the request cache, in
+ * the order they were added.  Must be called with m_mutex locked.
+ */
+void Reactor::drain_pending_requests() {
+  PendingRequest *req = __sync_lock_test_and_set(&m_pending_requests,
+                                                 (PendingRequest *)0);
+  PendingRequest *reversed = 0;
+
+  while (req) {
+    PendingRequest *next = req->next;
+    req->next = reversed;
+    reversed = req;
+    req = next;
+  }
+
+  while (reversed) {
+    req = reversed;
+    reversed = req->next;
+    m_request_cache.insert(req->id, req->handler, req->dh, req->expire);
+    delete req;
+  }
 }
 
 
 void Reactor::handle_timeouts(PollTimeout &next_timeout) {
-  vector<ExpireTimer> expired_timers;
-  EventPtr event_ptr;
-  boost::xtime     now, next_req_timeout;
-  ExpireTimer timer;
+  std::vector<TimerWheel::Entry *> expired;
+  std::vector<DispatchHandlerPtr> timer_handlers;
+  boost::xtime now;
 
   {
     ScopedLock lock(m_mutex);
     IOHandler       *handler;
     DispatchHandler *dh;
 
+    drain_pending_requests();
+
     boost::xtime_get(&now, boost::TIME_UTC);
 
-    while ((dh = m_request_cache.get_next_timeout(now, handler,
-                                                  &next_req_timeout)) != 0) {
-      handler->deliver_event(new Event(Event::ERROR, ((IOHandlerData *)
-          handler)->get_address(), Error::REQUEST_TIMEOUT), dh);
-    }
+    m_timer_wheel.advance(now, expired);
 
-    if (next_req_timeout.sec != 0) {
-      next_timeout.set(now, next_req_timeout);
-      memcpy(&m_next_wakeup, &next_req_timeout, sizeof(m_next_wakeup));
-    }
-    else {
-      next_timeout.set_indefinite();
-      memset(&m_next_wakeup, 0, sizeof(m_next_wakeup));
-    }
-
-    if (!m_timer_heap.empty()) {
-      ExpireTimer timer;
-
-      while (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
-        if (xtime_cmp(timer.expire_time, now) > 0) {
-          if (next_req_timeout.sec == 0
-              || xtime_cmp(timer.expire_time, next_req_timeout) < 0) {
-            next_timeout.set(now, timer.expire_time);
-            memcpy(&m_next_wakeup, &timer.expire_time, sizeof(m_next_wakeup));
-          }
-          break;
-        }
-        expired_timers.push_back(timer);
-        m_timer_heap.pop();
+    foreach(TimerWheel::Entry *entry, expired) {
+      if (entry->type == TIMER_ENTRY) {
+        TimerNode *node = static_cast<TimerNode *>(entry);
+        timer_handlers.push_back(node->handler);
+        delete node;
+      }
+      else if ((dh = m_request_cache.expire(entry, handler)) != 0) {
+        handler->deliver_event(new Event(Event::ERROR, ((IOHandlerData *)
+            handler)->get_address(), Error::REQUEST_TIMEOUT), dh);
       }
-
     }
   }
 
   /**
    * Deliver timer events
    */
-  for (size_t i=0; i<expired_timers.size(); i++) {
-    event_ptr = new Event(Event::TIMER, Error::OK);
-    if (expired_timers[i].handler)
-      expired_timers[i].handler->handle(event_ptr);
+  foreach(DispatchHandlerPtr &handler, timer_handlers) {
+    if (handler) {
+      EventPtr event_ptr = new Event(Event::TIMER, Error::OK);
+      handler->handle(event_ptr);
+    }
   }
 
   {
     ScopedLock lock(m_mutex);
+    schedule_wakeup(next_timeout);
+    poll_loop_continue();
+  }
 
-    if (!m_timer_heap.empty()) {
-      timer = m_timer_heap.top();
-      if (next_req_timeout.sec == 0
-          || xtime_cmp(timer.expire_time, next_req_timeout) < 0) {
-        next_timeout.set(now, timer.expire_time);
-        memcpy(&m_next_wakeup, &timer.expire_time, sizeof(m_next_wakeup));
-      }
-    }
+}
 
-    poll_loop_continue();
+
+/**
+ * Sets next_timeout to the next tick at which the timer wheel needs
+ * attention and publishes it for add_request().  Must be called with
+ * m_mutex locked.
+ */
+void Reactor::schedule_wakeup(PollTimeout &next_timeout) {
+  boost::xtime now;
+  uint64_t next_tick = m_timer_wheel.next_tick();
+
+  boost::xtime_get(&now, boost::TIME_UTC);
+
+  if (next_tick == 0)
+    next_timeout.set_indefinite();
+  else {
+    boost::xtime wakeup = m_timer_wheel.tick_time(next_tick);
+    // poll timeouts are truncated to milliseconds, don't wake up early
+    wakeup.nsec += 999999;
+    if (xtime_cmp(wakeup, now) < 0)
+      wakeup = now;
+    next_timeout.set(now, wakeup);
   }
 
+  // Publish the wakeup and then look for requests that were handed off in
+  // the meantime; if there are any, come right back so they get considered
+  // for the next timeout
+  m_next_wakeup_tick = next_tick;
+  __sync_synchronize();
+  if (m_pending_requests)
+    next_timeout.set(now, now);
 }
 
 
@@ -22,7 +22,6 @@
 #ifndef HYPERTABLE_REACTOR_H
 #define HYPERTABLE_REACTOR_H
 
-#include <queue>
 #include <set>
 
 #include <boost/thread/thread.hpp>
@@ -30,9 +29,11 @@
 #include "Common/Mutex.h"
 #include "Common/ReferenceCount.h"
 
+#include "BufferPool.h"
 #include "PollTimeout.h"
 #include "RequestCache.h"
 #include "ExpireTimer.h"
+#include "TimerWheel.h"
 
 namespace Hypertable {
 
@@ -45,38 +46,40 @@ namespace Hypertable {
     static const int READ_READY;
     static const int WRITE_READY;
 
-    Reactor();
-    ~Reactor() {
-      poll_loop_interrupt();
-    }
+    struct SendStats {
+      SendStats() : messages(0), syscalls(0) { }
+      uint64_t messages;        // messages completely written
+      uint64_t syscalls;        // write calls, including ones hitting EAGAIN
+    };
+
+    /**
+     * @param timer_tick_millis granularity of request timeouts and timers;
+     *        deadlines falling into the same tick are handled together
+     * @param receive_pool_bytes limit on the bytes kept in the pool of
+     *        inbound message buffers
+     */
+    Reactor(uint32_t timer_tick_millis, size_t receive_pool_bytes);
+    ~Reactor();
 
     void operator()();
 
+    /**
+     * Registers an outstanding request.  This is called by application
+     * threads on every send_request(), so it does not take the reactor
+     * mutex: the request is pushed onto a lock-free list that the reactor
+     * thread moves into the request cache before it next looks at it.  The
+     * reactor is only interrupted if the request expires in an earlier
+     * timer tick than the reactor's next scheduled wakeup.
+     */
     void add_request(uint32_t id, IOHandler *handler, DispatchHandler *dh,
-                     boost::xtime &expire) {
-      ScopedLock lock(m_mutex);
-      boost::xtime now;
-      m_request_cache.insert(id, handler, dh, expire);
-      boost::xtime_get(&now, boost::TIME_UTC);
-      if (m_next_wakeup.sec == 0 || xtime_cmp(expire, m_next_wakeup) < 0)
-        poll_loop_interrupt();
-    }
+                     boost::xtime &expire);
 
-    DispatchHandler *remove_request(uint32_t id) {
-      ScopedLock lock(m_mutex);
-      return m_request_cache.remove(id);
-    }
+    DispatchHandler *remove_request(uint32_t id);
 
-    void cancel_requests(IOHandler *handler, int32_t error=Error::COMM_BROKEN_CONNECTION) {
-      ScopedLock lock(m_mutex);
-      m_request_cache.purge_requests(handler, error);
-    }
+    void cancel_requests(IOHandler *handler,
+                         int32_t error=Error::COMM_BROKEN_CONNECTION);
 
-    void add_timer(ExpireTimer &timer) {
-      ScopedLock lock(m_mutex);
-      m_timer_heap.push(timer);
-      poll_loop_interrupt();
-    }
+    void add_timer(ExpireTimer &timer);
 
     void schedule_removal(IOHandler *handler) {
       ScopedLock lock(m_mutex);
@@ -91,6 +94,18 @@ namespace Hypertable {
 
     void handle_timeouts(PollTimeout &next_timeout);
 
+    /**
+     * Accounts for messages written and write system calls made on
+     * connections handled by this reactor.  Called by application threads
+     * as well as the reactor thread, so the counters are updated atomically.
+     */
+    void record_sends(uint64_t messages, uint64_t syscalls);
+
+    void get_send_stats(SendStats &stats);
+
+    /** Pool from which the payloads of inbound messages are allocated */
+    BufferPool *get_receive_pool() { return m_receive_pool.get(); }
+
 #if defined(__linux__)
     int poll_fd;
 #elif defined (__APPLE__)
@@ -101,16 +116,33 @@ namespace Hypertable {
     void poll_loop_continue();
 
   protected:
-    typedef std::priority_queue<ExpireTimer, std::vector<ExpireTimer>, LtTimer>
-            TimerHeap;
+    enum { TIMER_ENTRY = RequestCache::REQUEST_ENTRY + 1 };
+
+    struct TimerNode : public TimerWheel::Entry {
+      DispatchHandlerPtr handler;
+    };
+
+    struct PendingRequest {
+      PendingRequest   *next;
+      uint32_t          id;
+      IOHandler        *handler;
+      DispatchHandler  *dh;
+      boost::xtime      expire;
+    };
+
+    void drain_pending_requests();
+    void schedule_wakeup(PollTimeout &next_timeout);
 
     Mutex           m_mutex;
+    TimerWheel      m_timer_wheel;
     RequestCache    m_request_cache;
-    TimerHeap       m_timer_heap;
     int             m_interrupt_sd;
     bool            m_interrupt_in_progress;
-    boost::xtime    m_next_wakeup;
+    volatile uint64_t m_next_wakeup_tick;   // 0 if none
+    PendingRequest *volatile m_pending_requests;
     std::set<IOHandler *> m_removed_handlers;
+    BufferPoolPtr   m_receive_pool;
+    SendStats       m_send_stats;
   };
 
   typedef intrusive_ptr<Reactor> ReactorPtr;
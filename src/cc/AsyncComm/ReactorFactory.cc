@@ -20,8 +20,10 @@
  */
 
 #include "Common/Compat.h"
+#include "Common/Config.h"
 
 #include "HandlerMap.h"
+#include "IOHandlerData.h"
 #include "ReactorFactory.h"
 #include "ReactorRunner.h"
 using namespace Hypertable;
@@ -46,17 +48,51 @@ void ReactorFactory::initialize(uint16_t reactor_count) {
     return;
   ReactorPtr reactor_ptr;
   ReactorRunner rrunner;
-  ReactorRunner::ms_handler_map_ptr = new HandlerMap();
   signal(SIGPIPE, SIG_IGN);
   assert(reactor_count > 0);
+  ReactorRunner::ms_handler_map_ptr = new HandlerMap(reactor_count);
+  HT_EXPECT(Config::properties, Error::FAILED_EXPECTATION);
+  int32_t tick_millis = Config::properties->get_i32("Comm.TimerTickMillis");
+  int64_t pool_bytes =
+      Config::properties->get_i64("Comm.ReceiveBufferPool.MaxMemory");
+  IOHandlerData::ms_payload_checksum =
+      Config::properties->get_bool("Comm.PayloadChecksum");
   for (uint16_t i=0; i<reactor_count; i++) {
-    reactor_ptr = new Reactor();
+    reactor_ptr = new Reactor(tick_millis > 0 ? tick_millis : 1,
+                              pool_bytes > 0 ? pool_bytes : 0);
     ms_reactors.push_back(reactor_ptr);
     rrunner.set_reactor(reactor_ptr);
     ms_threads.create_thread(rrunner);
   }
 }
 
+void ReactorFactory::get_receive_pool_stats(BufferPool::Stats &stats) {
+  BufferPool::Stats reactor_stats;
+  ScopedLock lock(ms_mutex);
+
+  stats = BufferPool::Stats();
+  for (size_t i=0; i<ms_reactors.size(); i++) {
+    ms_reactors[i]->get_receive_pool()->get_stats(reactor_stats);
+    stats.allocations += reactor_stats.allocations;
+    stats.hits += reactor_stats.hits;
+    stats.oversized += reactor_stats.oversized;
+    stats.pooled_buffers += reactor_stats.pooled_buffers;
+    stats.pooled_bytes += reactor_stats.pooled_bytes;
+  }
+}
+
+void ReactorFactory::get_send_stats(Reactor::SendStats &stats) {
+  Reactor::SendStats reactor_stats;
+  ScopedLock lock(ms_mutex);
+
+  stats = Reactor::SendStats();
+  for (size_t i=0; i<ms_reactors.size(); i++) {
+    ms_reactors[i]->get_send_stats(reactor_stats);
+    stats.messages += reactor_stats.messages;
+    stats.syscalls += reactor_stats.syscalls;
+  }
+}
+
 void ReactorFactory::destroy() {
   ReactorRunner::ms_shutdown = true;
   for (size_t i=0; i<ms_reactors.size(); i++)
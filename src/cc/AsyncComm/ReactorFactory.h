@@ -29,6 +29,10 @@
 #include <cassert>
 #include <vector>
 
+extern "C" {
+#include <netinet/in.h>
+}
+
 #include "Common/atomic.h"
 #include "Reactor.h"
 
@@ -51,6 +55,20 @@ namespace Hypertable {
      */
     static void initialize(uint16_t reactor_count);
 
+    /** This method returns the totals of the receive buffer pools of all
+     * reactors (see Reactor::get_receive_pool())
+     *
+     * @param stats reference to returned statistics
+     */
+    static void get_receive_pool_stats(BufferPool::Stats &stats);
+
+    /** This method returns the totals of the send statistics of all
+     * reactors (see Reactor::record_sends())
+     *
+     * @param stats reference to returned statistics
+     */
+    static void get_send_stats(Reactor::SendStats &stats);
+
     /** This method shuts down the reactors
      */
     static void destroy();
@@ -65,6 +83,26 @@ namespace Hypertable {
                                 % ms_reactors.size()];
     }
 
+    /** This method returns the reactor that owns connections to or from
+     * the given address.  A connection always lands on the same reactor,
+     * and the HandlerMap keeps its entry in the shard belonging to that
+     * reactor (see hash_address()).
+     *
+     * @param addr remote address of the connection
+     * @param reactor_ptr reference to returned reactor
+     */
+    static void get_reactor(const sockaddr_in &addr, ReactorPtr &reactor_ptr) {
+      assert(ms_reactors.size() > 0);
+      reactor_ptr = ms_reactors[hash_address(addr) % ms_reactors.size()];
+    }
+
+    /** Hashes an address (IP and port) for assigning it to a reactor */
+    static size_t hash_address(const sockaddr_in &addr) {
+      uint32_t h = addr.sin_addr.s_addr ^ ((uint32_t)addr.sin_port << 16);
+      h *= 0x9e3779b1;
+      return h >> 8;
+    }
+
     /** vector of reactors */
     static std::vector<ReactorPtr> ms_reactors;
 
@@ -21,6 +21,7 @@
 
 #include "Common/Compat.h"
 
+#include <algorithm>
 #include <cassert>
 using namespace std;
 
@@ -32,6 +33,25 @@ using namespace std;
 #include "RequestCache.h"
 using namespace Hypertable;
 
+namespace {
+  struct LtNodeId {
+    template <typename NodeT>
+    bool operator()(const NodeT *n1, const NodeT *n2) const {
+      return n1->id < n2->id;
+    }
+  };
+}
+
+
+RequestCache::~RequestCache() {
+  for (IdHandlerMap::iterator iter = m_id_map.begin();
+       iter != m_id_map.end(); ++iter) {
+    m_wheel.remove((*iter).second);
+    delete (*iter).second;
+  }
+}
+
+
 void
 RequestCache::insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                      boost::xtime &expire) {
@@ -46,18 +66,8 @@ RequestCache::insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
   node->id = id;
   node->handler = handler;
   node->dh = dh;
-  memcpy(&node->expire, &expire, sizeof(expire));
-
-  if (m_head == 0) {
-    node->next = node->prev = 0;
-    m_head = m_tail = node;
-  }
-  else {
-    node->next = m_tail;
-    node->next->prev = node;
-    node->prev = 0;
-    m_tail = node;
-  }
+  node->type = REQUEST_ENTRY;
+  m_wheel.insert(node, expire);
 
   m_id_map[id] = node;
 }
@@ -76,16 +86,7 @@ DispatchHandler *RequestCache::remove(uint32_t id) {
 
   CacheNode *node = (*iter).second;
 
-  if (node->prev == 0)
-    m_tail = node->next;
-  else
-    node->prev->next = node->next;
-
-  if (node->next == 0)
-    m_head = node->prev;
-  else
-    node->next->prev = node->prev;
-
+  m_wheel.remove(node);
   m_id_map.erase(iter);
 
   DispatchHandler *dh = node->dh;
@@ -94,52 +95,37 @@ DispatchHandler *RequestCache::remove(uint32_t id) {
 }
 
 
-
 DispatchHandler *
-RequestCache::get_next_timeout(boost::xtime &now, IOHandler *&handlerp,
-                               boost::xtime *next_timeout) {
+RequestCache::expire(TimerWheel::Entry *entry, IOHandler *&handlerp) {
+  CacheNode *node = static_cast<CacheNode *>(entry);
+  DispatchHandler *dh = node->dh;
 
-  while (m_head && xtime_cmp(m_head->expire, now) <= 0) {
+  assert(!node->is_scheduled());
+  m_id_map.erase(node->id);
+  handlerp = node->handler;
+  delete node;
+  return dh;
+}
 
-    IdHandlerMap::iterator iter = m_id_map.find(m_head->id);
-    assert (iter != m_id_map.end());
-    CacheNode *node = m_head;
-    if (m_head->prev) {
-      m_head = m_head->prev;
-      m_head->next = 0;
-    }
-    else
-      m_head = m_tail = 0;
 
-    m_id_map.erase(iter);
+void RequestCache::purge_requests(IOHandler *handler, int32_t error) {
+  std::vector<CacheNode *> purged;
 
-    if (node->handler != 0) {
-      handlerp = node->handler;
-      DispatchHandler *dh = node->dh;
-      delete node;
-      return dh;
-    }
-    delete node;
+  for (IdHandlerMap::iterator iter = m_id_map.begin();
+       iter != m_id_map.end(); ++iter) {
+    if ((*iter).second->handler == handler)
+      purged.push_back((*iter).second);
   }
 
-  if (m_head)
-    memcpy(next_timeout, &m_head->expire, sizeof(boost::xtime));
-  else
-    memset(next_timeout, 0, sizeof(boost::xtime));
+  // fail them in the order they were sent
+  std::sort(purged.begin(), purged.end(), LtNodeId());
 
-  return 0;
-}
-
-
-
-void RequestCache::purge_requests(IOHandler *handler, int32_t error) {
-  for (CacheNode *node = m_tail; node != 0; node = node->next) {
-    if (node->handler == handler) {
-      HT_DEBUGF("Purging request id %d", node->id);
-      handler->deliver_event(new Event(Event::ERROR, ((IOHandlerData *)handler)->get_address(),
-                                       error), node->dh);
-      node->handler = 0;  // mark for deletion
-    }
+  foreach(CacheNode *node, purged) {
+    HT_DEBUGF("Purging request id %d", node->id);
+    m_wheel.remove(node);
+    m_id_map.erase(node->id);
+    handler->deliver_event(new Event(Event::ERROR,
+        ((IOHandlerData *)handler)->get_address(), error), node->dh);
+    delete node;
   }
 }
-
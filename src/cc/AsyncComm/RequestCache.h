@@ -23,21 +23,33 @@
 #ifndef HYPERTABLE_REQUESTCACHE_H
 #define HYPERTABLE_REQUESTCACHE_H
 
+#include <vector>
+
 #include <boost/thread/xtime.hpp>
 
 #include "Common/HashMap.h"
 
 #include "DispatchHandler.h"
+#include "TimerWheel.h"
 
 namespace Hypertable {
 
   class IOHandler;
 
+  /**
+   * Outstanding requests of a reactor, keyed by request ID.  Their
+   * timeouts are kept in the reactor's TimerWheel, as entries of type
+   * REQUEST_ENTRY.
+   */
   class RequestCache {
 
-    struct CacheNode {
-      struct CacheNode  *prev, *next;
-      boost::xtime       expire;
+  public:
+
+    enum { REQUEST_ENTRY = 1 };
+
+  private:
+
+    struct CacheNode : public TimerWheel::Entry {
       uint32_t           id;
       IOHandler         *handler;
       DispatchHandler   *dh;
@@ -47,21 +59,30 @@ namespace Hypertable {
 
   public:
 
-    RequestCache() : m_id_map(), m_head(0), m_tail(0) { return; }
+    RequestCache(TimerWheel &wheel) : m_wheel(wheel), m_id_map() { return; }
+
+    ~RequestCache();
 
     void insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                 boost::xtime &expire);
 
     DispatchHandler *remove(uint32_t id);
 
-    DispatchHandler *get_next_timeout(boost::xtime &now, IOHandler *&handlerp,
-                                      boost::xtime *next_timeout);
+    /**
+     * Removes the request belonging to a REQUEST_ENTRY that the timer wheel
+     * has expired.
+     *
+     * @param entry expired wheel entry
+     * @param handlerp set to the I/O handler the request was sent on
+     * @return dispatch handler of the request
+     */
+    DispatchHandler *expire(TimerWheel::Entry *entry, IOHandler *&handlerp);
 
     void purge_requests(IOHandler *handler, int32_t error);
 
   private:
+    TimerWheel   &m_wheel;
     IdHandlerMap  m_id_map;
-    CacheNode    *m_head, *m_tail;
   };
 }
 
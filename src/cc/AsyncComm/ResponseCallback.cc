@@ -34,7 +34,7 @@ int ResponseCallback::error(int error, const String &msg) {
   CommHeader header;
   header.initialize_from_request_header(m_event_ptr->header);
   CommBufPtr cbp(Protocol::create_error_message(header, error, msg.c_str()));
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
 int ResponseCallback::response_ok() {
@@ -42,6 +42,6 @@ int ResponseCallback::response_ok() {
   header.initialize_from_request_header(m_event_ptr->header);
   CommBufPtr cbp(new CommBuf(header, 4));
   cbp->append_i32(Error::OK);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
@@ -79,6 +79,18 @@ namespace Hypertable {
     }
 
   protected:
+    /**
+     * Sends a response message back to the client.  All responses go
+     * through here, subclasses can override it to deliver them elsewhere
+     * (e.g. to gather the responses to the parts of a batch request).
+     *
+     * @param cbp response message
+     * @return Error::OK on success or error code on failure
+     */
+    virtual int send_response(CommBufPtr &cbp) {
+      return m_comm->send_response(m_event_ptr->addr, cbp);
+    }
+
     Comm          *m_comm;
     EventPtr       m_event_ptr;
   };
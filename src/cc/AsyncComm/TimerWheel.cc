@@ -0,0 +1,240 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "TimerWheel.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  struct LtExpire {
+    bool operator()(const TimerWheel::Entry *e1,
+                    const TimerWheel::Entry *e2) const {
+      return xtime_cmp(e1->expire, e2->expire) < 0;
+    }
+  };
+
+}
+
+
+TimerWheel::TimerWheel(uint32_t tick_millis)
+  : m_tick_millis(tick_millis ? tick_millis : 1), m_size(0) {
+  boost::xtime now;
+
+  for (size_t i=0; i<ROOT_SIZE; i++)
+    m_root[i].prev = m_root[i].next = &m_root[i];
+  for (size_t level=0; level<LEVELS; level++)
+    for (size_t i=0; i<LEVEL_SIZE; i++)
+      m_levels[level][i].prev = m_levels[level][i].next = &m_levels[level][i];
+
+  boost::xtime_get(&now, boost::TIME_UTC);
+  m_tick = elapsed_tick(now) + 1;
+}
+
+
+void TimerWheel::insert(Entry *entry, const boost::xtime &expire) {
+  assert(!entry->is_scheduled());
+  entry->expire = expire;
+  entry->tick = expire_tick(expire);
+  place(entry);
+  m_size++;
+}
+
+
+void TimerWheel::remove(Entry *entry) {
+  if (entry->is_scheduled()) {
+    unlink(entry);
+    m_size--;
+  }
+}
+
+
+void TimerWheel::advance(const boost::xtime &now,
+                         std::vector<Entry *> &expired) {
+  uint64_t now_tick = elapsed_tick(now);
+  size_t first = expired.size();
+
+  while (m_tick <= now_tick) {
+    if (m_size == 0) {
+      m_tick = now_tick + 1;
+      break;
+    }
+
+    // skip over ticks with nothing to expire or cascade
+    if ((m_tick & (ROOT_SIZE - 1)) != 0
+        && empty(m_root[m_tick & (ROOT_SIZE - 1)])) {
+      m_tick = std::min(next_tick(), now_tick + 1);
+      continue;
+    }
+
+    process_tick(expired);
+  }
+
+  // entries of one tick are expired in deadline order
+  if (expired.size() - first > 1)
+    std::stable_sort(expired.begin() + first, expired.end(), LtExpire());
+}
+
+
+uint64_t TimerWheel::next_tick() {
+  uint64_t next = 0;
+
+  if (m_size == 0)
+    return 0;
+
+  for (size_t i=0; i<ROOT_SIZE; i++) {
+    if (!empty(m_root[(m_tick + i) & (ROOT_SIZE - 1)])) {
+      next = m_tick + i;
+      break;
+    }
+  }
+
+  // A slot of a higher level is cascaded at the start of the time range
+  // it covers.  If m_tick is exactly at such a boundary the slot for the
+  // current range has not been cascaded yet, otherwise the current index
+  // holds entries that are a full turn of the level away.
+  size_t shift = ROOT_BITS;
+  for (size_t level=0; level<LEVELS; level++, shift += LEVEL_BITS) {
+    uint64_t range = m_tick >> shift;
+    size_t first = (m_tick & ((1ULL << shift) - 1)) == 0 ? 0 : 1;
+
+    if (next && next <= ((range + first) << shift))
+      break;
+
+    for (size_t i=first; i<first+LEVEL_SIZE; i++) {
+      if (!empty(m_levels[level][(range + i) & (LEVEL_SIZE - 1)])) {
+        uint64_t tick = (range + i) << shift;
+        if (next == 0 || tick < next)
+          next = tick;
+        break;
+      }
+    }
+  }
+
+  return next;
+}
+
+
+void TimerWheel::clear(std::vector<Entry *> &entries) {
+  for (size_t i=0; i<ROOT_SIZE; i++)
+    while (!empty(m_root[i])) {
+      entries.push_back(m_root[i].next);
+      unlink(m_root[i].next);
+    }
+  for (size_t level=0; level<LEVELS; level++)
+    for (size_t i=0; i<LEVEL_SIZE; i++)
+      while (!empty(m_levels[level][i])) {
+        entries.push_back(m_levels[level][i].next);
+        unlink(m_levels[level][i].next);
+      }
+  m_size = 0;
+}
+
+
+void TimerWheel::link(Entry &head, Entry *entry) {
+  entry->next = &head;
+  entry->prev = head.prev;
+  head.prev->next = entry;
+  head.prev = entry;
+}
+
+
+void TimerWheel::unlink(Entry *entry) {
+  entry->prev->next = entry->next;
+  entry->next->prev = entry->prev;
+  entry->prev = entry->next = 0;
+}
+
+
+void TimerWheel::place(Entry *entry) {
+  // deadlines that have already passed expire with the next tick
+  uint64_t tick = std::max(entry->tick, m_tick);
+  uint64_t delta = tick - m_tick;
+
+  if (delta < ROOT_SIZE) {
+    link(m_root[tick & (ROOT_SIZE - 1)], entry);
+    return;
+  }
+
+  size_t level = 0;
+  size_t shift = ROOT_BITS;
+  while (level < LEVELS - 1 && delta >= (1ULL << (shift + LEVEL_BITS))) {
+    level++;
+    shift += LEVEL_BITS;
+  }
+
+  // beyond the reach of the wheel; park in the farthest slot and let
+  // cascading bring it back in range
+  if (delta >= (1ULL << (shift + LEVEL_BITS)))
+    tick = m_tick + (1ULL << (shift + LEVEL_BITS)) - 1;
+
+  link(m_levels[level][(tick >> shift) & (LEVEL_SIZE - 1)], entry);
+}
+
+
+void TimerWheel::cascade(Entry &head) {
+  Entry *entry = head.next;
+
+  // Detach the whole slot and walk the old chain, entries may land in
+  // this slot again.  Only the entries themselves are touched.
+  head.next = head.prev = &head;
+
+  while (entry != &head) {
+    Entry *next = entry->next;
+    place(entry);
+    entry = next;
+  }
+}
+
+
+void TimerWheel::process_tick(std::vector<Entry *> &expired) {
+  size_t index = m_tick & (ROOT_SIZE - 1);
+
+  if (index == 0) {
+    size_t shift = ROOT_BITS;
+    for (size_t level=0; level<LEVELS; level++, shift += LEVEL_BITS) {
+      size_t level_index = (m_tick >> shift) & (LEVEL_SIZE - 1);
+      cascade(m_levels[level][level_index]);
+      if (level_index != 0)
+        break;
+    }
+  }
+
+  Entry &head = m_root[index];
+  Entry *entry = head.next;
+
+  head.next = head.prev = &head;
+
+  while (entry != &head) {
+    Entry *next = entry->next;
+    entry->prev = entry->next = 0;
+    expired.push_back(entry);
+    m_size--;
+    entry = next;
+  }
+
+  m_tick++;
+}
@@ -0,0 +1,139 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_TIMERWHEEL_H
+#define HYPERTABLE_TIMERWHEEL_H
+
+#include <vector>
+
+#include <boost/thread/xtime.hpp>
+
+namespace Hypertable {
+
+  /**
+   * Hierarchical timing wheel.  Time is divided into ticks of a fixed
+   * number of milliseconds and every deadline is rounded up to a tick, so
+   * entries never expire early and at most one tick late, and all entries
+   * falling into the same tick are expired together.  The wheel has a
+   * 256 slot root level, indexed by tick, and four 64 slot levels above it
+   * whose slots are cascaded into the levels below as time catches up with
+   * them.  Insertion and removal take constant time.
+   *
+   * Entries are intrusive: owners derive from Entry and remain responsible
+   * for freeing them.  The wheel does no locking of its own.
+   */
+  class TimerWheel {
+  public:
+
+    struct Entry {
+      Entry() : prev(0), next(0), tick(0), type(0) { }
+      bool is_scheduled() const { return prev != 0; }
+
+      boost::xtime  expire;     // exact deadline
+      Entry        *prev;
+      Entry        *next;
+      uint64_t      tick;       // expire rounded up to a tick
+      int           type;       // free for use by the owner
+    };
+
+    /**
+     * @param tick_millis length of a tick in milliseconds
+     */
+    TimerWheel(uint32_t tick_millis);
+
+    uint32_t tick_millis() const { return m_tick_millis; }
+
+    /** Returns the tick in which the deadline t falls (rounded up) */
+    uint64_t expire_tick(const boost::xtime &t) const {
+      uint64_t ms = ((uint64_t)t.sec * 1000) + ((t.nsec + 999999) / 1000000);
+      return (ms + m_tick_millis - 1) / m_tick_millis;
+    }
+
+    /** Returns the last tick that has fully elapsed at time t */
+    uint64_t elapsed_tick(const boost::xtime &t) const {
+      return millis(t) / m_tick_millis;
+    }
+
+    /** Returns the time at which the given tick starts */
+    boost::xtime tick_time(uint64_t tick) const {
+      boost::xtime t;
+      uint64_t ms = tick * m_tick_millis;
+      t.sec = ms / 1000;
+      t.nsec = (ms % 1000) * 1000000;
+      return t;
+    }
+
+    /** Schedules entry, which must not already be scheduled, for expire */
+    void insert(Entry *entry, const boost::xtime &expire);
+
+    /** Unschedules entry; does nothing if it is not scheduled */
+    void remove(Entry *entry);
+
+    /**
+     * Moves the wheel forward to time now.  Entries whose tick has elapsed
+     * are unscheduled and appended to expired, ordered by deadline.
+     */
+    void advance(const boost::xtime &now, std::vector<Entry *> &expired);
+
+    /**
+     * Returns the tick at which advance() next needs to be called, or 0 if
+     * the wheel is empty.  This is the tick of the earliest deadline, or an
+     * earlier tick at which entries of a higher level have to be cascaded.
+     */
+    uint64_t next_tick();
+
+    /** Unschedules all entries and appends them to entries */
+    void clear(std::vector<Entry *> &entries);
+
+    size_t size() const { return m_size; }
+
+  private:
+    enum {
+      ROOT_BITS = 8,
+      ROOT_SIZE = 1 << ROOT_BITS,
+      LEVEL_BITS = 6,
+      LEVEL_SIZE = 1 << LEVEL_BITS,
+      LEVELS = 4
+    };
+
+    static uint64_t millis(const boost::xtime &t) {
+      return ((uint64_t)t.sec * 1000) + (t.nsec / 1000000);
+    }
+
+    static bool empty(const Entry &head) { return head.next == &head; }
+
+    static void link(Entry &head, Entry *entry);
+    static void unlink(Entry *entry);
+
+    void place(Entry *entry);
+    void cascade(Entry &head);
+    void process_tick(std::vector<Entry *> &expired);
+
+    uint32_t  m_tick_millis;
+    uint64_t  m_tick;           // next tick to process
+    size_t    m_size;
+    Entry     m_root[ROOT_SIZE];
+    Entry     m_levels[LEVELS][LEVEL_SIZE];
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_TIMERWHEEL_H
@@ -0,0 +1,326 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+}
+
+#include "AsyncComm/ApplicationQueue.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const uint64_t NO_GROUP = 0;
+
+  /**
+   * Records the order in which requests run, and checks that no two
+   * requests of the same thread group ever run at the same time.
+   */
+  class Recorder {
+  public:
+    Recorder() : m_concurrent(0), m_max_concurrent(0), m_deleted(0) { }
+
+    void begin(uint64_t group, int id) {
+      ScopedLock lock(m_mutex);
+      if (group != NO_GROUP)
+        HT_ASSERT(m_running[group]++ == 0);
+      if (++m_concurrent > m_max_concurrent)
+        m_max_concurrent = m_concurrent;
+      m_order.push_back(id);
+      m_group_order[group].push_back(id);
+    }
+
+    void end(uint64_t group) {
+      ScopedLock lock(m_mutex);
+      if (group != NO_GROUP)
+        m_running[group]--;
+      m_concurrent--;
+    }
+
+    void deleted() {
+      ScopedLock lock(m_mutex);
+      m_deleted++;
+    }
+
+    /** Waits until count requests have started */
+    void wait_for(size_t count) {
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_order.size() >= count)
+            return;
+        }
+        poll(0, 0, 1);
+      }
+    }
+
+    size_t started() {
+      ScopedLock lock(m_mutex);
+      return m_order.size();
+    }
+
+    Mutex m_mutex;
+    map<uint64_t, int> m_running;
+    vector<int> m_order;
+    map<uint64_t, vector<int> > m_group_order;
+    int m_concurrent;
+    int m_max_concurrent;
+    int m_deleted;
+  };
+
+  /** Keeps a worker busy until opened */
+  class Gate {
+  public:
+    Gate() : m_open(false) { }
+    void wait() {
+      ScopedLock lock(m_mutex);
+      while (!m_open)
+        m_cond.wait(lock);
+    }
+    void open() {
+      ScopedLock lock(m_mutex);
+      m_open = true;
+      m_cond.notify_all();
+    }
+  private:
+    Mutex m_mutex;
+    boost::condition m_cond;
+    bool m_open;
+  };
+
+  EventPtr make_event(uint64_t group, bool urgent, bool expired=false) {
+    EventPtr event = new Event(Event::MESSAGE);
+    event->thread_group = group;
+    event->header.flags = CommHeader::FLAGS_BIT_REQUEST;
+    if (urgent)
+      event->header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    event->header.timeout_ms = 1000;
+    event->arrival_clocks = std::clock();
+    // pretend an expired request arrived ten seconds (of clock time) ago
+    if (expired)
+      event->arrival_clocks -= 10 * CLOCKS_PER_SEC;
+    return event;
+  }
+
+  class TestHandler : public ApplicationHandler {
+  public:
+    TestHandler(Recorder &recorder, int id, uint64_t group, bool urgent,
+                int sleep_ms=0, Gate *gate=0, bool expired=false)
+      : ApplicationHandler(urgent), m_recorder(recorder), m_id(id),
+        m_group(group), m_sleep_ms(sleep_ms), m_gate(gate) {
+      m_event_ptr = make_event(group, urgent, expired);
+    }
+
+    virtual ~TestHandler() { m_recorder.deleted(); }
+
+    virtual void run() {
+      m_recorder.begin(m_group, m_id);
+      if (m_gate)
+        m_gate->wait();
+      if (m_sleep_ms)
+        poll(0, 0, m_sleep_ms);
+      m_recorder.end(m_group);
+    }
+
+  private:
+    Recorder &m_recorder;
+    int m_id;
+    uint64_t m_group;
+    int m_sleep_ms;
+    Gate *m_gate;
+  };
+
+  /**
+   * Requests of a thread group run one at a time, in the order they were
+   * added, while the workers carry out different groups concurrently.
+   */
+  void test_group_order() {
+    const int GROUPS = 8;
+    const int PER_GROUP = 40;
+    ApplicationQueuePtr app_queue = new ApplicationQueue(4);
+    Recorder recorder;
+
+    for (int i=0; i<PER_GROUP; i++)
+      for (int g=1; g<=GROUPS; g++)
+        app_queue->add(new TestHandler(recorder, i, g, (i % 5) == 0,
+                                       random() % 2));
+
+    app_queue->shutdown();
+    app_queue->join();
+
+    HT_ASSERT(recorder.m_order.size() == (size_t)(GROUPS * PER_GROUP));
+    HT_ASSERT(recorder.m_deleted == GROUPS * PER_GROUP);
+    HT_ASSERT(recorder.m_max_concurrent > 1);
+
+    /**
+     * Urgent requests of a group run ahead of its queued normal requests,
+     * but within each priority the order is FIFO
+     */
+    for (int g=1; g<=GROUPS; g++) {
+      vector<int> &order = recorder.m_group_order[g];
+      int last_urgent = -1, last_normal = -1;
+      HT_ASSERT(order.size() == (size_t)PER_GROUP);
+      foreach(int id, order) {
+        int &last = (id % 5) == 0 ? last_urgent : last_normal;
+        HT_ASSERT(id > last);
+        last = id;
+      }
+    }
+
+    ApplicationQueue::Stats stats;
+    app_queue->get_stats(stats);
+    HT_ASSERT(stats.dispatched == (uint64_t)(GROUPS * PER_GROUP));
+    HT_ASSERT(stats.depth == 0 && stats.urgent_depth == 0);
+    HT_ASSERT(stats.groups == 0);
+  }
+
+  /**
+   * With the only worker busy, queued urgent requests are carried out
+   * before normal ones, regardless of the order they were added in
+   */
+  void test_urgent_first() {
+    ApplicationQueuePtr app_queue = new ApplicationQueue(1);
+    Recorder recorder;
+    Gate gate;
+
+    app_queue->add(new TestHandler(recorder, 0, NO_GROUP, false, 0, &gate));
+    recorder.wait_for(1);
+
+    app_queue->add(new TestHandler(recorder, 1, 1, false));
+    app_queue->add(new TestHandler(recorder, 2, 2, false));
+    app_queue->add(new TestHandler(recorder, 3, 3, true));
+    app_queue->add(new TestHandler(recorder, 4, NO_GROUP, false));
+    app_queue->add(new TestHandler(recorder, 5, 4, true));
+    app_queue->add(new TestHandler(recorder, 6, NO_GROUP, true));
+
+    gate.open();
+    app_queue->shutdown();
+    app_queue->join();
+
+    int expected[] = { 0, 3, 5, 6, 1, 2, 4 };
+    HT_ASSERT(recorder.m_order ==
+              vector<int>(expected, expected + sizeof(expected)/sizeof(int)));
+  }
+
+  /**
+   * Requests that waited past their timeout are dropped instead of being
+   * carried out
+   */
+  void test_expiry() {
+    ApplicationQueuePtr app_queue = new ApplicationQueue(1);
+    Recorder recorder;
+    Gate gate;
+
+    ReactorRunner::ms_record_arrival_clocks = true;
+
+    app_queue->add(new TestHandler(recorder, 0, NO_GROUP, false, 0, &gate));
+    recorder.wait_for(1);
+
+    app_queue->add(new TestHandler(recorder, 1, 1, false, 0, 0, true));
+    app_queue->add(new TestHandler(recorder, 2, 1, false));
+    app_queue->add(new TestHandler(recorder, 3, 2, true, 0, 0, true));
+    app_queue->add(new TestHandler(recorder, 4, 2, false, 0, 0, true));
+    app_queue->add(new TestHandler(recorder, 5, NO_GROUP, true));
+
+    gate.open();
+    app_queue->shutdown();
+    app_queue->join();
+
+    ReactorRunner::ms_record_arrival_clocks = false;
+
+    int expected[] = { 0, 5, 2 };
+    HT_ASSERT(recorder.m_order ==
+              vector<int>(expected, expected + sizeof(expected)/sizeof(int)));
+    HT_ASSERT(recorder.m_deleted == 6);
+
+    ApplicationQueue::Stats stats;
+    app_queue->get_stats(stats);
+    HT_ASSERT(stats.expired == 3);
+    HT_ASSERT(stats.dispatched == 3);
+    HT_ASSERT(stats.groups == 0);
+  }
+
+  /**
+   * stop() holds back normal requests but not urgent ones, start()
+   * releases them, and shutdown() carries out everything still queued
+   * before join() returns
+   */
+  void test_stop_and_join() {
+    ApplicationQueuePtr app_queue = new ApplicationQueue(2);
+    Recorder recorder;
+
+    app_queue->stop();
+    for (int i=0; i<10; i++)
+      app_queue->add(new TestHandler(recorder, i, i % 3, false));
+    app_queue->add(new TestHandler(recorder, 10, 1, true));
+
+    recorder.wait_for(1);
+    poll(0, 0, 50);
+    HT_ASSERT(recorder.started() == 1);
+    HT_ASSERT(recorder.m_order[0] == 10);
+
+    ApplicationQueue::Stats stats;
+    app_queue->get_stats(stats);
+    HT_ASSERT(stats.depth == 10 && stats.urgent_depth == 0);
+
+    app_queue->start();
+    recorder.wait_for(11);
+
+    app_queue->stop();
+    for (int i=11; i<100; i++)
+      app_queue->add(new TestHandler(recorder, i, i % 7, (i % 9) == 0));
+    app_queue->start();
+
+    app_queue->shutdown();
+    app_queue->join();
+
+    HT_ASSERT(recorder.m_order.size() == 100);
+    HT_ASSERT(recorder.m_deleted == 100);
+
+    // a second join() returns at once
+    app_queue->join();
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  srandom(1);
+
+  test_group_order();
+  test_urgent_first();
+  test_expiry();
+  test_stop_and_join();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
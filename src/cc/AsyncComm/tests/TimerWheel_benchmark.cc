@@ -0,0 +1,156 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Init.h"
+#include "Common/Logger.h"
+#include "Common/Stopwatch.h"
+#include "Common/Time.h"
+#include "Common/Usage.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "AsyncComm/TimerWheel.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *usage[] = {
+    "usage: TimerWheel_benchmark",
+    "",
+    "  Inserts 1M timers with deadlines spread over the next minute and",
+    "  either cancels them all (as happens to request timeouts when the",
+    "  responses arrive) or lets them all expire, once with the TimerWheel",
+    "  used by the reactors and once with a std::multimap for comparison.",
+    (const char *)0
+  };
+
+  const size_t TIMER_COUNT = 1000000;
+  const uint32_t TICK_MILLIS = 10;
+
+  typedef multimap<uint64_t, size_t> TimerMap;
+
+  boost::xtime add_millis(const boost::xtime &base, uint64_t ms) {
+    boost::xtime t = base;
+    xtime_add_millis(t, ms);
+    return t;
+  }
+
+  double rate(double elapsed) {
+    return elapsed > 0.0 ? (double)TIMER_COUNT / elapsed : 0.0;
+  }
+
+  void run_wheel(const boost::xtime &base, vector<uint32_t> &delays) {
+    vector<TimerWheel::Entry> entries(TIMER_COUNT);
+    vector<TimerWheel::Entry *> expired;
+    TimerWheel wheel(TICK_MILLIS);
+
+    Stopwatch insert_timer;
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      wheel.insert(&entries[i], add_millis(base, delays[i]));
+    insert_timer.stop();
+
+    Stopwatch cancel_timer;
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      wheel.remove(&entries[i]);
+    cancel_timer.stop();
+
+    HT_ASSERT(wheel.size() == 0);
+
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      wheel.insert(&entries[i], add_millis(base, delays[i]));
+
+    // advance one tick at a time, as a busy reactor would
+    Stopwatch expire_timer;
+    for (uint64_t ms=0; ms<=60000 + TICK_MILLIS; ms += TICK_MILLIS) {
+      wheel.advance(add_millis(base, ms), expired);
+      expired.clear();
+    }
+    expire_timer.stop();
+
+    HT_ASSERT(wheel.size() == 0);
+
+    printf("  wheel     insert %12.0f/s  cancel %12.0f/s  expire %12.0f/s\n",
+           rate(insert_timer.elapsed()), rate(cancel_timer.elapsed()),
+           rate(expire_timer.elapsed()));
+  }
+
+  void run_map(vector<uint32_t> &delays) {
+    vector<TimerMap::iterator> iters(TIMER_COUNT);
+    TimerMap timers;
+
+    Stopwatch insert_timer;
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      iters[i] = timers.insert(TimerMap::value_type(delays[i], i));
+    insert_timer.stop();
+
+    Stopwatch cancel_timer;
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      timers.erase(iters[i]);
+    cancel_timer.stop();
+
+    for (size_t i=0; i<TIMER_COUNT; i++)
+      timers.insert(TimerMap::value_type(delays[i], i));
+
+    Stopwatch expire_timer;
+    for (uint64_t ms=0; ms<=60000 + TICK_MILLIS; ms += TICK_MILLIS) {
+      TimerMap::iterator end = timers.upper_bound(ms);
+      timers.erase(timers.begin(), end);
+    }
+    expire_timer.stop();
+
+    HT_ASSERT(timers.empty());
+
+    printf("  multimap  insert %12.0f/s  cancel %12.0f/s  expire %12.0f/s\n",
+           rate(insert_timer.elapsed()), rate(cancel_timer.elapsed()),
+           rate(expire_timer.elapsed()));
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  if (Config::has("help"))
+    Usage::dump_and_exit(usage);
+
+  boost::xtime base;
+  vector<uint32_t> delays(TIMER_COUNT);
+
+  boost::xtime_get(&base, boost::TIME_UTC);
+  srand(8876);
+  for (size_t i=0; i<TIMER_COUNT; i++)
+    delays[i] = rand() % 60000;
+
+  printf("%lu timers, %u ms ticks\n", (unsigned long)TIMER_COUNT,
+         (unsigned)TICK_MILLIS);
+  run_wheel(base, delays);
+  run_map(delays);
+
+  return 0;
+}
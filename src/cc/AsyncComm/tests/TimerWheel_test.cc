@@ -0,0 +1,332 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "AsyncComm/TimerWheel.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  // deadlines just around the boundaries of the root level, of each of
+  // the four upper levels and beyond the reach of the top level
+  const uint64_t BOUNDARIES[] = {
+    1ULL << 8, 1ULL << 14, 1ULL << 20, 1ULL << 26, 1ULL << 32, 1ULL << 33
+  };
+
+  struct TestEntry : TimerWheel::Entry {
+    TestEntry() : id(0), fired(false), cancelled(false) { }
+    size_t id;
+    bool   fired;
+    bool   cancelled;
+  };
+
+  uint64_t nanos(const boost::xtime &t) {
+    return (uint64_t)t.sec * 1000000000ULL + t.nsec;
+  }
+
+  boost::xtime from_nanos(uint64_t ns) {
+    boost::xtime t;
+    t.sec = ns / 1000000000ULL;
+    t.nsec = ns % 1000000000ULL;
+    return t;
+  }
+
+  uint64_t random64(uint64_t limit) {
+    uint64_t r = ((uint64_t)random() << 31) ^ random();
+    return limit ? r % limit : 0;
+  }
+
+  typedef set<pair<uint64_t, size_t> > PendingSet;
+
+  /**
+   * Drives a wheel the way the reactor does, waking up at next_tick()
+   * (sometimes early, sometimes late), and checks every expired entry:
+   * it must not fire before its deadline nor after the first wakeup past
+   * it, and entries must fire in deadline order.  Entries are cancelled
+   * at random between wakeups, wherever they happen to sit in the wheel.
+   */
+  class Driver {
+  public:
+    Driver(TimerWheel &wheel, vector<TestEntry> &entries)
+      : m_wheel(wheel), m_entries(entries), m_last_fired(0) {
+      boost::xtime_get(&m_now, boost::TIME_UTC);
+      for (size_t i=0; i<m_entries.size(); i++)
+        m_entries[i].id = i;
+    }
+
+    const boost::xtime &now() const { return m_now; }
+
+    void insert(size_t i, uint64_t delay_ns) {
+      TestEntry &entry = m_entries[i];
+      m_wheel.insert(&entry, from_nanos(nanos(m_now) + delay_ns));
+      m_pending.insert(make_pair(nanos(entry.expire), i));
+    }
+
+    void cancel(size_t i) {
+      TestEntry &entry = m_entries[i];
+      m_wheel.remove(&entry);
+      HT_ASSERT(!entry.is_scheduled());
+      if (!entry.fired && !entry.cancelled) {
+        m_pending.erase(make_pair(nanos(entry.expire), i));
+        entry.cancelled = true;
+      }
+      HT_ASSERT(m_wheel.size() == m_pending.size());
+    }
+
+    /** Cancels count random entries among the first limit ones */
+    void cancel_random(size_t count, size_t limit) {
+      for (size_t i=0; i<count && !m_pending.empty(); i++)
+        cancel(random64(limit));
+    }
+
+    /** Advances the wheel to the given time and checks what expired */
+    void advance_to(uint64_t ns) {
+      vector<TimerWheel::Entry *> expired;
+      uint64_t prev_tick = m_wheel.elapsed_tick(m_now);
+
+      HT_ASSERT(ns >= nanos(m_now));
+      m_now = from_nanos(ns);
+      m_wheel.advance(m_now, expired);
+
+      foreach(TimerWheel::Entry *e, expired) {
+        TestEntry *entry = static_cast<TestEntry *>(e);
+        uint64_t expire = nanos(entry->expire);
+
+        HT_ASSERT(!entry->is_scheduled());
+        HT_ASSERT(!entry->fired && !entry->cancelled);
+        HT_ASSERT(expire <= ns);
+        HT_ASSERT(m_wheel.expire_tick(entry->expire) > prev_tick);
+        HT_ASSERT(expire >= m_last_fired);
+        HT_ASSERT(m_pending.erase(make_pair(expire, entry->id)) == 1);
+        entry->fired = true;
+        m_last_fired = expire;
+      }
+
+      HT_ASSERT(m_wheel.size() == m_pending.size());
+      if (!m_pending.empty())
+        HT_ASSERT(m_wheel.expire_tick(from_nanos(m_pending.begin()->first))
+                  > m_wheel.elapsed_tick(m_now));
+    }
+
+    /** Sleeps until next_tick() with some jitter, returns false when done */
+    bool wakeup() {
+      uint64_t tick = m_wheel.next_tick();
+
+      if (m_pending.empty()) {
+        HT_ASSERT(tick == 0);
+        return false;
+      }
+      HT_ASSERT(tick > m_wheel.elapsed_tick(m_now));
+      HT_ASSERT(tick <= m_wheel.expire_tick(
+                from_nanos(m_pending.begin()->first)));
+
+      uint64_t target = nanos(m_wheel.tick_time(tick));
+      uint64_t tick_nanos = m_wheel.tick_millis() * 1000000ULL;
+
+      switch (random() % 4) {
+      case 0:   // early
+        target = nanos(m_now) + random64(target - nanos(m_now));
+        break;
+      case 1:   // late
+        target += random64(4 * tick_nanos);
+        break;
+      default:
+        break;
+      }
+      advance_to(target);
+      return true;
+    }
+
+  private:
+    TimerWheel         &m_wheel;
+    vector<TestEntry>  &m_entries;
+    PendingSet          m_pending;
+    boost::xtime        m_now;
+    uint64_t            m_last_fired;
+  };
+
+  void check_all_done(vector<TestEntry> &entries) {
+    foreach(TestEntry &entry, entries)
+      HT_ASSERT(entry.fired != entry.cancelled);
+  }
+
+  /**
+   * Deadlines on both sides of every level boundary, including some
+   * beyond the reach of the top level, with one millisecond ticks.
+   */
+  void test_boundaries() {
+    TimerWheel wheel(1);
+    vector<TestEntry> entries(sizeof(BOUNDARIES) / sizeof(*BOUNDARIES) * 5
+                              + 3);
+    Driver driver(wheel, entries);
+    size_t n = 0;
+
+    for (size_t i=0; i<sizeof(BOUNDARIES) / sizeof(*BOUNDARIES); i++) {
+      for (int64_t d=-2; d<=2; d++)
+        driver.insert(n++, (BOUNDARIES[i] + d) * 1000000ULL
+                      + random64(1000000));
+    }
+    driver.insert(n++, 1);
+    driver.insert(n++, 1000000);
+    driver.insert(n++, (3ULL << 32) * 1000000ULL);
+    HT_ASSERT(wheel.size() == entries.size());
+
+    while (driver.wakeup())
+      ;
+    check_all_done(entries);
+    foreach(TestEntry &entry, entries)
+      HT_ASSERT(entry.fired);
+  }
+
+  /**
+   * Cancels entries right before and right after the upper level slots
+   * that hold them are cascaded, at every level.
+   */
+  void test_cancel_during_cascade() {
+    const size_t PER_LEVEL = 60;
+    const size_t levels = sizeof(BOUNDARIES) / sizeof(*BOUNDARIES);
+    TimerWheel wheel(1);
+    vector<TestEntry> entries(PER_LEVEL * levels);
+    Driver driver(wheel, entries);
+    uint64_t base_tick = wheel.elapsed_tick(driver.now());
+
+    for (size_t level=0; level<levels; level++)
+      for (size_t i=0; i<PER_LEVEL; i++)
+        driver.insert(level * PER_LEVEL + i,
+                      (BOUNDARIES[level] + 3 * i) * 1000000ULL);
+
+    // an upper level slot is cascaded at the start of the range it covers;
+    // entries beyond the top level are parked in the top level
+    vector<pair<uint64_t, size_t> > cascades;
+    for (size_t level=0; level<levels; level++) {
+      uint64_t span = min(BOUNDARIES[level], BOUNDARIES[3]);
+      cascades.push_back(make_pair((base_tick + BOUNDARIES[level]) / span
+                                   * span, level));
+    }
+    sort(cascades.begin(), cascades.end());
+
+    for (size_t k=0; k<cascades.size(); k++) {
+      uint64_t boundary = cascades[k].first;
+      size_t level = cascades[k].second;
+
+      // just before the cascade: cancel every third entry of this level
+      if (boundary - 1 > wheel.elapsed_tick(driver.now()))
+        driver.advance_to(nanos(wheel.tick_time(boundary - 1)));
+      for (size_t i=0; i<PER_LEVEL; i+=3)
+        driver.cancel(level * PER_LEVEL + i);
+
+      // the boundary tick cascades the slot; cancel more, some twice
+      if (boundary > wheel.elapsed_tick(driver.now()))
+        driver.advance_to(nanos(wheel.tick_time(boundary)));
+      for (size_t i=1; i<PER_LEVEL; i+=3) {
+        driver.cancel(level * PER_LEVEL + i);
+        driver.cancel(level * PER_LEVEL + i);
+      }
+    }
+
+    while (driver.wakeup())
+      ;
+    check_all_done(entries);
+    for (size_t level=0; level<levels; level++)
+      for (size_t i=0; i<PER_LEVEL; i++)
+        HT_ASSERT(entries[level * PER_LEVEL + i].fired == (i % 3 == 2));
+  }
+
+  /**
+   * Random deadlines over every level with jittery wakeups, random
+   * cancellations and more insertions while the wheel runs.
+   */
+  void test_random(uint32_t tick_millis) {
+    const size_t COUNT = 20000;
+    TimerWheel wheel(tick_millis);
+    vector<TestEntry> entries(COUNT);
+    Driver driver(wheel, entries);
+    size_t inserted = 0;
+
+    for (; inserted<COUNT/2; inserted++) {
+      int shift = random() % 36;
+      driver.insert(inserted, random64((1ULL << shift) * 1000000ULL) + 1);
+    }
+
+    while (driver.wakeup()) {
+      driver.cancel_random(random() % 3, inserted);
+      for (int i=random() % 4; i>0 && inserted<COUNT; i--, inserted++) {
+        int shift = random() % 36;
+        driver.insert(inserted, random64((1ULL << shift) * 1000000ULL) + 1);
+      }
+    }
+
+    for (; inserted<COUNT; inserted++)
+      entries[inserted].cancelled = true;
+    check_all_done(entries);
+  }
+
+  /** clear() and remove() leave nothing behind */
+  void test_clear() {
+    TimerWheel wheel(10);
+    vector<TestEntry> entries(1000);
+    vector<TimerWheel::Entry *> removed;
+    boost::xtime now;
+
+    boost::xtime_get(&now, boost::TIME_UTC);
+    for (size_t i=0; i<entries.size(); i++)
+      wheel.insert(&entries[i], from_nanos(nanos(now)
+                   + random64((1ULL << (i % 40)) * 1000000ULL)));
+    HT_ASSERT(wheel.size() == entries.size());
+    HT_ASSERT(wheel.next_tick() != 0);
+
+    for (size_t i=0; i<entries.size(); i+=2)
+      wheel.remove(&entries[i]);
+    HT_ASSERT(wheel.size() == entries.size() / 2);
+
+    wheel.clear(removed);
+    HT_ASSERT(removed.size() == entries.size() / 2);
+    HT_ASSERT(wheel.size() == 0);
+    HT_ASSERT(wheel.next_tick() == 0);
+    foreach(TestEntry &entry, entries)
+      HT_ASSERT(!entry.is_scheduled());
+  }
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  srandom(1);
+
+  test_boundaries();
+  test_cancel_during_cascade();
+  test_random(1);
+  test_random(10);
+  test_clear();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
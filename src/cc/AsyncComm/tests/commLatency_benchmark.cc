@@ -0,0 +1,170 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Error.h"
+#include "Common/FileUtils.h"
+#include "Common/InetAddr.h"
+#include "Common/Init.h"
+#include "Common/Logger.h"
+#include "Common/Stopwatch.h"
+#include "Common/Usage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+#include <unistd.h>
+}
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/ConnectionHandlerFactory.h"
+#include "AsyncComm/DispatchHandlerSynchronizer.h"
+#include "AsyncComm/ReactorFactory.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *usage[] = {
+    "usage: commLatency_benchmark",
+    "",
+    "  Measures the round trip time of small requests sent to an echo",
+    "  server in the same process, once over TCP loopback and once over",
+    "  the Unix domain socket that Comm uses for connections within a host",
+    "  (see Comm::set_unix_socket_dir).",
+    (const char *)0
+  };
+
+  const uint16_t PORT = 38099;
+  const size_t ROUND_TRIPS = 20000;
+  const size_t WARMUP = 1000;
+
+  class EchoHandler : public DispatchHandler {
+  public:
+    EchoHandler(Comm *comm) : m_comm(comm) { }
+
+    virtual void handle(EventPtr &event) {
+      if (event->type != Event::MESSAGE)
+        return;
+      CommHeader header;
+      header.initialize_from_request_header(event->header);
+      CommBufPtr cbp(new CommBuf(header, 4 + event->payload_len));
+      cbp->append_i32(Error::OK);
+      cbp->append_bytes((uint8_t *)event->payload, event->payload_len);
+      m_comm->send_response(event->addr, cbp);
+    }
+
+  private:
+    Comm *m_comm;
+  };
+
+  class EchoHandlerFactory : public ConnectionHandlerFactory {
+  public:
+    EchoHandlerFactory(DispatchHandlerPtr &dhp) : m_dispatch_handler(dhp) { }
+    virtual void get_instance(DispatchHandlerPtr &dhp) {
+      dhp = m_dispatch_handler;
+    }
+  private:
+    DispatchHandlerPtr m_dispatch_handler;
+  };
+
+  void run(Comm *comm, const char *label, size_t payload_size) {
+    DispatchHandlerSynchronizer *conn_handler =
+        new DispatchHandlerSynchronizer();
+    DispatchHandlerPtr dhp(conn_handler);
+    DispatchHandlerSynchronizer sync_handler;
+    vector<uint8_t> payload(payload_size, 'x');
+    vector<double> latencies;
+    sockaddr_in addr;
+    EventPtr event;
+
+    InetAddr::initialize(&addr, "127.0.0.1", PORT);
+    HT_ASSERT(comm->connect(addr, dhp) == Error::OK);
+    conn_handler->wait_for_reply(event);
+    HT_ASSERT(event->type == Event::CONNECTION_ESTABLISHED);
+
+    for (size_t i=0; i<WARMUP+ROUND_TRIPS; i++) {
+      CommHeader header(1);
+      CommBufPtr cbp(new CommBuf(header, payload_size));
+      cbp->append_bytes(&payload[0], payload_size);
+      Stopwatch stopwatch;
+      HT_ASSERT(comm->send_request(addr, 10000, cbp, &sync_handler)
+                == Error::OK);
+      HT_ASSERT(sync_handler.wait_for_reply(event));
+      stopwatch.stop();
+      if (i >= WARMUP)
+        latencies.push_back(stopwatch.elapsed() * 1000000.0);
+    }
+
+    comm->close_socket(addr);
+    poll(0, 0, 500);
+
+    sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    foreach(double latency, latencies)
+      total += latency;
+
+    printf("  %-6s %5lu bytes  avg %7.1f us  p50 %7.1f us  p99 %7.1f us\n",
+           label, (unsigned long)payload_size, total / latencies.size(),
+           latencies[latencies.size() / 2],
+           latencies[latencies.size() * 99 / 100]);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  if (Config::has("help"))
+    Usage::dump_and_exit(usage);
+
+  ReactorFactory::initialize(2);
+  Comm *comm = Comm::instance();
+  String socket_dir = format("/tmp/commLatency_benchmark.%d", (int)getpid());
+  size_t sizes[] = { 32, 1024, 16384 };
+  sockaddr_in listen_addr;
+
+  comm->set_unix_socket_dir(socket_dir);
+
+  DispatchHandlerPtr echo_handler(new EchoHandler(comm));
+  ConnectionHandlerFactoryPtr chfp(new EchoHandlerFactory(echo_handler));
+  InetAddr::initialize(&listen_addr, INADDR_ANY, PORT);
+  comm->listen(listen_addr, chfp);
+
+  printf("%lu round trips per run\n", (unsigned long)ROUND_TRIPS);
+  for (size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+    comm->set_unix_socket_dir("");
+    run(comm, "tcp", sizes[i]);
+    comm->set_unix_socket_dir(socket_dir);
+    run(comm, "unix", sizes[i]);
+  }
+
+  unlink(format("%s/comm.%u.sock", socket_dir.c_str(), (unsigned)PORT).c_str());
+  rmdir(socket_dir.c_str());
+  fflush(stdout);
+  _exit(0);
+}
@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "Common/Init.h"
+#include "Common/Error.h"
+#include "Common/Random.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include "AsyncComm/Config.h"
+
+#include "Hypertable/Lib/Client.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+
+namespace {
+
+  const char *usage =
+    "Usage: random_multiget_test [options] <total-bytes>\n\n"
+    "Description:\n"
+    "  This program is meant to be used in conjunction with random_write_test.\n"
+    "  It generates the same sequence of keys as random_write_test (as long as\n"
+    "  <total-bytes> and --blocksize are the same) and looks them up in batches,\n"
+    "  once with one scanner per key and once with a single Table::get_cells()\n"
+    "  call per batch.  Every key must return exactly one cell.  It displays\n"
+    "  per-batch latency statistics for both methods.\n\n"
+    "Options";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("blocksize", i32()->default_value(1000), "Size of value written")
+        ("seed", i32()->default_value(1234), "Random number generator seed")
+        ("max-keys", i32()->default_value(0), "Maximum number of keys to lookup")
+        ("batch-size", i32()->default_value(100), "Number of keys per lookup")
+        ;
+      cmdline_hidden_desc().add_options()("total-bytes", i64(), "");
+      cmdline_positional_desc().add("total-bytes", -1);
+    }
+  };
+
+  void check_count(size_t n, size_t expected, const char *method) {
+    if (n != expected) {
+      HT_ERROR_OUT << method << ": wrong number of results: " << n
+                   << " (expected " << expected << ")" << HT_END;
+      _exit(1);
+    }
+  }
+
+  void report(const char *method, vector<double> &latencies, size_t keys) {
+    double total = 0.0;
+
+    sort(latencies.begin(), latencies.end());
+    for (size_t i=0; i<latencies.size(); i++)
+      total += latencies[i];
+
+    printf("%s\n", method);
+    printf("  Elapsed time:  %.2f s\n", total);
+    printf("    Throughput:  %.2f keys/s\n", (double)keys / total);
+    printf(" Batch latency:  mean %.3f ms, p50 %.3f ms, p99 %.3f ms, "
+           "max %.3f ms\n", total * 1000.0 / latencies.size(),
+           latencies[latencies.size() / 2] * 1000.0,
+           latencies[(latencies.size() * 99) / 100] * 1000.0,
+           latencies.back() * 1000.0);
+  }
+
+}
+
+typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
+
+
+int main(int argc, char **argv) {
+  ClientPtr hypertable_client_ptr;
+  TablePtr table_ptr;
+  size_t blocksize, batch_size, R;
+  uint64_t total = 0;
+  uint32_t max_keys;
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    blocksize = get_i32("blocksize");
+    total = get_i64("total-bytes");
+    max_keys = get_i32("max-keys");
+    batch_size = std::max(1, get_i32("batch-size"));
+
+    Random::seed(get_i32("seed"));
+
+    R = total / blocksize;
+
+    if (max_keys != 0 && max_keys < R)
+      R = max_keys;
+
+    hypertable_client_ptr = new Hypertable::Client(
+        System::locate_install_dir(argv[0]));
+
+    table_ptr = hypertable_client_ptr->open_table("RandomTest");
+  }
+  catch (Hypertable::Exception &e) {
+    cerr << "error: " << Error::get_text(e.code()) << " - " << e.what() << endl;
+    _exit(1);
+  }
+
+  char key_data[32];
+  vector<String> keys;
+  vector<double> scanner_latencies, multiget_latencies;
+  ScanSpecBuilder scan_spec;
+  Cell cell;
+
+  key_data[12] = '\0';  // Row key: a random 12-digit number.
+
+  try {
+
+    for (size_t i = 0; i < R; i += batch_size) {
+
+      keys.clear();
+      for (size_t j = i; j < R && j < i + batch_size; ++j) {
+        Random::fill_buffer_with_random_ascii(key_data, 12);
+        keys.push_back(key_data);
+      }
+
+      // one scanner per key
+      {
+        Stopwatch stopwatch;
+        size_t n = 0;
+        foreach(const String &key, keys) {
+          scan_spec.clear();
+          scan_spec.add_column("Field");
+          scan_spec.add_row(key.c_str());
+          TableScannerPtr scanner_ptr =
+              table_ptr->create_scanner(scan_spec.get());
+          while (scanner_ptr->next(cell))
+            ++n;
+        }
+        stopwatch.stop();
+        check_count(n, keys.size(), "scanner");
+        scanner_latencies.push_back(stopwatch.elapsed());
+      }
+
+      // one multi-get per batch
+      {
+        Stopwatch stopwatch;
+        CellsBuilder cells;
+        scan_spec.clear();
+        scan_spec.add_column("Field");
+        table_ptr->get_cells(keys, scan_spec.get(), cells);
+        stopwatch.stop();
+        check_count(cells.get().size(), keys.size(), "get_cells");
+        multiget_latencies.push_back(stopwatch.elapsed());
+      }
+    }
+
+  }
+  catch (Hypertable::Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+
+  if (scanner_latencies.empty())
+    _exit(0);
+
+  printf("Looked up %llu keys in batches of %llu\n", (Llu)R, (Llu)batch_size);
+  report("Per-key scanners", scanner_latencies, R);
+  report("Table::get_cells", multiget_latencies, R);
+  fflush(stdout);
+  _exit(0); // don't bother with static objects.
+}
@@ -18,8 +18,12 @@
  */
 
 #include "Compat.h"
+#include <cstring>
 #include <arpa/inet.h>
 #include <zlib.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
 #include "Checksum.h"
 
 namespace Hypertable {
@@ -207,6 +211,139 @@ crc32_update(uint32_t crc, const void *data, size_t len) {
   return ::crc32(crc, (Bytef *)data, len);
 }
 
+
+/* crc32c uses the Castagnoli polynomial (reflected 0x82F63B78), which is
+ * what the SSE4.2 crc32 instruction computes.  The software version
+ * processes 8 bytes per step with eight 256 entry tables (slicing-by-8),
+ * table k giving the crc of a byte followed by k zero bytes.
+ */
+namespace {
+
+  struct Crc32cTables {
+    Crc32cTables() {
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; ++j)
+          crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+        t[0][i] = crc;
+      }
+      for (uint32_t i = 0; i < 256; ++i)
+        for (int k = 1; k < 8; ++k)
+          t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xff];
+    }
+    uint32_t t[8][256];
+  };
+
+  const Crc32cTables &crc32c_tables() {
+    static Crc32cTables tables;
+    return tables;
+  }
+
+  uint32_t
+  crc32c_sw(uint32_t crc, const uint8_t *p, size_t len) {
+    const Crc32cTables &tab = crc32c_tables();
+
+    for (; len && ((uintptr_t)p & 7); --len)
+      crc = (crc >> 8) ^ tab.t[0][(crc ^ *p++) & 0xff];
+
+    for (; len >= 8; len -= 8, p += 8) {
+      uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16)
+                           | ((uint32_t)p[3] << 24));
+      crc = tab.t[7][lo & 0xff] ^ tab.t[6][(lo >> 8) & 0xff]
+          ^ tab.t[5][(lo >> 16) & 0xff] ^ tab.t[4][lo >> 24]
+          ^ tab.t[3][p[4]] ^ tab.t[2][p[5]] ^ tab.t[1][p[6]] ^ tab.t[0][p[7]];
+    }
+
+    for (; len; --len)
+      crc = (crc >> 8) ^ tab.t[0][(crc ^ *p++) & 0xff];
+
+    return crc;
+  }
+
+#if defined(__x86_64__)
+
+  bool detect_sse42() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+    return (ecx & (1 << 20)) != 0;
+  }
+
+  uint32_t
+  crc32c_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    uint64_t crc64;
+
+    for (; len && ((uintptr_t)p & 7); --len)
+      __asm__("crc32b %1, %0" : "+r"(crc) : "rm"(*p++));
+
+    crc64 = crc;
+    for (; len >= 8; len -= 8, p += 8)
+      __asm__("crc32q %1, %0" : "+r"(crc64) : "rm"(*(const uint64_t *)p));
+    crc = (uint32_t)crc64;
+
+    for (; len; --len)
+      __asm__("crc32b %1, %0" : "+r"(crc) : "rm"(*p++));
+
+    return crc;
+  }
+
+#else
+
+  bool detect_sse42() { return false; }
+
+  uint32_t
+  crc32c_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    return crc32c_sw(crc, p, len);
+  }
+
+#endif
+
+} // local namespace
+
+bool
+crc32c_hardware() {
+  static bool hardware = detect_sse42();
+  return hardware;
+}
+
+uint32_t
+crc32c_update(uint32_t crc, const void *data, size_t len) {
+  if (crc32c_hardware())
+    return ~crc32c_hw(~crc, (const uint8_t *)data, len);
+  return ~crc32c_sw(~crc, (const uint8_t *)data, len);
+}
+
+uint32_t
+crc32c_sw_update(uint32_t crc, const void *data, size_t len) {
+  return ~crc32c_sw(~crc, (const uint8_t *)data, len);
+}
+
+uint32_t
+crc32c(const void *data, size_t len) {
+  return crc32c_update(0, data, len);
+}
+
+uint32_t
+checksum(int type, const void *data, size_t len) {
+  if (type == CHECKSUM_CRC32C)
+    return crc32c_update(0, data, len);
+  return fletcher32(data, len);
+}
+
+const char *
+checksum_name(int type) {
+  return type == CHECKSUM_CRC32C ? "crc32c" : "fletcher32";
+}
+
+int
+checksum_type(const char *name) {
+  if (!strcmp(name, "fletcher32"))
+    return CHECKSUM_FLETCHER32;
+  if (!strcmp(name, "crc32c"))
+    return CHECKSUM_CRC32C;
+  return -1;
+}
+
 } // namespace Hypertable
 
 /* vim: et sw=2
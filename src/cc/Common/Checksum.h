@@ -73,6 +73,67 @@ crc32(const void *data, size_t len);
 extern uint32_t
 crc32_update(uint32_t crc, const void *data, size_t len);
 
+/** Compute crc32c (Castagnoli) checksum.  Uses the SSE4.2 crc32
+ *  instruction if the processor supports it and a table driven
+ *  slicing-by-8 implementation otherwise
+ *
+ * @param data - input data
+ * @param len - input data length in bytes
+ */
+extern uint32_t
+crc32c(const void *data, size_t len);
+
+/** Update crc32c checksum incrementally
+ *
+ * @param crc - current crc32c checksum
+ * @param data - input data
+ * @param len - input data length in bytes
+ */
+extern uint32_t
+crc32c_update(uint32_t crc, const void *data, size_t len);
+
+/** Update crc32c checksum incrementally, always using the slicing-by-8
+ *  implementation
+ *
+ * @param crc - current crc32c checksum
+ * @param data - input data
+ * @param len - input data length in bytes
+ */
+extern uint32_t
+crc32c_sw_update(uint32_t crc, const void *data, size_t len);
+
+/** Returns true if crc32c() runs on the SSE4.2 crc32 instruction
+ */
+extern bool
+crc32c_hardware();
+
+/** Checksum algorithms that can be selected with checksum()
+ */
+enum ChecksumType {
+  CHECKSUM_FLETCHER32 = 0,
+  CHECKSUM_CRC32C     = 1
+};
+
+/** Compute checksum with the given algorithm
+ *
+ * @param type - checksum algorithm (see ChecksumType)
+ * @param data - input data
+ * @param len - input data length in bytes
+ */
+extern uint32_t
+checksum(int type, const void *data, size_t len);
+
+/** Returns the name of checksum algorithm type ("fletcher32", "crc32c")
+ */
+extern const char *
+checksum_name(int type);
+
+/** Returns the checksum algorithm with the given name, or -1 if there is
+ *  no such algorithm
+ */
+extern int
+checksum_type(const char *name);
+
 } // namespace Hypertable
 
 #endif /* HYPERTABLE_CHECKSUM_H */
@@ -145,6 +145,24 @@ void init_default_options() {
   file_desc().add_options()
     ("Comm.DispatchDelay", i32()->default_value(0), "[TESTING ONLY] "
         "Delay dispatching of read requests by this number of milliseconds")
+    ("Comm.TimerTickMillis", i32()->default_value(10), "Granularity, in "
+        "milliseconds, of request timeouts and timers.  Deadlines falling "
+        "into the same tick are handled with a single reactor wakeup")
+    ("Comm.ReceiveBufferPool.MaxMemory", i64()->default_value(16*M),
+        "Maximum amount of memory (bytes) each reactor keeps in its pool of "
+        "inbound message buffers")
+    ("Comm.PayloadChecksum", boo()->default_value(false), "Send a crc32c "
+        "checksum of the payload with every message, which the receiver "
+        "verifies")
+    ("Comm.Compression", str()->default_value("none"), "Codec (lzo, "
+        "quicklz, ...) with which message payloads are compressed when the "
+        "peer takes compressed payloads")
+    ("Comm.Compression.MinSize", i32()->default_value(4*K), "Payloads "
+        "smaller than this number of bytes are not compressed")
+    ("Comm.UnixSocketDir", str()->default_value(""), "Directory (relative "
+        "to the installation directory unless absolute) of the Unix domain "
+        "sockets through which processes on the same host talk to each "
+        "other instead of TCP; empty turns this off")
     ("Hypertable.Verbose", boo()->default_value(false),
         "Enable verbose output (system wide)")
     ("Hypertable.Silent", boo()->default_value(false),
@@ -193,6 +211,13 @@ void init_default_options() {
     ("DfsBroker.Timeout", i32(), "Length of time, "
         "in milliseconds, to wait before timing out DFS Broker requests. This "
         "takes precedence over Hypertable.Request.Timeout")
+    ("DfsBroker.SharedMemory.Slots", i32()->default_value(0), "Number of "
+        "shared memory buffers through which clients pass pread and append "
+        "data to a DFS broker on the same host, 0 turns this off (read by "
+        "clients only)")
+    ("DfsBroker.SharedMemory.SlotSize", i32()->default_value(MiB), "Size of "
+        "the shared memory buffers; larger reads and appends go through the "
+        "socket (read by clients only)")
     ("Hyperspace.Timeout", i32()->default_value(30000), "Timeout (millisec) "
         "for hyperspace requests (preferred to Hypertable.Request.Timeout")
     ("Hyperspace.Master.Host", str(),
@@ -222,6 +247,12 @@ void init_default_options() {
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate",
      i64()->default_value(40*M), "Amount of updates (bytes) accumulated for "
         "all servers to trigger a scatter buffer flush")
+    ("Hypertable.Scanner.Readahead.MaxDepth", i32()->default_value(8),
+        "Maximum number of scan blocks a scanner requests ahead of the "
+        "consumer")
+    ("Hypertable.Scanner.Readahead.MemoryLimit", i64()->default_value(64*M),
+        "Amount of scan block data (bytes) all scanners of a client may "
+        "request ahead before readahead depth is reduced")
     ("Hypertable.LocationCache.MaxEntries", i64()->default_value(1*M),
         "Size of range location cache in number of entries")
     ("Hypertable.Master.Host", str(),
@@ -241,6 +272,9 @@ void init_default_options() {
         "Port number on which range servers are or should be listening")
     ("Hypertable.RangeServer.AccessGroup.CellCache.PageSize",
      i32()->default_value(512*KiB), "Page size for CellCache pool allocator")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.Type",
+     str()->default_value("map"), "Default cell map implementation for access "
+        "groups that do not specify one (map|skiplist)")
     ("Hypertable.RangeServer.AccessGroup.MaxFiles", i32()->default_value(20),
         "Maximum number of cell store files to create before merging")
     ("Hypertable.RangeServer.AccessGroup.MaxMemory", i64()->default_value(1*G),
@@ -253,8 +287,29 @@ void init_default_options() {
         str()->default_value("lzo"), "Default compressor for cell stores")
     ("Hypertable.RangeServer.CellStore.DefaultBloomFilter",
         str()->default_value("rows"), "Default bloom filter for cell stores")
+    ("Hypertable.RangeServer.BlockChecksum",
+        str()->default_value("fletcher32"), "Checksum algorithm (fletcher32 "
+        "or crc32c) for the data of newly written cell store and commit log "
+        "blocks.  Blocks written with crc32c can not be read by versions "
+        "that predate it")
     ("Hypertable.RangeServer.BlockCache.MaxMemory", i64()->default_value(200*M),
         "Bytes to dedicate to the block cache")
+    ("Hypertable.RangeServer.BlockCache.Compressed.MaxMemory",
+        i64()->default_value(0), "Bytes to dedicate to the compressed tier "
+        "of the block cache (0 disables it); blocks read once are kept "
+        "compressed and are inflated into the block cache when read again")
+    ("Hypertable.RangeServer.BlockCache.Shards", i32()->default_value(16),
+        "Number of independently locked shards the block cache is split into;"
+        " each gets an equal share of the block cache memory")
+    ("Hypertable.RangeServer.Compaction.Pipeline.Threads",
+        i32()->default_value(2), "Number of threads, shared by all "
+        "compactions, that inflate source blocks and deflate and write "
+        "destination blocks while the merge runs on the maintenance thread "
+        "(0 compacts inline)")
+    ("Hypertable.RangeServer.Compaction.Pipeline.QueueDepth",
+        i32()->default_value(8), "Maximum number of blocks in flight per "
+        "source cell store and for the destination cell store in a "
+        "pipelined compaction")
     ("Hypertable.RangeServer.Range.SplitSize", i64()->default_value(200*M),
         "Size of range in bytes before splitting")
     ("Hypertable.RangeServer.Range.MaximumSize", i64()->default_value(3*G),
@@ -287,8 +342,31 @@ void init_default_options() {
         "Commit log compressor to use (zlib, lzo, quicklz, bmz, none)")
     ("Hypertable.CommitLog.SkipErrors", boo()->default_value(false),
         "Skip over any corruption encountered in the commit log")
+    ("Hypertable.CommitLog.GroupCommit", boo()->default_value(true),
+        "Batch commit log writes from concurrent updates into a single "
+        "append and sync")
+    ("Hypertable.CommitLog.GroupCommit.MaxBatchBytes",
+        i32()->default_value(4*M), "Maximum amount of uncompressed update "
+        "data (bytes) the group commit leader waits for before writing")
+    ("Hypertable.CommitLog.GroupCommit.MaxWaitMicros",
+        i32()->default_value(0), "Maximum time (microseconds) the group "
+        "commit leader waits for other updates to join a batch")
+    ("Hypertable.CommitLog.Pipelined", boo()->default_value(false),
+        "Compress commit log blocks outside the log lock and append them "
+        "asynchronously from a dedicated writer thread")
+    ("Hypertable.CommitLog.Pipelined.MaxQueueBytes",
+        i32()->default_value(16*M), "Maximum amount of compressed data "
+        "(bytes) queued for the commit log writer thread")
     ("Hypertable.RangeServer.Scanner.Ttl", i32()->default_value(120000),
         "Number of milliseconds of inactivity before destroying scanners")
+    ("Hypertable.RangeServer.Scanner.ZeroCopyThreshold",
+        i32()->default_value(4*K), "Cell values of at least this many bytes "
+        "are sent to scan clients straight out of the cell cache or block "
+        "cache instead of being copied into the response (0 disables)")
+    ("Hypertable.RangeServer.AggregateScan.MaxBytes",
+        i32()->default_value(16*M), "Amount of key and value data (bytes) "
+        "an aggregate scan request reads before it returns a partial result "
+        "and the row for the client to resume from")
     ("Hypertable.RangeServer.Timer.Interval", i32()->default_value(20000),
         "Timer interval in milliseconds (reaping scanners, "
         "purging commit logs, etc.)")
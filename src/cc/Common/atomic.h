@@ -229,4 +229,13 @@ __asm__ __volatile__(LOCK "orl %0,%1" \
 #define atomic_inc_return(v)  (atomic_add_return(1,v))
 #define atomic_dec_return(v)  (atomic_sub_return(1,v))
 
+/*
+ * Memory barriers for publishing data to lock-free readers.  x86 never
+ * reorders stores with older stores or loads with older loads, so only
+ * the compiler needs to be kept from moving things around.
+ */
+#define compiler_barrier() __asm__ __volatile__("": : :"memory")
+#define smp_wmb() compiler_barrier()
+#define smp_rmb() compiler_barrier()
+
 #endif // ATOMIC_H
@@ -42,6 +42,7 @@ namespace {
     "Supported Algorithms:\n" \
     "\n" \
     "  fletcher32\n" \
+    "  crc32c\n" \
     "\n";
 
 }
@@ -56,11 +57,13 @@ int main(int argc, char **argv) {
     exit(1);
   }
 
-  if (!strcmp(argv[1], "fletcher32")) {
+  int type = checksum_type(argv[1]);
+
+  if (type >= 0) {
     off_t len;
     char *data = FileUtils::file_to_buffer(argv[2], &len);
-    int32_t checksum = fletcher32(data, len);
-    cout << checksum << endl;
+    int32_t sum = checksum(type, data, len);
+    cout << sum << endl;
   }
   else {
     cout << usage_str << endl;
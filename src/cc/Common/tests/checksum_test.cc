@@ -0,0 +1,135 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "Common/Checksum.h"
+#include "Common/Init.h"
+#include "Common/Stopwatch.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+struct MyPolicy : Config::Policy {
+  static void init_options() {
+    cmdline_desc("Usage: %s [Options]\n\nVerifies crc32c against known "
+        "values and the software implementation, then\nmeasures the "
+        "throughput of the checksum algorithms.\n\nOptions").add_options()
+      ("size,s", i32()->default_value(16*M), "bytes to checksum per pass")
+      ("repeats,r", i32()->default_value(8), "number of passes")
+      ;
+  }
+};
+
+typedef Cons<MyPolicy, DefaultPolicy> AppPolicy;
+
+#define MEASURE(_label_, _code_) do { \
+  Stopwatch w; \
+  for (int i = 0; i < repeats; ++i) { _code_; } \
+  w.stop(); \
+  cout << _label_ <<": "<< (double)size * repeats / w.elapsed() / 1e9 \
+       <<" GB/s (last="<< sum <<")"<< endl; \
+} while (0)
+
+void check_known_values() {
+  const char *digits = "123456789";
+  uint8_t zeros[32], ones[32], incr[32];
+
+  for (int i = 0; i < 32; ++i) {
+    zeros[i] = 0;
+    ones[i] = 0xff;
+    incr[i] = i;
+  }
+
+  // cf. RFC 3720, B.4
+  HT_ASSERT(crc32c(digits, 9) == 0xe3069283);
+  HT_ASSERT(crc32c(zeros, 32) == 0x8a9136aa);
+  HT_ASSERT(crc32c(ones, 32) == 0x62a8ab43);
+  HT_ASSERT(crc32c(incr, 32) == 0x46dd794e);
+  HT_ASSERT(crc32c(digits, 0) == 0);
+
+  HT_ASSERT(checksum(CHECKSUM_CRC32C, digits, 9) == 0xe3069283);
+  HT_ASSERT(checksum(CHECKSUM_FLETCHER32, digits, 9) == fletcher32(digits, 9));
+  HT_ASSERT(checksum_type(checksum_name(CHECKSUM_CRC32C)) == CHECKSUM_CRC32C);
+  HT_ASSERT(checksum_type("fletcher32") == CHECKSUM_FLETCHER32);
+  HT_ASSERT(checksum_type("md5") == -1);
+}
+
+/**
+ * Both implementations must agree for all alignments and lengths, and
+ * computing a checksum in two pieces must give the same result.
+ */
+void check_consistency() {
+  vector<uint8_t> buf(8192);
+
+  srandom(1);
+  for (size_t i = 0; i < buf.size(); ++i)
+    buf[i] = random();
+
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t len = 0; len + offset < buf.size(); len += 1 + len / 8) {
+      const uint8_t *p = &buf[offset];
+      uint32_t crc = crc32c(p, len);
+      HT_ASSERT(crc == crc32c_sw_update(0, p, len));
+      size_t split = len / 3;
+      HT_ASSERT(crc == crc32c_update(crc32c(p, split), p + split, len - split));
+    }
+  }
+}
+
+} // local namespace
+
+int main(int ac, char *av[]) {
+  try {
+    init_with_policy<AppPolicy>(ac, av);
+
+    check_known_values();
+    check_consistency();
+
+    size_t size = get_i32("size");
+    int repeats = get_i32("repeats");
+    vector<uint8_t> data(size);
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i < size; ++i)
+      data[i] = i * 31 + (i >> 8);
+
+    cout << "crc32c uses " << (crc32c_hardware() ? "SSE4.2" : "slicing-by-8")
+         << endl;
+
+    MEASURE("fletcher32", sum = fletcher32(&data[0], size));
+    MEASURE("crc32c", sum = crc32c(&data[0], size));
+    MEASURE("crc32c (slicing-by-8)", sum = crc32c_sw_update(0, &data[0], size));
+    MEASURE("crc32 (zlib)", sum = crc32(&data[0], size));
+    MEASURE("adler32", sum = adler32(&data[0], size));
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
@@ -21,6 +21,7 @@
 
 #include "Common/Compat.h"
 
+#include "Common/Config.h"
 #include "Common/Error.h"
 #include "Common/Logger.h"
 #include "Common/Serialization.h"
@@ -35,11 +36,70 @@ using namespace Hypertable;
 using namespace Serialization;
 using namespace Hypertable::DfsBroker;
 
+namespace {
+
+  /**
+   * Holds a slot of the shared memory region for the duration of a
+   * request.  The slot is not handed back if the broker may still be using
+   * it, i.e. if the request timed out or the connection broke.
+   */
+  class ShmSlot {
+  public:
+    ShmSlot(SharedMemoryRegionPtr &region, uint32_t slot)
+      : m_region(region), m_slot(slot), m_keep(false) { }
+
+    ~ShmSlot() {
+      if (!m_keep)
+        m_region->release_slot(m_slot);
+    }
+
+    uint8_t *get() { return m_region->get_slot(m_slot); }
+
+    void keep() {
+      HT_WARNF("Giving up shared memory slot %u of %s", (unsigned)m_slot,
+               m_region->get_name().c_str());
+      m_keep = true;
+    }
+
+  private:
+    SharedMemoryRegionPtr m_region;
+    uint32_t              m_slot;
+    bool                  m_keep;
+  };
+
+  /**
+   * Response handler of an asynchronous shm append.  Hands back the slot
+   * and passes the response on to the handler of the caller.
+   */
+  class ShmAppendHandler : public DispatchHandler {
+  public:
+    ShmAppendHandler(SharedMemoryRegionPtr &region, uint32_t slot,
+                     DispatchHandler *handler)
+      : m_slot(region, slot), m_handler(handler) { }
+
+    virtual void handle(EventPtr &event_ptr) {
+      DispatchHandler *handler = m_handler;
+      if (event_ptr->type != Event::MESSAGE)
+        m_slot.keep();
+      // hand the slot back before the caller can ask for it again
+      delete this;
+      handler->handle(event_ptr);
+    }
+
+  private:
+    ShmSlot          m_slot;
+    DispatchHandler *m_handler;
+  };
+
+}
+
+
 Client::Client(ConnectionManagerPtr &conn_mgr, const sockaddr_in &addr,
                uint32_t timeout_ms)
     : m_conn_mgr(conn_mgr), m_addr(addr), m_timeout_ms(timeout_ms) {
   m_comm = conn_mgr->get_comm();
   conn_mgr->add(m_addr, m_timeout_ms, "DFS Broker");
+  initialize_shm(Config::properties);
 }
 
 
@@ -56,10 +116,12 @@ Client::Client(ConnectionManagerPtr &conn_mgr, PropertiesPtr &cfg)
   InetAddr::initialize(&m_addr, host.c_str(), port);
 
   conn_mgr->add(m_addr, m_timeout_ms, "DFS Broker");
+  initialize_shm(cfg);
 }
 
 Client::Client(Comm *comm, const sockaddr_in &addr, uint32_t timeout_ms)
     : m_comm(comm), m_conn_mgr(0), m_addr(addr), m_timeout_ms(timeout_ms) {
+  initialize_shm(Config::properties);
 }
 
 Client::Client(const String &host, int port, uint32_t timeout_ms)
@@ -68,6 +130,7 @@ Client::Client(const String &host, int port, uint32_t timeout_ms)
   m_comm = Comm::instance();
   m_conn_mgr = new ConnectionManager(m_comm);
   m_conn_mgr->add(m_addr, timeout_ms, "DFS Broker");
+  initialize_shm(Config::properties);
 }
 
 void
@@ -266,6 +329,14 @@ Client::read(int32_t fd, void *dst, size_t len) {
 void
 Client::append(int32_t fd, StaticBuffer &buffer, uint32_t flags,
                DispatchHandler *handler) {
+  SharedMemoryRegionPtr region;
+  uint32_t slot;
+
+  if (acquire_shm_slot(buffer.size, region, &slot)) {
+    shm_append(region, slot, fd, buffer, flags, handler);
+    return;
+  }
+
   CommBufPtr cbp(m_protocol.create_append_request(fd, buffer, flags));
 
   try { send_message(cbp, handler); }
@@ -280,10 +351,17 @@ size_t
 Client::append(int32_t fd, StaticBuffer &buffer, uint32_t flags) {
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event_ptr;
-  CommBufPtr cbp(m_protocol.create_append_request(fd, buffer, flags));
+  SharedMemoryRegionPtr region;
+  uint32_t slot;
+  CommBufPtr cbp;
 
   try {
-    send_message(cbp, &sync_handler);
+    if (acquire_shm_slot(buffer.size, region, &slot))
+      shm_append(region, slot, fd, buffer, flags, &sync_handler);
+    else {
+      cbp = m_protocol.create_append_request(fd, buffer, flags);
+      send_message(cbp, &sync_handler);
+    }
 
     if (!sync_handler.wait_for_reply(event_ptr))
       HT_THROW(Protocol::response_code(event_ptr.get()),
@@ -453,6 +531,12 @@ size_t
 Client::pread(int32_t fd, void *dst, size_t len, uint64_t offset) {
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event_ptr;
+  SharedMemoryRegionPtr region;
+  uint32_t slot;
+
+  if (acquire_shm_slot(len, region, &slot))
+    return shm_pread(region, slot, fd, dst, len, offset);
+
   CommBufPtr cbp(m_protocol.create_position_read_request(fd, offset, len));
 
   try {
@@ -713,3 +797,134 @@ Client::send_message(CommBufPtr &cbp, DispatchHandler *handler) {
   if (error != Error::OK)
     HT_THROWF(error, "DFS send_request to %s failed", m_addr.format().c_str());
 }
+
+
+void Client::initialize_shm(PropertiesPtr &props) {
+  m_shm_slot_size = 0;
+  m_shm_slot_count = 0;
+  m_shm_attached = false;
+  if (props) {
+    m_shm_slot_size = props->get_i32("DfsBroker.SharedMemory.SlotSize",
+                                     Property::MiB);
+    m_shm_slot_count = props->get_i32("DfsBroker.SharedMemory.Slots", 0);
+  }
+  if (m_shm_slot_count && !m_comm->is_local_address(m_addr)) {
+    HT_INFOF("Not using shared memory with DFS broker at %s, which is not "
+             "on this host", m_addr.format().c_str());
+    m_shm_slot_count = 0;
+  }
+}
+
+
+void Client::attach_shm() {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event_ptr;
+
+  try {
+    // the region is kept until the broker accepts it, so that it isn't
+    // recreated for every request while the broker is not connected
+    if (!m_shm_region)
+      m_shm_region = new SharedMemoryRegion(m_shm_slot_size, m_shm_slot_count);
+    CommBufPtr cbp(m_protocol.create_shm_attach_request(
+        m_shm_region->get_name(), m_shm_region->get_cookie()));
+    send_message(cbp, &sync_handler);
+  }
+  catch (Exception &e) {
+    // not connected yet, try again with the next request
+    if (e.code() == Error::COMM_NOT_CONNECTED)
+      return;
+    HT_WARNF("Not using shared memory with DFS broker - %s", e.what());
+    m_shm_slot_count = 0;
+    m_shm_region = 0;
+    return;
+  }
+
+  if (!sync_handler.wait_for_reply(event_ptr)) {
+    HT_INFOF("Not using shared memory with DFS broker at %s - %s",
+             m_addr.format().c_str(),
+             m_protocol.string_format_message(event_ptr).c_str());
+    m_shm_slot_count = 0;
+    m_shm_region = 0;
+    return;
+  }
+
+  HT_INFOF("Passing DFS data through shared memory region %s (%u x %u "
+           "bytes)", m_shm_region->get_name().c_str(),
+           (unsigned)m_shm_slot_count, (unsigned)m_shm_slot_size);
+  m_shm_attached = true;
+}
+
+
+bool
+Client::acquire_shm_slot(size_t len, SharedMemoryRegionPtr &region,
+                         uint32_t *slotp) {
+  {
+    ScopedLock lock(m_shm_mutex);
+    if (m_shm_slot_count == 0 || len > m_shm_slot_size)
+      return false;
+    if (!m_shm_attached)
+      attach_shm();
+    if (!m_shm_attached)
+      return false;
+    region = m_shm_region;
+  }
+  return region->acquire_slot(slotp);
+}
+
+
+size_t
+Client::shm_pread(SharedMemoryRegionPtr &region, uint32_t slot, int32_t fd,
+                  void *dst, size_t len, uint64_t offset) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event_ptr;
+  ShmSlot shm_slot(region, slot);
+  CommBufPtr cbp(m_protocol.create_shm_position_read_request(
+      region->get_name(), region->get_cookie(), region->get_slot_size(), slot,
+      fd, offset, len));
+
+  try {
+    send_message(cbp, &sync_handler);
+
+    if (!sync_handler.wait_for_reply(event_ptr)) {
+      if (event_ptr->type != Event::MESSAGE)
+        shm_slot.keep();
+      HT_THROW(Protocol::response_code(event_ptr.get()),
+               m_protocol.string_format_message(event_ptr).c_str());
+    }
+
+    // the response has the layout of an append response
+    uint64_t read_offset;
+    size_t amount = decode_response_append(event_ptr, &read_offset);
+
+    if (amount > len)
+      HT_THROWF(Error::DFSBROKER_IO_ERROR, "asked for %u bytes but got %u",
+                (unsigned)len, (unsigned)amount);
+
+    memcpy(dst, shm_slot.get(), amount);
+    return amount;
+  }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Error preading at byte %llu on DFS fd %d",
+               (Llu)offset, (int)fd);
+  }
+}
+
+
+void
+Client::shm_append(SharedMemoryRegionPtr &region, uint32_t slot, int32_t fd,
+                   StaticBuffer &buffer, uint32_t flags,
+                   DispatchHandler *handler) {
+  ShmAppendHandler *shm_handler = new ShmAppendHandler(region, slot, handler);
+  CommBufPtr cbp(m_protocol.create_shm_append_request(region->get_name(),
+      region->get_cookie(), region->get_slot_size(), slot, fd, buffer.size,
+      flags));
+
+  memcpy(region->get_slot(slot), buffer.base, buffer.size);
+
+  try { send_message(cbp, shm_handler); }
+  catch (Exception &e) {
+    delete shm_handler;
+    HT_THROW2F(e.code(), e, "Error appending %u bytes to DFS fd %d",
+               (unsigned)buffer.size, (int)fd);
+  }
+}
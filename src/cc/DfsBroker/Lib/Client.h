@@ -35,6 +35,7 @@
 
 #include "ClientBufferedReaderHandler.h"
 #include "Protocol.h"
+#include "SharedMemoryRegion.h"
 
 
 namespace Hypertable { namespace DfsBroker {
@@ -44,6 +45,11 @@ namespace Hypertable { namespace DfsBroker {
      * serialized by the underlying filesystem.  In other words, if you issue
      * three asynchronous commands, they will get carried out and their
      * responses will come back in the same order in which they were issued.
+     *
+     * If DfsBroker.SharedMemory.Slots is non-zero and the broker is on the
+     * same host, synchronous preads and all appends pass their data through
+     * a SharedMemoryRegion instead of the socket, as long as it fits into a
+     * slot and a slot is free.
      */
     class Client : public Filesystem {
     public:
@@ -195,6 +201,28 @@ namespace Hypertable { namespace DfsBroker {
        */
       void send_message(CommBufPtr &cbp, DispatchHandler *handler);
 
+      void initialize_shm(PropertiesPtr &props);
+
+      /**
+       * Creates the shared memory region, unless that was done before, and
+       * has the broker map it
+       */
+      void attach_shm();
+
+      /**
+       * Takes a slot of the shared memory region for a transfer of len
+       * bytes.  Returns false if the data has to go through the socket.
+       */
+      bool acquire_shm_slot(size_t len, SharedMemoryRegionPtr &region,
+                            uint32_t *slotp);
+
+      size_t shm_pread(SharedMemoryRegionPtr &region, uint32_t slot,
+                       int32_t fd, void *dst, size_t len, uint64_t offset);
+
+      void shm_append(SharedMemoryRegionPtr &region, uint32_t slot,
+                      int32_t fd, StaticBuffer &buffer, uint32_t flags,
+                      DispatchHandler *handler);
+
       typedef hash_map<uint32_t, ClientBufferedReaderHandler *>
           BufferedReaderMap;
 
@@ -205,6 +233,11 @@ namespace Hypertable { namespace DfsBroker {
       uint32_t              m_timeout_ms;
       Protocol              m_protocol;
       BufferedReaderMap     m_buffered_reader_map;
+      Mutex                 m_shm_mutex;
+      SharedMemoryRegionPtr m_shm_region;
+      bool                  m_shm_attached;
+      uint32_t              m_shm_slot_size;
+      uint32_t              m_shm_slot_count; // 0 if shared memory is off
     };
 
     typedef intrusive_ptr<Client> ClientPtr;
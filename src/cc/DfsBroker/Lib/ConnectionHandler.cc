@@ -46,6 +46,8 @@
 #include "RequestHandlerReaddir.h"
 #include "RequestHandlerExists.h"
 #include "RequestHandlerRename.h"
+#include "RequestHandlerShmAppend.h"
+#include "RequestHandlerShmPread.h"
 
 using namespace Hypertable;
 using namespace DfsBroker;
@@ -119,6 +121,20 @@ void ConnectionHandler::handle(EventPtr &event) {
       case Protocol::COMMAND_DEBUG:
         handler = new RequestHandlerDebug(m_comm, m_broker_ptr.get(), event);
         break;
+      case Protocol::COMMAND_SHM_ATTACH: {
+          ResponseCallback cb(m_comm, event);
+          get_shm_region(event);
+          cb.response_ok();
+        }
+        return;
+      case Protocol::COMMAND_SHM_PREAD:
+        handler = new RequestHandlerShmPread(m_comm, m_broker_ptr.get(),
+                                             get_shm_region(event), event);
+        break;
+      case Protocol::COMMAND_SHM_APPEND:
+        handler = new RequestHandlerShmAppend(m_comm, m_broker_ptr.get(),
+                                              get_shm_region(event), event);
+        break;
       case Protocol::COMMAND_STATUS:
         handler = new RequestHandlerStatus(m_comm, m_broker_ptr.get(), event);
         break;
@@ -151,6 +167,7 @@ void ConnectionHandler::handle(EventPtr &event) {
               event->addr.format().c_str());
     OpenFileMap &ofmap = m_broker_ptr->get_open_file_map();
     ofmap.remove_all(event->addr);
+    m_shm_region = 0;
   }
   else {
     HT_DEBUGF("%s", event->to_str().c_str());
@@ -158,3 +175,24 @@ void ConnectionHandler::handle(EventPtr &event) {
 
 }
 
+
+SharedMemoryRegion *ConnectionHandler::get_shm_region(EventPtr &event) {
+  const uint8_t *decode_ptr = event->payload;
+  size_t decode_remain = event->payload_len;
+  String name = decode_str16(&decode_ptr, &decode_remain);
+  uint64_t cookie = decode_i64(&decode_ptr, &decode_remain);
+
+  if (!m_comm->is_local_address(event->addr))
+    HT_THROWF(Error::DFSBROKER_INVALID_ARGUMENT, "Shared memory requested "
+              "by %s, which is not on this host",
+              event->addr.format().c_str());
+
+  if (!m_shm_region || m_shm_region->get_name() != name ||
+      m_shm_region->get_cookie() != cookie) {
+    m_shm_region = 0;
+    m_shm_region = new SharedMemoryRegion(name, cookie);
+    HT_INFOF("Mapped shared memory region %s for %s", name.c_str(),
+             event->addr.format().c_str());
+  }
+  return m_shm_region.get();
+}
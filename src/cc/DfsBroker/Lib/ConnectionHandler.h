@@ -26,6 +26,7 @@
 #include "AsyncComm/DispatchHandler.h"
 
 #include "Broker.h"
+#include "SharedMemoryRegion.h"
 
 namespace Hypertable {
 
@@ -42,9 +43,18 @@ namespace Hypertable {
       virtual void handle(EventPtr &event_ptr);
 
     private:
+      /**
+       * Returns the shared memory region named at the start of the payload
+       * of a shm request, mapping it if it isn't the one used last.  Only
+       * clients on this host may use shared memory, and only with the
+       * cookie of the region.
+       */
+      SharedMemoryRegion *get_shm_region(EventPtr &event_ptr);
+
       Comm               *m_comm;
       ApplicationQueuePtr m_app_queue_ptr;
       BrokerPtr           m_broker_ptr;
+      SharedMemoryRegionPtr m_shm_region;
     };
   }
 
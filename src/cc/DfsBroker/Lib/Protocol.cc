@@ -60,7 +60,10 @@ namespace Hypertable {
       "readdir",
       "exists",
       "rename",
-      "debug"
+      "debug",
+      "shm attach",
+      "shm pread",
+      "shm append"
     };
 
 
@@ -257,6 +260,49 @@ namespace Hypertable {
       return cbuf;
     }
 
+    CommBuf *Protocol::create_shm_attach_request(const String &name,
+                                                 uint64_t cookie) {
+      CommHeader header(COMMAND_SHM_ATTACH);
+      CommBuf *cbuf = new CommBuf(header, encoded_length_str16(name) + 8);
+      cbuf->append_str16(name);
+      cbuf->append_i64(cookie);
+      return cbuf;
+    }
+
+    CommBuf *
+    Protocol::create_shm_position_read_request(const String &name,
+        uint64_t cookie, uint32_t slot_size, uint32_t slot, int32_t fd,
+        uint64_t offset, uint32_t amount) {
+      CommHeader header(COMMAND_SHM_PREAD);
+      header.gid = fd;
+      CommBuf *cbuf = new CommBuf(header, encoded_length_str16(name) + 32);
+      cbuf->append_str16(name);
+      cbuf->append_i64(cookie);
+      cbuf->append_i32(slot_size);
+      cbuf->append_i32(slot);
+      cbuf->append_i32(fd);
+      cbuf->append_i64(offset);
+      cbuf->append_i32(amount);
+      return cbuf;
+    }
+
+    CommBuf *
+    Protocol::create_shm_append_request(const String &name,
+        uint64_t cookie, uint32_t slot_size, uint32_t slot, int32_t fd,
+        uint32_t amount, bool flush) {
+      CommHeader header(COMMAND_SHM_APPEND);
+      header.gid = fd;
+      CommBuf *cbuf = new CommBuf(header, encoded_length_str16(name) + 25);
+      cbuf->append_str16(name);
+      cbuf->append_i64(cookie);
+      cbuf->append_i32(slot_size);
+      cbuf->append_i32(slot);
+      cbuf->append_i32(fd);
+      cbuf->append_i32(amount);
+      cbuf->append_bool(flush);
+      return cbuf;
+    }
+
     const char *Protocol::command_text(uint64_t command) {
       if (command < 0 || command >= COMMAND_MAX)
         return "UNKNOWN";
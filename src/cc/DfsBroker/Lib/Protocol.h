@@ -82,6 +82,34 @@ namespace Hypertable {
       static CommBuf *create_debug_request(int32_t command,
                                            StaticBuffer &serialized_parameters);
 
+      /**
+       * Asks the broker to map the shared memory region called name, whose
+       * header holds cookie (see SharedMemoryRegion).  Fails unless the
+       * client is connected over a Unix domain socket or from the same
+       * host.
+       */
+      static CommBuf *create_shm_attach_request(const String &name,
+                                                uint64_t cookie);
+
+      /**
+       * Like create_position_read_request(), except that the broker puts
+       * the data into slot slot (of slot_size bytes) of the shared memory
+       * region called name.  The response has the layout of an append
+       * response: error, offset, amount.
+       */
+      static CommBuf *create_shm_position_read_request(const String &name,
+          uint64_t cookie, uint32_t slot_size, uint32_t slot, int32_t fd,
+          uint64_t offset, uint32_t amount);
+
+      /**
+       * Like create_append_request(), except that the amount bytes to
+       * append are in slot slot (of slot_size bytes) of the shared memory
+       * region called name.
+       */
+      static CommBuf *create_shm_append_request(const String &name,
+          uint64_t cookie, uint32_t slot_size, uint32_t slot, int32_t fd,
+          uint32_t amount, bool flush = false);
+
       virtual const char *command_text(uint64_t command);
 
       static const uint64_t COMMAND_OPEN     = 0;
@@ -102,7 +130,10 @@ namespace Hypertable {
       static const uint64_t COMMAND_EXISTS   = 15;
       static const uint64_t COMMAND_RENAME   = 16;
       static const uint64_t COMMAND_DEBUG    = 17;
-      static const uint64_t COMMAND_MAX      = 18;
+      static const uint64_t COMMAND_SHM_ATTACH = 18;
+      static const uint64_t COMMAND_SHM_PREAD  = 19;
+      static const uint64_t COMMAND_SHM_APPEND = 20;
+      static const uint64_t COMMAND_MAX      = 21;
 
       static const uint16_t SHUTDOWN_FLAG_IMMEDIATE = 0x0001;
 
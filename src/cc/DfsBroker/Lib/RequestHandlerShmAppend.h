@@ -0,0 +1,56 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_REQUESTHANDLERSHMAPPEND_H
+#define HYPERTABLE_REQUESTHANDLERSHMAPPEND_H
+
+#include "AsyncComm/ApplicationHandler.h"
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/Event.h"
+
+#include "Broker.h"
+#include "SharedMemoryRegion.h"
+
+
+namespace Hypertable {
+
+  namespace DfsBroker {
+
+    class RequestHandlerShmAppend : public ApplicationHandler {
+    public:
+      RequestHandlerShmAppend(Comm *comm, Broker *broker,
+                              SharedMemoryRegion *region, EventPtr &event_ptr)
+        : ApplicationHandler(event_ptr), m_comm(comm), m_broker(broker),
+          m_region(region) { }
+
+      virtual void run();
+
+    private:
+      Comm                  *m_comm;
+      Broker                *m_broker;
+      SharedMemoryRegionPtr  m_region;
+    };
+
+  }
+
+}
+
+#endif // HYPERTABLE_REQUESTHANDLERSHMAPPEND_H
@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "RequestHandlerShmPread.h"
+#include "ResponseCallbackShmRead.h"
+
+using namespace Hypertable;
+using namespace DfsBroker;
+using namespace Serialization;
+
+/**
+ *
+ */
+void RequestHandlerShmPread::run() {
+  const uint8_t *decode_ptr = m_event_ptr->payload;
+  size_t decode_remain = m_event_ptr->payload_len;
+
+  try {
+    decode_str16(&decode_ptr, &decode_remain);  // region name
+    decode_i64(&decode_ptr, &decode_remain);    // region cookie
+    uint32_t slot_size = decode_i32(&decode_ptr, &decode_remain);
+    uint32_t slot = decode_i32(&decode_ptr, &decode_remain);
+    uint32_t fd = decode_i32(&decode_ptr, &decode_remain);
+    uint64_t offset = decode_i64(&decode_ptr, &decode_remain);
+    uint32_t amount = decode_i32(&decode_ptr, &decode_remain);
+
+    if (amount > slot_size)
+      HT_THROWF(Error::DFSBROKER_INVALID_ARGUMENT, "Read of %u bytes does "
+                "not fit into %u byte slot", (unsigned)amount,
+                (unsigned)slot_size);
+
+    ResponseCallbackShmRead cb(m_comm, m_event_ptr,
+        m_region->get_slot(slot_size, slot), slot_size);
+    m_broker->pread(&cb, fd, offset, amount);
+  }
+  catch (Exception &e) {
+    ResponseCallback cb(m_comm, m_event_ptr);
+    HT_ERROR_OUT << e << HT_END;
+    cb.error(e.code(), "Error handling SHM PREAD message");
+  }
+}
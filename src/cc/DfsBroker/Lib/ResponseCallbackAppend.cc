@@ -36,5 +36,5 @@ int ResponseCallbackAppend::response(uint64_t offset, uint32_t amount) {
   cbp->append_i32(Error::OK);
   cbp->append_i64(offset);
   cbp->append_i32(amount);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
@@ -35,5 +35,5 @@ int ResponseCallbackExists::response(bool exists) {
   CommBufPtr cbp( new CommBuf(header, 5) );
   cbp->append_i32(Error::OK);
   cbp->append_bool(exists);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
@@ -35,5 +35,5 @@ int ResponseCallbackLength::response(uint64_t offset) {
   CommBufPtr cbp( new CommBuf(header, 12) );
   cbp->append_i32(Error::OK);
   cbp->append_i64(offset);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
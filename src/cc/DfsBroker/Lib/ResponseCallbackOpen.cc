@@ -35,5 +35,5 @@ int ResponseCallbackOpen::response(int32_t fd) {
   CommBufPtr cbp( new CommBuf(header, 8) );
   cbp->append_i32(Error::OK);
   cbp->append_i32(fd);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
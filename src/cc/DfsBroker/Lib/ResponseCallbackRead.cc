@@ -36,5 +36,5 @@ int ResponseCallbackRead::response(uint64_t offset, StaticBuffer &buffer) {
   cbp->append_i32(Error::OK);
   cbp->append_i64(offset);
   cbp->append_i32(buffer.size);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
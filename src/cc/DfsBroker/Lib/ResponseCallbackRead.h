@@ -38,7 +38,9 @@ namespace Hypertable {
       ResponseCallbackRead(Comm *comm, EventPtr &event_ptr)
         : ResponseCallback(comm, event_ptr) { }
 
-      int response(uint64_t offset, StaticBuffer &buffer);
+      virtual ~ResponseCallbackRead() { }
+
+      virtual int response(uint64_t offset, StaticBuffer &buffer);
     };
   }
 
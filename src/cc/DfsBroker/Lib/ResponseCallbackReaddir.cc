@@ -42,5 +42,5 @@ int ResponseCallbackReaddir::response(std::vector<std::string> &listing) {
   cbp->append_i32(listing.size());
   for (size_t i=0; i<listing.size(); i++)
     cbp->append_str16(listing[i]);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
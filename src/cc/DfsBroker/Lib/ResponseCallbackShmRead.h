@@ -0,0 +1,53 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_RESPONSECALLBACKSHMREAD_H
+#define HYPERTABLE_RESPONSECALLBACKSHMREAD_H
+
+#include "ResponseCallbackRead.h"
+
+namespace Hypertable {
+
+  namespace DfsBroker {
+
+    /**
+     * Response callback of shm pread requests.  The data read goes into a
+     * slot of the client's shared memory region and the response carries
+     * only the offset and amount.
+     */
+    class ResponseCallbackShmRead : public ResponseCallbackRead {
+    public:
+      ResponseCallbackShmRead(Comm *comm, EventPtr &event_ptr, uint8_t *slot,
+                              uint32_t slot_size)
+        : ResponseCallbackRead(comm, event_ptr), m_slot(slot),
+          m_slot_size(slot_size) { }
+
+      virtual int response(uint64_t offset, StaticBuffer &buffer);
+
+    private:
+      uint8_t  *m_slot;
+      uint32_t  m_slot_size;
+    };
+  }
+
+}
+
+#endif // HYPERTABLE_RESPONSECALLBACKSHMREAD_H
@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/atomic.h"
+
+#include "SharedMemoryRegion.h"
+
+using namespace Hypertable;
+using namespace DfsBroker;
+
+namespace {
+
+  const char *SHM_DIR = "/dev/shm/";
+  const char *SHM_PREFIX = "hypertable-dfs.";
+
+  /** The header is the magic string followed by the cookie */
+  const char SHM_MAGIC[8] = { 'H', 'T', 'D', 'F', 'S', 'S', 'H', 'M' };
+  const size_t HEADER_SIZE = 64;
+
+  atomic_t next_region = ATOMIC_INIT(0);
+
+  uint64_t random_cookie() {
+    uint64_t cookie = 0;
+    int fd;
+    ssize_t nread = -1;
+
+    if ((fd = ::open("/dev/urandom", O_RDONLY)) >= 0) {
+      nread = ::read(fd, &cookie, sizeof(cookie));
+      ::close(fd);
+    }
+    if (nread != (ssize_t)sizeof(cookie))
+      HT_THROWF(Error::DFSBROKER_IO_ERROR, "Unable to read /dev/urandom - %s",
+                strerror(errno));
+    return cookie;
+  }
+
+}
+
+
+SharedMemoryRegion::SharedMemoryRegion(uint32_t slot_size,
+                                       uint32_t slot_count)
+  : m_cookie(random_cookie()), m_owner(true), m_base(0), m_size(0),
+    m_slot_size(slot_size) {
+  size_t size = HEADER_SIZE + (size_t)slot_size * slot_count;
+  int fd;
+
+  m_name = format("%s%d.%d", SHM_PREFIX, (int)getpid(),
+                  atomic_inc_return(&next_region));
+  String path = String(SHM_DIR) + m_name;
+
+  if ((fd = ::open(path.c_str(), O_RDWR|O_CREAT|O_EXCL, 0600)) < 0)
+    HT_THROWF(Error::DFSBROKER_IO_ERROR, "Unable to create %s - %s",
+              path.c_str(), strerror(errno));
+
+  if (ftruncate(fd, (off_t)size) < 0) {
+    int saved_errno = errno;
+    ::close(fd);
+    unlink(path.c_str());
+    HT_THROWF(Error::DFSBROKER_IO_ERROR, "Unable to size %s - %s",
+              path.c_str(), strerror(saved_errno));
+  }
+
+  try { map(fd, size); }
+  catch (...) {
+    unlink(path.c_str());
+    throw;
+  }
+
+  memcpy(m_base, SHM_MAGIC, sizeof(SHM_MAGIC));
+  memcpy(m_base + sizeof(SHM_MAGIC), &m_cookie, sizeof(m_cookie));
+
+  for (uint32_t i=slot_count; i>0; i--)
+    m_free_slots.push_back(i-1);
+}
+
+
+SharedMemoryRegion::SharedMemoryRegion(const String &name, uint64_t cookie)
+  : m_name(name), m_cookie(cookie), m_owner(false), m_base(0), m_size(0),
+    m_slot_size(0) {
+  struct stat statbuf;
+  uint8_t header[sizeof(SHM_MAGIC) + sizeof(cookie)];
+  int fd;
+
+  if (name.compare(0, strlen(SHM_PREFIX), SHM_PREFIX) != 0 ||
+      name.find('/') != String::npos)
+    HT_THROWF(Error::DFSBROKER_BAD_FILENAME, "Bad shared memory region "
+              "name '%s'", name.c_str());
+
+  String path = String(SHM_DIR) + m_name;
+
+  if ((fd = ::open(path.c_str(), O_RDWR|O_NOFOLLOW)) < 0)
+    HT_THROWF(Error::DFSBROKER_FILE_NOT_FOUND, "Unable to open %s - %s",
+              path.c_str(), strerror(errno));
+
+  if (fstat(fd, &statbuf) < 0) {
+    int saved_errno = errno;
+    ::close(fd);
+    HT_THROWF(Error::DFSBROKER_IO_ERROR, "Unable to stat %s - %s",
+              path.c_str(), strerror(saved_errno));
+  }
+
+  // check the cookie before mapping anything
+  if (!S_ISREG(statbuf.st_mode) || statbuf.st_size < (off_t)HEADER_SIZE ||
+      pread(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      memcmp(header, SHM_MAGIC, sizeof(SHM_MAGIC)) != 0 ||
+      memcmp(header + sizeof(SHM_MAGIC), &cookie, sizeof(cookie)) != 0) {
+    ::close(fd);
+    HT_THROWF(Error::DFSBROKER_INVALID_ARGUMENT, "Bad cookie for shared "
+              "memory region %s", path.c_str());
+  }
+
+  map(fd, statbuf.st_size);
+}
+
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+  if (m_base)
+    munmap(m_base, m_size);
+  if (m_owner)
+    unlink((String(SHM_DIR) + m_name).c_str());
+}
+
+
+uint8_t *SharedMemoryRegion::get_slot(uint32_t slot_size, uint32_t slot) {
+  if (slot_size == 0 ||
+      HEADER_SIZE + ((uint64_t)slot + 1) * slot_size > m_size)
+    HT_THROWF(Error::DFSBROKER_INVALID_ARGUMENT, "Slot %u of size %u is "
+              "outside of shared memory region %s", (unsigned)slot,
+              (unsigned)slot_size, m_name.c_str());
+  return m_base + HEADER_SIZE + (size_t)slot * slot_size;
+}
+
+
+bool SharedMemoryRegion::acquire_slot(uint32_t *slotp) {
+  ScopedLock lock(m_mutex);
+  if (m_free_slots.empty())
+    return false;
+  *slotp = m_free_slots.back();
+  m_free_slots.pop_back();
+  return true;
+}
+
+
+void SharedMemoryRegion::release_slot(uint32_t slot) {
+  ScopedLock lock(m_mutex);
+  m_free_slots.push_back(slot);
+}
+
+
+void SharedMemoryRegion::map(int fd, size_t size) {
+  void *base = MAP_FAILED;
+  int saved_errno = EINVAL;
+
+  if (size > 0 &&
+      (base = mmap(0, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0))
+      == MAP_FAILED)
+    saved_errno = errno;
+  ::close(fd);
+
+  if (base == MAP_FAILED)
+    HT_THROWF(Error::DFSBROKER_IO_ERROR, "Unable to map shared memory "
+              "region %s - %s", m_name.c_str(), strerror(saved_errno));
+
+  m_base = (uint8_t *)base;
+  m_size = size;
+}
@@ -0,0 +1,104 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_DFSBROKER_SHAREDMEMORYREGION_H
+#define HYPERTABLE_DFSBROKER_SHAREDMEMORYREGION_H
+
+#include <vector>
+
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  namespace DfsBroker {
+
+    /**
+     * Memory shared between a DfsBroker::Client and a broker on the same
+     * host, through which pread and append data is passed instead of the
+     * socket.  The client creates the region as a file in /dev/shm, divided
+     * into equally sized slots, and tells the broker the name of the file
+     * and the slot that holds the data of each request.  The broker maps
+     * the file the first time a connection names it.  The file starts with
+     * a header holding a random cookie, which every request carries and the
+     * broker checks before mapping, so a client can only have the broker
+     * map a region it knows the cookie of.
+     */
+    class SharedMemoryRegion : public ReferenceCount {
+    public:
+
+      /**
+       * Creates a region of slot_count slots of slot_size bytes.  The
+       * file is removed again when the region is destroyed.
+       */
+      SharedMemoryRegion(uint32_t slot_size, uint32_t slot_count);
+
+      /**
+       * Maps the region created under name by another process.  Only
+       * names of regions created by this class are accepted, and the
+       * cookie in the header of the file has to match cookie.
+       */
+      SharedMemoryRegion(const String &name, uint64_t cookie);
+
+      ~SharedMemoryRegion();
+
+      const String &get_name() const { return m_name; }
+
+      uint64_t get_cookie() const { return m_cookie; }
+
+      uint32_t get_slot_size() const { return m_slot_size; }
+
+      /**
+       * Returns the start of a slot, throwing DFSBROKER_INVALID_ARGUMENT
+       * if it lies outside of the region
+       */
+      uint8_t *get_slot(uint32_t slot_size, uint32_t slot);
+
+      uint8_t *get_slot(uint32_t slot) {
+        return get_slot(m_slot_size, slot);
+      }
+
+      /** Takes a free slot, returns false if there is none */
+      bool acquire_slot(uint32_t *slotp);
+
+      void release_slot(uint32_t slot);
+
+    private:
+      void map(int fd, size_t size);
+
+      String                m_name;
+      uint64_t              m_cookie;
+      bool                  m_owner;
+      uint8_t              *m_base;
+      size_t                m_size;
+      uint32_t              m_slot_size;
+      Mutex                 m_mutex;
+      std::vector<uint32_t> m_free_slots;
+    };
+
+    typedef intrusive_ptr<SharedMemoryRegion> SharedMemoryRegionPtr;
+
+  }
+
+}
+
+#endif // HYPERTABLE_DFSBROKER_SHAREDMEMORYREGION_H
@@ -0,0 +1,519 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+}
+
+#include "AsyncComm/ApplicationQueue.h"
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/ConnectionManager.h"
+#include "AsyncComm/DispatchHandlerSynchronizer.h"
+#include "AsyncComm/ReactorFactory.h"
+
+#include "DfsBroker/Lib/Broker.h"
+#include "DfsBroker/Lib/Client.h"
+#include "DfsBroker/Lib/ConnectionHandler.h"
+#include "DfsBroker/Lib/Protocol.h"
+#include "DfsBroker/Lib/SharedMemoryRegion.h"
+
+using namespace Hypertable;
+using namespace DfsBroker;
+using namespace Serialization;
+using namespace std;
+
+namespace {
+
+  const uint16_t BASE_PORT = 38131;
+  const uint32_t SLOT_SIZE = 256;
+  const int32_t FD = 3;
+
+  const uint64_t APPEND = DfsBroker::Protocol::COMMAND_APPEND;
+  const uint64_t PREAD = DfsBroker::Protocol::COMMAND_PREAD;
+  const uint64_t SHM_ATTACH = DfsBroker::Protocol::COMMAND_SHM_ATTACH;
+  const uint64_t SHM_APPEND = DfsBroker::Protocol::COMMAND_SHM_APPEND;
+  const uint64_t SHM_PREAD = DfsBroker::Protocol::COMMAND_SHM_PREAD;
+
+  /**
+   * Broker that keeps the data appended to each fd in memory.  Appends
+   * can be held back, to keep a request (and its shared memory slot)
+   * outstanding.
+   */
+  class MemoryBroker : public Broker {
+  public:
+    MemoryBroker() : m_hold(false), m_held(0), m_preads(0) { }
+
+    virtual void open(ResponseCallbackOpen *cb, const char *fname,
+                      uint32_t bufsz) { unsupported(cb); }
+    virtual void create(ResponseCallbackOpen *cb, const char *fname,
+                        bool overwrite, int32_t bufsz, int16_t replication,
+                        int64_t blksz) { unsupported(cb); }
+    virtual void close(ResponseCallback *cb, uint32_t fd) {
+      cb->response_ok();
+    }
+    virtual void read(ResponseCallbackRead *cb, uint32_t fd,
+                      uint32_t amount) { unsupported(cb); }
+
+    virtual void append(ResponseCallbackAppend *cb, uint32_t fd,
+                        uint32_t amount, const void *data, bool flush) {
+      uint64_t offset;
+      {
+        ScopedLock lock(m_mutex);
+        if (m_hold) {
+          m_held++;
+          while (m_hold)
+            m_cond.wait(lock);
+        }
+        vector<uint8_t> &contents = m_files[fd];
+        offset = contents.size();
+        contents.insert(contents.end(), (const uint8_t *)data,
+                        (const uint8_t *)data + amount);
+      }
+      cb->response(offset, amount);
+    }
+
+    virtual void seek(ResponseCallback *cb, uint32_t fd, uint64_t offset) {
+      unsupported(cb);
+    }
+    virtual void remove(ResponseCallback *cb, const char *fname) {
+      unsupported(cb);
+    }
+    virtual void length(ResponseCallbackLength *cb, const char *fname) {
+      unsupported(cb);
+    }
+
+    virtual void pread(ResponseCallbackRead *cb, uint32_t fd, uint64_t offset,
+                       uint32_t amount) {
+      StaticBuffer buf(amount);
+      {
+        ScopedLock lock(m_mutex);
+        vector<uint8_t> &contents = m_files[fd];
+        m_preads++;
+        if (offset + amount > contents.size()) {
+          cb->error(Error::DFSBROKER_EOF, "pread past end of file");
+          return;
+        }
+        memcpy(buf.base, &contents[offset], amount);
+      }
+      cb->response(offset, buf);
+    }
+
+    virtual void mkdirs(ResponseCallback *cb, const char *dname) {
+      unsupported(cb);
+    }
+    virtual void rmdir(ResponseCallback *cb, const char *dname) {
+      unsupported(cb);
+    }
+    virtual void readdir(ResponseCallbackReaddir *cb, const char *dname) {
+      unsupported(cb);
+    }
+    virtual void flush(ResponseCallback *cb, uint32_t fd) {
+      cb->response_ok();
+    }
+    virtual void status(ResponseCallback *cb) { cb->response_ok(); }
+    virtual void shutdown(ResponseCallback *cb) { cb->response_ok(); }
+    virtual void exists(ResponseCallbackExists *cb, const char *fname) {
+      unsupported(cb);
+    }
+    virtual void rename(ResponseCallback *cb, const char *src,
+                        const char *dst) { unsupported(cb); }
+    virtual void debug(ResponseCallback *cb, int32_t command,
+                       StaticBuffer &serialized_parameters) {
+      unsupported(cb);
+    }
+
+    /** Holds back appends until release() is called */
+    void hold() {
+      ScopedLock lock(m_mutex);
+      m_hold = true;
+    }
+
+    void release() {
+      ScopedLock lock(m_mutex);
+      m_hold = false;
+      m_cond.notify_all();
+    }
+
+    /** Waits until count appends are held back */
+    void wait_for_held(int count) {
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_held >= count)
+            return;
+        }
+        poll(0, 0, 1);
+      }
+    }
+
+    vector<uint8_t> contents(uint32_t fd) {
+      ScopedLock lock(m_mutex);
+      return m_files[fd];
+    }
+
+    void put(uint32_t fd, const vector<uint8_t> &contents) {
+      ScopedLock lock(m_mutex);
+      m_files[fd] = contents;
+    }
+
+    int preads() {
+      ScopedLock lock(m_mutex);
+      return m_preads;
+    }
+
+  private:
+    void unsupported(ResponseCallback *cb) {
+      cb->error(Error::DFSBROKER_INVALID_ARGUMENT, "not supported");
+    }
+
+    Mutex m_mutex;
+    boost::condition m_cond;
+    map<uint32_t, vector<uint8_t> > m_files;
+    bool m_hold;
+    int m_held;
+    int m_preads;
+  };
+
+  typedef intrusive_ptr<MemoryBroker> MemoryBrokerPtr;
+
+  /** Counts the requests the broker receives, by command */
+  class Recorder {
+  public:
+    void record(uint64_t command) {
+      ScopedLock lock(m_mutex);
+      m_counts[command]++;
+    }
+    int count(uint64_t command) {
+      ScopedLock lock(m_mutex);
+      return m_counts[command];
+    }
+  private:
+    Mutex m_mutex;
+    map<uint64_t, int> m_counts;
+  };
+
+  /** Returns a pointer to the cookie of a shm request */
+  uint8_t *shm_cookie(Event *event) {
+    const uint8_t *ptr = event->payload;
+    size_t remain = event->payload_len;
+    decode_str16(&ptr, &remain);
+    return (uint8_t *)ptr;
+  }
+
+  /**
+   * Records the requests of a connection before passing them on to the
+   * real connection handler.  Optionally spoils the cookie of shared memory
+   * attach requests.
+   */
+  class RecordingHandler : public DispatchHandler {
+  public:
+    RecordingHandler(DispatchHandler *handler, Recorder &recorder,
+                     bool spoil_cookie)
+      : m_handler(handler), m_recorder(recorder),
+        m_spoil_cookie(spoil_cookie) { }
+
+    virtual void handle(EventPtr &event) {
+      if (event->type == Event::MESSAGE) {
+        m_recorder.record(event->header.command);
+        if (m_spoil_cookie &&
+            event->header.command == SHM_ATTACH)
+          shm_cookie(event.get())[0] ^= 0xff;
+      }
+      m_handler->handle(event);
+    }
+
+  private:
+    DispatchHandlerPtr m_handler;
+    Recorder &m_recorder;
+    bool m_spoil_cookie;
+  };
+
+  class RecordingHandlerFactory : public Hypertable::ConnectionHandlerFactory {
+  public:
+    RecordingHandlerFactory(ApplicationQueuePtr &app_queue, BrokerPtr broker,
+                            Recorder &recorder, bool spoil_cookie)
+      : m_app_queue(app_queue), m_broker(broker), m_recorder(recorder),
+        m_spoil_cookie(spoil_cookie) { }
+
+    virtual void get_instance(DispatchHandlerPtr &dhp) {
+      dhp = new RecordingHandler(new DfsBroker::ConnectionHandler(
+          Comm::instance(), m_app_queue, m_broker), m_recorder,
+          m_spoil_cookie);
+    }
+
+  private:
+    ApplicationQueuePtr m_app_queue;
+    BrokerPtr m_broker;
+    Recorder &m_recorder;
+    bool m_spoil_cookie;
+  };
+
+  /**
+   * A broker listening on localhost:port, and a client of it passing data
+   * through the given number of shared memory slots
+   */
+  struct Setup {
+    Setup(ConnectionManagerPtr &conn_mgr, uint16_t port, uint32_t slots,
+          bool spoil_cookie=false) {
+      app_queue = new ApplicationQueue(4);
+      broker = new MemoryBroker();
+      ConnectionHandlerFactoryPtr chf = new RecordingHandlerFactory(
+          app_queue, broker.get(), recorder, spoil_cookie);
+      InetAddr listen_addr(INADDR_ANY, port);
+      Comm::instance()->listen(listen_addr, chf);
+      InetAddr::initialize(&addr, "localhost", port);
+
+      Config::properties->set("DfsBroker.SharedMemory.Slots", (int32_t)slots);
+      Config::properties->set("DfsBroker.SharedMemory.SlotSize",
+                                  (int32_t)SLOT_SIZE);
+      client = new DfsBroker::Client(conn_mgr, addr, 15000);
+      HT_ASSERT(client->wait_for_connection(15000));
+    }
+
+    struct sockaddr_in addr;
+    ApplicationQueuePtr app_queue;
+    MemoryBrokerPtr broker;
+    Recorder recorder;
+    DfsBroker::ClientPtr client;
+  };
+
+  vector<uint8_t> make_data(size_t len, uint8_t seed) {
+    vector<uint8_t> data(len);
+    for (size_t i=0; i<len; i++)
+      data[i] = (uint8_t)(seed + i * 7);
+    return data;
+  }
+
+  void append(DfsBroker::Client *client, const vector<uint8_t> &data,
+              DispatchHandler *handler=0) {
+    StaticBuffer buf(data.size());
+    memcpy(buf.base, &data[0], data.size());
+    if (handler)
+      client->append(FD, buf, 0, handler);
+    else
+      HT_ASSERT(client->append(FD, buf) == data.size());
+  }
+
+  /**
+   * A client on the same host attaches its region once and then passes
+   * appends and preads that fit into a slot through it
+   */
+  void test_local_attach(ConnectionManagerPtr &conn_mgr) {
+    Setup setup(conn_mgr, BASE_PORT, 2);
+    vector<uint8_t> data = make_data(SLOT_SIZE, 1);
+    vector<uint8_t> more = make_data(100, 2);
+    uint8_t buf[SLOT_SIZE];
+
+    append(setup.client.get(), data);
+    append(setup.client.get(), more);
+    HT_ASSERT(setup.recorder.count(SHM_ATTACH) == 1);
+    HT_ASSERT(setup.recorder.count(SHM_APPEND) == 2);
+    HT_ASSERT(setup.recorder.count(APPEND) == 0);
+
+    data.insert(data.end(), more.begin(), more.end());
+    HT_ASSERT(setup.broker->contents(FD) == data);
+
+    HT_ASSERT(setup.client->pread(FD, buf, SLOT_SIZE, 50) == SLOT_SIZE);
+    HT_ASSERT(memcmp(buf, &data[50], SLOT_SIZE) == 0);
+    HT_ASSERT(setup.recorder.count(SHM_PREAD) == 1);
+    HT_ASSERT(setup.recorder.count(PREAD) == 0);
+  }
+
+  /**
+   * Transfers larger than a slot, and transfers made while every slot is
+   * taken by an outstanding request, go over the socket
+   */
+  void test_fallback(ConnectionManagerPtr &conn_mgr) {
+    Setup setup(conn_mgr, BASE_PORT + 1, 1);
+    vector<uint8_t> large = make_data(SLOT_SIZE + 1, 3);
+    vector<uint8_t> first = make_data(10, 4);
+    vector<uint8_t> second = make_data(20, 5);
+    uint8_t buf[2 * SLOT_SIZE];
+
+    append(setup.client.get(), large);
+    HT_ASSERT(setup.recorder.count(APPEND) == 1);
+    HT_ASSERT(setup.recorder.count(SHM_APPEND) == 0);
+
+    // the held back append keeps the only slot
+    DispatchHandlerSynchronizer sync_handler;
+    EventPtr event;
+    setup.broker->hold();
+    append(setup.client.get(), first, &sync_handler);
+    setup.broker->wait_for_held(1);
+    append(setup.client.get(), second, &sync_handler);
+    setup.broker->release();
+    HT_ASSERT(sync_handler.wait_for_reply(event));
+    HT_ASSERT(sync_handler.wait_for_reply(event));
+    HT_ASSERT(setup.recorder.count(SHM_APPEND) == 1);
+    HT_ASSERT(setup.recorder.count(APPEND) == 2);
+
+    vector<uint8_t> expected = large;
+    expected.insert(expected.end(), first.begin(), first.end());
+    expected.insert(expected.end(), second.begin(), second.end());
+    HT_ASSERT(setup.broker->contents(FD) == expected);
+
+    // the slot is free again
+    append(setup.client.get(), first);
+    HT_ASSERT(setup.recorder.count(SHM_APPEND) == 2);
+
+    HT_ASSERT(setup.client->pread(FD, buf, SLOT_SIZE + 1, 0) == SLOT_SIZE + 1);
+    HT_ASSERT(memcmp(buf, &large[0], SLOT_SIZE + 1) == 0);
+    HT_ASSERT(setup.recorder.count(PREAD) == 1);
+    HT_ASSERT(setup.recorder.count(SHM_PREAD) == 0);
+  }
+
+  /**
+   * When the broker rejects the attach (here because the cookie does not
+   * match), the client passes everything over the socket
+   */
+  void test_rejected_attach(ConnectionManagerPtr &conn_mgr) {
+    Setup setup(conn_mgr, BASE_PORT + 2, 2, true);
+    vector<uint8_t> data = make_data(100, 6);
+    uint8_t buf[100];
+
+    append(setup.client.get(), data);
+    append(setup.client.get(), data);
+    HT_ASSERT(setup.recorder.count(SHM_ATTACH) == 1);
+    HT_ASSERT(setup.recorder.count(SHM_APPEND) == 0);
+    HT_ASSERT(setup.recorder.count(APPEND) == 2);
+
+    HT_ASSERT(setup.client->pread(FD, buf, 100, 100) == 100);
+    HT_ASSERT(memcmp(buf, &data[0], 100) == 0);
+    HT_ASSERT(setup.recorder.count(SHM_PREAD) == 0);
+  }
+
+  /**
+   * Returns a shm pread request for the whole of slot of the region called
+   * name, as if it had been received from host
+   */
+  EventPtr shm_pread_event(const String &name, uint64_t cookie, uint32_t slot,
+                           const char *host) {
+    CommBufPtr cbp(DfsBroker::Protocol::create_shm_position_read_request(
+        name, cookie, SLOT_SIZE, slot, FD, 0, SLOT_SIZE));
+    CommBuf::SegmentVector segments;
+    size_t len = 0;
+
+    cbp->get_payload_segments(segments);
+    foreach(const CommBuf::Segment &segment, segments)
+      len += segment.len;
+
+    Event *event = new Event(Event::MESSAGE);
+    uint8_t *payload = new uint8_t [len];
+    event->header = cbp->header;
+    event->payload = payload;
+    event->payload_len = len;
+    foreach(const CommBuf::Segment &segment, segments) {
+      memcpy(payload, segment.base, segment.len);
+      payload += segment.len;
+    }
+    InetAddr::initialize(&event->addr, host, BASE_PORT + 3);
+    return event;
+  }
+
+  /**
+   * The broker only fills slots of a region for clients on its own host
+   * that know the cookie of the region.  Requests are handed to the
+   * connection handler directly, so they can claim to come from anywhere;
+   * their responses go nowhere.
+   */
+  void test_broker_checks() {
+    ApplicationQueuePtr app_queue = new ApplicationQueue(1);
+    MemoryBrokerPtr broker = new MemoryBroker();
+    BrokerPtr broker_ptr = broker.get();
+    DispatchHandlerPtr handler =
+        new DfsBroker::ConnectionHandler(Comm::instance(), app_queue,
+                                         broker_ptr);
+    SharedMemoryRegionPtr region = new SharedMemoryRegion(SLOT_SIZE, 2);
+    const String &name = region->get_name();
+    uint64_t cookie = region->get_cookie();
+    vector<uint8_t> data = make_data(SLOT_SIZE, 7);
+    uint8_t *slot = region->get_slot(1);
+    EventPtr event;
+
+    broker->put(FD, data);
+    memset(slot, 0, SLOT_SIZE);
+
+    // a remote client
+    event = shm_pread_event(name, cookie, 1, "192.0.2.1");
+    handler->handle(event);
+
+    // a wrong cookie
+    event = shm_pread_event(name, cookie + 1, 1, "127.0.0.1");
+    handler->handle(event);
+
+    // a name that is not a region
+    event = shm_pread_event("../" + name, cookie, 1, "127.0.0.1");
+    handler->handle(event);
+
+    // a slot past the end of the region
+    event = shm_pread_event(name, cookie, 2, "127.0.0.1");
+    handler->handle(event);
+
+    app_queue->shutdown();
+    app_queue->join();
+    HT_ASSERT(broker->preads() == 0);
+
+    // a local client with the right cookie
+    app_queue = new ApplicationQueue(1);
+    handler = new DfsBroker::ConnectionHandler(Comm::instance(), app_queue,
+                                               broker_ptr);
+    event = shm_pread_event(name, cookie, 1, "127.0.0.1");
+    handler->handle(event);
+
+    app_queue->shutdown();
+    app_queue->join();
+    HT_ASSERT(broker->preads() == 1);
+    HT_ASSERT(memcmp(slot, &data[0], SLOT_SIZE) == 0);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    Config::init(argc, argv);
+    ReactorFactory::initialize(2);
+
+    ConnectionManagerPtr conn_mgr = new ConnectionManager();
+
+    test_local_attach(conn_mgr);
+    test_fallback(conn_mgr);
+    test_rejected_attach(conn_mgr);
+    test_broker_checks();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
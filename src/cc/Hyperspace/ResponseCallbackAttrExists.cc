@@ -41,6 +41,6 @@ int ResponseCallbackAttrExists::response(bool exists) {
   cbp->append_i32(Error::OK);
   cbp->append_byte((uint8_t)exists);
 
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
@@ -38,6 +38,6 @@ int ResponseCallbackAttrGet::response(StaticBuffer &buffer) {
   CommBufPtr cbp(new CommBuf(header, 8, buffer));
   cbp->append_i32(Error::OK);
   cbp->append_i32(buffer.size);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
@@ -52,6 +52,6 @@ int ResponseCallbackAttrList::response(const vector<string> &anames) {
     cbp->append_vstr(*it);
   }
 
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
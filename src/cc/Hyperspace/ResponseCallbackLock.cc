@@ -39,6 +39,6 @@ int ResponseCallbackLock::response(uint32_t status, uint64_t lock_generation) {
   cbp->append_i32(Error::OK);
   cbp->append_i32(status);
   cbp->append_i64(lock_generation);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
@@ -39,5 +39,5 @@ ResponseCallbackOpen::response(uint64_t handle, bool created,
   cbp->append_i64(handle);
   cbp->append_byte((uint8_t)created);
   cbp->append_i64(lock_generation);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
@@ -49,6 +49,6 @@ int ResponseCallbackReaddir::response(std::vector<DirEntry> &listing) {
   for (size_t i=0; i<listing.size(); i++)
     encode_dir_entry(cbp->get_data_ptr_address(), listing[i]);
 
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
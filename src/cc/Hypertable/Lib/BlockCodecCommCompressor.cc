@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include "Common/Checksum.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "BlockCodecCommCompressor.h"
+#include "CompressorFactory.h"
+
+using namespace Hypertable;
+
+namespace {
+  const char PAYLOAD_MAGIC[10] = { 'C','o','m','m','P','a','y','l','d','-' };
+}
+
+
+BlockCodecCommCompressor::BlockCodecCommCompressor(
+    BlockCompressionCodec::Type type, const BlockCompressionCodec::Args &args)
+  : m_type(type), m_args(args) {
+}
+
+
+BlockCodecCommCompressor::~BlockCodecCommCompressor() {
+  for (size_t i=0; i<BlockCompressionCodec::COMPRESSION_TYPE_LIMIT; i++)
+    foreach(BlockCompressionCodec *codec, m_idle[i])
+      delete codec;
+}
+
+
+bool BlockCodecCommCompressor::compress(const DynamicBuffer &input,
+                                        DynamicBuffer &output) {
+  BlockCompressionHeader header(PAYLOAD_MAGIC);
+  BlockCompressionCodec *codec;
+
+  if (m_type == BlockCompressionCodec::NONE)
+    return false;
+
+  // the data checksum only guards the decompressor against garbage
+  header.set_data_checksum_type(CHECKSUM_CRC32C);
+
+  codec = checkout(m_type);
+  try {
+    codec->deflate(input, output, header);
+  }
+  catch (...) {
+    checkin(codec);
+    throw;
+  }
+  checkin(codec);
+
+  return header.get_compression_type() != BlockCompressionCodec::NONE;
+}
+
+
+void BlockCodecCommCompressor::decompress(const uint8_t *data, size_t len,
+                                          DynamicBuffer &output) {
+  BlockCompressionHeader header;
+  BlockCompressionCodec *codec;
+  DynamicBuffer input(0, false);
+  const uint8_t *ptr = data;
+  size_t remaining = len;
+
+  header.decode(&ptr, &remaining);
+  if (!header.check_magic(PAYLOAD_MAGIC))
+    HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC, "compressed payload");
+
+  input.base = (uint8_t *)data;
+  input.ptr = input.base + len;
+
+  codec = checkout(header.get_compression_type());
+  try {
+    codec->inflate(input, output, header);
+  }
+  catch (...) {
+    checkin(codec);
+    throw;
+  }
+  checkin(codec);
+}
+
+
+void BlockCodecCommCompressor::install(Comm *comm, PropertiesPtr &props) {
+  BlockCompressionCodec::Args args;
+  String spec = props->get_str("Comm.Compression");
+  BlockCompressionCodec::Type type =
+      CompressorFactory::parse_block_codec_spec(spec, args);
+
+  if (type == BlockCompressionCodec::UNKNOWN)
+    HT_THROWF(Error::CONFIG_BAD_VALUE, "Comm.Compression: %s", spec.c_str());
+
+  CommCompressorPtr compressor = new BlockCodecCommCompressor(type, args);
+  comm->set_compressor(compressor,
+                       props->get_i32("Comm.Compression.MinSize"),
+                       type != BlockCompressionCodec::NONE);
+}
+
+
+BlockCompressionCodec *BlockCodecCommCompressor::checkout(int type) {
+  if (type < 0 || type >= BlockCompressionCodec::COMPRESSION_TYPE_LIMIT)
+    HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE,
+              "compressed payload type %d", type);
+
+  {
+    ScopedLock lock(m_mutex);
+    if (!m_idle[type].empty()) {
+      BlockCompressionCodec *codec = m_idle[type].back();
+      m_idle[type].pop_back();
+      return codec;
+    }
+  }
+
+  // only the codec we send with is configured
+  return CompressorFactory::create_block_codec(
+      (BlockCompressionCodec::Type)type, type == m_type
+      ? m_args : BlockCompressionCodec::Args());
+}
+
+
+void BlockCodecCommCompressor::checkin(BlockCompressionCodec *codec) {
+  ScopedLock lock(m_mutex);
+  m_idle[codec->get_type()].push_back(codec);
+}
@@ -0,0 +1,79 @@
+/** -*- C++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BLOCKCODECCOMMCOMPRESSOR_H
+#define HYPERTABLE_BLOCKCODECCOMMCOMPRESSOR_H
+
+#include <vector>
+
+#include "Common/Mutex.h"
+#include "Common/Properties.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/CommCompressor.h"
+
+#include "BlockCompressionCodec.h"
+
+namespace Hypertable {
+
+  /**
+   * Compresses message payloads with one of the block compression codecs.
+   * A compressed payload is a block with a BlockCompressionHeader, so it
+   * can be inflated whichever codec the sender was configured with.  Idle
+   * codec instances are kept per type and handed out to one caller at a
+   * time.
+   */
+  class BlockCodecCommCompressor : public CommCompressor {
+  public:
+    /**
+     * @param type codec used by compress()
+     * @param args codec arguments
+     */
+    BlockCodecCommCompressor(BlockCompressionCodec::Type type,
+                             const BlockCompressionCodec::Args &args);
+    virtual ~BlockCodecCommCompressor();
+
+    virtual bool compress(const DynamicBuffer &input, DynamicBuffer &output);
+    virtual void decompress(const uint8_t *data, size_t len,
+                            DynamicBuffer &output);
+
+    /**
+     * Installs a compressor in comm as configured by the Comm.Compression
+     * properties.  Payloads are only compressed if Comm.Compression names
+     * a codec, but compressed payloads are always accepted.
+     */
+    static void install(Comm *comm, PropertiesPtr &props);
+
+  private:
+    typedef std::vector<BlockCompressionCodec *> CodecVector;
+
+    BlockCompressionCodec *checkout(int type);
+    void checkin(BlockCompressionCodec *codec);
+
+    Mutex m_mutex;
+    BlockCompressionCodec::Type m_type;
+    BlockCompressionCodec::Args m_args;
+    CodecVector m_idle[BlockCompressionCodec::COMPRESSION_TYPE_LIMIT];
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_BLOCKCODECCOMMCOMPRESSOR_H
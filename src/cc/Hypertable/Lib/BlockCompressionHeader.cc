@@ -33,6 +33,8 @@ using namespace Hypertable;
 using namespace Serialization;
 
 const size_t BlockCompressionHeader::LENGTH;
+const uint8_t BlockCompressionHeader::CRC32C_BIT;
+int BlockCompressionHeader::ms_default_data_checksum_type = CHECKSUM_FLETCHER32;
 
 
 /**
@@ -42,7 +44,8 @@ void BlockCompressionHeader::encode(uint8_t **bufp) {
   memcpy(*bufp, m_magic, 10);
   (*bufp) += 10;
   *(*bufp)++ = (uint8_t)length();
-  *(*bufp)++ = (uint8_t)m_compression_type;
+  *(*bufp)++ = (uint8_t)m_compression_type
+      | (m_data_checksum_type == CHECKSUM_CRC32C ? CRC32C_BIT : 0);
   encode_i32(bufp, m_data_checksum);
   encode_i32(bufp, m_data_length);
   encode_i32(bufp, m_data_zlength);
@@ -88,6 +91,12 @@ void BlockCompressionHeader::decode(const uint8_t **bufp, size_t *remainp) {
               ": %lu, expecting: %lu", (Lu)header_length, (Lu)length());
 
   m_compression_type = decode_byte(bufp, remainp);
+  if (m_compression_type & CRC32C_BIT) {
+    m_compression_type &= ~CRC32C_BIT;
+    m_data_checksum_type = CHECKSUM_CRC32C;
+  }
+  else
+    m_data_checksum_type = CHECKSUM_FLETCHER32;
 
   if (m_compression_type >= BlockCompressionCodec::COMPRESSION_TYPE_LIMIT)
     HT_THROWF(Error::BLOCK_COMPRESSOR_BAD_HEADER, "Bad compression type: %d",
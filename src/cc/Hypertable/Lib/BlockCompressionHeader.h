@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_BLOCKCOMPRESSIONHEADER_H
 #define HYPERTABLE_BLOCKCOMPRESSIONHEADER_H
 
+#include "Common/Checksum.h"
+
 namespace Hypertable {
 
   /**
@@ -32,12 +34,19 @@ namespace Hypertable {
 
     static const size_t LENGTH = 26;
 
+    /** Set in the encoded compression type if the data checksum is crc32c */
+    static const uint8_t CRC32C_BIT = 0x80;
+
     BlockCompressionHeader() : m_data_length(0), m_data_zlength(0),
-        m_data_checksum(0), m_compression_type((uint16_t)-1) { }
+        m_data_checksum(0), m_compression_type((uint16_t)-1),
+        m_data_checksum_type(ms_default_data_checksum_type) { }
 
     BlockCompressionHeader(const char *magic)
       : m_data_length(0), m_data_zlength(0), m_data_checksum(0),
-        m_compression_type((uint16_t)-1) { memcpy(m_magic, magic, 10); }
+        m_compression_type((uint16_t)-1),
+        m_data_checksum_type(ms_default_data_checksum_type) {
+      memcpy(m_magic, magic, 10);
+    }
 
     virtual ~BlockCompressionHeader() { return; }
 
@@ -58,6 +67,28 @@ namespace Hypertable {
     void     set_compression_type(uint16_t type) { m_compression_type = type; }
     uint16_t get_compression_type() { return m_compression_type; }
 
+    /**
+     * Algorithm of the data checksum (see ChecksumType).  Headers are
+     * created with the default algorithm; decode() picks up the one the
+     * block was written with.
+     */
+    void set_data_checksum_type(int type) { m_data_checksum_type = type; }
+    int  get_data_checksum_type() { return m_data_checksum_type; }
+
+    /** Computes the checksum of data with the data checksum algorithm */
+    uint32_t compute_data_checksum(const void *data, size_t len) {
+      return checksum(m_data_checksum_type, data, len);
+    }
+
+    /**
+     * Sets the data checksum algorithm of newly created headers.  Blocks
+     * written with fletcher32, the default, can be read by all versions;
+     * crc32c is much faster but older versions reject such blocks.
+     */
+    static void set_default_data_checksum_type(int type) {
+      ms_default_data_checksum_type = type;
+    }
+
     virtual size_t length() { return LENGTH; }
     virtual void   encode(uint8_t **bufp);
     virtual void   write_header_checksum(uint8_t *base, uint8_t **bufp);
@@ -69,6 +100,9 @@ namespace Hypertable {
     uint32_t m_data_zlength;
     uint32_t m_data_checksum;
     uint16_t m_compression_type;
+    int m_data_checksum_type;
+
+    static int ms_default_data_checksum_type;
   };
 
 }
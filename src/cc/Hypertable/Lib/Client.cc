@@ -40,6 +40,7 @@ extern "C" {
 #include "Hyperspace/DirEntry.h"
 #include "Hypertable/Lib/Config.h"
 
+#include "BlockCodecCommCompressor.h"
 #include "Client.h"
 #include "HqlCommandInterpreter.h"
 
@@ -289,6 +290,7 @@ void Client::initialize() {
   uint32_t wait_time, remaining;
 
   m_comm = Comm::instance();
+  BlockCodecCommCompressor::install(m_comm, m_props);
   m_conn_manager = new ConnectionManager(m_comm);
 
   if (m_timeout_ms == 0)
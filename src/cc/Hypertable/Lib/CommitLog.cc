@@ -29,6 +29,7 @@
 #include "Common/Logger.h"
 #include "Common/StringExt.h"
 #include "Common/Config.h"
+#include "Common/Time.h"
 
 #include "AsyncComm/Protocol.h"
 
@@ -54,6 +55,34 @@ namespace {
       return x.num < y.num;
     }
   };
+
+  /**
+   * Blocks the caller until a pipelined write has been acknowledged.
+   */
+  class SyncCommitCallback : public CommitLogCallback {
+  public:
+    SyncCommitCallback() : m_done(false), m_error(Error::OK) { }
+
+    virtual void committed(int error) {
+      ScopedLock lock(m_mutex);
+      m_error = error;
+      m_done = true;
+      m_cond.notify_all();
+    }
+
+    int wait() {
+      ScopedLock lock(m_mutex);
+      while (!m_done)
+        m_cond.wait(lock);
+      return m_error;
+    }
+
+  private:
+    Mutex            m_mutex;
+    boost::condition m_cond;
+    bool             m_done;
+    int              m_error;
+  };
 }
 
 
@@ -63,28 +92,46 @@ CommitLog::CommitLog(Filesystem *fs, const String &log_dir)
 }
 
 CommitLog::~CommitLog() {
-  delete m_compressor;
   close();
+  foreach (BlockCompressionCodec *codec, m_codec_pool)
+    delete codec;
 }
 
 void
 CommitLog::initialize(Filesystem *fs, const String &log_dir,
                       PropertiesPtr &props, CommitLogBase *init_log) {
-  String compressor;
 
   m_fs = fs;
   m_log_dir = log_dir;
   m_cur_fragment_length = 0;
   m_cur_fragment_num = 0;
   m_needs_roll = false;
+  m_pending_bytes = 0;
+  m_pending_sync = false;
+  m_leader_active = false;
+  m_next_ticket = 0;
+  m_committed_ticket = 0;
+  m_turn_ticket = 0;
+  memset(&m_group_stats, 0, sizeof(m_group_stats));
+  m_write_queue_bytes = 0;
+  m_append_error = Error::OK;
+  m_writer_busy = false;
+  m_writer_shutdown = false;
+  m_writer_thread = 0;
 
   SubProperties cfg(props, "Hypertable.CommitLog.");
 
   HT_TRY("getting commit log properites",
     m_max_fragment_size = cfg.get_i64("RollLimit");
-    compressor = cfg.get_str("Compressor"));
+    m_compressor_name = cfg.get_str("Compressor");
+    m_group_commit = cfg.get_bool("GroupCommit", true);
+    m_group_max_bytes = cfg.get_i32("GroupCommit.MaxBatchBytes", 4*1024*1024);
+    m_group_max_wait = cfg.get_i32("GroupCommit.MaxWaitMicros", 0);
+    m_pipelined = cfg.get_bool("Pipelined", false);
+    m_write_queue_max = cfg.get_i32("Pipelined.MaxQueueBytes", 16*1024*1024));
 
-  m_compressor = CompressorFactory::create_block_codec(compressor);
+  // fail early on a bad compressor name
+  checkin_codec(checkout_codec());
 
   FileUtils::add_trailing_slash(m_log_dir);
 
@@ -118,6 +165,11 @@ CommitLog::initialize(Filesystem *fs, const String &log_dir,
     m_fd = -1;
     throw;
   }
+
+  if (m_pipelined) {
+    m_append_handler = new AppendHandler(this);
+    m_writer_thread = new Thread(WriterThread(this));
+  }
 }
 
 
@@ -151,7 +203,8 @@ int CommitLog::write(DynamicBuffer &buffer, int64_t revision, bool sync) {
   int error;
   BlockCompressionHeaderCommitLog header(MAGIC_DATA, revision);
 
-  if (m_needs_roll) {
+  // the writer thread takes care of rolling in pipelined mode
+  if (m_needs_roll && !m_pipelined) {
     ScopedLock lock(m_mutex);
     if ((error = roll()) != Error::OK)
       return error;
@@ -166,7 +219,7 @@ int CommitLog::write(DynamicBuffer &buffer, int64_t revision, bool sync) {
   /**
    * Roll the log
    */
-  if (m_cur_fragment_length > m_max_fragment_size) {
+  if (!m_pipelined && m_cur_fragment_length > m_max_fragment_size) {
     ScopedLock lock(m_mutex);
     roll();
   }
@@ -175,6 +228,202 @@ int CommitLog::write(DynamicBuffer &buffer, int64_t revision, bool sync) {
 }
 
 
+void
+CommitLog::write_async(DynamicBuffer &buffer, int64_t revision, bool sync,
+                       CommitLogCallback *cb) {
+  BlockCompressionHeaderCommitLog header(MAGIC_DATA, revision);
+
+  if (!m_pipelined) {
+    cb->committed(write(buffer, revision, sync));
+    return;
+  }
+
+  DynamicBufferPtr zblock = new DynamicBuffer();
+  BlockCompressionCodec *codec = checkout_codec();
+  try {
+    codec->deflate(buffer, *zblock, header);
+  }
+  catch (Exception &e) {
+    checkin_codec(codec);
+    HT_ERRORF("Problem compressing commit log block: %s", e.what());
+    cb->committed(e.code());
+    return;
+  }
+  checkin_codec(codec);
+
+  submit(zblock, revision, sync, cb);
+}
+
+
+uint64_t
+CommitLog::enqueue(DynamicBuffer &buffer, int64_t revision, bool sync) {
+  ScopedLock lock(m_group_mutex);
+
+  m_pending.push_back(PendingCommit(&buffer, revision));
+  m_pending_bytes += buffer.fill();
+  if (sync)
+    m_pending_sync = true;
+
+  // wake up a leader that is waiting for the batch to fill
+  if (m_leader_active && m_pending_bytes >= m_group_max_bytes)
+    m_group_cond.notify_all();
+
+  return m_next_ticket++;
+}
+
+
+/**
+ * Completion callback for a group commit batch written in pipelined mode.
+ */
+class CommitLog::GroupCommitCallback : public CommitLogCallback {
+public:
+  GroupCommitCallback(CommitLog *log, uint64_t batch_begin,
+                      uint64_t batch_end, size_t bytes, bool sync,
+                      HiResTime &start_time)
+    : m_log(log), m_batch_begin(batch_begin), m_batch_end(batch_end),
+      m_bytes(bytes), m_sync(sync), m_start_time(start_time) { }
+
+  virtual void committed(int error) {
+    {
+      ScopedLock lock(m_log->m_group_mutex);
+      m_log->finish_batch(m_batch_begin, m_batch_end, m_bytes, m_sync,
+                          m_start_time, error);
+    }
+    delete this;
+  }
+
+private:
+  CommitLog *m_log;
+  uint64_t   m_batch_begin;
+  uint64_t   m_batch_end;
+  size_t     m_bytes;
+  bool       m_sync;
+  HiResTime  m_start_time;
+};
+
+
+int CommitLog::wait_for_commit(uint64_t ticket) {
+  ScopedLock lock(m_group_mutex);
+  PendingCommitVector batch;
+  bool sync;
+  int error;
+
+  while (ticket >= m_committed_ticket) {
+
+    // Someone else is writing, or (pipelined mode) our block is in flight
+    if (m_leader_active || m_pending.empty()) {
+      m_group_cond.wait(lock);
+      continue;
+    }
+
+    m_leader_active = true;
+
+    // Optionally give concurrent writers a chance to join the batch
+    if (m_group_max_wait && m_pending_bytes < m_group_max_bytes) {
+      boost::xtime deadline;
+      boost::xtime_get(&deadline, boost::TIME_UTC);
+      deadline.nsec += (int64_t)m_group_max_wait * 1000LL;
+      if (deadline.nsec >= 1000000000LL) {
+        deadline.sec += deadline.nsec / 1000000000LL;
+        deadline.nsec %= 1000000000LL;
+      }
+      while (m_pending_bytes < m_group_max_bytes)
+        if (!m_group_cond.timed_wait(lock, deadline))
+          break;
+    }
+
+    uint64_t batch_end = m_next_ticket;
+    uint64_t batch_begin = batch_end - m_pending.size();
+    batch.clear();
+    batch.swap(m_pending);
+    sync = m_pending_sync;
+    size_t batch_bytes = m_pending_bytes;
+    m_pending_bytes = 0;
+    m_pending_sync = false;
+
+    HiResTime start_time;
+
+    lock.unlock();
+
+    if (m_pipelined) {
+      // Hand the batch to the writer thread and give up leadership so the
+      // next batch can be compressed while this one is in flight.
+      // Completion (or failure) is recorded by GroupCommitCallback.
+      write_batch(batch, sync, new GroupCommitCallback(this, batch_begin,
+                  batch_end, batch_bytes, sync, start_time));
+      lock.lock();
+      m_leader_active = false;
+      m_group_cond.notify_all();
+      continue;
+    }
+
+    error = write_batch(batch, sync, 0);
+    lock.lock();
+
+    finish_batch(batch_begin, batch_end, batch_bytes, sync, start_time, error);
+    m_leader_active = false;
+  }
+
+  if (!m_failed_tickets.empty()) {
+    std::map<uint64_t, int>::iterator iter = m_failed_tickets.find(ticket);
+    if (iter != m_failed_tickets.end()) {
+      error = iter->second;
+      m_failed_tickets.erase(iter);
+      return error;
+    }
+  }
+
+  return Error::OK;
+}
+
+
+void CommitLog::wait_for_turn(uint64_t ticket) {
+  ScopedLock lock(m_group_mutex);
+  while (m_turn_ticket != ticket)
+    m_turn_cond.wait(lock);
+}
+
+
+void CommitLog::end_turn(uint64_t ticket) {
+  ScopedLock lock(m_group_mutex);
+  HT_ASSERT(m_turn_ticket == ticket);
+  m_turn_ticket++;
+  m_turn_cond.notify_all();
+}
+
+
+void
+CommitLog::finish_batch(uint64_t batch_begin, uint64_t batch_end,
+                        size_t bytes, bool sync, HiResTime &start_time,
+                        int error) {
+  HiResTime end_time;
+
+  if (error != Error::OK) {
+    for (uint64_t i = batch_begin; i < batch_end; i++)
+      m_failed_tickets[i] = error;
+  }
+
+  uint64_t latency = ((int64_t)end_time.sec - (int64_t)start_time.sec)
+      * 1000000LL + ((int64_t)end_time.nsec - (int64_t)start_time.nsec) / 1000LL;
+  uint32_t blocks = batch_end - batch_begin;
+  m_group_stats.batches++;
+  m_group_stats.blocks += blocks;
+  m_group_stats.bytes += bytes;
+  if (sync)
+    m_group_stats.syncs++;
+  if (blocks > m_group_stats.max_batch_blocks)
+    m_group_stats.max_batch_blocks = blocks;
+  m_group_stats.total_latency_us += latency;
+  if (latency > m_group_stats.max_latency_us)
+    m_group_stats.max_latency_us = latency;
+
+  // batches complete in order, since appends to a file are serialized
+  if (batch_end > m_committed_ticket)
+    m_committed_ticket = batch_end;
+  m_group_cond.notify_all();
+}
+
+
 int CommitLog::link_log(CommitLogBase *log_base) {
   int error;
   int64_t link_revision = log_base->get_latest_revision();
@@ -183,6 +432,14 @@ int CommitLog::link_log(CommitLogBase *log_base) {
   DynamicBuffer input;
   String &log_dir = log_base->get_log_dir();
 
+  // make sure queued blocks land in the fragment before the link
+  if (m_pipelined) {
+    wait_for_writer_drain();
+    ScopedLock lock(m_writer_mutex);
+    if (m_append_error != Error::OK)
+      return m_append_error;
+  }
+
   if (m_needs_roll) {
     ScopedLock lock(m_mutex);
     if ((error = roll()) != Error::OK)
@@ -192,16 +449,14 @@ int CommitLog::link_log(CommitLogBase *log_base) {
   HT_INFOF("clgc Linking log %s into fragment %d; link_rev=%lld latest_rev=%lld",
            log_dir.c_str(), m_cur_fragment_num, (Lld)link_revision, (Lld)m_latest_revision);
 
-  if (link_revision > m_latest_revision)
-    m_latest_revision = link_revision;
-
   input.ensure(header.length());
 
   header.set_revision(link_revision);
   header.set_compression_type(BlockCompressionCodec::NONE);
   header.set_data_length(log_dir.length() + 1);
   header.set_data_zlength(log_dir.length() + 1);
-  header.set_data_checksum(fletcher32(log_dir.c_str(), log_dir.length()+1));
+  header.set_data_checksum(header.compute_data_checksum(log_dir.c_str(),
+                                                      log_dir.length()+1));
 
   header.encode(&input.ptr);
   input.add(log_dir.c_str(), log_dir.length() + 1);
@@ -212,7 +467,12 @@ int CommitLog::link_log(CommitLogBase *log_base) {
     StaticBuffer send_buf(input);
 
     m_fs->append(m_fd, send_buf, false);
-    m_cur_fragment_length += amount;
+    {
+      ScopedLock wlock(m_writer_mutex);
+      if (link_revision > m_latest_revision)
+        m_latest_revision = link_revision;
+      m_cur_fragment_length += amount;
+    }
 
     roll();
   }
@@ -227,6 +487,16 @@ int CommitLog::link_log(CommitLogBase *log_base) {
 
 int CommitLog::close() {
 
+  // let in-flight group commits drain
+  {
+    ScopedLock lock(m_group_mutex);
+    while (m_committed_ticket < m_next_ticket)
+      m_group_cond.wait(lock);
+  }
+
+  if (m_pipelined)
+    stop_writer();
+
   try {
     ScopedLock lock(m_mutex);
     if (m_fd > 0) {
@@ -289,6 +559,10 @@ int CommitLog::purge(int64_t revision) {
 int CommitLog::roll() {
   CommitLogFileInfo file_info;
 
+  // appends already handed to the filesystem belong to this fragment
+  if (m_pipelined)
+    wait_for_outstanding_appends();
+
   if (m_latest_revision == TIMESTAMP_MIN)
     return Error::OK;
 
@@ -350,16 +624,32 @@ int
 CommitLog::compress_and_write(DynamicBuffer &input,
     BlockCompressionHeader *header, int64_t revision, bool sync) {
   int error = Error::OK;
-  DynamicBuffer zblock;
+  DynamicBufferPtr zblock = new DynamicBuffer();
+  BlockCompressionCodec *codec = checkout_codec();
 
-  // Compress block and kick off log write (protected by lock)
+  // Compress block outside of the log lock
   try {
-    ScopedLock lock(m_mutex);
+    codec->deflate(input, *zblock, *header);
+  }
+  catch (Exception &e) {
+    checkin_codec(codec);
+    HT_ERRORF("Problem compressing commit log block: %s", e.what());
+    return e.code();
+  }
+  checkin_codec(codec);
+
+  if (m_pipelined) {
+    SyncCommitCallback cb;
+    submit(zblock, revision, sync, &cb);
+    return cb.wait();
+  }
 
-    m_compressor->deflate(input, zblock, *header);
+  // Kick off log write (protected by lock)
+  try {
+    ScopedLock lock(m_mutex);
 
-    size_t amount = zblock.fill();
-    StaticBuffer send_buf(zblock);
+    size_t amount = zblock->fill();
+    StaticBuffer send_buf(*zblock);
 
     m_fs->append(m_fd, send_buf, sync);
     assert(revision != 0);
@@ -377,11 +667,302 @@ CommitLog::compress_and_write(DynamicBuffer &input,
 }
 
 
+int
+CommitLog::write_batch(PendingCommitVector &batch, bool sync,
+                       CommitLogCallback *cb) {
+  DynamicBuffer zblock;
+  DynamicBufferPtr output = new DynamicBuffer();
+  int64_t latest_revision = TIMESTAMP_MIN;
+  BlockCompressionCodec *codec = checkout_codec();
+  int error;
+
+  // Compress each pending block separately so the on-disk block format
+  // (one table identifier per block) is unchanged
+  try {
+    for (size_t i=0; i<batch.size(); i++) {
+      BlockCompressionHeaderCommitLog header(MAGIC_DATA, batch[i].revision);
+      codec->deflate(*batch[i].buffer, zblock, header);
+      output->add(zblock.base, zblock.fill());
+      assert(batch[i].revision != 0);
+      if (batch[i].revision > latest_revision)
+        latest_revision = batch[i].revision;
+    }
+  }
+  catch (Exception &e) {
+    checkin_codec(codec);
+    HT_ERRORF("Problem compressing commit log block: %s", e.what());
+    if (cb) {
+      DynamicBufferPtr null_block;
+      submit(null_block, 0, false, cb, e.code());
+    }
+    return e.code();
+  }
+  checkin_codec(codec);
+
+  if (cb) {
+    submit(output, latest_revision, sync, cb);
+    return Error::OK;
+  }
+
+  try {
+    ScopedLock lock(m_mutex);
+
+    if (m_needs_roll && (error = roll()) != Error::OK)
+      return error;
+
+    size_t amount = output->fill();
+    StaticBuffer send_buf(*output);
+
+    m_fs->append(m_fd, send_buf, sync);
+    if (latest_revision > m_latest_revision)
+      m_latest_revision = latest_revision;
+    m_cur_fragment_length += amount;
+
+    if (m_cur_fragment_length > m_max_fragment_size)
+      roll();
+  }
+  catch (Exception &e) {
+    HT_ERRORF("Problem writing commit log: %s: %s",
+              m_cur_fragment_fname.c_str(), e.what());
+    return e.code();
+  }
+
+  return Error::OK;
+}
+
+
+BlockCompressionCodec *CommitLog::checkout_codec() {
+  {
+    ScopedLock lock(m_codec_mutex);
+    if (!m_codec_pool.empty()) {
+      BlockCompressionCodec *codec = m_codec_pool.back();
+      m_codec_pool.pop_back();
+      return codec;
+    }
+  }
+  return CompressorFactory::create_block_codec(m_compressor_name);
+}
+
+
+void CommitLog::checkin_codec(BlockCompressionCodec *codec) {
+  ScopedLock lock(m_codec_mutex);
+  m_codec_pool.push_back(codec);
+}
+
+
+void
+CommitLog::submit(DynamicBufferPtr &block, int64_t revision, bool sync,
+                  CommitLogCallback *cb, int error) {
+  ScopedLock lock(m_writer_mutex);
+  size_t len = block ? block->fill() : 0;
+
+  // apply back pressure while the queue is full
+  while (m_write_queue_bytes > 0 && m_write_queue_bytes + len
+         > m_write_queue_max && !m_writer_shutdown)
+    m_writer_cond.wait(lock);
+
+  if (m_writer_shutdown) {
+    lock.unlock();
+    cb->committed(Error::CANCELLED);
+    return;
+  }
+
+  WriteRequest request;
+  request.block = block;
+  request.revision = revision;
+  request.sync = sync;
+  request.cb = cb;
+  request.error = error;
+  m_write_queue.push_back(request);
+  m_write_queue_bytes += len;
+  m_writer_cond.notify_all();
+}
+
+
+void CommitLog::writer_loop() {
+  CallbackVector callbacks;
+
+  while (true) {
+    DynamicBufferPtr output;
+    int64_t revision = TIMESTAMP_MIN;
+    bool sync = false;
+    int error = Error::OK;
+
+    callbacks.clear();
+
+    {
+      ScopedLock lock(m_writer_mutex);
+
+      while (m_write_queue.empty() && !m_writer_shutdown)
+        m_writer_cond.wait(lock);
+
+      if (m_write_queue.empty())
+        break;
+
+      // Coalesce queued blocks into a single append
+      while (!m_write_queue.empty()) {
+        WriteRequest &request = m_write_queue.front();
+        if (request.error != Error::OK) {
+          if (callbacks.empty()) {
+            error = request.error;
+            callbacks.push_back(request.cb);
+            m_write_queue.pop_front();
+          }
+          break;
+        }
+        if (!output)
+          output = request.block;
+        else if (output->fill() + request.block->fill() > m_write_queue_max)
+          break;
+        else
+          output->add(request.block->base, request.block->fill());
+        m_write_queue_bytes -= request.block->fill();
+        if (request.revision > revision)
+          revision = request.revision;
+        if (request.sync)
+          sync = true;
+        callbacks.push_back(request.cb);
+        m_write_queue.pop_front();
+      }
+      // nothing is written behind a failed append
+      if (error == Error::OK)
+        error = m_append_error;
+      m_writer_busy = true;
+      m_writer_cond.notify_all();
+    }
+
+    // A failed request completes in order, after everything before it
+    if (error == Error::OK) {
+      ScopedLock lock(m_mutex);
+      bool needs_roll = m_needs_roll;
+
+      {
+        ScopedLock wlock(m_writer_mutex);
+        if (m_cur_fragment_length > m_max_fragment_size)
+          needs_roll = true;
+      }
+
+      if (needs_roll)
+        error = roll();
+
+      if (error == Error::OK) {
+        {
+          ScopedLock wlock(m_writer_mutex);
+          OutstandingAppend append;
+          append.callbacks.swap(callbacks);
+          append.revision = revision;
+          append.amount = output->fill();
+          m_outstanding.push_back(append);
+        }
+        try {
+          StaticBuffer send_buf(*output);
+          m_fs->append(m_fd, send_buf, sync ? Filesystem::O_FLUSH : 0,
+                       m_append_handler.get());
+        }
+        catch (Exception &e) {
+          HT_ERRORF("Problem writing commit log: %s: %s",
+                    m_cur_fragment_fname.c_str(), e.what());
+          error = e.code();
+          ScopedLock wlock(m_writer_mutex);
+          callbacks.swap(m_outstanding.back().callbacks);
+          m_outstanding.pop_back();
+        }
+      }
+    }
+    else
+      wait_for_outstanding_appends();
+
+    foreach (CommitLogCallback *cb, callbacks)
+      cb->committed(error);
+
+    {
+      ScopedLock lock(m_writer_mutex);
+      m_writer_busy = false;
+      m_writer_cond.notify_all();
+    }
+  }
+}
+
+
+void CommitLog::AppendHandler::handle(EventPtr &event_ptr) {
+  int error = Error::OK;
+
+  if (event_ptr->type == Event::MESSAGE || event_ptr->type == Event::ERROR) {
+    if ((error = Protocol::response_code(event_ptr)) != Error::OK)
+      HT_ERRORF("Commit log append failed - %s", Error::get_text(error));
+    m_log->append_finished(error);
+  }
+  else
+    HT_ERROR_OUT << "Unexpected event - " << event_ptr->to_str() << HT_END;
+}
+
+
+/**
+ * The fragment only accounts for appends that made it to the filesystem.
+ * After a failure, the appends still in flight would leave a gap in the
+ * fragment, so they fail as well and nothing further is written.
+ */
+void CommitLog::append_finished(int error) {
+  CallbackVector callbacks;
+
+  {
+    ScopedLock lock(m_writer_mutex);
+    HT_ASSERT(!m_outstanding.empty());
+    OutstandingAppend &append = m_outstanding.front();
+    if (error != Error::OK && m_append_error == Error::OK)
+      m_append_error = error;
+    if (m_append_error == Error::OK) {
+      if (append.revision > m_latest_revision)
+        m_latest_revision = append.revision;
+      m_cur_fragment_length += append.amount;
+    }
+    else
+      error = m_append_error;
+    callbacks.swap(append.callbacks);
+    m_outstanding.pop_front();
+    m_writer_cond.notify_all();
+  }
+
+  foreach (CommitLogCallback *cb, callbacks)
+    cb->committed(error);
+}
+
+
+void CommitLog::wait_for_outstanding_appends() {
+  ScopedLock lock(m_writer_mutex);
+  while (!m_outstanding.empty())
+    m_writer_cond.wait(lock);
+}
+
+
+void CommitLog::wait_for_writer_drain() {
+  ScopedLock lock(m_writer_mutex);
+  while (!m_write_queue.empty() || m_writer_busy || !m_outstanding.empty())
+    m_writer_cond.wait(lock);
+}
+
+
+void CommitLog::stop_writer() {
+  {
+    ScopedLock lock(m_writer_mutex);
+    if (m_writer_thread == 0)
+      return;
+    m_writer_shutdown = true;
+    m_writer_cond.notify_all();
+  }
+  m_writer_thread->join();
+  delete m_writer_thread;
+  m_writer_thread = 0;
+  wait_for_outstanding_appends();
+}
+
+
 void CommitLog::load_cumulative_size_map(CumulativeSizeMap &cumulative_size_map) {
   ScopedLock lock(m_mutex);
   int64_t cumulative_total = 0;
   uint32_t distance = 0;
   CumulativeFragmentData frag_data;
+  ScopedLock wlock(m_writer_mutex);
 
   memset(&frag_data, 0, sizeof(frag_data));
 
@@ -410,6 +991,13 @@ void CommitLog::load_cumulative_size_map(CumulativeSizeMap &cumulative_size_map)
 
 void CommitLog::get_stats(const String &prefix, String &result) {
   ScopedLock lock(m_mutex);
+  int64_t fragment_length, latest_revision;
+
+  {
+    ScopedLock wlock(m_writer_mutex);
+    fragment_length = m_cur_fragment_length;
+    latest_revision = m_latest_revision;
+  }
 
   try {
     foreach (const CommitLogFileInfo &frag, m_fragment_queue) {
@@ -417,9 +1005,21 @@ void CommitLog::get_stats(const String &prefix, String &result) {
       result += prefix + String("-log-fragment[") + frag.num + "]\trevision\t" + frag.revision + "\n";
       result += prefix + String("-log-fragment[") + frag.num + "]\tdir\t" + frag.log_dir + "\n";
     }
-    result += prefix + String("-log-fragment[") + m_cur_fragment_num + "]\tsize\t" + m_cur_fragment_length + "\n";
-    result += prefix + String("-log-fragment]") + m_cur_fragment_num + "]\trevision\t" + m_latest_revision + "\n";
+    result += prefix + String("-log-fragment[") + m_cur_fragment_num + "]\tsize\t" + fragment_length + "\n";
+    result += prefix + String("-log-fragment]") + m_cur_fragment_num + "]\trevision\t" + latest_revision + "\n";
     result += prefix + String("-log-fragment]") + m_cur_fragment_num + "]\tdir\t" + m_log_dir + "\n";
+    if (m_group_commit) {
+      GroupCommitStats stats;
+      get_group_commit_stats(stats);
+      result += prefix + String("-group-commit\tbatches\t") + stats.batches + "\n";
+      result += prefix + String("-group-commit\tblocks\t") + stats.blocks + "\n";
+      result += prefix + String("-group-commit\tbytes\t") + stats.bytes + "\n";
+      result += prefix + String("-group-commit\tsyncs\t") + stats.syncs + "\n";
+      result += prefix + String("-group-commit\tmax-batch-blocks\t") + stats.max_batch_blocks + "\n";
+      result += prefix + String("-group-commit\tavg-latency-us\t")
+          + (stats.batches ? stats.total_latency_us / stats.batches : 0) + "\n";
+      result += prefix + String("-group-commit\tmax-latency-us\t") + stats.max_latency_us + "\n";
+    }
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << "Problem getting stats for log fragments" << HT_END;
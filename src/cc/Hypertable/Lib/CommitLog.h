@@ -25,15 +25,22 @@
 #include <deque>
 #include <map>
 #include <stack>
+#include <vector>
 
+#include <boost/thread/condition.hpp>
 #include <boost/thread/xtime.hpp>
 
 #include "Common/Mutex.h"
 #include "Common/DynamicBuffer.h"
+#include "Common/Error.h"
+#include "Common/Thread.h"
+#include "Common/Time.h"
 #include "Common/ReferenceCount.h"
 #include "Common/String.h"
 #include "Common/Properties.h"
 
+#include "AsyncComm/DispatchHandler.h"
+
 #include "Hypertable/Lib/BlockCompressionCodec.h"
 #include "Hypertable/Lib/Filesystem.h"
 #include "Hypertable/Lib/Types.h"
@@ -50,6 +57,37 @@ namespace Hypertable {
     uint32_t fragno;
   } CumulativeFragmentData;
 
+  /**
+   * Group commit statistics.  A "batch" is the set of blocks that were
+   * compressed and appended to the log with a single append (and flush)
+   * by the group commit leader.
+   */
+  struct GroupCommitStats {
+    uint64_t batches;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t syncs;
+    uint32_t max_batch_blocks;
+    uint64_t total_latency_us;
+    uint64_t max_latency_us;
+  };
+
+  /**
+   * Callback interface for asynchronous (pipelined) commit log writes.
+   */
+  class CommitLogCallback {
+  public:
+    virtual ~CommitLogCallback() { }
+
+    /** Called once the append holding the block has been acknowledged by
+     * the filesystem, including the flush if sync was requested.  This is
+     * invoked from a communication thread, so it should not block.
+     *
+     * @param error Error::OK on success or error code on failure
+     */
+    virtual void committed(int error) = 0;
+  };
+
 
   /**
    * Commit log for persisting range updates.  The commit log is a directory
@@ -63,6 +101,12 @@ namespace Hypertable {
    *<pre>
    * Hypertable.RangeServer.CommitLog.RollLimit
    *</pre>
+   * If Hypertable.CommitLog.Pipelined is set, blocks are compressed on the
+   * calling thread outside of the log lock and handed to a dedicated writer
+   * thread through a bounded queue.  The writer thread issues asynchronous
+   * appends so that several appends can be in flight at once, and
+   * durability is signalled when the matching append (and flush) is
+   * acknowledged.
    */
 
   class CommitLog : public CommitLogBase {
@@ -110,6 +154,82 @@ namespace Hypertable {
      */
     int write(DynamicBuffer &buffer, int64_t revision, bool sync=true);
 
+    /** Enqueues a block of updates for group commit.  Blocks enqueued by
+     * concurrent writers are compressed and appended to the log in enqueue
+     * order with a single append (and a single flush if any of them
+     * requested sync).  The buffer must remain valid until the matching
+     * call to wait_for_commit() returns.
+     *
+     * @param buffer block of updates to commit
+     * @param revision most recent revision in buffer
+     * @param sync syncs the commit log updates to disk
+     * @return ticket to pass to wait_for_commit()
+     */
+    uint64_t enqueue(DynamicBuffer &buffer, int64_t revision, bool sync=true);
+
+    /** Writes a block of updates to the commit log without waiting for it
+     * to become durable.  The block is compressed on the calling thread, so
+     * the buffer may be reused as soon as this method returns.  In
+     * pipelined mode the compressed block is queued for the writer thread
+     * (blocking while the queue is full) and cb->committed() is called once
+     * the append is acknowledged.  Otherwise the block is written
+     * synchronously and the callback is invoked before returning.
+     *
+     * @param buffer block of updates to commit
+     * @param revision most recent revision in buffer
+     * @param sync syncs the commit log updates to disk
+     * @param cb callback to invoke once the block is durable
+     */
+    void write_async(DynamicBuffer &buffer, int64_t revision, bool sync,
+                     CommitLogCallback *cb);
+
+    /** Waits for a block enqueued with enqueue() to be committed.  If no
+     * other thread is currently writing a batch, the caller becomes the
+     * group leader and writes out everything pending, including the blocks
+     * of other waiters.
+     *
+     * @param ticket ticket returned by enqueue()
+     * @return Error::OK on success or error code on failure
+     */
+    int wait_for_commit(uint64_t ticket);
+
+    /** Waits until the holders of all tickets enqueued before this one
+     * have called end_turn().  Callers that apply their updates between
+     * wait_for_turn() and end_turn() apply them in enqueue (and therefore
+     * revision) order, even though they no longer hold a lock while their
+     * blocks get committed.  Every ticket returned by enqueue() must go
+     * through wait_for_turn() and end_turn(), even if its commit failed.
+     *
+     * @param ticket ticket returned by enqueue()
+     */
+    void wait_for_turn(uint64_t ticket);
+
+    /** Passes the turn on to the next ticket.
+     *
+     * @param ticket ticket passed to wait_for_turn()
+     */
+    void end_turn(uint64_t ticket);
+
+    /**
+     * Returns true if group commit is enabled for this log
+     */
+    bool group_commit_enabled() { return m_group_commit; }
+
+    /**
+     * Returns true if writes go through the asynchronous writer thread
+     */
+    bool pipelined() { return m_pipelined; }
+
+    /**
+     * Returns a snapshot of the group commit statistics
+     *
+     * @param stats reference to stats structure to fill in
+     */
+    void get_group_commit_stats(GroupCommitStats &stats) {
+      ScopedLock lock(m_group_mutex);
+      stats = m_group_stats;
+    }
+
     /** Sync previous updates written to commit log.
      *
      * @return Error::OK on success or error code on failure
@@ -182,15 +302,110 @@ namespace Hypertable {
     int compress_and_write(DynamicBuffer &input, BlockCompressionHeader *header,
                            int64_t revision, bool sync);
 
+    struct PendingCommit {
+      PendingCommit(DynamicBuffer *b, int64_t rev) : buffer(b), revision(rev) { }
+      DynamicBuffer *buffer;
+      int64_t revision;
+    };
+    typedef std::vector<PendingCommit> PendingCommitVector;
+
+    int write_batch(PendingCommitVector &batch, bool sync,
+                    CommitLogCallback *cb);
+    void finish_batch(uint64_t batch_begin, uint64_t batch_end,
+                      size_t bytes, bool sync, HiResTime &start_time,
+                      int error);
+
+    BlockCompressionCodec *checkout_codec();
+    void checkin_codec(BlockCompressionCodec *codec);
+
+    struct WriteRequest {
+      DynamicBufferPtr   block;
+      int64_t            revision;
+      bool               sync;
+      CommitLogCallback *cb;
+      int                error;
+    };
+    typedef std::deque<WriteRequest> WriteRequestQueue;
+    typedef std::vector<CommitLogCallback *> CallbackVector;
+
+    // an append handed to the filesystem, accounted for once it completes
+    struct OutstandingAppend {
+      CallbackVector     callbacks;
+      int64_t            revision;
+      size_t             amount;
+    };
+
+    class AppendHandler : public DispatchHandler {
+    public:
+      AppendHandler(CommitLog *log) : m_log(log) { }
+      virtual void handle(EventPtr &event_ptr);
+    private:
+      CommitLog *m_log;
+    };
+
+    class GroupCommitCallback;
+    friend class GroupCommitCallback;
+
+    struct WriterThread {
+      WriterThread(CommitLog *log) : m_log(log) { }
+      void operator()() { m_log->writer_loop(); }
+      CommitLog *m_log;
+    };
+
+    void submit(DynamicBufferPtr &block, int64_t revision, bool sync,
+                CommitLogCallback *cb, int error = Error::OK);
+    void writer_loop();
+    void append_finished(int error);
+    void wait_for_outstanding_appends();
+    void wait_for_writer_drain();
+    void stop_writer();
+
+    // In pipelined mode the fragment length and latest revision are only
+    // advanced by append_finished(), which also holds m_writer_mutex
     Mutex                   m_mutex;
     Filesystem             *m_fs;
-    BlockCompressionCodec  *m_compressor;
+    String                  m_compressor_name;
     String                  m_cur_fragment_fname;
     int64_t                 m_cur_fragment_length;
     uint32_t                m_cur_fragment_num;
     int64_t                 m_max_fragment_size;
     int32_t                 m_fd;
     bool                    m_needs_roll;
+
+    // group commit state (protected by m_group_mutex)
+    Mutex                   m_group_mutex;
+    boost::condition        m_group_cond;
+    bool                    m_group_commit;
+    size_t                  m_group_max_bytes;
+    uint32_t                m_group_max_wait;
+    PendingCommitVector     m_pending;
+    size_t                  m_pending_bytes;
+    bool                    m_pending_sync;
+    bool                    m_leader_active;
+    uint64_t                m_next_ticket;
+    uint64_t                m_committed_ticket;
+    uint64_t                m_turn_ticket;
+    boost::condition        m_turn_cond;
+    std::map<uint64_t, int> m_failed_tickets;
+    GroupCommitStats        m_group_stats;
+
+    // compression codecs for concurrent writers (protected by m_codec_mutex)
+    Mutex                   m_codec_mutex;
+    std::vector<BlockCompressionCodec *> m_codec_pool;
+
+    // pipelined writer state (protected by m_writer_mutex)
+    bool                    m_pipelined;
+    Mutex                   m_writer_mutex;
+    boost::condition        m_writer_cond;
+    WriteRequestQueue       m_write_queue;
+    size_t                  m_write_queue_bytes;
+    size_t                  m_write_queue_max;
+    std::deque<OutstandingAppend> m_outstanding;
+    int                     m_append_error;
+    bool                    m_writer_busy;
+    bool                    m_writer_shutdown;
+    Thread                 *m_writer_thread;
+    DispatchHandlerPtr      m_append_handler;
   };
 
   typedef intrusive_ptr<CommitLog> CommitLogPtr;
@@ -88,6 +88,7 @@ namespace {
     "    cell_predicate",
     "    | row_predicate",
     "    | timestamp_predicate",
+    "    | filter_predicate",
     "",
     "relop: '=' | '<' | '<=' | '>' | '>=' | '=^'",
     "",
@@ -106,13 +107,24 @@ namespace {
     "timestamp_predicate: ",
     "    [timestamp relop] TIMESTAMP relop timestamp",
     "",
+    "filter_predicate: ",
+    "    cell_filter",
+    "    | '(' cell_filter (OR cell_filter)* ')'",
+    "",
+    "cell_filter: ",
+    "    [NOT] (ROW REGEXP regex",
+    "           | QUALIFIER ('=' | '=^' | REGEXP) string",
+    "           | VALUE (relop | CONTAINS | REGEXP) string)",
+    "",
     "options_spec:",
     "    (REVS = revision_count",
     "    | LIMIT = row_count",
     "    | INTO FILE 'file_name'",
     "    | DISPLAY_TIMESTAMPS",
     "    | RETURN_DELETES",
-    "    | KEYS_ONLY)*",
+    "    | KEYS_ONLY",
+    "    | PARALLEL = range_count",
+    "    | UNORDERED)*",
     "",
     "timestamp:",
     "    'YYYY-MM-DD HH:MM:SS[.nanoseconds]'",
@@ -249,6 +261,7 @@ namespace {
     "      | BLOCKSIZE '=' int",
     "      | COMPRESSOR '=' compressor_spec",
     "      | BLOOMFILTER '=' bloom_filter_spec",
+    "      | CELLCACHE '=' cell_cache_spec",
     "",
     "    compressor_spec:",
     "      bmz [ bmz_options ]",
@@ -275,6 +288,10 @@ namespace {
     "      --false-positive float",
     "      --max-approx-items int",
     "",
+    "    cell_cache_spec:",
+    "      map",
+    "      | skiplist",
+    "",
     "Description",
     "-----------",
     "",
@@ -381,6 +398,7 @@ namespace {
     "      | BLOCKSIZE '=' int",
     "      | COMPRESSOR '=' compressor_spec",
     "      | BLOOMFILTER '=' bloom_filter_spec",
+    "      | CELLCACHE '=' cell_cache_spec",
     "",
     "    compressor_spec:",
     "      bmz [ bmz_options ]",
@@ -407,6 +425,10 @@ namespace {
     "      --false-positive float",
     "      --max-approx-items int",
     "",
+    "    cell_cache_spec:",
+    "      map",
+    "      | skiplist",
+    "",
     "Description",
     "-----------",
     "",
@@ -516,6 +538,7 @@ namespace {
     "  * BLOCKSIZE '=' int",
     "  * COMPRESSOR '=' compressor_spec",
     "  * BLOOMFILTER '=' bloom_filter_spec",
+    "  * CELLCACHE '=' cell_cache_spec",
     "",
     "The IN_MEMORY option indicates that all cell data for the access group should",
     "remain memory resident.  Queries against column families in IN_MEMORY access",
@@ -568,6 +591,12 @@ namespace {
     "  --max-approx-items arg  Number of cell store items used to guess the number",
     "                          of actual bloom filter entries (default = 1000)",
     "",
+    "The CELLCACHE option selects the in-memory data structure used for the cell",
+    "cache.  map (a balanced tree guarded by a lock) is the default.  skiplist is",
+    "an arena allocated skip list that allows scans to proceed without blocking",
+    "concurrent inserts.  The default is defined by the config property:",
+    "Hypertable.RangeServer.AccessGroup.CellCache.Type.",
+    "",
     "Compressors",
     "-----------",
     "",
@@ -597,7 +626,7 @@ namespace {
     "SELECT",
     "======",
     "",
-    "    SELECT ('*' | column_family_name [',' column_family_name]*)",
+    "    SELECT ('*' | COUNT(*) | column_family_name [',' column_family_name]*)",
     "      FROM table_name",
     "      [where_clause]",
     "      [options_spec]",
@@ -609,6 +638,7 @@ namespace {
     "      cell_predicate",
     "      | row_predicate",
     "      | timestamp_predicate",
+    "      | filter_predicate",
     "",
     "    relop: '=' | '<' | '<=' | '>' | '>=' | '=^'",
     "",
@@ -627,6 +657,15 @@ namespace {
     "    timestamp_predicate:",
     "      [timestamp relop] TIMESTAMP relop timestamp",
     "",
+    "    filter_predicate:",
+    "      cell_filter",
+    "      | '(' cell_filter (OR cell_filter)* ')'",
+    "",
+    "    cell_filter:",
+    "      [NOT] (ROW REGEXP regex",
+    "             | QUALIFIER ('=' | '=^' | REGEXP) string",
+    "             | VALUE (relop | CONTAINS | REGEXP) string)",
+    "",
     "    options_spec:",
     "      (REVS revision_count",
     "      | LIMIT row_count",
@@ -634,6 +673,8 @@ namespace {
     "      | DISPLAY_TIMESTAMPS",
     "      | KEYS_ONLY",
     "      | NOESCAPE",
+    "      | PARALLEL range_count",
+    "      | UNORDERED",
     "      | RETURN_DELETES)*",
     "",
     "    timestamp:",
@@ -646,6 +687,19 @@ namespace {
     "\"starts with\" operator.  It will return all rows that have the same prefix as",
     "the operand.",
     "",
+    "Filter predicates are evaluated by the RangeServers, so cells that do not",
+    "match are never sent to the client.  They select individual cells, not",
+    "whole rows: a cell is returned only if it satisfies every filter predicate",
+    "of the WHERE clause.  Row key, qualifier and value tests may be negated",
+    "with NOT and combined with OR inside parentheses.  Values are compared",
+    "bytewise and regular expressions are POSIX extended expressions.  LIMIT",
+    "counts the rows that have at least one matching cell.",
+    "",
+    "SELECT COUNT(*) displays the number of rows that have at least one cell",
+    "selected by the WHERE clause.  The rows are counted by the RangeServers,",
+    "each range in parallel, and only the counts are sent to the client.  It",
+    "can not be combined with LIMIT.",
+    "",
     "Options",
     "-------",
     "",
@@ -711,6 +765,19 @@ namespace {
     "",
     "The NOESCAPE option turns off this escaping mechanism.",
     "",
+    "PARALLEL range_count",
+    "",
+    "By default the ranges of a table are scanned one after the other.  The",
+    "PARALLEL option keeps up to range_count ranges in flight at once, which",
+    "lets a large scan use many RangeServers at the same time.  Results are",
+    "still returned in row key order.",
+    "",
+    "UNORDERED",
+    "",
+    "Used together with PARALLEL, returns each range as a whole in the order",
+    "the ranges respond instead of in row key order.  The cells of a row are",
+    "still returned together.",
+    "",
     "RETURN_DELETES",
     "",
     "The RETURN_DELETES option is used internally for debugging.  When data is",
@@ -739,6 +806,11 @@ namespace {
     "    SELECT * FROM test WHERE CELL > \"old\",\"tag:abacate\";",
     "    SELECT * FROM test WHERE CELL >= \"old\",\"tag:abacate\";",
     "    SELECT * FROM test WHERE \"old\",\"tag:foo\" < CELL >= \"old\",\"tag:abacate\";",
+    "    SELECT * FROM test WHERE ROW REGEXP '^b[0-9]+$' AND VALUE CONTAINS 'x';",
+    "    SELECT * FROM test WHERE ('a' <= ROW < 'c') AND QUALIFIER =^ 'ab'",
+    "                             AND NOT VALUE = '';",
+    "    SELECT * FROM test WHERE (VALUE >= 'm' OR QUALIFIER REGEXP '^a.*e$');",
+    "    SELECT COUNT(*) FROM test WHERE ROW =^ 'b' AND VALUE CONTAINS 'x';",
     "    SELECT * FROM test WHERE ( CELL = \"maui\",\"tag:abaisance\" OR ",
     "                               CELL = \"foo\",\"tag:adage\" OR ",
     "                               CELL = \"cow\",\"tag:Ab\" OR ",
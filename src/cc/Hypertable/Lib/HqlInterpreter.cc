@@ -209,6 +209,17 @@ cmd_select(Client *client, ParserState &state, HqlInterpreter::Callback &cb) {
   int out_fd = -1;
 
   table = client->open_table(state.table_name);
+
+  // COUNT(*) is computed by the range servers, only the counts come back
+  if (state.scan.count) {
+    ScanAggregate result;
+    state.scan.builder.set_keys_only(true);
+    table->aggregate(state.scan.builder.get(), result);
+    cb.on_return(format("%llu", (Llu)result.rows));
+    cb.on_finish();
+    return;
+  }
+
   scanner = table->create_scanner(state.scan.builder.get(), 0, true);
 
   // whether it's select into file
@@ -187,10 +187,10 @@ namespace Hypertable {
 
     class ScanState {
     public:
-      ScanState() : display_timestamps(false), keys_only(false),
+      ScanState() : display_timestamps(false), keys_only(false), count(false),
           current_rowkey_set(false), start_time_set(false),
           end_time_set(false), current_timestamp_set(false),
-          current_relop(0) { }
+          current_relop(0), predicate_group(-1), predicate_negated(false) { }
 
       void set_time_interval(int64_t start, int64_t end) {
         HQL_DEBUG("("<< start <<", "<< end <<")");
@@ -207,6 +207,39 @@ namespace Hypertable {
         builder.set_end_time(end);
         end_time_set = true;
       }
+      /**
+       * Adds a cell predicate, counting it as an operand of the open
+       * OR group (unless it is the operand of a NOT).  A null bound of a
+       * VALUE_RANGE is open.
+       */
+      void add_predicate(uint8_t op, const char *operand,
+                         const char *end_operand = 0,
+                         bool start_inclusive = true,
+                         bool end_inclusive = true) {
+        HQL_DEBUG((int)op <<" "<< (operand ? operand : "")
+                  <<" "<< (end_operand ? end_operand : ""));
+        if (op == CellPredicate::VALUE_RANGE)
+          builder.add_value_range(operand, start_inclusive, end_operand,
+                                  end_inclusive);
+        else
+          builder.add_predicate(op, operand);
+        if (predicate_negated)
+          predicate_negated = false;
+        else if (predicate_group >= 0)
+          builder.get().predicates[predicate_group].children++;
+      }
+      void negate_predicate() {
+        builder.add_predicate_group(CellPredicate::NOT, 1);
+        if (predicate_group >= 0)
+          builder.get().predicates[predicate_group].children++;
+        predicate_negated = true;
+      }
+      void open_predicate_group() {
+        predicate_group = builder.get().predicates.size();
+        builder.add_predicate_group(CellPredicate::OR, 0);
+      }
+      void close_predicate_group() { predicate_group = -1; }
+
       int64_t start_time() { return builder.get().time_interval.first; }
       int64_t end_time() { return builder.get().time_interval.second; }
 
@@ -214,6 +247,7 @@ namespace Hypertable {
       String outfile;
       bool display_timestamps;
       bool keys_only;
+      bool count;
       String current_rowkey;
       bool current_rowkey_set;
       RowInterval current_ri;
@@ -225,6 +259,8 @@ namespace Hypertable {
       int64_t current_timestamp;
       bool    current_timestamp_set;
       int current_relop;
+      int predicate_group;
+      bool predicate_negated;
     };
 
     class ParserState {
@@ -482,6 +518,19 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_access_group_cell_cache {
+      set_access_group_cell_cache(ParserState &state) : state(state) { }
+      void operator()(char const * str, char const *end) const {
+        state.ag->cell_cache = String(str, end-str);
+        trim_if(state.ag->cell_cache, boost::is_any_of("'\""));
+        to_lower(state.ag->cell_cache);
+        if (state.ag->cell_cache != "map" && state.ag->cell_cache != "skiplist")
+          HT_THROW(Error::HQL_PARSE_ERROR, String("Invalid CELLCACHE value '")
+                   + state.ag->cell_cache + "' (expected map|skiplist)");
+      }
+      ParserState &state;
+    };
+
     struct add_column_family {
       add_column_family(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -833,6 +882,25 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct scan_set_parallel {
+      scan_set_parallel(ParserState &state) : state(state) { }
+      void operator()(int ival) const {
+        if (state.scan.builder.get().parallel != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR,
+                   "SELECT PARALLEL predicate multiply defined.");
+        state.scan.builder.set_parallel(ival);
+      }
+      ParserState &state;
+    };
+
+    struct scan_set_unordered {
+      scan_set_unordered(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        state.scan.builder.set_unordered(true);
+      }
+      ParserState &state;
+    };
+
     struct scan_set_outfile {
       scan_set_outfile(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1094,6 +1162,99 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct scan_add_predicate {
+      scan_add_predicate(ParserState &state, uint8_t op)
+        : state(state), op(op) { }
+      void operator()(char const *str, char const *end) const {
+        String operand(str, end-str);
+        trim_if(operand, is_any_of("'\""));
+        state.scan.add_predicate(op, operand.c_str());
+      }
+      ParserState &state;
+      uint8_t op;
+    };
+
+    struct scan_add_value_predicate {
+      scan_add_value_predicate(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        String operand(str, end-str);
+        trim_if(operand, is_any_of("'\""));
+        switch (state.scan.current_relop) {
+        case RELOP_EQ:
+          state.scan.add_predicate(CellPredicate::VALUE_EQUAL,
+                                   operand.c_str());
+          break;
+        case RELOP_SW:
+          state.scan.add_predicate(CellPredicate::VALUE_PREFIX,
+                                   operand.c_str());
+          break;
+        case RELOP_LT:
+          state.scan.add_predicate(CellPredicate::VALUE_RANGE, 0,
+                                   operand.c_str(), true, false);
+          break;
+        case RELOP_LE:
+          state.scan.add_predicate(CellPredicate::VALUE_RANGE, 0,
+                                   operand.c_str());
+          break;
+        case RELOP_GT:
+          state.scan.add_predicate(CellPredicate::VALUE_RANGE,
+                                   operand.c_str(), 0, false, true);
+          break;
+        case RELOP_GE:
+          state.scan.add_predicate(CellPredicate::VALUE_RANGE,
+                                   operand.c_str());
+          break;
+        default:
+          HT_THROW(Error::HQL_PARSE_ERROR, "Bad value expression");
+        }
+        state.scan.current_relop = 0;
+      }
+      ParserState &state;
+    };
+
+    struct scan_add_qualifier_predicate {
+      scan_add_qualifier_predicate(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        String operand(str, end-str);
+        trim_if(operand, is_any_of("'\""));
+        if (state.scan.current_relop == RELOP_EQ)
+          state.scan.add_predicate(CellPredicate::QUALIFIER_EQUAL,
+                                   operand.c_str());
+        else if (state.scan.current_relop == RELOP_SW)
+          state.scan.add_predicate(CellPredicate::QUALIFIER_PREFIX,
+                                   operand.c_str());
+        else
+          HT_THROW(Error::HQL_PARSE_ERROR, "Bad qualifier expression "
+                   "(only = and =^ are supported)");
+        state.scan.current_relop = 0;
+      }
+      ParserState &state;
+    };
+
+    struct scan_negate_predicate {
+      scan_negate_predicate(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        state.scan.negate_predicate();
+      }
+      ParserState &state;
+    };
+
+    struct scan_open_predicate_group {
+      scan_open_predicate_group(ParserState &state) : state(state) { }
+      void operator()(const char c) const {
+        state.scan.open_predicate_group();
+      }
+      ParserState &state;
+    };
+
+    struct scan_close_predicate_group {
+      scan_close_predicate_group(ParserState &state) : state(state) { }
+      void operator()(const char c) const {
+        state.scan.close_predicate_group();
+      }
+      ParserState &state;
+    };
+
     struct scan_set_keys_only {
       scan_set_keys_only(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1103,6 +1264,14 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct scan_set_count {
+      scan_set_count(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        state.scan.count=true;
+      }
+      ParserState &state;
+    };
+
     struct set_insert_timestamp {
       set_insert_timestamp(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1333,6 +1502,8 @@ namespace Hypertable {
           Token DISPLAY_TIMESTAMPS = as_lower_d["display_timestamps"];
           Token RETURN_DELETES = as_lower_d["return_deletes"];
           Token KEYS_ONLY    = as_lower_d["keys_only"];
+          Token PARALLEL     = as_lower_d["parallel"];
+          Token UNORDERED    = as_lower_d["unordered"];
           Token RANGE        = as_lower_d["range"];
           Token UPDATE       = as_lower_d["update"];
           Token SCANNER      = as_lower_d["scanner"];
@@ -1347,6 +1518,7 @@ namespace Hypertable {
           Token COMMIT       = as_lower_d["commit"];
           Token LOG          = as_lower_d["log"];
           Token BLOOMFILTER  = as_lower_d["bloomfilter"];
+          Token CELLCACHE    = as_lower_d["cellcache"];
           Token TRUE         = as_lower_d["true"];
           Token FALSE        = as_lower_d["false"];
           Token YES          = as_lower_d["yes"];
@@ -1355,6 +1527,12 @@ namespace Hypertable {
           Token AND          = as_lower_d["and"];
           Token OR           = as_lower_d["or"];
           Token LIKE         = as_lower_d["like"];
+          Token NOT          = as_lower_d["not"];
+          Token VALUE        = as_lower_d["value"];
+          Token QUALIFIER    = as_lower_d["qualifier"];
+          Token REGEXP       = as_lower_d["regexp"];
+          Token CONTAINS     = as_lower_d["contains"];
+          Token COUNT        = as_lower_d["count"];
           Token NOESCAPE     = as_lower_d["noescape"];
           Token IDS          = as_lower_d["ids"];
           Token NOKEYS       = as_lower_d["nokeys"];
@@ -1646,6 +1824,7 @@ namespace Hypertable {
             | COMPRESSOR >> EQUAL >> string_literal[
                 set_access_group_compressor(self.state)]
             | bloom_filter_option
+            | cell_cache_option
             ;
 
           bloom_filter_option
@@ -1653,6 +1832,11 @@ namespace Hypertable {
               >> string_literal[set_access_group_bloom_filter(self.state)]
             ;
 
+          cell_cache_option
+            = CELLCACHE >> EQUAL
+              >> string_literal[set_access_group_cell_cache(self.state)]
+            ;
+
           in_memory_option
             = IN_MEMORY
             ;
@@ -1664,7 +1848,9 @@ namespace Hypertable {
 
           select_statement
             = SELECT
-              >> ('*' | (user_identifier[scan_add_column_family(self.state)]
+              >> ('*' | (COUNT >> LPAREN >> '*' >> RPAREN)[
+                  scan_set_count(self.state)]
+              | (user_identifier[scan_add_column_family(self.state)]
               >> *(COMMA >> user_identifier[
                   scan_add_column_family(self.state)])))
               >> FROM >> user_identifier[set_table_name(self.state)]
@@ -1715,10 +1901,34 @@ namespace Hypertable {
             | LPAREN >> cell_interval >> *( OR >> cell_interval ) >> RPAREN
             ;
 
+          filter_leaf
+            = !NOT[scan_negate_predicate(self.state)]
+              >> (ROW >> REGEXP >> string_literal[
+                    scan_add_predicate(self.state, CellPredicate::ROW_REGEX)]
+              | QUALIFIER >> REGEXP >> string_literal[scan_add_predicate(
+                    self.state, CellPredicate::QUALIFIER_REGEX)]
+              | QUALIFIER >> relop >> string_literal[
+                    scan_add_qualifier_predicate(self.state)]
+              | VALUE >> REGEXP >> string_literal[
+                    scan_add_predicate(self.state, CellPredicate::VALUE_REGEX)]
+              | VALUE >> CONTAINS >> string_literal[scan_add_predicate(
+                    self.state, CellPredicate::VALUE_CONTAINS)]
+              | VALUE >> relop >> string_literal[
+                    scan_add_value_predicate(self.state)])
+            ;
+
+          filter_predicate
+            = filter_leaf
+            | LPAREN[scan_open_predicate_group(self.state)] >> filter_leaf
+              >> *(OR >> filter_leaf)
+              >> RPAREN[scan_close_predicate_group(self.state)]
+            ;
+
           where_predicate
             = cell_predicate
             | row_predicate
             | time_predicate
+            | filter_predicate
             ;
 
           option_spec
@@ -1730,6 +1940,9 @@ namespace Hypertable {
             | DISPLAY_TIMESTAMPS[scan_set_display_timestamps(self.state)]
             | RETURN_DELETES[scan_set_return_deletes(self.state)]
             | KEYS_ONLY[scan_set_keys_only(self.state)]
+            | PARALLEL >> EQUAL >> uint_p[scan_set_parallel(self.state)]
+            | PARALLEL >> uint_p[scan_set_parallel(self.state)]
+            | UNORDERED[scan_set_unordered(self.state)]
             | NOESCAPE[set_noescape(self.state)]
             ;
 
@@ -1823,6 +2036,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(access_group_definition);
           BOOST_SPIRIT_DEBUG_RULE(access_group_option);
           BOOST_SPIRIT_DEBUG_RULE(bloom_filter_option);
+          BOOST_SPIRIT_DEBUG_RULE(cell_cache_option);
           BOOST_SPIRIT_DEBUG_RULE(in_memory_option);
           BOOST_SPIRIT_DEBUG_RULE(blocksize_option);
           BOOST_SPIRIT_DEBUG_RULE(help_statement);
@@ -1831,6 +2045,8 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(select_statement);
           BOOST_SPIRIT_DEBUG_RULE(where_clause);
           BOOST_SPIRIT_DEBUG_RULE(where_predicate);
+          BOOST_SPIRIT_DEBUG_RULE(filter_predicate);
+          BOOST_SPIRIT_DEBUG_RULE(filter_leaf);
           BOOST_SPIRIT_DEBUG_RULE(time_predicate);
           BOOST_SPIRIT_DEBUG_RULE(cell_interval);
           BOOST_SPIRIT_DEBUG_RULE(cell_predicate);
@@ -1885,9 +2101,10 @@ namespace Hypertable {
           max_versions_option, statement, single_string_literal,
           double_string_literal, string_literal, ttl_option,
           access_group_definition, access_group_option,
-          bloom_filter_option, in_memory_option,
+          bloom_filter_option, cell_cache_option, in_memory_option,
           blocksize_option, help_statement, describe_table_statement,
           show_statement, select_statement, where_clause, where_predicate,
+          filter_predicate, filter_leaf,
           time_predicate, relop, row_interval, row_predicate,
           option_spec, date_expression, datetime, date, time, year,
           load_data_statement, load_data_input, load_data_option, insert_statement,
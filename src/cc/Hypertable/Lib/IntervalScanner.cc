@@ -20,8 +20,10 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <vector>
 
+#include "Common/Config.h"
 #include "Common/Error.h"
 #include "Common/String.h"
 
@@ -36,22 +38,37 @@ extern "C" {
 
 using namespace Hypertable;
 
+Mutex IntervalScanner::ms_readahead_mutex;
+int64_t IntervalScanner::ms_readahead_bytes = 0;
+
 
 /**
  * TODO: Asynchronously destroy dangling scanners on EOS
  */
 IntervalScanner::IntervalScanner(Comm *comm, Table *table,
     RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
-    uint32_t timeout_ms, bool retry_table_not_found)
+    uint32_t timeout_ms, bool retry_table_not_found, Mutex *notify_mutex,
+    boost::condition *notify_cond)
   : m_comm(comm), m_table(table), m_range_locator(range_locator),
     m_loc_cache(range_locator->location_cache()),
     m_range_server(comm, timeout_ms), m_eos(false), m_readahead(true),
-    m_fetch_outstanding(false), m_create_scanner_outstanding(false),
+    m_readahead_depth(1), m_readahead_bytes(0), m_fetches_outstanding(0),
+    m_create_scanner_outstanding(false),
     m_end_inclusive(false), m_rows_seen(0),
     m_timeout_ms(timeout_ms), m_retry_table_not_found(retry_table_not_found) {
 
   HT_ASSERT(m_timeout_ms);
 
+  if (notify_mutex)
+    m_sync_handler.set_notify(notify_mutex, notify_cond);
+
+  HT_ASSERT(Config::properties);
+
+  m_readahead_max_depth = std::max(1, Config::properties->get_i32(
+      "Hypertable.Scanner.Readahead.MaxDepth"));
+  m_readahead_limit = Config::properties->get_i64(
+      "Hypertable.Scanner.Readahead.MemoryLimit");
+
   Timer timer(timeout_ms);
   table->get(m_table_identifier, m_schema);
   init(scan_spec, timer);
@@ -77,6 +94,9 @@ void IntervalScanner::init(const ScanSpec &scan_spec, Timer &timer) {
     m_scan_spec_builder.add_column(scan_spec.columns[i]);
   }
 
+  foreach(const CellPredicate &cp, scan_spec.predicates)
+    m_scan_spec_builder.add_predicate(cp);
+
   HT_ASSERT(scan_spec.row_intervals.size() <= 1);
 
   if (!scan_spec.row_intervals.empty()) {
@@ -149,9 +169,10 @@ void IntervalScanner::init(const ScanSpec &scan_spec, Timer &timer) {
 
 IntervalScanner::~IntervalScanner() {
 
-  // if there is an outstanding fetch, wait for it to come back or timeout
-  if (m_fetch_outstanding || m_create_scanner_outstanding)
+  // if there is an outstanding request, wait for it to come back or timeout
+  if (m_create_scanner_outstanding)
     m_sync_handler.wait_for_reply(m_event);
+  drain_readahead();
 }
 
 
@@ -175,11 +196,7 @@ bool IntervalScanner::next(Cell &cell) {
     else {
       m_create_scanner_outstanding = false;
       error = m_scanblock.load(m_event);
-      if (m_readahead && !m_scanblock.eos()) {
-        m_range_server.fetch_scanblock(m_cur_addr,
-            m_scanblock.get_scanner_id(), &m_sync_handler);
-        m_fetch_outstanding = true;
-      }
+      readahead();
     }
   }
 
@@ -196,30 +213,15 @@ bool IntervalScanner::next(Cell &cell) {
       find_range_and_start_scan(next_row.c_str(), timer, true);
     }
     else {
-      if (m_fetch_outstanding) {
-        if (!m_sync_handler.wait_for_reply(m_event)) {
-          m_fetch_outstanding = false;
-          HT_ERRORF("fetch scanblock : %s - %s",
-                    Error::get_text((int)Protocol::response_code(m_event)),
-                    Protocol::string_format_message(m_event).c_str());
-          HT_THROW((int)Protocol::response_code(m_event), "");
-        }
-        else {
-          error = m_scanblock.load(m_event);
-          if (m_readahead && !m_scanblock.eos()) {
-            m_range_server.fetch_scanblock(m_cur_addr,
-                m_scanblock.get_scanner_id(), &m_sync_handler);
-            m_fetch_outstanding = true;
-          }
-          else
-            m_fetch_outstanding = false;
-        }
-      }
+      if (m_fetches_outstanding)
+        load_readahead_block();
       else {
         timer.start();
         m_range_server.set_timeout(timer.remaining());
         m_range_server.fetch_scanblock(m_cur_addr,
             m_scanblock.get_scanner_id(), m_scanblock);
+        if (m_scanblock.eos())
+          destroy_exhausted_scanner();
       }
 
     }
@@ -407,12 +409,109 @@ IntervalScanner::find_range_and_start_scan(const char *row_key, Timer &timer, bo
     break;
   }
   // maybe kick off readahead
-  if (synchronous && m_readahead && !m_scanblock.eos()) {
+  if (synchronous)
+    readahead();
+}
+
+
+/**
+ * Tops up the number of outstanding fetch_scanblock requests to the current
+ * readahead depth.  The RangeServer handles requests for the same scanner
+ * in order, so the replies come back in scan order.
+ */
+void IntervalScanner::readahead() {
+  if (!m_readahead || m_scanblock.eos())
+    return;
+
+  while (m_fetches_outstanding < m_readahead_depth) {
     m_range_server.fetch_scanblock(m_cur_addr, m_scanblock.get_scanner_id(),
                                    &m_sync_handler);
-    m_fetch_outstanding = true;
+    m_fetches_outstanding++;
+  }
+  update_readahead_bytes();
+}
+
+
+/**
+ * Loads the next readahead reply into m_scanblock.  The depth doubles (up
+ * to Hypertable.Scanner.Readahead.MaxDepth) whenever the consumer had to
+ * wait for a block, and halves while the scanblocks requested ahead by all
+ * scanners exceed Hypertable.Scanner.Readahead.MemoryLimit.
+ */
+void IntervalScanner::load_readahead_block() {
+  bool stalled = !m_sync_handler.has_reply();
+
+  m_fetches_outstanding--;
+
+  if (!m_sync_handler.wait_for_reply(m_event)) {
+    HT_ERRORF("fetch scanblock : %s - %s",
+              Error::get_text((int)Protocol::response_code(m_event)),
+              Protocol::string_format_message(m_event).c_str());
+    HT_THROW((int)Protocol::response_code(m_event), "");
   }
-  else
-    m_fetch_outstanding = false;
 
+  m_scanblock.load(m_event);
+
+  if (m_scanblock.eos()) {
+    destroy_exhausted_scanner();
+    return;
+  }
+
+  int64_t block_size = m_scanblock.get_payload_length();
+  int64_t total = update_readahead_bytes();
+
+  m_readahead_depth = adjust_readahead_depth(m_readahead_depth,
+      m_readahead_max_depth, stalled, total, block_size, m_readahead_limit);
+
+  readahead();
+}
+
+
+uint32_t IntervalScanner::adjust_readahead_depth(uint32_t depth,
+    uint32_t max_depth, bool stalled, int64_t total, int64_t block_size,
+    int64_t limit) {
+  if (total > limit)
+    return depth > 1 ? depth / 2 : 1;
+  if (stalled && depth < max_depth && total + block_size * depth <= limit)
+    return std::min(depth * 2, max_depth);
+  return depth;
+}
+
+
+void IntervalScanner::drain_readahead() {
+  EventPtr event;
+
+  while (m_fetches_outstanding) {
+    m_sync_handler.wait_for_reply(event);
+    m_fetches_outstanding--;
+  }
+  update_readahead_bytes();
+}
+
+
+/**
+ * Called once the RangeServer has answered a fetch with the final block.
+ * The server keeps the exhausted scanner id around so that readahead
+ * requests arriving after the last block get an empty EOS block.  Once
+ * their replies (which carry no data) have been discarded, no more
+ * requests for the id are on the way and the entry can go.
+ */
+void IntervalScanner::destroy_exhausted_scanner() {
+  drain_readahead();
+  m_range_server.destroy_scanner(m_cur_addr, m_scanblock.get_scanner_id(), 0);
+}
+
+
+/**
+ * Accounts this scanner's outstanding fetches, estimated at the size of the
+ * current block each, in the process wide total and returns that total.
+ */
+int64_t IntervalScanner::update_readahead_bytes() {
+  int64_t bytes = (int64_t)m_fetches_outstanding
+      * m_scanblock.get_payload_length();
+  ScopedLock lock(ms_readahead_mutex);
+
+  ms_readahead_bytes += bytes - m_readahead_bytes;
+  m_readahead_bytes = bytes;
+  return ms_readahead_bytes;
 }
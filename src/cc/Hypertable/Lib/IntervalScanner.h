@@ -51,22 +51,58 @@ namespace Hypertable {
      *        methods to execute before throwing an exception
      * @param retry_table_not_found whether to retry upon errors caused by
      *        drop/create tables with the same name
+     * @param notify_mutex if non-null, mutex held while queueing replies
+     * @param notify_cond if non-null, signalled whenever a reply arrives
      */
     IntervalScanner(Comm *comm, Table *table, RangeLocatorPtr &range_locator,
                     const ScanSpec &scan_spec, uint32_t timeout_ms,
-                    bool retry_table_not_found);
+                    bool retry_table_not_found, Mutex *notify_mutex = 0,
+                    boost::condition *notify_cond = 0);
 
     virtual ~IntervalScanner();
 
     bool next(Cell &cell);
 
+    /**
+     * Returns true unless the scanner is still waiting for the reply to
+     * its initial create_scanner request.  Call with the notify mutex
+     * held to avoid missing the wakeup.
+     */
+    bool ready() {
+      return !m_create_scanner_outstanding || m_sync_handler.has_reply();
+    }
+
     int32_t get_rows_seen() { return m_rows_seen; }
     void    set_rows_seen(int32_t n) { m_rows_seen = n; }
 
     void find_range_and_start_scan(const char *row_key, Timer &timer, bool synchronous=false);
 
+    /**
+     * Returns the readahead depth to use after a block was loaded.  The
+     * depth is halved (down to one) while total, the scanblock bytes
+     * requested ahead by all scanners, exceeds limit.  Otherwise it is
+     * doubled (up to max_depth) if the consumer stalled on the block and
+     * doubling the outstanding requests of block_size bytes each would
+     * stay within limit.
+     *
+     * @param depth current readahead depth
+     * @param max_depth maximum readahead depth
+     * @param stalled true if the block had not arrived when it was needed
+     * @param total scanblock bytes requested ahead by all scanners
+     * @param block_size size of the block just loaded
+     * @param limit readahead memory limit
+     * @return new readahead depth
+     */
+    static uint32_t adjust_readahead_depth(uint32_t depth, uint32_t max_depth,
+        bool stalled, int64_t total, int64_t block_size, int64_t limit);
+
   private:
     void init(const ScanSpec &, Timer &);
+    void readahead();
+    void load_readahead_block();
+    void drain_readahead();
+    void destroy_exhausted_scanner();
+    int64_t update_readahead_bytes();
 
     Comm               *m_comm;
     Table              *m_table;
@@ -83,7 +119,11 @@ namespace Hypertable {
     RangeLocationInfo   m_range_info;
     struct sockaddr_in  m_cur_addr;
     bool                m_readahead;
-    bool                m_fetch_outstanding;
+    uint32_t            m_readahead_depth;
+    uint32_t            m_readahead_max_depth;
+    int64_t             m_readahead_limit;
+    int64_t             m_readahead_bytes;
+    uint32_t            m_fetches_outstanding;
     bool                m_create_scanner_outstanding;
     DispatchHandlerSynchronizer  m_sync_handler;
     EventPtr            m_event;
@@ -93,6 +133,10 @@ namespace Hypertable {
     int32_t             m_rows_seen;
     uint32_t            m_timeout_ms;
     bool                m_retry_table_not_found;
+
+    // scanblock bytes requested ahead by all scanners in this process
+    static Mutex        ms_readahead_mutex;
+    static int64_t      ms_readahead_bytes;
   };
 
   typedef intrusive_ptr<IntervalScanner> IntervalScannerPtr;
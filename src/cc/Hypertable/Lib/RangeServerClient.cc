@@ -178,6 +178,75 @@ RangeServerClient::fetch_scanblock(const sockaddr_in &addr, int scanner_id,
 }
 
 
+void
+RangeServerClient::get_cells(const sockaddr_in &addr,
+    const TableIdentifier &table, const RangeSpec &range,
+    const ScanSpec &scan_spec, DispatchHandler *handler) {
+  CommBufPtr cbp(RangeServerProtocol::create_request_get_cells(table,
+                 range, scan_spec));
+  send_message(addr, cbp, handler);
+}
+
+
+void
+RangeServerClient::get_cells(const sockaddr_in &addr,
+    const TableIdentifier &table, const RangeSpec &range,
+    const ScanSpec &scan_spec, ScanBlock &scan_block) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event_ptr;
+  CommBufPtr cbp(RangeServerProtocol::create_request_get_cells(table,
+                 range, scan_spec));
+  send_message(addr, cbp, &sync_handler);
+
+  if (!sync_handler.wait_for_reply(event_ptr))
+    HT_THROW((int)Protocol::response_code(event_ptr),
+             String("RangeServer get_cells() failure : ")
+             + Protocol::string_format_message(event_ptr));
+  else {
+    HT_EXPECT(scan_block.load(event_ptr) == Error::OK,
+              Error::FAILED_EXPECTATION);
+  }
+}
+
+
+void
+RangeServerClient::aggregate_scan(const sockaddr_in &addr,
+    const TableIdentifier &table, const RangeSpec &range,
+    const ScanSpec &scan_spec, const char *resume_row,
+    DispatchHandler *handler) {
+  CommBufPtr cbp(RangeServerProtocol::create_request_aggregate_scan(table,
+                 range, scan_spec, resume_row));
+  send_message(addr, cbp, handler);
+}
+
+
+void
+RangeServerClient::aggregate_scan(const sockaddr_in &addr,
+    const TableIdentifier &table, const RangeSpec &range,
+    const ScanSpec &scan_spec, ScanAggregate &result) {
+  String resume_row;
+
+  result.clear();
+  do {
+    DispatchHandlerSynchronizer sync_handler;
+    EventPtr event_ptr;
+    ScanAggregate partial;
+    CommBufPtr cbp(RangeServerProtocol::create_request_aggregate_scan(table,
+                   range, scan_spec, resume_row.c_str()));
+    send_message(addr, cbp, &sync_handler);
+
+    if (!sync_handler.wait_for_reply(event_ptr))
+      HT_THROW((int)Protocol::response_code(event_ptr),
+               String("RangeServer aggregate_scan() failure : ")
+               + Protocol::string_format_message(event_ptr));
+
+    RangeServerProtocol::decode_aggregate_scan_response(event_ptr, partial,
+                                                        resume_row);
+    result.merge(partial);
+  } while (!resume_row.empty());
+}
+
+
 void
 RangeServerClient::drop_table(const sockaddr_in &addr,
     const TableIdentifier &table, DispatchHandler *handler) {
@@ -278,6 +347,33 @@ RangeServerClient::get_statistics(const sockaddr_in &addr,
 }
 
 
+void
+RangeServerClient::batch(const sockaddr_in &addr,
+                         std::vector<CommBufPtr> &requests,
+                         DispatchHandler *handler) {
+  CommBufPtr cbp(RangeServerProtocol::create_request_batch(requests));
+  send_message(addr, cbp, handler);
+}
+
+
+void
+RangeServerClient::batch(const sockaddr_in &addr,
+                         std::vector<CommBufPtr> &requests,
+                         std::vector<EventPtr> &responses) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event_ptr;
+  CommBufPtr cbp(RangeServerProtocol::create_request_batch(requests));
+  send_message(addr, cbp, &sync_handler);
+
+  if (!sync_handler.wait_for_reply(event_ptr))
+    HT_THROW((int)Protocol::response_code(event_ptr),
+             String("RangeServer batch() failure : ")
+             + Protocol::string_format_message(event_ptr));
+
+  RangeServerProtocol::decode_batch_response(event_ptr, responses);
+}
+
+
 void
 RangeServerClient::replay_begin(const sockaddr_in &addr, uint16_t group,
                                 DispatchHandler *handler) {
@@ -34,6 +34,7 @@
 
 #include "RangeServerProtocol.h"
 #include "RangeState.h"
+#include "ScanAggregate.h"
 #include "Types.h"
 #include "Stat.h"
 
@@ -178,6 +179,62 @@ namespace Hypertable {
     void fetch_scanblock(const sockaddr_in &addr, int scanner_id,
                          ScanBlock &scan_block);
 
+    /** Issues a "get cells" request asynchronously.  Every row interval
+     * in scan_spec must name a single row; the response is one scan block
+     * holding the matching cells of all of the rows.
+     *
+     * @param addr remote address of RangeServer connection
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification
+     * @param handler response handler
+     */
+    void get_cells(const sockaddr_in &addr, const TableIdentifier &table,
+                   const RangeSpec &range, const ScanSpec &scan_spec,
+                   DispatchHandler *handler);
+
+    /** Issues a "get cells" request.
+     *
+     * @param addr remote address of RangeServer connection
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification
+     * @param scan_block block of return key/value pairs
+     */
+    void get_cells(const sockaddr_in &addr, const TableIdentifier &table,
+                   const RangeSpec &range, const ScanSpec &scan_spec,
+                   ScanBlock &scan_block);
+
+    /** Issues an "aggregate scan" request asynchronously.  The response
+     * holds the ScanAggregate of the cells selected by scan_spec in the
+     * range, up to the row to resume from if the range server stopped
+     * early (see RangeServerProtocol::decode_aggregate_scan_response).
+     *
+     * @param addr remote address of RangeServer connection
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification
+     * @param resume_row row returned by the previous request for this
+     *        range, empty for the first one
+     * @param handler response handler
+     */
+    void aggregate_scan(const sockaddr_in &addr, const TableIdentifier &table,
+                        const RangeSpec &range, const ScanSpec &scan_spec,
+                        const char *resume_row, DispatchHandler *handler);
+
+    /** Issues "aggregate scan" requests until the range server has
+     * scanned all of the cells selected by scan_spec in the range.
+     *
+     * @param addr remote address of RangeServer connection
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification
+     * @param result aggregate of the selected cells of the range
+     */
+    void aggregate_scan(const sockaddr_in &addr, const TableIdentifier &table,
+                        const RangeSpec &range, const ScanSpec &scan_spec,
+                        ScanAggregate &result);
+
     /** Issues a "drop table" request asynchronously.
      *
      * @param addr remote address of RangeServer connection
@@ -243,6 +300,28 @@ namespace Hypertable {
      */
     void get_statistics(const sockaddr_in &addr, RangeServerStat &stat);
 
+    /** Issues a "batch" request asynchronously.  The requests, created
+     * with the RangeServerProtocol::create_request_ methods, are sent as one
+     * message and carried out in parallel by the range server.  The handler
+     * receives a single response, which
+     * RangeServerProtocol::decode_batch_response splits up.
+     * @param addr remote address of RangeServer connection
+     * @param requests requests to batch
+     * @param handler response handler
+     */
+    void batch(const sockaddr_in &addr, std::vector<CommBufPtr> &requests,
+               DispatchHandler *handler);
+
+    /** Issues a "batch" request.  This call blocks until it receives the
+     * response.  Errors of individual requests do not make it fail, they
+     * are returned in their responses.
+     * @param addr remote address of RangeServer connection
+     * @param requests requests to batch
+     * @param responses receives one response per request, in order
+     */
+    void batch(const sockaddr_in &addr, std::vector<CommBufPtr> &requests,
+               std::vector<EventPtr> &responses);
+
     /** Issues a "replay begin" request.
      *
      * @param addr remote address of RangeServer connection
@@ -20,6 +20,9 @@
  */
 
 #include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
 #include "AsyncComm/CommBuf.h"
 #include "AsyncComm/CommHeader.h"
 
@@ -49,6 +52,9 @@ namespace Hypertable {
     "update schema",
     "commit log sync",
     "close",
+    "batch",
+    "get cells",
+    "aggregate scan",
     (const char *)0
   };
 
@@ -120,6 +126,47 @@ namespace Hypertable {
     return cbuf;
   }
 
+  CommBuf *
+  RangeServerProtocol::create_request_get_cells(const TableIdentifier &table,
+      const RangeSpec &range, const ScanSpec &scan_spec) {
+    CommHeader header(COMMAND_GET_CELLS);
+    if (table.id == 0) // If METADATA table, set the urgent bit
+      header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    CommBuf *cbuf = new CommBuf(header, table.encoded_length()
+        + range.encoded_length() + scan_spec.encoded_length());
+    table.encode(cbuf->get_data_ptr_address());
+    range.encode(cbuf->get_data_ptr_address());
+    scan_spec.encode(cbuf->get_data_ptr_address());
+    return cbuf;
+  }
+
+  CommBuf *
+  RangeServerProtocol::create_request_aggregate_scan(
+      const TableIdentifier &table, const RangeSpec &range,
+      const ScanSpec &scan_spec, const char *resume_row) {
+    CommHeader header(COMMAND_AGGREGATE_SCAN);
+    if (table.id == 0) // If METADATA table, set the urgent bit
+      header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    CommBuf *cbuf = new CommBuf(header, table.encoded_length()
+        + range.encoded_length() + scan_spec.encoded_length()
+        + encoded_length_str16(resume_row));
+    table.encode(cbuf->get_data_ptr_address());
+    range.encode(cbuf->get_data_ptr_address());
+    scan_spec.encode(cbuf->get_data_ptr_address());
+    cbuf->append_str16(resume_row);
+    return cbuf;
+  }
+
+  void
+  RangeServerProtocol::decode_aggregate_scan_response(EventPtr &event,
+      ScanAggregate &result, String &resume_row) {
+    const uint8_t *decode_ptr = event->payload + 4;
+    size_t decode_remain = event->payload_len - 4;
+
+    result.decode(&decode_ptr, &decode_remain);
+    resume_row = decode_str16(&decode_ptr, &decode_remain);
+  }
+
   CommBuf *RangeServerProtocol::create_request_destroy_scanner(int scanner_id) {
     CommHeader header(COMMAND_DESTROY_SCANNER);
     header.gid = scanner_id;
@@ -227,4 +274,69 @@ namespace Hypertable {
     return cbuf;
   }
 
+  /*
+   * A batch request holds the number of requests, the command and payload
+   * length of each request, and then the payloads back-to-back.  The
+   * response holds Error::OK, the number of responses and their payload
+   * lengths, followed by the payloads.
+   */
+  CommBuf *
+  RangeServerProtocol::create_request_batch(std::vector<CommBufPtr> &requests) {
+    CommHeader header(COMMAND_BATCH);
+    CommBuf::SegmentVector segments;
+
+    foreach(CommBufPtr &request, requests) {
+      HT_ASSERT(request->header.command == COMMAND_UPDATE
+                || request->header.command == COMMAND_CREATE_SCANNER
+                || request->header.command == COMMAND_FETCH_SCANBLOCK
+                || request->header.command == COMMAND_DESTROY_SCANNER
+                || request->header.command == COMMAND_GET_CELLS);
+      if (request->header.flags & CommHeader::FLAGS_BIT_URGENT)
+        header.flags |= CommHeader::FLAGS_BIT_URGENT;
+      request->get_payload_segments(segments);
+    }
+
+    CommBuf *cbuf = new CommBuf(header, 4 + 12 * requests.size(), segments);
+    cbuf->append_i32(requests.size());
+    foreach(CommBufPtr &request, requests) {
+      cbuf->append_i64(request->header.command);
+      cbuf->append_i32(request->header.total_len
+                       - request->header.encoded_length());
+    }
+    return cbuf;
+  }
+
+  void
+  RangeServerProtocol::decode_batch_response(EventPtr &event,
+      std::vector<EventPtr> &responses) {
+    const uint8_t *decode_ptr = event->payload;
+    size_t decode_remain = event->payload_len;
+    std::vector<uint32_t> lengths;
+
+    int error = decode_i32(&decode_ptr, &decode_remain);
+    if (error != Error::OK)
+      HT_THROW(error, "batch request failed");
+
+    lengths.resize(decode_i32(&decode_ptr, &decode_remain));
+    for (size_t i=0; i<lengths.size(); i++)
+      lengths[i] = decode_i32(&decode_ptr, &decode_remain);
+
+    responses.clear();
+    responses.reserve(lengths.size());
+    foreach(uint32_t len, lengths) {
+      if (len > decode_remain)
+        HT_THROWF(Error::PROTOCOL_ERROR, "Truncated batch response "
+                  "(%lu > %lu)", (Lu)len, (Lu)decode_remain);
+      uint8_t *payload = new uint8_t [len];
+      memcpy(payload, decode_ptr, len);
+      Event *response = new Event(Event::MESSAGE, event->addr);
+      response->header = event->header;
+      response->payload = payload;
+      response->payload_len = len;
+      responses.push_back(response);
+      decode_ptr += len;
+      decode_remain -= len;
+    }
+  }
+
 } // namespace Hypertable
@@ -22,9 +22,14 @@
 #ifndef HYPERTABLE_RANGESERVERPROTOCOL_H
 #define HYPERTABLE_RANGESERVERPROTOCOL_H
 
+#include <vector>
+
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/Event.h"
 #include "AsyncComm/Protocol.h"
 
 #include "RangeState.h"
+#include "ScanAggregate.h"
 #include "ScanSpec.h"
 #include "Types.h"
 
@@ -53,7 +58,10 @@ namespace Hypertable {
     static const uint64_t COMMAND_UPDATE_SCHEMA     = 16;
     static const uint64_t COMMAND_COMMIT_LOG_SYNC   = 17;
     static const uint64_t COMMAND_CLOSE             = 18;
-    static const uint64_t COMMAND_MAX               = 19;
+    static const uint64_t COMMAND_BATCH             = 19;
+    static const uint64_t COMMAND_GET_CELLS         = 20;
+    static const uint64_t COMMAND_AGGREGATE_SCAN    = 21;
+    static const uint64_t COMMAND_MAX               = 22;
 
     static const char *m_command_strings[];
 
@@ -129,6 +137,47 @@ namespace Hypertable {
      */
     static CommBuf *create_request_destroy_scanner(int scanner_id);
 
+    /** Creates a "get cells" request message.  It looks up a set of rows
+     * in one range without creating a scanner.  Each row interval of the
+     * scan spec must cover a single row.  The response has the format of
+     * a final scan block holding the cells of all the rows.
+     *
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification with one row interval per row
+     * @return protocol message
+     */
+    static CommBuf *create_request_get_cells(const TableIdentifier &table,
+        const RangeSpec &range, const ScanSpec &scan_spec);
+
+    /** Creates an "aggregate scan" request message.  The range server
+     * scans the part of the range selected by the scan spec, which may
+     * hold at most one row or cell interval, and returns the ScanAggregate
+     * of the cells instead of the cells themselves.  A request reads a
+     * bounded amount of data; if it stops early, the response holds the
+     * row to resume from, which is passed back in the next request.
+     *
+     * @param table table identifier
+     * @param range range specification
+     * @param scan_spec scan specification
+     * @param resume_row row to resume the scan from, empty to start at the
+     *        beginning
+     * @return protocol message
+     */
+    static CommBuf *create_request_aggregate_scan(const TableIdentifier &table,
+        const RangeSpec &range, const ScanSpec &scan_spec,
+        const char *resume_row = "");
+
+    /** Decodes the response to an "aggregate scan" request.
+     *
+     * @param event successful response to an aggregate scan request
+     * @param result receives the aggregate of the part that was scanned
+     * @param resume_row receives the row to resume from, or the empty
+     *        string if the scan is complete
+     */
+    static void decode_aggregate_scan_response(EventPtr &event,
+        ScanAggregate &result, String &resume_row);
+
     /** Creates a "fetch scanblock" request message.
      *
      * @param scanner_id scanner ID returned from a "create scanner" request
@@ -213,6 +262,28 @@ namespace Hypertable {
      */
     static CommBuf *create_request_get_statistics();
 
+    /** Creates a "batch" request message, which carries several requests
+     * created with the other create_request_ methods.  The payloads of the
+     * requests are referenced, not copied.  Update, create scanner, fetch
+     * scanblock, destroy scanner and get cells requests can be batched.  The range
+     * server carries them out in parallel, so they must not depend on each
+     * other.
+     *
+     * @param requests requests to batch
+     * @return protocol message
+     */
+    static CommBuf *create_request_batch(std::vector<CommBufPtr> &requests);
+
+    /** Splits the response to a "batch" request into one event per
+     * request, in the order of the requests.  Each holds the response the
+     * range server would have sent to the request on its own.
+     *
+     * @param event response to a batch request
+     * @param responses receives the responses to the batched requests
+     */
+    static void decode_batch_response(EventPtr &event,
+                                      std::vector<EventPtr> &responses);
+
     virtual const char *command_text(uint64_t command);
   };
 
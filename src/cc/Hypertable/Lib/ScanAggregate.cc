@@ -0,0 +1,152 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "ScanAggregate.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+
+bool ScanAggregate::add_value(const uint8_t *value, size_t len) {
+  char buf[24];
+  size_t i = 0;
+  int64_t n;
+
+  if (len == 0 || len >= sizeof(buf))
+    return false;
+
+  if (value[0] == '-' || value[0] == '+')
+    i++;
+
+  if (i == len)
+    return false;
+
+  for (; i < len; i++)
+    if (value[i] < '0' || value[i] > '9')
+      return false;
+
+  memcpy(buf, value, len);
+  buf[len] = 0;
+  errno = 0;
+  n = strtoll(buf, 0, 10);
+  if (errno == ERANGE)
+    return false;
+
+  if (numeric_cells == 0 || n < min)
+    min = n;
+  if (numeric_cells == 0 || n > max)
+    max = n;
+  add_to_sum(n);
+  numeric_cells++;
+  return true;
+}
+
+
+/**
+ * Adds n to sum, saturating and setting sum_overflow if the result does
+ * not fit.  Once saturated, the sum no longer changes.
+ */
+void ScanAggregate::add_to_sum(int64_t n) {
+  if (sum_overflow)
+    return;
+  if (n > 0 && sum > std::numeric_limits<int64_t>::max() - n) {
+    sum = std::numeric_limits<int64_t>::max();
+    sum_overflow = true;
+  }
+  else if (n < 0 && sum < std::numeric_limits<int64_t>::min() - n) {
+    sum = std::numeric_limits<int64_t>::min();
+    sum_overflow = true;
+  }
+  else
+    sum += n;
+}
+
+
+void ScanAggregate::merge(const ScanAggregate &other) {
+  if (other.numeric_cells) {
+    if (numeric_cells == 0 || other.min < min)
+      min = other.min;
+    if (numeric_cells == 0 || other.max > max)
+      max = other.max;
+    if (other.sum_overflow && !sum_overflow) {
+      sum = other.sum;
+      sum_overflow = true;
+    }
+    else
+      add_to_sum(other.sum);
+    numeric_cells += other.numeric_cells;
+  }
+  cells += other.cells;
+  rows += other.rows;
+}
+
+
+size_t ScanAggregate::encoded_length() const {
+  return encoded_length_vi64(cells) + encoded_length_vi64(rows)
+      + encoded_length_vi64(numeric_cells) + 25;
+}
+
+
+void ScanAggregate::encode(uint8_t **bufp) const {
+  encode_vi64(bufp, cells);
+  encode_vi64(bufp, rows);
+  encode_vi64(bufp, numeric_cells);
+  encode_i64(bufp, sum);
+  encode_i64(bufp, min);
+  encode_i64(bufp, max);
+  encode_bool(bufp, sum_overflow);
+}
+
+
+void ScanAggregate::decode(const uint8_t **bufp, size_t *remainp) {
+  HT_TRY("decoding scan aggregate",
+    cells = decode_vi64(bufp, remainp);
+    rows = decode_vi64(bufp, remainp);
+    numeric_cells = decode_vi64(bufp, remainp);
+    sum = decode_i64(bufp, remainp);
+    min = decode_i64(bufp, remainp);
+    max = decode_i64(bufp, remainp);
+    sum_overflow = decode_bool(bufp, remainp));
+}
+
+
+std::ostream &Hypertable::operator<<(std::ostream &os, const ScanAggregate &a) {
+  os <<"{ScanAggregate: cells="<< a.cells <<" rows="<< a.rows
+     <<" numeric_cells="<< a.numeric_cells;
+  if (a.numeric_cells) {
+    os <<" sum="<< a.sum;
+    if (a.sum_overflow)
+      os <<" (overflow)";
+    os <<" min="<< a.min <<" max="<< a.max;
+  }
+  os <<"}";
+  return os;
+}
@@ -0,0 +1,87 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_SCANAGGREGATE_H
+#define HYPERTABLE_SCANAGGREGATE_H
+
+#include <iosfwd>
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Holds the result of an aggregate scan: the number of cells and rows
+   * returned by the scan and the sum, minimum and maximum of the values
+   * that are decimal integers.  Each range server computes the aggregate
+   * of its ranges and the client merges them.  Rows never span ranges, so
+   * row counts of different ranges simply add up.  If the sum does not fit
+   * in 64 bits, sum_overflow is set and sum saturates at INT64_MAX or
+   * INT64_MIN; min and max stay exact.
+   */
+  class ScanAggregate {
+  public:
+    ScanAggregate() { clear(); }
+
+    void clear() {
+      cells = rows = numeric_cells = 0;
+      sum = min = max = 0;
+      sum_overflow = false;
+    }
+
+    /**
+     * Adds a cell value to the numeric aggregates if it is a decimal
+     * integer (optional sign followed by digits) that fits in 64 bits.
+     *
+     * @param value pointer to the value bytes
+     * @param len length of the value
+     * @return true if the value was numeric
+     */
+    bool add_value(const uint8_t *value, size_t len);
+
+    /**
+     * Merges the aggregate of another (disjoint) part of the table.
+     *
+     * @param other aggregate to merge into this one
+     */
+    void merge(const ScanAggregate &other);
+
+    size_t encoded_length() const;
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+    uint64_t cells;
+    uint64_t rows;
+    uint64_t numeric_cells;   // values counted in sum, min and max
+    int64_t sum;
+    int64_t min;
+    int64_t max;
+    bool sum_overflow;        // sum is saturated
+
+  private:
+    void add_to_sum(int64_t n);
+  };
+
+  std::ostream &operator<<(std::ostream &, const ScanAggregate &);
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_SCANAGGREGATE_H
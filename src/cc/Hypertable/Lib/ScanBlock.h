@@ -92,6 +92,14 @@ namespace Hypertable {
      */
     int get_scanner_id() { return m_scanner_id; }
 
+    /** Returns the size of the message this scanblock was loaded from.
+     *
+     * @return payload length in bytes
+     */
+    size_t get_payload_length() {
+      return m_event_ptr ? m_event_ptr->payload_len : 0;
+    }
+
   private:
     int m_error;
     uint16_t m_flags;
@@ -77,15 +77,46 @@ void CellInterval::decode(const uint8_t **bufp, size_t *remainp) {
     end_inclusive = decode_bool(bufp, remainp));
 }
 
+size_t CellPredicate::encoded_length() const {
+  return 5 + encoded_length_vi32(children) + encoded_length_vstr(operand)
+      + encoded_length_vstr(end_operand);
+}
+
+void CellPredicate::encode(uint8_t **bufp) const {
+  encode_i8(bufp, op);
+  encode_vi32(bufp, children);
+  encode_vstr(bufp, operand);
+  encode_bool(bufp, has_start);
+  encode_bool(bufp, start_inclusive);
+  encode_vstr(bufp, end_operand);
+  encode_bool(bufp, has_end);
+  encode_bool(bufp, end_inclusive);
+}
+
+
+void CellPredicate::decode(const uint8_t **bufp, size_t *remainp) {
+  HT_TRY("decoding cell predicate",
+    op = decode_i8(bufp, remainp);
+    children = decode_vi32(bufp, remainp);
+    operand = decode_vstr(bufp, remainp);
+    has_start = decode_bool(bufp, remainp);
+    start_inclusive = decode_bool(bufp, remainp);
+    end_operand = decode_vstr(bufp, remainp);
+    has_end = decode_bool(bufp, remainp);
+    end_inclusive = decode_bool(bufp, remainp));
+}
+
 size_t ScanSpec::encoded_length() const {
   size_t len = encoded_length_vi32(row_limit) +
                encoded_length_vi32(max_versions) +
                encoded_length_vi32(columns.size()) +
                encoded_length_vi32(row_intervals.size()) +
-               encoded_length_vi32(cell_intervals.size());
+               encoded_length_vi32(cell_intervals.size()) +
+               encoded_length_vi32(predicates.size());
   foreach(const char *c, columns) len += encoded_length_vstr(c);
   foreach(const RowInterval &ri, row_intervals) len += ri.encoded_length();
   foreach(const CellInterval &ci, cell_intervals) len += ci.encoded_length();
+  foreach(const CellPredicate &cp, predicates) len += cp.encoded_length();
   return len + 8 + 8 + 2;
 }
 
@@ -102,11 +133,14 @@ void ScanSpec::encode(uint8_t **bufp) const {
   encode_i64(bufp, time_interval.second);
   encode_bool(bufp, return_deletes);
   encode_bool(bufp, keys_only);
+  encode_vi32(bufp, predicates.size());
+  foreach(const CellPredicate &cp, predicates) cp.encode(bufp);
 }
 
 void ScanSpec::decode(const uint8_t **bufp, size_t *remainp) {
   RowInterval ri;
   CellInterval ci;
+  CellPredicate cp;
   HT_TRY("decoding scan spec",
     row_limit = decode_vi32(bufp, remainp);
     max_versions = decode_vi32(bufp, remainp);
@@ -123,7 +157,11 @@ void ScanSpec::decode(const uint8_t **bufp, size_t *remainp) {
     time_interval.first = decode_i64(bufp, remainp);
     time_interval.second = decode_i64(bufp, remainp);
     return_deletes = decode_i8(bufp, remainp);
-    keys_only = decode_i8(bufp, remainp));
+    keys_only = decode_i8(bufp, remainp);
+    for (size_t ncp = decode_vi32(bufp, remainp); ncp--;) {
+      cp.decode(bufp, remainp);
+      predicates.push_back(cp);
+    });
 }
 
 
@@ -171,6 +209,31 @@ ostream &Hypertable::operator<<(ostream &os, const CellInterval &ci) {
   return os;
 }
 
+ostream &Hypertable::operator<<(ostream &os, const CellPredicate &cp) {
+  static const char *op_names[] = { "?", "AND", "OR", "NOT", "ROW_PREFIX",
+      "ROW_REGEX", "QUALIFIER_EQUAL", "QUALIFIER_PREFIX", "QUALIFIER_REGEX",
+      "VALUE_EQUAL", "VALUE_PREFIX", "VALUE_RANGE", "VALUE_CONTAINS",
+      "VALUE_REGEX" };
+
+  os <<"{CellPredicate: "
+     << (cp.op < CellPredicate::OP_MAX ? op_names[cp.op] : op_names[0]);
+  if (cp.op <= CellPredicate::NOT)
+    os <<" children="<< cp.children;
+  else if (cp.op == CellPredicate::VALUE_RANGE) {
+    os << (cp.start_inclusive ? " [" : " (");
+    if (cp.has_start)
+      os <<"\""<< (cp.operand ? cp.operand : "") <<"\"";
+    os <<"..";
+    if (cp.has_end)
+      os <<"\""<< (cp.end_operand ? cp.end_operand : "") <<"\"";
+    os << (cp.end_inclusive ? "]" : ")");
+  }
+  else
+    os <<" \""<< (cp.operand ? cp.operand : "") <<"\"";
+  os <<"}";
+  return os;
+}
+
 
 ostream &Hypertable::operator<<(ostream &os, const ScanSpec &scan_spec) {
   os <<"\n{ScanSpec: row_limit="<< scan_spec.row_limit
@@ -178,6 +241,10 @@ ostream &Hypertable::operator<<(ostream &os, const ScanSpec &scan_spec) {
      <<" return_deletes="<< scan_spec.return_deletes
      <<" keys_only="<< scan_spec.keys_only;
 
+  if (scan_spec.parallel > 1)
+    os <<" parallel="<< scan_spec.parallel
+       <<" unordered="<< scan_spec.unordered;
+
   if (!scan_spec.row_intervals.empty()) {
     os << "\n rows=";
     foreach(const RowInterval &ri, scan_spec.row_intervals)
@@ -188,6 +255,11 @@ ostream &Hypertable::operator<<(ostream &os, const ScanSpec &scan_spec) {
     foreach(const CellInterval &ci, scan_spec.cell_intervals)
       os << " " << ci;
   }
+  if (!scan_spec.predicates.empty()) {
+    os << "\n predicates=";
+    foreach(const CellPredicate &cp, scan_spec.predicates)
+      os << " " << cp;
+  }
   if (!scan_spec.columns.empty()) {
     os << "\n columns=(";
     foreach (const char *c, scan_spec.columns)
@@ -207,6 +279,8 @@ ScanSpecBuilder::ScanSpecBuilder(const ScanSpec &ss) {
   set_time_interval(ss.time_interval.first, ss.time_interval.second);
   set_return_deletes(ss.return_deletes);
   set_keys_only(ss.keys_only);
+  set_parallel(ss.parallel);
+  set_unordered(ss.unordered);
 
   foreach(const char *c, ss.columns)
     add_column(c);
@@ -218,4 +292,7 @@ ScanSpecBuilder::ScanSpecBuilder(const ScanSpec &ss) {
   foreach(const CellInterval &ci, ss.cell_intervals)
     add_cell_interval(ci.start_row, ci.start_column, ci.start_inclusive,
                       ci.end_row, ci.end_column, ci.end_inclusive);
+
+  foreach(const CellPredicate &cp, ss.predicates)
+    add_predicate(cp);
 }
@@ -89,6 +89,63 @@ namespace Hypertable {
   };
 
 
+  /**
+   * Represents one node of a cell filter.  A filter is a tree flattened in
+   * prefix order: an AND, OR or NOT node is immediately followed by its
+   * <code>children</code> operand subtrees (NOT has exactly one).  The
+   * remaining operators are leaves that test a single cell; operands are
+   * compared bytewise and regular expressions are POSIX extended.  c-string
+   * data members are not managed so caller must handle (de)allocation.
+   */
+  class CellPredicate {
+  public:
+    enum {
+      AND = 1,
+      OR,
+      NOT,
+      ROW_PREFIX,
+      ROW_REGEX,
+      QUALIFIER_EQUAL,
+      QUALIFIER_PREFIX,
+      QUALIFIER_REGEX,
+      VALUE_EQUAL,
+      VALUE_PREFIX,
+      VALUE_RANGE,      // operand..end_operand, see has_start/has_end
+      VALUE_CONTAINS,
+      VALUE_REGEX,
+      OP_MAX
+    };
+
+    CellPredicate() : op(0), children(0), operand(0), has_start(false),
+        start_inclusive(true), end_operand(0), has_end(false),
+        end_inclusive(true) { }
+    /** A null operand or end_operand leaves that end of a range open */
+    CellPredicate(uint8_t op, uint32_t children, const char *operand,
+                  bool start_inclusive=true, const char *end_operand=0,
+                  bool end_inclusive=true)
+      : op(op), children(children), operand(operand),
+        has_start(operand != 0), start_inclusive(start_inclusive),
+        end_operand(end_operand), has_end(end_operand != 0),
+        end_inclusive(end_inclusive) { }
+    CellPredicate(const uint8_t **bufp, size_t *remainp) {
+      decode(bufp, remainp);
+    }
+
+    size_t encoded_length() const;
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+    uint8_t op;
+    uint32_t children;
+    const char *operand;
+    bool has_start;             // VALUE_RANGE has a lower bound
+    bool start_inclusive;
+    const char *end_operand;
+    bool has_end;               // VALUE_RANGE has an upper bound
+    bool end_inclusive;
+  };
+
+
   /**
    * Represents a scan predicate.
    */
@@ -96,7 +153,8 @@ namespace Hypertable {
   public:
     ScanSpec() : row_limit(0), max_versions(0),
                  time_interval(TIMESTAMP_MIN, TIMESTAMP_MAX),
-                 return_deletes(false), keys_only(false) { }
+                 return_deletes(false), keys_only(false), parallel(0),
+                 unordered(false) { }
     ScanSpec(const uint8_t **bufp, size_t *remainp) { decode(bufp, remainp); }
 
     size_t encoded_length() const;
@@ -113,6 +171,9 @@ namespace Hypertable {
       time_interval.second = TIMESTAMP_MAX;
       keys_only = false;
       return_deletes = false;
+      predicates.clear();
+      parallel = 0;
+      unordered = false;
     }
 
     /** Initialize 'other' ScanSpec with this copy sans the intervals */
@@ -123,6 +184,9 @@ namespace Hypertable {
       other.time_interval = time_interval;
       other.keys_only = keys_only;
       other.return_deletes = return_deletes;
+      other.predicates = predicates;
+      other.parallel = parallel;
+      other.unordered = unordered;
       other.row_intervals.clear();
       other.cell_intervals.clear();
     }
@@ -135,6 +199,9 @@ namespace Hypertable {
       std::swap(time_interval, ss.time_interval);
       std::swap(return_deletes, ss.return_deletes);
       std::swap(keys_only, ss.keys_only);
+      predicates.swap(ss.predicates);
+      std::swap(parallel, ss.parallel);
+      std::swap(unordered, ss.unordered);
     }
 
     int32_t row_limit;
@@ -145,6 +212,27 @@ namespace Hypertable {
     std::pair<int64_t,int64_t> time_interval;
     bool return_deletes;
     bool keys_only;
+
+    /**
+     * Cell filter evaluated by the range servers; a cell is returned only
+     * if it satisfies every top level predicate tree.  Row limits count
+     * the rows that have at least one matching cell.
+     */
+    std::vector<CellPredicate> predicates;
+
+    /**
+     * Client side only (not sent to range servers).  Maximum number of
+     * ranges the TableScanner keeps in flight; 0 or 1 scans the ranges
+     * of each interval one after the other.
+     */
+    uint32_t parallel;
+
+    /**
+     * Client side only.  With parallel > 1, deliver ranges in the order
+     * their first scan blocks arrive instead of in key order.  Cells of
+     * a row are still returned together.
+     */
+    bool unordered;
   };
 
   /**
@@ -284,6 +372,83 @@ namespace Hypertable {
       m_scan_spec.keys_only = val;
     }
 
+    /**
+     * Adds a leaf predicate to the cell filter.  Top level predicates must
+     * all be satisfied; predicates following an add_predicate_group() call
+     * become operands of that group.
+     *
+     * @param op CellPredicate operator (ROW_PREFIX .. VALUE_REGEX)
+     * @param operand prefix, value or regular expression to match
+     */
+    void add_predicate(uint8_t op, const char *operand) {
+      if (op <= CellPredicate::NOT || op == CellPredicate::VALUE_RANGE
+          || op >= CellPredicate::OP_MAX)
+        HT_THROWF(Error::BAD_SCAN_SPEC, "Bad cell predicate operator %d",
+                  (int)op);
+      m_scan_spec.predicates.push_back(CellPredicate(op, 0,
+                                                     m_alloc.dup(operand)));
+    }
+
+    /**
+     * Adds a value range predicate to the cell filter.
+     *
+     * @param start lower bound, null for none
+     * @param start_inclusive true if the range includes start
+     * @param end upper bound, null for none
+     * @param end_inclusive true if the range includes end
+     */
+    void add_value_range(const char *start, bool start_inclusive,
+                         const char *end, bool end_inclusive) {
+      m_scan_spec.predicates.push_back(CellPredicate(
+          CellPredicate::VALUE_RANGE, 0, m_alloc.dup(start), start_inclusive,
+          m_alloc.dup(end), end_inclusive));
+    }
+
+    /**
+     * Adds an AND, OR or NOT node to the cell filter.  The next
+     * <code>children</code> predicate trees added are its operands.
+     *
+     * @param op CellPredicate::AND, OR or NOT
+     * @param children number of operands (1 for NOT)
+     */
+    void add_predicate_group(uint8_t op, uint32_t children) {
+      if (op < CellPredicate::AND || op > CellPredicate::NOT
+          || (op == CellPredicate::NOT && children != 1))
+        HT_THROWF(Error::BAD_SCAN_SPEC, "Bad cell predicate group %d/%u",
+                  (int)op, (unsigned)children);
+      m_scan_spec.predicates.push_back(CellPredicate(op, children, 0));
+    }
+
+    /**
+     * Adds a copy of a cell filter node of any kind.
+     *
+     * @param cp cell predicate to copy
+     */
+    void add_predicate(const CellPredicate &cp) {
+      if (cp.op >= CellPredicate::AND && cp.op <= CellPredicate::NOT)
+        add_predicate_group(cp.op, cp.children);
+      else if (cp.op == CellPredicate::VALUE_RANGE)
+        add_value_range(cp.has_start ? cp.operand : 0, cp.start_inclusive,
+                        cp.has_end ? cp.end_operand : 0, cp.end_inclusive);
+      else
+        add_predicate(cp.op, cp.operand);
+    }
+
+    /**
+     * Sets the number of ranges to scan concurrently.
+     *
+     * @param n maximum ranges in flight (0 or 1 for sequential)
+     */
+    void set_parallel(uint32_t n) { m_scan_spec.parallel = n; }
+
+    /**
+     * Return ranges in arrival order rather than key order when
+     * scanning in parallel
+     */
+    void set_unordered(bool val) {
+      m_scan_spec.unordered = val;
+    }
+
     /**
      * Internal use only.
      */
@@ -323,6 +488,8 @@ namespace Hypertable {
 
   std::ostream &operator<<(std::ostream &os, const CellInterval &ci);
 
+  std::ostream &operator<<(std::ostream &os, const CellPredicate &cp);
+
   std::ostream &operator<<(std::ostream &os, const ScanSpec &scan_spec);
 
 } // namespace Hypertable
@@ -64,6 +64,33 @@ void RangeStat::decode(const uint8_t **bufp, size_t *remainp) {
     memory_usage = decode_i64(bufp, remainp));
 }
 
+size_t BlockCacheStat::encoded_length() const {
+  return 56 + encoded_length_vstr(name);
+}
+
+void BlockCacheStat::encode(uint8_t **bufp) const {
+  encode_vstr(bufp, name);
+  encode_i64(bufp, max_memory);
+  encode_i64(bufp, memory_used);
+  encode_i64(bufp, hits);
+  encode_i64(bufp, misses);
+  encode_i64(bufp, inserts);
+  encode_i64(bufp, evictions);
+  encode_i64(bufp, promotions);
+}
+
+void BlockCacheStat::decode(const uint8_t **bufp, size_t *remainp) {
+  HT_TRY("decoding block cache statistics",
+    name = decode_vstr(bufp, remainp);
+    max_memory = decode_i64(bufp, remainp);
+    memory_used = decode_i64(bufp, remainp);
+    hits = decode_i64(bufp, remainp);
+    misses = decode_i64(bufp, remainp);
+    inserts = decode_i64(bufp, remainp);
+    evictions = decode_i64(bufp, remainp);
+    promotions = decode_i64(bufp, remainp));
+}
+
 size_t RangeServerStat::encoded_length() const {
   size_t length = 28;
 
@@ -71,6 +98,10 @@ size_t RangeServerStat::encoded_length() const {
     length += range_stats[i].encoded_length();
   }
 
+  length += 4;
+  for (size_t i = 0; i < block_cache_stats.size(); ++i)
+    length += block_cache_stats[i].encoded_length();
+
   return length;
 }
 
@@ -80,6 +111,10 @@ void RangeServerStat::encode(uint8_t **bufp) const {
   for (size_t i = 0; i < range_stats.size(); ++i) {
     range_stats[i].encode(bufp);
   }
+
+  encode_i32(bufp, block_cache_stats.size());
+  for (size_t i = 0; i < block_cache_stats.size(); ++i)
+    block_cache_stats[i].encode(bufp);
 }
 
 void RangeServerStat::decode(const uint8_t **bufp, size_t *remainp) {
@@ -91,6 +126,16 @@ void RangeServerStat::decode(const uint8_t **bufp, size_t *remainp) {
   for (size_t i = 0; i < n; ++i) {
     range_stats.push_back(RangeStat(bufp, remainp));
   }
+
+  // older servers do not send block cache statistics
+  if (*remainp == 0)
+    return;
+
+  HT_TRY("decoding block cache statistics",
+    n = decode_i32(bufp, remainp));
+
+  for (size_t i = 0; i < n; ++i)
+    block_cache_stats.push_back(BlockCacheStat(bufp, remainp));
 }
 
 ostream &Hypertable::operator<<(ostream &os, const RangeStat &stat) {
@@ -109,12 +154,30 @@ ostream &Hypertable::operator<<(ostream &os, const RangeStat &stat) {
   return os;
 }
 
+ostream &Hypertable::operator<<(ostream &os, const BlockCacheStat &stat) {
+  os << " {" << endl
+     << "  name = " << stat.name
+     << "  max_memory = " << stat.max_memory
+     << "  memory_used = " << stat.memory_used << endl
+     << "  hits = " << stat.hits
+     << "  misses = " << stat.misses
+     << "  inserts = " << stat.inserts
+     << "  evictions = " << stat.evictions
+     << "  promotions = " << stat.promotions << endl
+     << " }";
+  return os;
+}
+
 ostream &Hypertable::operator<<(ostream &os, const RangeServerStat &stat) {
   os << "{RangeServerStat: range_stats_number = " << stat.range_stats.size()
      <<'\n';
   for (size_t i = 0; i < stat.range_stats.size(); ++i) {
     os << " range_stats[" << i << "] = " << stat.range_stats[i] <<'\n';
   }
+  for (size_t i = 0; i < stat.block_cache_stats.size(); ++i) {
+    os << " block_cache_stats[" << i << "] = " << stat.block_cache_stats[i]
+       << '\n';
+  }
 
   os << "}";
 
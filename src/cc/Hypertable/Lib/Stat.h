@@ -50,6 +50,29 @@ namespace Hypertable {
     uint64_t memory_usage;
   };
 
+  /** Statistics of one tier of the RangeServer block cache */
+  class BlockCacheStat {
+  public:
+    BlockCacheStat() : max_memory(0), memory_used(0), hits(0), misses(0),
+        inserts(0), evictions(0), promotions(0) { }
+    BlockCacheStat(const uint8_t **bufp, size_t *remainp) {
+      decode(bufp, remainp);
+    }
+
+    size_t encoded_length() const;
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+    String   name;
+    uint64_t max_memory;
+    uint64_t memory_used;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t inserts;
+    uint64_t evictions;
+    uint64_t promotions;
+  };
+
   /** Statistics of a RangeServer */
   class RangeServerStat {
   public:
@@ -63,10 +86,13 @@ namespace Hypertable {
     void decode(const uint8_t **bufp, size_t *remainp);
 
     std::vector<RangeStat> range_stats;
+    std::vector<BlockCacheStat> block_cache_stats;
   };
 
   std::ostream &operator<<(std::ostream &os, const RangeStat &stat);
 
+  std::ostream &operator<<(std::ostream &os, const BlockCacheStat &stat);
+
   std::ostream &operator<<(std::ostream &os, const RangeServerStat &stat);
 
 } // namespace Hypertable
@@ -20,16 +20,27 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <cstring>
+#include <map>
+#include <poll.h>
 
 #include "Common/String.h"
 #include "Common/DynamicBuffer.h"
 #include "Common/Error.h"
 #include "Common/Logger.h"
 
+#include "AsyncComm/DispatchHandlerSynchronizer.h"
+#include "AsyncComm/Protocol.h"
+
 #include "Hyperspace/HandleCallback.h"
 #include "Hyperspace/Session.h"
 
+#include "Key.h"
+#include "LocationCache.h"
+#include "RangeServerClient.h"
+#include "RangeServerProtocol.h"
+#include "ScanBlock.h"
 #include "Table.h"
 #include "TableScanner.h"
 #include "TableMutatorShared.h"
@@ -170,3 +181,437 @@ Table::create_scanner(const ScanSpec &scan_spec, uint32_t timeout_ms,
                           timeout_ms ? timeout_ms : m_timeout_ms,
                           retry_table_not_found);
 }
+
+
+namespace {
+
+  /** The rows of a get_cells() call that fall in one range */
+  struct GetCellsRange {
+    RangeLocationInfo info;
+    sockaddr_in addr;
+    std::vector<const char *> rows;
+  };
+
+  /** The part of an aggregate() interval that falls in one range */
+  struct AggregatePiece {
+    size_t interval;
+    String from;       // row used to look up the range
+    String to;         // last row of the piece
+    String resume;     // row the range server stopped at, empty if none
+    RangeLocationInfo info;
+    sockaddr_in addr;
+  };
+
+  /** Ranges aggregate() scans at a time unless ScanSpec::parallel is set */
+  const size_t AGGREGATE_WINDOW = 4;
+
+  /** Errors after which a lookup is retried with fresh range locations */
+  bool retryable(int error) {
+    return error == Error::RANGESERVER_RANGE_NOT_FOUND
+        || error == Error::RANGESERVER_GENERATION_MISMATCH
+        || error == Error::REQUEST_TIMEOUT
+        || error == Error::COMM_NOT_CONNECTED
+        || error == Error::COMM_BROKEN_CONNECTION;
+  }
+
+}
+
+
+/**
+ * Each round locates the ranges of the rows not yet fetched, sends one
+ * batch of "get cells" requests per RangeServer and then collects the
+ * replies.  A RangeServer answers the rows of a range in order until its
+ * reply reaches DATA_TRANSFER_BLOCKSIZE, so the rows it did not get to
+ * are sent again in the next round.  Rows whose range moved, split or
+ * whose server went away are looked up again (bypassing the location
+ * cache) in the next round.
+ */
+void
+Table::get_cells(const std::vector<String> &rows, const ScanSpec &scan_spec,
+                 CellsBuilder &cells, uint32_t timeout_ms) {
+  Timer timer(timeout_ms ? timeout_ms : m_timeout_ms, true);
+  LocationCachePtr loc_cache = m_range_locator->location_cache();
+  RangeServerClient range_server(m_comm, timer.duration());
+  TableIdentifierManaged table;
+  SchemaPtr schema;
+  std::vector<String> pending(rows);
+  std::map<String, EventPtr> results;  // keyed by first row of the reply
+  bool hard = false;
+
+  if (!scan_spec.row_intervals.empty() || !scan_spec.cell_intervals.empty())
+    HT_THROW(Error::BAD_SCAN_SPEC,
+             "get_cells() takes rows, not row or cell intervals");
+
+  get(table, schema);
+
+  for (size_t i=0; i<scan_spec.columns.size(); i++)
+    if (schema->get_column_family(scan_spec.columns[i]) == 0)
+      HT_THROW(Error::RANGESERVER_INVALID_COLUMNFAMILY, scan_spec.columns[i]);
+
+  std::sort(pending.begin(), pending.end());
+  pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+  while (!pending.empty()) {
+    std::vector<GetCellsRange> ranges;
+    typedef std::map<String, std::vector<size_t> > ServerMap;
+    ServerMap servers;
+    std::vector<String> retry;    // rows to look up again
+    std::vector<String> resend;   // rows left over from a full reply
+    int last_error = Error::OK;
+
+    // group the (sorted) rows by range, then the ranges by server
+    foreach(const String &row, pending) {
+      if (ranges.empty() || (ranges.back().info.end_row.compare(row) < 0
+                             && ranges.back().info.end_row
+                                != Key::END_ROW_MARKER)) {
+        ranges.push_back(GetCellsRange());
+        GetCellsRange &gr = ranges.back();
+        if (hard || !loc_cache->lookup(table.id, row.c_str(), &gr.info))
+          m_range_locator->find_loop(&table, row.c_str(), &gr.info, timer,
+                                     hard);
+        if (!LocationCache::location_to_addr(gr.info.location.c_str(),
+                                             gr.addr))
+          HT_THROWF(Error::INVALID_METADATA, "Invalid location found in "
+                    "METADATA entry range [%s..%s] - %s",
+                    gr.info.start_row.c_str(), gr.info.end_row.c_str(),
+                    gr.info.location.c_str());
+        servers[gr.info.location].push_back(ranges.size()-1);
+      }
+      ranges.back().rows.push_back(row.c_str());
+    }
+
+    // send one batch per server
+    std::vector<DispatchHandlerPtr> handlers;
+    std::vector<const std::vector<size_t> *> batches;
+    range_server.set_default_timeout(timer.remaining());
+    for (ServerMap::iterator it = servers.begin(); it != servers.end(); ++it) {
+      std::vector<CommBufPtr> requests;
+      DispatchHandlerPtr handler = new DispatchHandlerSynchronizer();
+      foreach(size_t i, it->second) {
+        ScanSpec spec;
+        RangeSpec range;
+        scan_spec.base_copy(spec);
+        range.start_row = ranges[i].info.start_row.c_str();
+        range.end_row = ranges[i].info.end_row.c_str();
+        foreach(const char *row, ranges[i].rows)
+          spec.row_intervals.push_back(RowInterval(row, true, row, true));
+        requests.push_back(RangeServerProtocol::create_request_get_cells(
+                           table, range, spec));
+      }
+      try {
+        range_server.batch(ranges[it->second[0]].addr, requests,
+                           handler.get());
+      }
+      catch (Exception &e) {
+        if (!retryable(e.code()))
+          HT_THROW2(e.code(), e, "Problem issuing get_cells() batch");
+        last_error = e.code();
+        foreach(size_t i, it->second)
+          retry.insert(retry.end(), ranges[i].rows.begin(),
+                       ranges[i].rows.end());
+        continue;
+      }
+      handlers.push_back(handler);
+      batches.push_back(&it->second);
+    }
+
+    // collect the replies
+    for (size_t h=0; h<handlers.size(); h++) {
+      DispatchHandlerSynchronizer *sync_handler =
+          static_cast<DispatchHandlerSynchronizer *>(handlers[h].get());
+      std::vector<EventPtr> responses;
+      EventPtr event_ptr;
+      int error;
+
+      if (sync_handler->wait_for_reply(event_ptr)) {
+        RangeServerProtocol::decode_batch_response(event_ptr, responses);
+        if (responses.size() != batches[h]->size())
+          HT_THROWF(Error::PROTOCOL_ERROR, "get_cells() batch on %s returned "
+                    "%d responses for %d requests", table.name,
+                    (int)responses.size(), (int)batches[h]->size());
+      }
+      else
+        responses.resize(batches[h]->size(), event_ptr);
+
+      for (size_t r=0; r<batches[h]->size(); r++) {
+        GetCellsRange &gr = ranges[(*batches[h])[r]];
+        if ((error = Protocol::response_code(responses[r])) == Error::OK) {
+          ScanBlock block;
+          size_t answered;
+
+          if ((error = block.load(responses[r])) != Error::OK)
+            HT_THROWF(error, "get_cells() on %s[%s..%s] returned a bad "
+                      "response", table.name, gr.info.start_row.c_str(),
+                      gr.info.end_row.c_str());
+          results[gr.rows[0]] = responses[r];
+          if (!block.eos()) {
+            answered = (size_t)block.get_scanner_id();
+            if (answered == 0 || answered >= gr.rows.size())
+              HT_THROWF(Error::PROTOCOL_ERROR, "get_cells() on %s[%s..%s] "
+                        "answered %d of %d rows", table.name,
+                        gr.info.start_row.c_str(), gr.info.end_row.c_str(),
+                        (int)answered, (int)gr.rows.size());
+            resend.insert(resend.end(), gr.rows.begin() + answered,
+                          gr.rows.end());
+          }
+          continue;
+        }
+        if (!retryable(error))
+          HT_THROWF(error, "get_cells() on %s[%s..%s] failed - %s",
+                    table.name, gr.info.start_row.c_str(),
+                    gr.info.end_row.c_str(),
+                    Protocol::string_format_message(responses[r]).c_str());
+        if (error == Error::RANGESERVER_GENERATION_MISMATCH)
+          refresh(table, schema);
+        last_error = error;
+        m_range_locator->invalidate(&table, gr.rows[0]);
+        retry.insert(retry.end(), gr.rows.begin(), gr.rows.end());
+      }
+    }
+
+    if (retry.empty() && resend.empty())
+      break;
+
+    if (!retry.empty()) {
+      if (timer.remaining() <= 1000)
+        HT_THROWF(Error::REQUEST_TIMEOUT, "get_cells() on %s unable to "
+                  "complete within %d ms (last error: %s)", table.name,
+                  (int)timer.duration(), Error::get_text(last_error));
+      poll(0, 0, 1000);
+      hard = true;
+    }
+
+    retry.insert(retry.end(), resend.begin(), resend.end());
+    pending.swap(retry);
+    std::sort(pending.begin(), pending.end());
+  }
+
+  // ranges are disjoint, so ordering them by first row orders the cells
+  for (std::map<String, EventPtr>::iterator it = results.begin();
+       it != results.end(); ++it) {
+    ScanBlock block;
+    SerializedKey serkey;
+    ByteString value;
+    Key key;
+    Cell cell;
+    Schema::ColumnFamily *cf;
+
+    HT_EXPECT(block.load(it->second) == Error::OK, Error::FAILED_EXPECTATION);
+
+    while (block.next(serkey, value)) {
+      if (!key.load(serkey))
+        HT_THROW(Error::BAD_KEY, "");
+      if ((cf = schema->get_column_family(key.column_family_code)) == 0)
+        HT_THROWF(Error::BAD_KEY, "Unexpected column family code %d",
+                  (int)key.column_family_code);
+      cell.row_key = key.row;
+      cell.column_family = cf->name.c_str();
+      cell.column_qualifier = key.column_qualifier;
+      cell.timestamp = key.timestamp;
+      cell.revision = key.revision;
+      cell.value_len = value.decode_length(&cell.value);
+      cell.flag = key.flag;
+      cells.add(cell);
+    }
+  }
+}
+
+
+namespace {
+
+  /**
+   * Appends a piece for every range holding rows from..to of an
+   * aggregate() interval.
+   */
+  void locate_pieces(RangeLocatorPtr &range_locator, LocationCachePtr &loc_cache,
+                     TableIdentifier *table, size_t interval, String from,
+                     const String &to, Timer &timer, bool hard,
+                     std::vector<AggregatePiece> &pieces) {
+    while (true) {
+      AggregatePiece piece;
+      piece.interval = interval;
+      piece.from = from;
+      piece.to = to;
+      if (hard || !loc_cache->lookup(table->id, from.c_str(), &piece.info))
+        range_locator->find_loop(table, from.c_str(), &piece.info, timer,
+                                 hard);
+      if (!LocationCache::location_to_addr(piece.info.location.c_str(),
+                                           piece.addr))
+        HT_THROWF(Error::INVALID_METADATA, "Invalid location found in "
+                  "METADATA entry range [%s..%s] - %s",
+                  piece.info.start_row.c_str(), piece.info.end_row.c_str(),
+                  piece.info.location.c_str());
+      if (piece.info.end_row == Key::END_ROW_MARKER
+          || to.compare(piece.info.end_row) <= 0) {
+        pieces.push_back(piece);
+        break;
+      }
+      piece.to = piece.info.end_row;
+      pieces.push_back(piece);
+      from = piece.info.end_row;
+      from.append(1, 1);  // construct row key in next range
+    }
+  }
+
+}
+
+
+/**
+ * Splits each row or cell interval of the scan spec at range boundaries
+ * and sends one "aggregate scan" request per piece, up to
+ * ScanSpec::parallel (AGGREGATE_WINDOW if unset) at a time.  A range
+ * server that stops early returns the row to resume from, and the piece
+ * is sent again from there in a later window.  Pieces whose range moved,
+ * split or whose server went away are looked up again (bypassing the
+ * location cache) in the next round, from the row they got to.
+ */
+void
+Table::aggregate(const ScanSpec &scan_spec, ScanAggregate &result,
+                 uint32_t timeout_ms) {
+  Timer timer(timeout_ms ? timeout_ms : m_timeout_ms, true);
+  LocationCachePtr loc_cache = m_range_locator->location_cache();
+  RangeServerClient range_server(m_comm, timer.duration());
+  TableIdentifierManaged table;
+  SchemaPtr schema;
+  std::vector<ScanSpec> specs;
+  std::vector<AggregatePiece> pending;
+
+  if (scan_spec.row_limit)
+    HT_THROW(Error::BAD_SCAN_SPEC, "aggregate() does not take a row limit");
+
+  get(table, schema);
+
+  for (size_t i=0; i<scan_spec.columns.size(); i++)
+    if (schema->get_column_family(scan_spec.columns[i]) == 0)
+      HT_THROW(Error::RANGESERVER_INVALID_COLUMNFAMILY, scan_spec.columns[i]);
+
+  result.clear();
+
+  // one scan spec and row span per interval
+  if (!scan_spec.row_intervals.empty()) {
+    foreach(const RowInterval &ri, scan_spec.row_intervals) {
+      String from = ri.start ? ri.start : "";
+      if (!ri.start_inclusive && !from.empty())
+        from.append(1, 1);
+      specs.push_back(ScanSpec());
+      scan_spec.base_copy(specs.back());
+      specs.back().row_intervals.push_back(ri);
+      locate_pieces(m_range_locator, loc_cache, &table, specs.size()-1, from,
+                    ri.end ? ri.end : Key::END_ROW_MARKER, timer, false,
+                    pending);
+    }
+  }
+  else if (!scan_spec.cell_intervals.empty()) {
+    foreach(const CellInterval &ci, scan_spec.cell_intervals) {
+      specs.push_back(ScanSpec());
+      scan_spec.base_copy(specs.back());
+      specs.back().cell_intervals.push_back(ci);
+      locate_pieces(m_range_locator, loc_cache, &table, specs.size()-1,
+                    ci.start_row ? ci.start_row : "",
+                    ci.end_row ? ci.end_row : Key::END_ROW_MARKER, timer,
+                    false, pending);
+    }
+  }
+  else {
+    specs.push_back(ScanSpec());
+    scan_spec.base_copy(specs.back());
+    locate_pieces(m_range_locator, loc_cache, &table, 0, "",
+                  Key::END_ROW_MARKER, timer, false, pending);
+  }
+
+  while (!pending.empty()) {
+    std::vector<AggregatePiece> retry;
+    size_t window = scan_spec.parallel > 1 ? scan_spec.parallel
+                                           : AGGREGATE_WINDOW;
+    int last_error = Error::OK;
+
+    for (size_t first=0; first<pending.size(); first+=window) {
+      size_t last = std::min(first + window, pending.size());
+      std::vector<DispatchHandlerPtr> handlers(last - first);
+
+      range_server.set_default_timeout(timer.remaining());
+      for (size_t i=first; i<last; i++) {
+        RangeSpec range;
+        range.start_row = pending[i].info.start_row.c_str();
+        range.end_row = pending[i].info.end_row.c_str();
+        handlers[i-first] = new DispatchHandlerSynchronizer();
+        try {
+          range_server.aggregate_scan(pending[i].addr, table, range,
+              specs[pending[i].interval], pending[i].resume.c_str(),
+              handlers[i-first].get());
+        }
+        catch (Exception &e) {
+          if (!retryable(e.code()))
+            HT_THROW2(e.code(), e, "Problem issuing aggregate_scan()");
+          last_error = e.code();
+          handlers[i-first] = 0;
+          retry.push_back(pending[i]);
+        }
+      }
+
+      // collect the partial results
+      for (size_t i=first; i<last; i++) {
+        DispatchHandlerSynchronizer *sync_handler =
+            static_cast<DispatchHandlerSynchronizer *>(handlers[i-first].get());
+        AggregatePiece piece = pending[i];
+        EventPtr event_ptr;
+        int error;
+
+        if (sync_handler == 0)
+          continue;
+
+        if (sync_handler->wait_for_reply(event_ptr)) {
+          ScanAggregate partial;
+          String resume = piece.resume;
+          RangeServerProtocol::decode_aggregate_scan_response(event_ptr,
+              partial, piece.resume);
+          // a resume row that does not advance within the range would loop
+          if (!piece.resume.empty()
+              && (piece.resume.compare(resume) <= 0
+                  || piece.resume.compare(piece.info.end_row) > 0))
+            HT_THROWF(Error::PROTOCOL_ERROR, "aggregate_scan() on %s[%s..%s] "
+                      "returned bad resume row '%s'", table.name,
+                      piece.info.start_row.c_str(),
+                      piece.info.end_row.c_str(), piece.resume.c_str());
+          result.merge(partial);
+          // not done with the range yet, continue in a later window
+          if (!piece.resume.empty())
+            pending.push_back(piece);
+          continue;
+        }
+        error = Protocol::response_code(event_ptr);
+        if (!retryable(error))
+          HT_THROWF(error, "aggregate_scan() on %s[%s..%s] failed - %s",
+                    table.name, piece.info.start_row.c_str(),
+                    piece.info.end_row.c_str(),
+                    Protocol::string_format_message(event_ptr).c_str());
+        if (error == Error::RANGESERVER_GENERATION_MISMATCH)
+          refresh(table, schema);
+        last_error = error;
+        m_range_locator->invalidate(&table, piece.from.c_str());
+        // rows before the resume row have been counted
+        if (!piece.resume.empty())
+          piece.from = piece.resume;
+        retry.push_back(piece);
+      }
+    }
+
+    if (retry.empty())
+      break;
+
+    if (timer.remaining() <= 1000)
+      HT_THROWF(Error::REQUEST_TIMEOUT, "aggregate() on %s unable to complete "
+                "within %d ms (last error: %s)", table.name,
+                (int)timer.duration(), Error::get_text(last_error));
+    poll(0, 0, 1000);
+
+    pending.clear();
+    foreach(const AggregatePiece &piece, retry) {
+      size_t first_new = pending.size();
+      locate_pieces(m_range_locator, loc_cache, &table, piece.interval,
+                    piece.from, piece.to, timer, true, pending);
+      if (pending.size() > first_new)
+        pending[first_new].resume = piece.resume;
+    }
+  }
+}
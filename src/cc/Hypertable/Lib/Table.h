@@ -27,8 +27,10 @@
 
 #include "AsyncComm/ApplicationQueue.h"
 
+#include "Cells.h"
 #include "Schema.h"
 #include "RangeLocator.h"
+#include "ScanAggregate.h"
 #include "Types.h"
 
 namespace Hyperspace {
@@ -81,6 +83,38 @@ namespace Hypertable {
                                  uint32_t timeout_ms = 0,
                                  bool retry_table_not_found = false);
 
+    /**
+     * Fetches the cells of a set of rows.  The rows are grouped by the
+     * range that holds them and each RangeServer gets a single batched
+     * lookup, all sent in parallel.  Cells are returned in row order.
+     *
+     * @param rows row keys to look up (duplicates are ignored)
+     * @param scan_spec columns, versions and time interval to return; must
+     *        not have row or cell intervals
+     * @param cells receives the cells found
+     * @param timeout_ms maximum time in milliseconds to allow the lookup
+     *        to take before throwing an exception
+     */
+    void get_cells(const std::vector<String> &rows, const ScanSpec &scan_spec,
+                   CellsBuilder &cells, uint32_t timeout_ms = 0);
+
+    /**
+     * Computes the ScanAggregate (cell and row counts, numeric sum, min and
+     * max of the values) of the cells selected by a scan spec without
+     * returning the cells.  Each range computes its part and the results
+     * are merged here; ranges are scanned in parallel, ScanSpec::parallel
+     * (or a small default number) at a time.  With keys_only, values
+     * are not read and only cells and rows are counted.  Rows selected by
+     * more than one interval are counted once per interval.
+     *
+     * @param scan_spec scan specification; must not have a row limit
+     * @param result receives the aggregate
+     * @param timeout_ms maximum time in milliseconds to allow the scan
+     *        to take before throwing an exception
+     */
+    void aggregate(const ScanSpec &scan_spec, ScanAggregate &result,
+                   uint32_t timeout_ms = 0);
+
     void get_identifier(TableIdentifier *table_id_p) {
       memcpy(table_id_p, &m_table, sizeof(TableIdentifier));
     }
@@ -26,6 +26,7 @@
 #include "Common/String.h"
 
 #include "Defaults.h"
+#include "Key.h"
 #include "Table.h"
 #include "TableScanner.h"
 
@@ -42,7 +43,12 @@ using namespace Hypertable;
 TableScanner::TableScanner(Comm *comm, Table *table,
     RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
     uint32_t timeout_ms, bool retry_table_not_found)
-  : m_eos(false), m_scanneri(0), m_rows_seen(0) {
+  : m_comm(comm), m_table(table), m_range_locator(range_locator),
+    m_scan_spec_builder(scan_spec), m_timeout_ms(timeout_ms),
+    m_retry_table_not_found(retry_table_not_found), m_eos(false),
+    m_scanneri(0), m_rows_seen(0), m_parallel(scan_spec.parallel),
+    m_unordered(scan_spec.unordered), m_selected(false), m_intervali(0),
+    m_split(false) {
 
   HT_ASSERT(timeout_ms);
 
@@ -50,7 +56,18 @@ TableScanner::TableScanner(Comm *comm, Table *table,
   ScanSpec interval_scan_spec;
   Timer timer(timeout_ms);
 
-  if (scan_spec.row_intervals.empty()) {
+  if (m_parallel > 1) {
+    SchemaPtr schema;
+    table->get(m_table_identifier, schema);
+    // start the first window of scans asynchronously
+    while (m_interval_scanners.size() < m_parallel && next_interval(timer)) {
+      ri_scanner = new IntervalScanner(comm, table, range_locator,
+          m_interval_spec, timeout_ms, retry_table_not_found,
+          &m_ready_mutex, &m_ready_cond);
+      m_interval_scanners.push_back(ri_scanner);
+    }
+  }
+  else if (scan_spec.row_intervals.empty()) {
     if (scan_spec.cell_intervals.empty()) {
       ri_scanner = new IntervalScanner(comm, table, range_locator, scan_spec,
                                        timeout_ms, retry_table_not_found);
@@ -79,7 +96,15 @@ TableScanner::TableScanner(Comm *comm, Table *table,
 }
 
 
+TableScanner::~TableScanner() {
+  m_interval_scanners.clear();
+  // wait for any reply handler still signalling m_ready_cond
+  ScopedLock lock(m_ready_mutex);
+}
+
+
 bool TableScanner::next(Cell &cell) {
+  int32_t row_limit = m_scan_spec_builder.get().row_limit;
 
   if (m_eos)
     return false;
@@ -91,10 +116,25 @@ bool TableScanner::next(Cell &cell) {
   }
 
   do {
+    if (m_parallel > 1 && !m_selected) {
+      if (!select_scanner())
+        break;
+      m_interval_scanners[m_scanneri]->set_rows_seen(m_rows_seen);
+    }
+
     if (m_interval_scanners[m_scanneri]->next(cell))
       return true;
 
-    m_rows_seen += m_interval_scanners[m_scanneri]->get_rows_seen();
+    m_rows_seen = m_interval_scanners[m_scanneri]->get_rows_seen();
+
+    if (row_limit > 0 && m_rows_seen >= row_limit)
+      break;
+
+    if (m_parallel > 1) {
+      m_interval_scanners.erase(m_interval_scanners.begin() + m_scanneri);
+      m_selected = false;
+      continue;
+    }
 
     m_scanneri++;
 
@@ -109,6 +149,108 @@ bool TableScanner::next(Cell &cell) {
 }
 
 
+/**
+ * Tops up the window of in-flight ranges and picks the one to read next:
+ * the first in key order or, if unordered, the first to have answered.
+ */
+bool TableScanner::select_scanner() {
+  Timer timer(m_timeout_ms);
+  IntervalScannerPtr ri_scanner;
+
+  while (m_interval_scanners.size() < m_parallel && next_interval(timer)) {
+    ri_scanner = new IntervalScanner(m_comm, m_table, m_range_locator,
+        m_interval_spec, m_timeout_ms, m_retry_table_not_found,
+        &m_ready_mutex, &m_ready_cond);
+    m_interval_scanners.push_back(ri_scanner);
+  }
+
+  if (m_interval_scanners.empty())
+    return false;
+
+  m_scanneri = 0;
+
+  if (m_unordered) {
+    ScopedLock lock(m_ready_mutex);
+    while (true) {
+      for (m_scanneri = 0; m_scanneri < m_interval_scanners.size();
+           m_scanneri++)
+        if (m_interval_scanners[m_scanneri]->ready())
+          break;
+      if (m_scanneri < m_interval_scanners.size())
+        break;
+      m_ready_cond.wait(lock);
+    }
+  }
+
+  m_selected = true;
+  return true;
+}
+
+
+/**
+ * Sets m_interval_spec to the next piece of the scan: a cell interval, or
+ * the part of a row interval that falls into a single range.
+ */
+bool TableScanner::next_interval(Timer &timer) {
+  const ScanSpec &ss = m_scan_spec_builder.get();
+  RowInterval ri("", false, Key::END_ROW_MARKER, false);
+
+  ss.base_copy(m_interval_spec);
+
+  if (!ss.cell_intervals.empty()) {
+    if (m_intervali == ss.cell_intervals.size())
+      return false;
+    m_interval_spec.cell_intervals.push_back(
+        ss.cell_intervals[m_intervali++]);
+    return true;
+  }
+
+  if (!ss.row_intervals.empty()) {
+    if (m_intervali == ss.row_intervals.size())
+      return false;
+    ri = ss.row_intervals[m_intervali];
+    if (ri.start == 0)
+      ri.start = "";
+    if (ri.end == 0)
+      ri.end = Key::END_ROW_MARKER;
+  }
+  else if (m_intervali)
+    return false;
+
+  // pieces after the first start right after the previous range
+  if (m_split) {
+    m_piece_start = m_split_row;
+    ri.start_inclusive = false;
+  }
+  else
+    m_piece_start = ri.start;
+
+  String row = m_piece_start;
+  if (!ri.start_inclusive)
+    row.append(1, 1);
+
+  m_range_locator->find_loop(&m_table_identifier, row.c_str(), &m_range_info,
+                             timer, false);
+
+  if (m_range_info.end_row == Key::END_ROW_MARKER
+      || strcmp(ri.end, m_range_info.end_row.c_str()) <= 0) {
+    m_piece_end = ri.end;
+    m_split = false;
+    m_intervali++;
+  }
+  else {
+    m_piece_end = m_range_info.end_row;
+    ri.end_inclusive = true;
+    m_split_row = m_range_info.end_row;
+    m_split = true;
+  }
+
+  m_interval_spec.row_intervals.push_back(RowInterval(m_piece_start.c_str(),
+      ri.start_inclusive, m_piece_end.c_str(), ri.end_inclusive));
+  return true;
+}
+
+
 void TableScanner::unget(const Cell &cell) {
   if (m_ungot.row_key)
     HT_THROW_(Error::DOUBLE_UNGET);
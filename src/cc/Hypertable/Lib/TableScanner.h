@@ -22,8 +22,11 @@
 #ifndef HYPERTABLE_TABLESCANNER_H
 #define HYPERTABLE_TABLESCANNER_H
 
+#include "Common/Mutex.h"
 #include "Common/ReferenceCount.h"
 
+#include <boost/thread/condition.hpp>
+
 #include "AsyncComm/DispatchHandlerSynchronizer.h"
 
 #include "Cells.h"
@@ -38,6 +41,14 @@ namespace Hypertable {
 
   class Table;
 
+  /**
+   * Scans a table, one IntervalScanner per row or cell interval of the
+   * scan spec.  When ScanSpec::parallel is greater than one, row intervals
+   * are further split at range boundaries and up to that many ranges are
+   * kept in flight at once; their results are returned either in key order
+   * or, with ScanSpec::unordered, one whole range at a time in the order
+   * the ranges respond.
+   */
   class TableScanner : public ReferenceCount {
 
   public:
@@ -57,6 +68,8 @@ namespace Hypertable {
                  const ScanSpec &scan_spec, uint32_t timeout_ms,
                  bool retry_table_not_found);
 
+    virtual ~TableScanner();
+
     /**
      * Get the next cell.
      *
@@ -78,12 +91,43 @@ namespace Hypertable {
     void unget(const Cell &cell);
 
   private:
+    bool select_scanner();
+    bool next_interval(Timer &timer);
+
+    Comm               *m_comm;
+    Table              *m_table;
+    RangeLocatorPtr     m_range_locator;
+    ScanSpecBuilder     m_scan_spec_builder;
+    TableIdentifierManaged m_table_identifier;
+    uint32_t            m_timeout_ms;
+    bool                m_retry_table_not_found;
+
+    // parallel mode: replies to any in-flight create_scanner signal this.
+    // Declared before m_interval_scanners so that they are destroyed after
+    // the interval scanners, which wait for their outstanding replies.
+    Mutex               m_ready_mutex;
+    boost::condition    m_ready_cond;
+
+    // all interval scanners, or the window of in-flight ranges when
+    // scanning in parallel
     std::vector<IntervalScannerPtr>  m_interval_scanners;
 
     bool      m_eos;
     size_t    m_scanneri;
     int64_t   m_rows_seen;
     Cell      m_ungot;
+
+    // parallel mode state
+    uint32_t  m_parallel;
+    bool      m_unordered;
+    bool      m_selected;
+    size_t    m_intervali;
+    bool      m_split;
+    String    m_split_row;
+    String    m_piece_start;
+    String    m_piece_end;
+    ScanSpec  m_interval_spec;
+    RangeLocationInfo m_range_info;
   };
 
   typedef intrusive_ptr<TableScanner> TableScannerPtr;
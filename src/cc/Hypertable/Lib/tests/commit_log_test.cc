@@ -23,6 +23,8 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <boost/thread/thread.hpp>
+
 #include "AsyncComm/Comm.h"
 
 #include "Common/Init.h"
@@ -55,6 +57,8 @@ namespace {
 
   void test1(DfsBroker::Client *dfs_client);
   void test_link(DfsBroker::Client *dfs_client);
+  void test_group_commit(DfsBroker::Client *dfs_client, const String &fname);
+  void test_pipelined(DfsBroker::Client *dfs_client);
   void write_entries(CommitLog *log, int num_entries, uint64_t *sump,
                      CommitLogBase *link_log);
   void read_entries(DfsBroker::Client *dfs_client, CommitLogReader *log_reader,
@@ -85,6 +89,8 @@ int main(int argc, char **argv) {
 
     //test1(dfs);
     test_link(dfs);
+    test_group_commit(dfs, "/hypertable/test_log/g");
+    test_pipelined(dfs);
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -202,6 +208,172 @@ namespace {
     HT_ASSERT(sum_read == sum_written);
   }
 
+  struct GroupCommitWriter {
+    GroupCommitWriter(CommitLog *log, uint32_t seed, uint64_t *sump,
+                      std::vector<uint64_t> *turns)
+      : m_log(log), m_seed(seed), m_sump(sump), m_turns(turns) { }
+    void operator()() {
+      int error;
+      uint32_t payload[100];
+      uint32_t limit;
+      DynamicBuffer dbuf;
+      uint64_t sum = 0;
+
+      for (size_t i=0; i<50; i++) {
+        limit = (rand_r(&m_seed) % 100) + 1;
+        for (size_t j=0; j<limit; j++) {
+          payload[j] = rand_r(&m_seed);
+          sum += payload[j];
+        }
+
+        dbuf.base = (uint8_t *)payload;
+        dbuf.ptr = dbuf.base + (4*limit);
+        dbuf.own = false;
+
+        uint64_t ticket = m_log->enqueue(dbuf, m_log->get_timestamp());
+        if ((error = m_log->wait_for_commit(ticket)) != Error::OK)
+          HT_THROW(error, "Problem writing to log file");
+
+        // only one writer at a time gets here, in ticket order
+        m_log->wait_for_turn(ticket);
+        m_turns->push_back(ticket);
+        m_log->end_turn(ticket);
+      }
+      *m_sump = sum;
+    }
+    CommitLog *m_log;
+    uint32_t m_seed;
+    uint64_t *m_sump;
+    std::vector<uint64_t> *m_turns;
+  };
+
+  void test_group_commit(DfsBroker::Client *dfs_client, const String &fname) {
+    CommitLog *log;
+    CommitLogReaderPtr log_reader_ptr;
+    uint64_t sums[8];
+    uint64_t sum_written = 0;
+    uint64_t sum_read = 0;
+    boost::thread_group threads;
+    GroupCommitStats stats;
+    std::vector<uint64_t> turns;
+
+    dfs_client->rmdir(fname);
+    dfs_client->mkdirs(fname);
+
+    log = new CommitLog(dfs_client, fname, properties);
+
+    for (uint32_t i=0; i<8; i++)
+      threads.create_thread(GroupCommitWriter(log, i+1, &sums[i], &turns));
+    threads.join_all();
+
+    HT_ASSERT(turns.size() == 8*50);
+    for (size_t i=0; i<turns.size(); i++)
+      HT_ASSERT(turns[i] == i);
+
+    log->get_group_commit_stats(stats);
+    HT_ASSERT(stats.blocks == 8*50);
+    HT_ASSERT(stats.batches > 0 && stats.batches <= stats.blocks);
+
+    for (size_t i=0; i<8; i++)
+      sum_written += sums[i];
+
+    delete log;
+
+    log_reader_ptr = new CommitLogReader(dfs_client, fname);
+    read_entries(dfs_client, log_reader_ptr.get(), &sum_read);
+
+    HT_ASSERT(sum_read == sum_written);
+  }
+
+  struct CountingCallback : CommitLogCallback {
+    CountingCallback() : count(0), errors(0) { }
+    virtual void committed(int error) {
+      ScopedLock lock(mutex);
+      if (error != Error::OK)
+        errors++;
+      count++;
+      cond.notify_all();
+    }
+    void wait_for(uint32_t n) {
+      ScopedLock lock(mutex);
+      while (count < n)
+        cond.wait(lock);
+    }
+    Mutex mutex;
+    boost::condition cond;
+    uint32_t count;
+    uint32_t errors;
+  };
+
+  void test_pipelined(DfsBroker::Client *dfs_client) {
+    String fname = "/hypertable/test_log/p";
+    CommitLog *log;
+    CommitLogReaderPtr log_reader_ptr;
+    CountingCallback cb;
+    uint32_t payload[100];
+    uint32_t limit;
+    DynamicBuffer dbuf;
+    uint64_t sum_written = 0;
+    uint64_t sum_read = 0;
+    int64_t roll_limit = properties->get_i64("Hypertable.CommitLog.RollLimit");
+    int32_t queue_max =
+        properties->get_i32("Hypertable.CommitLog.Pipelined.MaxQueueBytes");
+    std::vector<String> listing;
+
+    properties->set("Hypertable.CommitLog.Pipelined", true);
+
+    // group commit on top of the pipelined writer
+    test_group_commit(dfs_client, "/hypertable/test_log/pg");
+
+    dfs_client->rmdir(fname);
+    dfs_client->mkdirs(fname);
+
+    /**
+     * With a small roll limit and a small write queue, the writer thread
+     * rolls the log several times while the appends queued behind it are
+     * still outstanding
+     */
+    properties->set("Hypertable.RangeServer.CommitLog.RollLimit",
+                    (int64_t)1000);
+    properties->set("Hypertable.CommitLog.RollLimit", (int64_t)1000);
+    properties->set("Hypertable.CommitLog.Pipelined.MaxQueueBytes",
+                    (int32_t)2000);
+
+    log = new CommitLog(dfs_client, fname, properties);
+    HT_ASSERT(log->pipelined());
+
+    for (size_t i=0; i<200; i++) {
+      limit = (random() % 100) + 1;
+      for (size_t j=0; j<limit; j++) {
+        payload[j] = random();
+        sum_written += payload[j];
+      }
+      dbuf.base = (uint8_t *)payload;
+      dbuf.ptr = dbuf.base + (4*limit);
+      dbuf.own = false;
+      log->write_async(dbuf, log->get_timestamp(), (i % 10) == 0, &cb);
+    }
+    cb.wait_for(200);
+    HT_ASSERT(cb.errors == 0);
+
+    delete log;
+
+    properties->set("Hypertable.CommitLog.Pipelined", false);
+    properties->set("Hypertable.RangeServer.CommitLog.RollLimit", roll_limit);
+    properties->set("Hypertable.CommitLog.RollLimit", roll_limit);
+    properties->set("Hypertable.CommitLog.Pipelined.MaxQueueBytes",
+                    queue_max);
+
+    dfs_client->readdir(fname, listing);
+    HT_ASSERT(listing.size() > 4);
+
+    // read back across all of the fragments
+    log_reader_ptr = new CommitLogReader(dfs_client, fname);
+    read_entries(dfs_client, log_reader_ptr.get(), &sum_read);
+
+    HT_ASSERT(sum_read == sum_written);
+  }
+
   void
   write_entries(CommitLog *log, int num_entries, uint64_t *sump,
                 CommitLogBase *link_log) {
@@ -0,0 +1,166 @@
+/** -*- c++ -*-
+ * Copyright (C) 2008 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "Common/Usage.h"
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/Defaults.h"
+
+using namespace std;
+using namespace Hypertable;
+
+namespace {
+
+  const char *schema =
+  "<Schema>"
+  "  <AccessGroup name=\"default\">"
+  "    <ColumnFamily>"
+  "      <Name>data</Name>"
+  "    </ColumnFamily>"
+  "  </AccessGroup>"
+  "</Schema>";
+
+  const char *usage[] = {
+    "usage: get_cells_test",
+    "",
+    "Validates Table::get_cells() on a set of rows whose cells do not fit",
+    "in a single response.",
+    0
+  };
+
+  const size_t NUM_ROWS = 400;
+  const size_t BIG_ROW = 201;
+
+  /** Rows hold 1000 byte values, one of them holds more than a block */
+  size_t value_length(size_t i) {
+    return i == BIG_ROW ? 4 * DATA_TRANSFER_BLOCKSIZE : 1000;
+  }
+
+  void fill_value(size_t i, uint8_t *buf) {
+    size_t len = value_length(i);
+    for (size_t j=0; j<len; j++)
+      buf[j] = (uint8_t)((i + j) % 251);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  uint8_t *buf = new uint8_t [4 * DATA_TRANSFER_BLOCKSIZE];
+  uint8_t *expected = new uint8_t [4 * DATA_TRANSFER_BLOCKSIZE];
+  char keybuf[32];
+
+  if (argc > 1)
+    Usage::dump_and_exit(usage);
+
+  try {
+    Client *hypertable = new Client(argv[0], "./hypertable.cfg");
+
+    TablePtr table_ptr;
+    TableMutatorPtr mutator_ptr;
+    KeySpec key;
+    ScanSpec scan_spec;
+    CellsBuilder cells;
+    std::vector<String> rows;
+    std::vector<size_t> wanted;
+
+    hypertable->drop_table("GetCellsTest", true);
+    hypertable->create_table("GetCellsTest", schema);
+
+    table_ptr = hypertable->open_table("GetCellsTest");
+
+    mutator_ptr = table_ptr->create_mutator();
+
+    key.column_family = "data";
+    key.column_qualifier = 0;
+    key.column_qualifier_len = 0;
+
+    for (size_t i=0; i<NUM_ROWS; i++) {
+      fill_value(i, buf);
+      sprintf(keybuf, "%05u", (unsigned)i);
+      key.row = keybuf;
+      key.row_len = strlen(keybuf);
+      mutator_ptr->set(key, buf, value_length(i));
+    }
+    mutator_ptr->flush();
+    mutator_ptr = 0;
+
+    /**
+     * Ask for every other row (about three blocks worth plus the big row),
+     * out of order, with duplicates and with rows that do not exist
+     */
+    for (size_t i=NUM_ROWS; i>0; i--) {
+      if ((i-1) % 2)
+        continue;
+      sprintf(keybuf, "%05u", (unsigned)(i-1));
+      rows.push_back(keybuf);
+      wanted.insert(wanted.begin(), i-1);
+    }
+    rows.push_back("00002");
+    rows.push_back("00002x");
+    rows.push_back("99999");
+    if (std::find(wanted.begin(), wanted.end(), BIG_ROW) == wanted.end()) {
+      sprintf(keybuf, "%05u", (unsigned)BIG_ROW);
+      rows.push_back(keybuf);
+      wanted.insert(std::lower_bound(wanted.begin(), wanted.end(), BIG_ROW),
+                    BIG_ROW);
+    }
+
+    table_ptr->get_cells(rows, scan_spec, cells);
+
+    const Cells &result = cells.get();
+
+    if (result.size() != wanted.size()) {
+      HT_ERRORF("Expected %d cells, got %d", (int)wanted.size(),
+                (int)result.size());
+      _exit(1);
+    }
+
+    for (size_t i=0; i<wanted.size(); i++) {
+      sprintf(keybuf, "%05u", (unsigned)wanted[i]);
+      if (strcmp(result[i].row_key, keybuf)) {
+        HT_ERRORF("Cell %d has row '%s', expected '%s'", (int)i,
+                  result[i].row_key, keybuf);
+        _exit(1);
+      }
+      fill_value(wanted[i], expected);
+      if (result[i].value_len != value_length(wanted[i]) ||
+          memcmp(result[i].value, expected, result[i].value_len)) {
+        HT_ERRORF("Value mismatch in row '%s'", keybuf);
+        _exit(1);
+      }
+    }
+
+    table_ptr = 0;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+
+  _exit(0);
+}
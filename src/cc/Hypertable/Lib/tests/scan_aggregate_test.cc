@@ -0,0 +1,231 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "Hypertable/Lib/HqlParser.h"
+#include "Hypertable/Lib/ScanAggregate.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const int64_t INT64_HIGH = numeric_limits<int64_t>::max();
+  const int64_t INT64_LOW = numeric_limits<int64_t>::min();
+
+  int failures = 0;
+
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      cout << "FAILED: " << what << endl;
+      failures++;
+    }
+  }
+
+  bool add(ScanAggregate &a, const char *value) {
+    return a.add_value((const uint8_t *)value, strlen(value));
+  }
+
+  void test_add_value() {
+    ScanAggregate a;
+
+    check(add(a, "5"), "5 is numeric");
+    check(add(a, "-12"), "-12 is numeric");
+    check(add(a, "+7"), "+7 is numeric");
+    check(add(a, "0042"), "0042 is numeric");
+    check(!add(a, ""), "empty value is not numeric");
+    check(!add(a, "-"), "lone sign is not numeric");
+    check(!add(a, "12a"), "12a is not numeric");
+    check(!add(a, " 3"), "leading space is not numeric");
+    check(!add(a, "1.5"), "1.5 is not numeric");
+    check(!add(a, "99999999999999999999"), "out of range value is rejected");
+    check(!add(a, "123456789012345678901234"), "too long value is rejected");
+
+    check(a.numeric_cells == 4, "add_value numeric_cells");
+    check(a.sum == 42, "add_value sum");
+    check(a.min == -12, "add_value min");
+    check(a.max == 42, "add_value max");
+    check(!a.sum_overflow, "add_value no overflow");
+
+    a.clear();
+    check(add(a, "9223372036854775807"), "INT64_MAX is numeric");
+    check(add(a, "-9223372036854775808"), "INT64_MIN is numeric");
+    check(a.min == INT64_LOW && a.max == INT64_HIGH, "extreme min and max");
+    check(a.sum == -1 && !a.sum_overflow, "extremes sum without overflow");
+  }
+
+  void test_sum_overflow() {
+    ScanAggregate a;
+
+    add(a, "9223372036854775807");
+    add(a, "1");
+    check(a.sum_overflow && a.sum == INT64_HIGH, "positive overflow saturates");
+    add(a, "-5");
+    check(a.sum == INT64_HIGH, "saturated sum does not change");
+    check(a.numeric_cells == 3 && a.min == -5, "overflow keeps min exact");
+
+    a.clear();
+    add(a, "-9223372036854775808");
+    add(a, "-1");
+    check(a.sum_overflow && a.sum == INT64_LOW, "negative overflow saturates");
+
+    a.clear();
+    check(!a.sum_overflow && a.sum == 0, "clear resets overflow");
+  }
+
+  void test_merge() {
+    ScanAggregate a, b, empty;
+
+    a.cells = 3;
+    a.rows = 2;
+    add(a, "10");
+    add(a, "-4");
+    b.cells = 4;
+    b.rows = 1;
+    add(b, "100");
+
+    a.merge(empty);
+    check(a.cells == 3 && a.rows == 2 && a.numeric_cells == 2
+          && a.sum == 6 && a.min == -4 && a.max == 10, "merge of empty");
+
+    empty.merge(b);
+    check(empty.numeric_cells == 1 && empty.min == 100 && empty.max == 100
+          && empty.sum == 100, "merge into empty takes min and max");
+
+    a.merge(b);
+    check(a.cells == 7 && a.rows == 3 && a.numeric_cells == 3
+          && a.sum == 106 && a.min == -4 && a.max == 100, "merge");
+
+    ScanAggregate c, d;
+    add(c, "9223372036854775807");
+    add(d, "9223372036854775807");
+    c.merge(d);
+    check(c.sum_overflow && c.sum == INT64_HIGH, "merge overflow saturates");
+
+    ScanAggregate e, f;
+    add(e, "-9223372036854775808");
+    add(e, "-1");
+    add(f, "5");
+    f.merge(e);
+    check(f.sum_overflow && f.sum == INT64_LOW && f.min == INT64_LOW
+          && f.max == 5, "merge propagates overflow");
+  }
+
+  void test_serialization() {
+    ScanAggregate a, b;
+
+    a.cells = 1000000;
+    a.rows = 17;
+    add(a, "-9223372036854775808");
+    add(a, "-1");
+
+    size_t len = a.encoded_length();
+    uint8_t *buf = new uint8_t [len];
+    uint8_t *p = buf;
+    a.encode(&p);
+    check((size_t)(p - buf) == len, "encoded_length matches encode");
+
+    const uint8_t *q = buf;
+    size_t remain = len;
+    b.decode(&q, &remain);
+    check(remain == 0, "decode consumes the encoding");
+    check(b.cells == a.cells && b.rows == a.rows
+          && b.numeric_cells == a.numeric_cells && b.sum == a.sum
+          && b.min == a.min && b.max == a.max && b.sum_overflow,
+          "decode round trip");
+
+    q = buf;
+    remain = len - 1;
+    try {
+      b.decode(&q, &remain);
+      check(false, "truncated decode throws");
+    }
+    catch (Exception &e) {
+    }
+    delete [] buf;
+  }
+
+  void parse(const char *query, Hql::ParserState &state) {
+    Hql::Parser parser(state);
+    boost::spirit::classic::parse_info<> info =
+        boost::spirit::classic::parse(query, parser,
+                                      boost::spirit::classic::space_p);
+    if (!info.full) {
+      cout << "FAILED: parse of '" << query << "'" << endl;
+      failures++;
+    }
+  }
+
+  void test_count_parsing() {
+    {
+      Hql::ParserState state;
+      parse("SELECT COUNT(*) FROM t", state);
+      check(state.scan.count, "COUNT(*) sets count");
+      check(state.table_name == "t", "COUNT(*) table name");
+      check(state.scan.builder.get().columns.empty(), "COUNT(*) columns");
+    }
+    {
+      Hql::ParserState state;
+      parse("select count ( * ) from t where row >= 'a' and value = 'x'",
+            state);
+      const ScanSpec &ss = state.scan.builder.get();
+      check(state.scan.count, "count ( * ) with WHERE sets count");
+      check(ss.row_intervals.size() == 1, "count ( * ) row interval");
+      check(ss.predicates.size() == 1, "count ( * ) value predicate");
+    }
+    {
+      Hql::ParserState state;
+      parse("select count from t", state);
+      const ScanSpec &ss = state.scan.builder.get();
+      check(!state.scan.count, "count as a column name");
+      check(ss.columns.size() == 1 && !strcmp(ss.columns[0], "count"),
+            "count column selected");
+    }
+    {
+      Hql::ParserState state;
+      parse("select * from t", state);
+      check(!state.scan.count, "select * does not count");
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  test_add_value();
+  test_sum_overflow();
+  test_merge();
+  test_serialization();
+  test_count_parsing();
+
+  if (failures)
+    return 1;
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -36,5 +36,5 @@ int ResponseCallbackGetSchema::response(const char *schema) {
   CommBufPtr cbp(new CommBuf(header, 4 + encoded_length_vstr(schema)));
   cbp->append_i32(Error::OK);
   cbp->append_vstr(schema);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "Common/Error.h"
+#include "Common/Stopwatch.h"
 #include "Common/md5.h"
 
 #include "AccessGroup.h"
@@ -41,6 +42,48 @@
 
 using namespace Hypertable;
 
+namespace {
+
+  double mb_per_sec(uint64_t bytes, double seconds) {
+    if (seconds <= 0.0)
+      return 0.0;
+    return (double)bytes / (seconds * 1048576.0);
+  }
+
+  /**
+   * Formats the throughput of each stage of a compaction.  The rates of
+   * the pooled stages are for the whole pool, i.e. the busy time of all
+   * workers is divided by the number of workers.
+   */
+  String format_compaction_stats(uint64_t cells, uint64_t bytes,
+      double merge_elapsed, CompactionPipeline *pipeline) {
+    String str = format("%llu cells, %.1f MB", (Llu)cells,
+                        (double)bytes / 1048576.0);
+
+    if (pipeline) {
+      CompactionPipeline::Stats stats;
+      pipeline->get_stats(stats);
+      double threads = (double)stats.threads;
+      double merge_busy = merge_elapsed - stats.stall;
+      if (merge_busy < 0.0)
+        merge_busy = 0.0;
+      str += format("; inflate %.1f MB/s, merge %.1f MB/s, deflate %.1f MB/s,"
+                    " write %.1f MB/s (%u pipeline threads, merge stalled "
+                    "%.2fs of %.2fs)",
+                    mb_per_sec(stats.inflate.bytes, stats.inflate.busy/threads),
+                    mb_per_sec(bytes, merge_busy),
+                    mb_per_sec(stats.deflate.bytes, stats.deflate.busy/threads),
+                    mb_per_sec(stats.write.bytes, stats.write.busy),
+                    (unsigned)stats.threads, stats.stall, merge_elapsed);
+    }
+    else
+      str += format("; merge %.1f MB/s", mb_per_sec(bytes, merge_elapsed));
+
+    return str;
+  }
+
+}
+
 
 AccessGroup::AccessGroup(const TableIdentifier *identifier,
     SchemaPtr &schema, Schema::AccessGroup *ag, const RangeSpec *range)
@@ -59,7 +102,12 @@ AccessGroup::AccessGroup(const TableIdentifier *identifier,
   m_end_row = range->end_row;
   m_range_name = m_table_name + "[" + m_start_row + ".." + m_end_row + "]";
   m_full_name = m_range_name + "(" + m_name + ")";
-  m_cell_cache = new CellCache();
+
+  assert(Config::properties); // requires Config::init* first
+  m_cell_cache_type = CellCache::parse_map_type(ag->cell_cache.size() ?
+      ag->cell_cache : Config::get_str("Hypertable.RangeServer.AccessGroup"
+      ".CellCache.Type"));
+  m_cell_cache = new CellCache(m_cell_cache_type);
 
   foreach(Schema::ColumnFamily *cf, ag->columns)
     m_column_families.insert(cf->id);
@@ -188,6 +236,10 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
 
       for (size_t i=0; i<m_stores.size(); ++i) {
 
+        // Skip stores whose timestamps fall outside the scan's time interval
+        if (!m_stores[i]->may_contain_time_interval(scan_context->time_interval))
+          continue;
+
         // Query bloomfilter only if it is enabled and a start row has been specified
         // (ie query is not something like select bar from foo;)
 
@@ -370,7 +422,7 @@ void AccessGroup::add_cell_store(CellStorePtr &cellstore, uint32_t id) {
     CellListScannerPtr scanner = cellstore->create_scanner(scan_context);
     ByteString key, value;
     Key key_comps;
-    m_cell_cache = new CellCache();
+    m_cell_cache = new CellCache(m_cell_cache_type);
     while (scanner->get(key_comps, value)) {
       m_cell_cache->add(key_comps, value);
       scanner->forward();
@@ -399,7 +451,9 @@ void AccessGroup::run_compaction(bool major) {
   size_t tableidx = 1;
   CellStorePtr cellstore;
   CellCachePtr filtered_cache;
+  CompactionPipelinePtr pipeline;
   String metadata_key_str;
+  String stats_str;
 
   try {
 
@@ -468,13 +522,20 @@ void AccessGroup::run_compaction(bool major) {
                             m_table_name.c_str(), m_name.c_str(), hash_str,
                             m_next_cs_id++);
 
-    cellstore = new CellStoreV1(Global::dfs);
+    CellStoreV1 *new_store = new CellStoreV1(Global::dfs);
+    cellstore = new_store;
     int64_t max_num_entries = 0;
 
+    if (Global::compaction_pipeline_pool) {
+      pipeline = new CompactionPipeline(Global::compaction_pipeline_pool,
+                                        Global::compaction_pipeline_queue_depth);
+      new_store->set_compaction_pipeline(pipeline);
+    }
 
     {
       ScopedLock lock(m_mutex);
       ScanContextPtr scan_context = new ScanContext(m_schema);
+      scan_context->pipeline = pipeline;
 
       max_num_entries = m_immutable_cache->size();
 
@@ -482,7 +543,7 @@ void AccessGroup::run_compaction(bool major) {
         MergeScanner *mscanner = new MergeScanner(scan_context, false);
         scanner = mscanner;
         mscanner->add_scanner(m_immutable_cache->create_scanner(scan_context));
-        filtered_cache = new CellCache();
+        filtered_cache = new CellCache(m_cell_cache_type);
       }
       else if (major || tableidx < m_stores.size()) {
         bool return_everything = (major) ? false : (tableidx > 0);
@@ -503,15 +564,26 @@ void AccessGroup::run_compaction(bool major) {
 
     cellstore->create(cs_file.c_str(), max_num_entries, m_cellstore_props);
 
+    uint64_t cells = 0;
+    uint64_t bytes = 0;
+    Stopwatch merge_stopwatch;
+
     while (scanner->get(key, value)) {
       cellstore->add(key, value);
       if (m_in_memory)
         filtered_cache->add(key, value);
+      cells++;
+      bytes += key.length + value.length();
       scanner->forward();
     }
 
+    double merge_elapsed = merge_stopwatch.elapsed();
+
     cellstore->finalize(&m_identifier);
 
+    stats_str = format_compaction_stats(cells, bytes, merge_elapsed,
+                                        pipeline.get());
+
     /**
      * Install new CellCache and CellStore and update Live file tracker
      */
@@ -577,8 +649,8 @@ void AccessGroup::run_compaction(bool major) {
 
     m_earliest_cached_revision_saved = TIMESTAMP_MAX;
 
-    HT_INFOF("Finished Compaction of %s(%s)", m_range_name.c_str(),
-             m_name.c_str());
+    HT_INFOF("Finished Compaction of %s(%s) (%s)", m_range_name.c_str(),
+             m_name.c_str(), stats_str.c_str());
 
   }
   catch (Exception &e) {
@@ -633,7 +705,7 @@ void AccessGroup::shrink(String &split_row, bool drop_high) {
 
     m_file_tracker.change_range(m_start_row, m_end_row);
 
-    new_cell_cache = new CellCache();
+    new_cell_cache = new CellCache(m_cell_cache_type);
     new_cell_cache->lock();
 
     m_cell_cache = new_cell_cache;
@@ -715,7 +787,7 @@ void AccessGroup::initiate_compaction() {
   HT_ASSERT(!m_immutable_cache);
   m_immutable_cache = m_cell_cache;
   m_immutable_cache->freeze();
-  m_cell_cache = new CellCache();
+  m_cell_cache = new CellCache(m_cell_cache_type);
   m_earliest_cached_revision_saved = m_earliest_cached_revision;
   m_earliest_cached_revision = TIMESTAMP_MAX;
 }
@@ -743,7 +815,7 @@ void AccessGroup::merge_caches() {
 
   Key key;
   ByteString value;
-  CellCachePtr merged_cache = new CellCache();
+  CellCachePtr merged_cache = new CellCache(m_cell_cache_type);
   ScanContextPtr scan_context = new ScanContext(m_schema);
   CellListScannerPtr scanner = m_immutable_cache->create_scanner(scan_context);
   while (scanner->get(key, value)) {
@@ -191,6 +191,7 @@ namespace Hypertable {
     LiveFileTracker      m_file_tracker;
     bool                 m_recovering;
     bool                 m_bloom_filter_disabled;
+    CellCache::MapType   m_cell_cache_type;
 
   };
   typedef boost::intrusive_ptr<AccessGroup> AccessGroupPtr;
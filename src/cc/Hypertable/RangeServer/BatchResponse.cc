@@ -0,0 +1,51 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include "BatchResponse.h"
+
+using namespace Hypertable;
+
+
+/**
+ * The response holds Error::OK, the number of responses and their payload
+ * lengths, followed by the payloads (referenced, not copied).
+ */
+void BatchResponse::send() {
+  CommHeader header;
+  CommBuf::SegmentVector segments;
+  int error;
+
+  header.initialize_from_request_header(m_event->header);
+  foreach(CommBufPtr &response, m_responses)
+    response->get_payload_segments(segments);
+
+  CommBufPtr cbp(new CommBuf(header, 8 + 4 * m_responses.size(), segments));
+  cbp->append_i32(Error::OK);
+  cbp->append_i32(m_responses.size());
+  foreach(CommBufPtr &response, m_responses)
+    cbp->append_i32(response->header.total_len
+                    - response->header.encoded_length());
+
+  if ((error = send_response(cbp)) != Error::OK)
+    HT_ERRORF("Problem sending batch response - %s", Error::get_text(error));
+}
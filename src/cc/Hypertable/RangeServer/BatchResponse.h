@@ -0,0 +1,130 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_BATCHRESPONSE_H
+#define HYPERTABLE_BATCHRESPONSE_H
+
+#include <vector>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/ReferenceCount.h"
+#include "Common/atomic.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/Event.h"
+#include "AsyncComm/Protocol.h"
+
+namespace Hypertable {
+
+  /**
+   * Collects the responses to the requests of one batch and sends them
+   * back once all of them are in.
+   */
+  class BatchResponse : public ReferenceCount {
+  public:
+    BatchResponse(Comm *comm, EventPtr &event, size_t count)
+      : m_comm(comm), m_event(event), m_responses(count) {
+      atomic_set(&m_outstanding, count);
+    }
+
+    virtual ~BatchResponse() { }
+
+    EventPtr &get_event() { return m_event; }
+
+    /**
+     * Records the response to request <code>index</code> of the batch.
+     * The batch response is sent when the last one comes in.
+     *
+     * @param index position of the request in the batch
+     * @param cbp response message
+     */
+    void set_response(size_t index, CommBufPtr &cbp) {
+      m_responses[index] = cbp;
+      if (atomic_dec_and_test(&m_outstanding))
+        send();
+    }
+
+  protected:
+    /**
+     * Sends the assembled batch response to the client.
+     *
+     * @param cbp batch response message
+     * @return Error::OK on success or error code on failure
+     */
+    virtual int send_response(CommBufPtr &cbp) {
+      return m_comm->send_response(m_event->addr, cbp);
+    }
+
+  private:
+    void send();
+
+    Comm                   *m_comm;
+    EventPtr                m_event;
+    std::vector<CommBufPtr> m_responses;
+    atomic_t                m_outstanding;
+  };
+
+  typedef intrusive_ptr<BatchResponse> BatchResponsePtr;
+
+  /**
+   * Response callback for one request of a batch.  The response goes to
+   * the BatchResponse instead of the client.  A request that ends without
+   * a response gets an error response, so the batch always completes.
+   */
+  template <class CallbackT>
+  class BatchPartCallback : public CallbackT {
+  public:
+    BatchPartCallback(Comm *comm, BatchResponse *batch, size_t index)
+      : CallbackT(comm, batch->get_event()), m_batch(batch), m_index(index),
+        m_responded(false) { }
+
+    virtual ~BatchPartCallback() {
+      if (!m_responded) {
+        CommHeader header;
+        header.initialize_from_request_header(this->m_event_ptr->header);
+        CommBufPtr cbp(Hypertable::Protocol::create_error_message(header,
+            Error::FAILED_EXPECTATION, "No response to batched request"));
+        m_batch->set_response(m_index, cbp);
+      }
+    }
+
+  protected:
+    virtual int send_response(CommBufPtr &cbp) {
+      if (m_responded)
+        HT_WARN("Dropping second response to batched request");
+      else {
+        m_responded = true;
+        m_batch->set_response(m_index, cbp);
+      }
+      return Error::OK;
+    }
+
+  private:
+    BatchResponsePtr m_batch;
+    size_t           m_index;
+    bool             m_responded;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_BATCHRESPONSE_H
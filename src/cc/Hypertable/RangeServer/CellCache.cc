@@ -35,12 +35,62 @@
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+
+  template <typename MapT>
+  void get_split_rows_from_map(MapT &cell_map, std::vector<String> &split_rows) {
+    if (cell_map.size() > 2) {
+      typename MapT::const_iterator iter = cell_map.begin();
+      size_t i=0, mid = cell_map.size() / 2;
+      for (i=0; i<mid; i++)
+        ++iter;
+      split_rows.push_back((*iter).first.row());
+    }
+  }
+
+  template <typename MapT>
+  void get_rows_from_map(MapT &cell_map, std::vector<String> &rows) {
+    const char *row, *last_row = "";
+    for (typename MapT::const_iterator iter = cell_map.begin();
+         iter != cell_map.end(); ++iter) {
+      row = (*iter).first.row();
+      if (strcmp(row, last_row)) {
+        rows.push_back(row);
+        last_row = row;
+      }
+    }
+  }
 
-CellCache::CellCache()
+  template <typename MapT>
+  void populate_key_set_from_map(MapT &cell_map, KeySet &keys) {
+    Key key;
+    for (typename MapT::const_iterator iter = cell_map.begin();
+         iter != cell_map.end(); ++iter) {
+      key.load((*iter).first);
+      keys.insert(key);
+    }
+  }
+
+} // local namespace
+
+
+CellCache::CellCache(MapType type)
   : m_alloc(), m_cell_map(std::less<const SerializedKey>(), Alloc(m_alloc)),
-    m_deletes(0), m_collisions(0), m_frozen(false) {
+    m_skip_list(0), m_deletes(0), m_collisions(0), m_frozen(false) {
   assert(Config::properties); // requires Config::init* first
   m_alloc.set_bufsize( (size_t)Config::get_i32("Hypertable.RangeServer.AccessGroup.CellCache.PageSize") );
+  if (type == SKIPLIST)
+    m_skip_list = new CellSkipList(m_alloc);
+}
+
+
+CellCache::MapType CellCache::parse_map_type(const String &name) {
+  if (name == "map")
+    return MAP;
+  else if (name == "skiplist")
+    return SKIPLIST;
+  HT_THROWF(Error::CONFIG_BAD_VALUE, "Unknown cell cache type '%s' "
+            "(expected map|skiplist)", name.c_str());
 }
 
 
@@ -60,7 +110,11 @@ void CellCache::add(const Key &key, const ByteString value) {
 
   value.write(ptr);
 
-  if (! m_cell_map.insert(CellMap::value_type(new_key, key.length)).second) {
+  bool inserted = m_skip_list ?
+    m_skip_list->insert(CellMap::value_type(new_key, key.length)).second :
+    m_cell_map.insert(CellMap::value_type(new_key, key.length)).second;
+
+  if (!inserted) {
     m_collisions++;
     HT_WARNF("Collision detected key insert (row = %s)", new_key.row());
   }
@@ -80,34 +134,39 @@ const char *CellCache::get_split_row() {
 
 
 void CellCache::get_split_rows(std::vector<std::string> &split_rows) {
-  ScopedLock lock(m_mutex);
-  if (m_cell_map.size() > 2) {
-    CellMap::const_iterator iter = m_cell_map.begin();
-    size_t i=0, mid = m_cell_map.size() / 2;
-    for (i=0; i<mid; i++)
-      ++iter;
-    split_rows.push_back((*iter).first.row());
+  if (m_skip_list)
+    get_split_rows_from_map(*m_skip_list, split_rows);
+  else {
+    ScopedLock lock(m_mutex);
+    get_split_rows_from_map(m_cell_map, split_rows);
   }
 }
 
 
 
 void CellCache::get_rows(std::vector<std::string> &rows) {
-  ScopedLock lock(m_mutex);
-  const char *row, *last_row = "";
-  for (CellMap::const_iterator iter = m_cell_map.begin();
-       iter != m_cell_map.end(); ++iter) {
-    row = (*iter).first.row();
-    if (strcmp(row, last_row)) {
-      rows.push_back(row);
-      last_row = row;
-    }
+  if (m_skip_list)
+    get_rows_from_map(*m_skip_list, rows);
+  else {
+    ScopedLock lock(m_mutex);
+    get_rows_from_map(m_cell_map, rows);
   }
 }
 
 
 
+void CellCache::populate_key_set(KeySet &keys) {
+  if (m_skip_list)
+    populate_key_set_from_map(*m_skip_list, keys);
+  else
+    populate_key_set_from_map(m_cell_map, keys);
+}
+
+
+
 CellListScanner *CellCache::create_scanner(ScanContextPtr &scan_ctx) {
   CellCachePtr cellcache(this);
-  return new CellCacheScanner(cellcache, scan_ctx);
+  if (m_skip_list)
+    return new CellCacheSkipListScanner(cellcache, *m_skip_list, 0, scan_ctx);
+  return new CellCacheScanner(cellcache, m_cell_map, &m_mutex, scan_ctx);
 }
@@ -34,6 +34,7 @@
 
 #include "CellCachePool.h"
 #include "CellCachePoolAllocator.h"
+#include "CellCacheSkipList.h"
 
 namespace Hypertable {
 
@@ -54,8 +55,15 @@ namespace Hypertable {
   class CellCache : public CellList {
 
   public:
-    CellCache();
-    virtual ~CellCache() { }
+    /**
+     * Underlying cell map implementation.  MAP is a std::map that readers
+     * and the writer serialize on through the cache mutex.  SKIPLIST is a
+     * CellSkipList, which scanners may traverse without taking the mutex.
+     */
+    enum MapType { MAP, SKIPLIST };
+
+    CellCache(MapType type = MAP);
+    virtual ~CellCache() { delete m_skip_list; }
     /**
      * Adds a key/value pair to the CellCache.  This method assumes that
      * the CellCache has been locked by a call to #lock.  Copies of
@@ -72,7 +80,7 @@ namespace Hypertable {
 
     virtual void get_rows(std::vector<std::string> &rows);
 
-    virtual int64_t get_total_entries() { return m_cell_map.size(); }
+    virtual int64_t get_total_entries() { return size(); }
 
     /** Creates a CellCacheScanner object that contains an shared pointer
      * (intrusive_ptr) to this CellCache.
@@ -82,7 +90,11 @@ namespace Hypertable {
     void lock()   { if (!m_frozen) m_mutex.lock(); }
     void unlock() { if (!m_frozen) m_mutex.unlock(); }
 
-    size_t size() { return m_cell_map.size(); }
+    size_t size() {
+      return m_skip_list ? m_skip_list->size() : m_cell_map.size();
+    }
+
+    MapType get_map_type() { return m_skip_list ? SKIPLIST : MAP; }
 
     /** Returns the amount of memory used by the CellCache.  This is the
      * summation of the lengths of all the keys and values in the map.
@@ -99,16 +111,13 @@ namespace Hypertable {
     void freeze() { m_frozen = true; }
     void unfreeze() { m_frozen = false; }
 
-    void populate_key_set(KeySet &keys) {
-      Key key;
-      for (CellMap::const_iterator iter = m_cell_map.begin();
-	   iter != m_cell_map.end(); ++iter) {
-	key.load((*iter).first);
-	keys.insert(key);
-      }
-    }
+    void populate_key_set(KeySet &keys);
 
-    friend class CellCacheScanner;
+    /**
+     * Parses a cell map type name ("map" or "skiplist"), throwing
+     * Error::CONFIG_BAD_VALUE if the name is not recognized.
+     */
+    static MapType parse_map_type(const String &name);
 
     typedef std::pair<const SerializedKey, uint32_t> Value;
     typedef CellCachePoolAllocator<Value> Alloc;
@@ -120,6 +129,7 @@ namespace Hypertable {
     Mutex              m_mutex;
     CellCachePool      m_alloc;
     CellMap            m_cell_map;
+    CellSkipList      *m_skip_list;
     uint32_t           m_deletes;
     uint32_t           m_collisions;
     bool               m_frozen;
@@ -31,20 +31,43 @@
 
 using namespace Hypertable;
 
+namespace {
+
+  /**
+   * Holds the given mutex for the lifetime of the object, or does nothing
+   * if the mutex is null.
+   */
+  class OptionalLock {
+  public:
+    OptionalLock(Mutex *mutex) : m_mutex(mutex) {
+      if (m_mutex)
+        m_mutex->lock();
+    }
+    ~OptionalLock() {
+      if (m_mutex)
+        m_mutex->unlock();
+    }
+  private:
+    Mutex *m_mutex;
+  };
+
+}
+
 /**
  *
  */
-CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
-                                   ScanContextPtr &scan_ctx)
+template <typename CellMapT>
+CellCacheScannerT<CellMapT>::CellCacheScannerT(CellCachePtr &cellcache,
+    CellMapT &cell_map, Mutex *mutex, ScanContextPtr &scan_ctx)
   : CellListScanner(scan_ctx), m_cell_cache_ptr(cellcache),
-    m_cell_cache_mutex(cellcache->m_mutex), m_cur_value(0), m_in_deletes(false),
-    m_eos(false), m_keys_only(false) {
-  ScopedLock lock(m_cell_cache_mutex);
+    m_cell_map(cell_map), m_cell_cache_mutex(mutex), m_cur_value(0),
+    m_in_deletes(false), m_eos(false), m_keys_only(false) {
+  OptionalLock lock(m_cell_cache_mutex);
   DynamicBuffer current_buf;
   Key current;
   String tmp_str;
 
-  m_keys_only = (scan_ctx->spec) ? scan_ctx->spec->keys_only : false;
+  m_keys_only = scan_ctx->keys_only;
 
   current_buf.grow(scan_ctx->start_key.row_len +
                    scan_ctx->start_key.column_qualifier_len +
@@ -60,7 +83,7 @@ CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
    * ie, the scan contains a qualified column.
    */
   if (scan_ctx->has_cell_interval) {
-    CellCache::CellMap::iterator iter;
+    typename CellMapT::iterator iter;
 
     /**
      * Look for any DELETE_ROW records for this row and add them
@@ -72,8 +95,8 @@ CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
 
     current.serial.ptr = current_buf.base;
 
-    for (iter = m_cell_cache_ptr->m_cell_map.lower_bound(current.serial);
-         iter != m_cell_cache_ptr->m_cell_map.end(); ++iter) {
+    for (iter = m_cell_map.lower_bound(current.serial);
+         iter != m_cell_map.end(); ++iter) {
       current.load(iter->first);
       if (current.flag != FLAG_DELETE_ROW ||
           strcmp(current.row, scan_ctx->start_key.row))
@@ -91,8 +114,8 @@ CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
 
       current.serial.ptr = current_buf.base;
 
-      for (iter = m_cell_cache_ptr->m_cell_map.lower_bound(current.serial);
-           iter != m_cell_cache_ptr->m_cell_map.end(); ++iter) {
+      for (iter = m_cell_map.lower_bound(current.serial);
+           iter != m_cell_map.end(); ++iter) {
         current.load(iter->first);
         if (current.flag != FLAG_DELETE_COLUMN_FAMILY ||
             current.column_family_code != scan_ctx->start_key.column_family_code ||
@@ -103,11 +126,11 @@ CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
     }
   }
 
-  m_start_iter = m_cell_cache_ptr->m_cell_map.lower_bound(scan_ctx->start_serkey);
-  if (m_start_iter != m_cell_cache_ptr->m_cell_map.end())
-    m_end_iter = m_cell_cache_ptr->m_cell_map.lower_bound(scan_ctx->end_serkey);
+  m_start_iter = m_cell_map.lower_bound(scan_ctx->start_serkey);
+  if (m_start_iter != m_cell_map.end())
+    m_end_iter = m_cell_map.lower_bound(scan_ctx->end_serkey);
   else
-    m_end_iter = m_cell_cache_ptr->m_cell_map.end();
+    m_end_iter = m_cell_map.end();
   m_cur_iter = m_start_iter;
 
   if (!m_deletes.empty()) {
@@ -129,7 +152,8 @@ CellCacheScanner::CellCacheScanner(CellCachePtr &cellcache,
 }
 
 
-bool CellCacheScanner::get(Key &key, ByteString &value) {
+template <typename CellMapT>
+bool CellCacheScannerT<CellMapT>::get(Key &key, ByteString &value) {
 
   if (m_in_deletes) {
     m_cur_key.load( (*m_delete_iter).first );
@@ -149,8 +173,9 @@ bool CellCacheScanner::get(Key &key, ByteString &value) {
 
 
 
-void CellCacheScanner::forward() {
-  ScopedLock lock(m_cell_cache_mutex);
+template <typename CellMapT>
+void CellCacheScannerT<CellMapT>::forward() {
+  OptionalLock lock(m_cell_cache_mutex);
 
   if (m_in_deletes) {
     ++m_delete_iter;
@@ -172,3 +197,9 @@ void CellCacheScanner::forward() {
   }
   m_eos = true;
 }
+
+
+namespace Hypertable {
+  template class CellCacheScannerT<CellCache::CellMap>;
+  template class CellCacheScannerT<CellSkipList>;
+}
@@ -30,25 +30,34 @@
 namespace Hypertable {
 
   /**
-   * Provides a scanning interface to a CellCache.
+   * Provides a scanning interface to a CellCache.  CellMapT is the type of
+   * the cache's underlying cell map.  If a mutex is supplied, it is held
+   * while positioning and advancing the scanner; scanners over a
+   * CellSkipList pass none since the skip list supports lock-free readers.
    */
-  class CellCacheScanner : public CellListScanner {
+  template <typename CellMapT>
+  class CellCacheScannerT : public CellListScanner {
   public:
-    CellCacheScanner(CellCachePtr &cellcache, ScanContextPtr &scan_ctx);
-    virtual ~CellCacheScanner() { return; }
+    CellCacheScannerT(CellCachePtr &cellcache, CellMapT &cell_map,
+                      Mutex *mutex, ScanContextPtr &scan_ctx);
+    virtual ~CellCacheScannerT() { return; }
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
 
+    /** Cells live in the cache's pool until the cache goes away */
+    virtual ReferenceCount *get_pin() { return m_cell_cache_ptr.get(); }
+
     typedef std::map<const SerializedKey, uint32_t> CellCacheMap;
 
 
   private:
-    CellCache::CellMap::iterator   m_start_iter;
-    CellCache::CellMap::iterator   m_end_iter;
-    CellCache::CellMap::iterator   m_cur_iter;
+    typename CellMapT::iterator    m_start_iter;
+    typename CellMapT::iterator    m_end_iter;
+    typename CellMapT::iterator    m_cur_iter;
     CellCacheMap::iterator         m_delete_iter;
     CellCachePtr                   m_cell_cache_ptr;
-    Mutex                         &m_cell_cache_mutex;
+    CellMapT                      &m_cell_map;
+    Mutex                         *m_cell_cache_mutex;
     Key                            m_cur_key;
     ByteString                     m_cur_value;
     CellCacheMap                   m_deletes;
@@ -56,6 +65,9 @@ namespace Hypertable {
     bool                           m_eos;
     bool                           m_keys_only;
   };
+
+  typedef CellCacheScannerT<CellCache::CellMap> CellCacheScanner;
+  typedef CellCacheScannerT<CellSkipList> CellCacheSkipListScanner;
 }
 
 #endif // HYPERTABLE_CELLCACHESCANNER_H
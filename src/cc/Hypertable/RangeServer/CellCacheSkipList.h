@@ -0,0 +1,185 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_CELLCACHESKIPLIST_H
+#define HYPERTABLE_CELLCACHESKIPLIST_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "Common/atomic.h"
+
+#include "Hypertable/Lib/SerializedKey.h"
+
+#include "CellCachePool.h"
+
+namespace Hypertable {
+
+  /**
+   * Sorted map from SerializedKey to key length, implemented as a skip list
+   * whose nodes are carved out of a CellCachePool.  It exposes the subset of
+   * the std::map interface used by CellCache and CellCacheScanner.
+   *
+   * Inserts must be serialized by the caller (single writer), but readers
+   * may traverse the list concurrently with an insert without holding any
+   * lock.  A node is fully initialized before it is linked in, and nodes are
+   * never unlinked; their memory goes away with the pool.
+   */
+  class CellSkipList {
+  public:
+    enum { MAX_HEIGHT = 12, BRANCHING = 4 };
+
+    typedef std::pair<const SerializedKey, uint32_t> value_type;
+
+  private:
+    struct Node {
+      value_type entry;
+      Node *volatile next[1];   // actually 'height' entries
+    };
+
+  public:
+    class iterator {
+    public:
+      iterator(Node *node = 0) : m_node(node) { }
+      const value_type &operator*() const { return m_node->entry; }
+      const value_type *operator->() const { return &m_node->entry; }
+      iterator &operator++() { m_node = load(m_node, 0); return *this; }
+      bool operator==(const iterator &other) const {
+        return m_node == other.m_node;
+      }
+      bool operator!=(const iterator &other) const {
+        return m_node != other.m_node;
+      }
+    private:
+      Node *m_node;
+    };
+    typedef iterator const_iterator;
+
+    CellSkipList(CellCachePool &pool)
+      : m_pool(pool), m_head(0), m_height(1), m_size(0), m_rnd(0xdeadbeef) {
+      m_head = new_node(value_type(SerializedKey(), 0), MAX_HEIGHT);
+    }
+
+    /**
+     * Inserts a copy of value (the key bytes themselves are not copied).
+     * Must not be called concurrently with another insert.
+     *
+     * @return pair whose second member is false if an equal key exists
+     */
+    std::pair<iterator, bool> insert(const value_type &value) {
+      Node *prev[MAX_HEIGHT];
+      Node *x = find_greater_or_equal(value.first, prev);
+
+      if (x && x->entry.first.compare(value.first) == 0)
+        return std::make_pair(iterator(x), false);
+
+      int height = random_height();
+      if (height > m_height) {
+        for (int i = m_height; i < height; i++)
+          prev[i] = m_head;
+        // readers that see the new height before the node find a null
+        // pointer at the new levels and simply descend
+        m_height = height;
+      }
+
+      x = new_node(value, height);
+      for (int i = 0; i < height; i++)
+        x->next[i] = prev[i]->next[i];
+
+      smp_wmb();  // node contents must be visible before the node itself
+
+      for (int i = 0; i < height; i++)
+        prev[i]->next[i] = x;
+
+      m_size++;
+      return std::make_pair(iterator(x), true);
+    }
+
+    /** Returns iterator to the first entry whose key is not less than key */
+    iterator lower_bound(const SerializedKey &key) const {
+      return iterator(find_greater_or_equal(key, 0));
+    }
+
+    iterator begin() const { return iterator(load(m_head, 0)); }
+    iterator end() const { return iterator(0); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+  private:
+    static Node *load(Node *node, int level) {
+      Node *next = node->next[level];
+      smp_rmb();
+      return next;
+    }
+
+    Node *new_node(const value_type &value, int height) {
+      size_t len = offsetof(Node, next) + height * sizeof(Node *);
+      len = (len + CCP_WORD_SIZE - 1) & ~(CCP_WORD_SIZE - 1);
+      Node *node = (Node *)m_pool.allocate(len, true);
+      new (&node->entry) value_type(value);
+      for (int i = 0; i < height; i++)
+        node->next[i] = 0;
+      return node;
+    }
+
+    Node *find_greater_or_equal(const SerializedKey &key, Node **prev) const {
+      Node *x = m_head;
+      int level = m_height - 1;
+
+      while (true) {
+        Node *next = load(x, level);
+        if (next && next->entry.first.compare(key) < 0)
+          x = next;
+        else {
+          if (prev)
+            prev[level] = x;
+          if (level == 0)
+            return next;
+          level--;
+        }
+      }
+    }
+
+    int random_height() {
+      int height = 1;
+      while (height < MAX_HEIGHT) {
+        m_rnd ^= m_rnd << 13;
+        m_rnd ^= m_rnd >> 17;
+        m_rnd ^= m_rnd << 5;
+        if (m_rnd % BRANCHING)
+          break;
+        height++;
+      }
+      return height;
+    }
+
+    CellCachePool   &m_pool;
+    Node            *m_head;
+    volatile int     m_height;
+    volatile size_t  m_size;
+    uint32_t         m_rnd;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_CELLCACHESKIPLIST_H
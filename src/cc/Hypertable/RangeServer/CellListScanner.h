@@ -40,6 +40,15 @@ namespace Hypertable {
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
 
+    /**
+     * Returns an object that keeps the value last returned by get() valid
+     * and unchanged for as long as a reference to it is held, even after
+     * the scanner has moved on or been destroyed.  This lets the value be
+     * sent to the client without being copied.  Returns 0 if the scanner
+     * cannot pin its cell memory.
+     */
+    virtual ReferenceCount *get_pin() { return 0; }
+
   protected:
     ScanContextPtr m_scan_context_ptr;
   };
@@ -115,6 +115,19 @@ namespace Hypertable {
      */
     virtual bool may_contain(ScanContextPtr &) = 0;
 
+    /**
+     * Returns false if nothing in this cell store can affect a scan over
+     * the given time interval (first <= timestamp < second).  Cell stores
+     * that do not record their timestamp range always return true.
+     *
+     * @param interval scan time interval
+     * @return true if cell store may contain relevant cells
+     */
+    virtual bool
+    may_contain_time_interval(const std::pair<int64_t, int64_t> &interval) {
+      return true;
+    }
+
     /**
      * Returns the disk used by this cell store.  If the cell store is opened
      * with a restricted range, then it returns an estimate of the disk used by
@@ -24,7 +24,7 @@
 
 #include <cassert>
 #include <iostream>
-#include <map>
+#include <vector>
 
 #include "Common/StaticBuffer.h"
 
@@ -33,47 +33,51 @@
 
 namespace Hypertable {
 
+  template <typename OffsetT> class CellStoreBlockIndexMap;
+
   /**
    * Provides an STL-style iterator on CellStoreBlockIndex objects.
    */
   template <typename OffsetT>
   class CellStoreBlockIndexIteratorMap {
   public:
-    typedef typename std::map<const SerializedKey, OffsetT>::iterator MapIteratorT;
-
-    CellStoreBlockIndexIteratorMap() { }
-    CellStoreBlockIndexIteratorMap(MapIteratorT iter) : m_iter(iter) { }
-    SerializedKey key() { return (*m_iter).first; }
-    int64_t value() { return (int64_t)(*m_iter).second; }
-    CellStoreBlockIndexIteratorMap &operator++() { ++m_iter; return *this; }
+    CellStoreBlockIndexIteratorMap() : m_index(0), m_pos(0) { }
+    CellStoreBlockIndexIteratorMap(const CellStoreBlockIndexMap<OffsetT> *index,
+                                   size_t pos) : m_index(index), m_pos(pos) { }
+    SerializedKey key() { return m_index->key_at(m_pos); }
+    int64_t value() { return (int64_t)m_index->offset_at(m_pos); }
+    CellStoreBlockIndexIteratorMap &operator++() { ++m_pos; return *this; }
     CellStoreBlockIndexIteratorMap operator++(int) {
       CellStoreBlockIndexIteratorMap<OffsetT> copy(*this);
       ++(*this);
       return copy;
     }
     bool operator==(const CellStoreBlockIndexIteratorMap &other) {
-      return m_iter == other.m_iter;
+      return m_pos == other.m_pos && m_index == other.m_index;
     }
     bool operator!=(const CellStoreBlockIndexIteratorMap &other) {
-      return m_iter != other.m_iter;
+      return !(*this == other);
     }
   protected:
-    MapIteratorT m_iter;
+    const CellStoreBlockIndexMap<OffsetT> *m_index;
+    size_t m_pos;
   };
 
 
   /**
-   *
+   * Block index of a cell store: the last key of each block and the
+   * block's file offset, in key order.  The keys stay where they are in
+   * the variable index buffer, which the index takes over; the index itself
+   * is just two flat arrays, the position of each key in that buffer and
+   * the block offsets, so loading it costs two allocations and a lookup is
+   * a binary search over a contiguous array.
    */
   template <typename OffsetT>
   class CellStoreBlockIndexMap {
   public:
     typedef typename Hypertable::CellStoreBlockIndexIteratorMap<OffsetT> iterator;
-    typedef typename std::map<const SerializedKey, OffsetT> MapT;
-    typedef typename std::map<const SerializedKey, OffsetT>::iterator MapIteratorT;
-    typedef typename std::map<const SerializedKey, OffsetT>::value_type value_type;
 
-    CellStoreBlockIndexMap() : m_disk_used(0) { }
+    CellStoreBlockIndexMap() : m_end_of_last_block(0), m_disk_used(0) { }
 
     void load(DynamicBuffer &fixed, DynamicBuffer &variable,int64_t end_of_data,
               const String &start_row="", const String &end_row="") {
@@ -86,6 +90,7 @@ namespace Hypertable {
       bool check_for_end_row = end_row != "";
 
       assert(variable.own);
+      HT_ASSERT(variable.size <= (size_t)UINT32_MAX);
 
       m_end_of_last_block = end_of_data;
 
@@ -93,6 +98,11 @@ namespace Hypertable {
       fixed.ptr = fixed.base;
       key_ptr   = m_keydata.base;
 
+      m_keys.clear();
+      m_offsets.clear();
+      m_keys.reserve(index_entries);
+      m_offsets.reserve(index_entries);
+
       for (size_t i=0; i<index_entries; ++i) {
 
         // variable portion
@@ -110,7 +120,7 @@ namespace Hypertable {
         }
         else if (check_for_end_row &&
                  strcmp(key.row(), end_row.c_str()) > 0) {
-          m_map.insert(m_map.end(), value_type(key, offset));
+          append(key, offset);
           if (i+1 < index_entries) {
             key.ptr = key_ptr;
             key_ptr += key.length();
@@ -119,21 +129,19 @@ namespace Hypertable {
           break;
         }
 
-        m_map.insert(m_map.end(), value_type(key, offset));
+        append(key, offset);
       }
 
       HT_ASSERT(key_ptr <= (m_keydata.base + m_keydata.size));
 
-      if (!m_map.empty()) {
+      if (!m_keys.empty()) {
 
         /** compute space covered by this index scope **/
-        m_disk_used = m_end_of_last_block - (*m_map.begin()).second;
+        m_disk_used = m_end_of_last_block - m_offsets.front();
 
         /** determine split key **/
-        MapIteratorT iter = m_map.begin();
-        for (size_t i=1; i<(m_map.size()+1)/2; ++iter,++i)
-          ;
-        m_middle_key = (*iter).first;
+        size_t middle = (m_keys.size() + 1) / 2;
+        m_middle_key = key_at(middle ? middle - 1 : 0);
       }
 
     }
@@ -143,15 +151,15 @@ namespace Hypertable {
       int64_t last_offset = 0;
       int64_t block_size;
       size_t i=0;
-      for (MapIteratorT iter = m_map.begin(); iter != m_map.end(); ++iter) {
+      for (size_t pos=0; pos<m_keys.size(); ++pos) {
         if (last_key) {
-          block_size = (*iter).second - last_offset;
+          block_size = m_offsets[pos] - last_offset;
           std::cout << i << ": offset=" << last_offset << " size=" << block_size
                     << " row=" << last_key.row() << "\n";
           i++;
         }
-        last_offset = (*iter).second;
-        last_key = (*iter).first;
+        last_offset = m_offsets[pos];
+        last_key = key_at(pos);
       }
       if (last_key) {
         block_size = m_end_of_last_block - last_offset;
@@ -163,36 +171,70 @@ namespace Hypertable {
 
     const SerializedKey middle_key() { return m_middle_key; }
 
-    size_t memory_used() { return m_keydata.size + (m_map.size() * 32); }
+    size_t memory_used() {
+      return m_keydata.size + m_keys.capacity() * sizeof(uint32_t)
+          + m_offsets.capacity() * sizeof(OffsetT);
+    }
 
     int64_t disk_used() { return m_disk_used; }
 
     int64_t end_of_last_block() { return m_end_of_last_block; }
 
     iterator begin() {
-      return iterator(m_map.begin());
+      return iterator(this, 0);
     }
 
     iterator end() {
-      return iterator(m_map.end());
+      return iterator(this, m_keys.size());
     }
 
+    /** Returns iterator to the first entry whose key is not less than k */
     iterator lower_bound(const SerializedKey& k) {
-      return iterator(m_map.lower_bound(k));
+      size_t lo = 0, hi = m_keys.size();
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (key_at(mid) < k)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return iterator(this, lo);
     }
 
+    /** Returns iterator to the first entry whose key is greater than k */
     iterator upper_bound(const SerializedKey& k) {
-      return iterator(m_map.upper_bound(k));
+      size_t lo = 0, hi = m_keys.size();
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (k < key_at(mid))
+          hi = mid;
+        else
+          lo = mid + 1;
+      }
+      return iterator(this, lo);
     }
 
     void clear() {
-      m_map.clear();
+      std::vector<uint32_t>().swap(m_keys);
+      std::vector<OffsetT>().swap(m_offsets);
       m_keydata.free();
       m_middle_key.ptr = 0;
     }
 
+    SerializedKey key_at(size_t pos) const {
+      return SerializedKey(m_keydata.base + m_keys[pos]);
+    }
+
+    OffsetT offset_at(size_t pos) const { return m_offsets[pos]; }
+
   private:
-    MapT m_map;
+    void append(const SerializedKey key, OffsetT offset) {
+      m_keys.push_back((uint32_t)(key.ptr - m_keydata.base));
+      m_offsets.push_back(offset);
+    }
+
+    std::vector<uint32_t> m_keys;     // key positions within m_keydata
+    std::vector<OffsetT> m_offsets;   // block offsets
     StaticBuffer m_keydata;
     SerializedKey m_middle_key;
     int64_t m_end_of_last_block;
@@ -41,6 +41,9 @@ namespace Hypertable {
     virtual ~CellStoreScanner();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual ReferenceCount *get_pin() {
+      return m_eos ? 0 : m_interval_scanners[m_interval_index]->get_pin();
+    }
 
   private:
     CellStorePtr              m_cellstore;
@@ -23,8 +23,11 @@
 #define HYPERTABLE_CELLSTORESCANNERINTERVAL_H
 
 #include "Common/ByteString.h"
+#include "Common/ReferenceCount.h"
 #include "Hypertable/Lib/Key.h"
 
+#include "Global.h"
+
 namespace Hypertable {
 
   class CellStoreScannerInterval {
@@ -32,14 +35,74 @@ namespace Hypertable {
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
     virtual ~CellStoreScannerInterval() { }
+
+    /** @see CellListScanner::get_pin */
+    virtual ReferenceCount *get_pin() { return 0; }
+
   protected:
     struct BlockInfo {
       int64_t offset;
       int64_t zlength;
       const uint8_t *base;
       const uint8_t *end;
+      bool cached;    // base is checked out of Global::block_cache
     };
 
+    /**
+     * Owns an inflated block.  The scanner holds a reference while the
+     * block is current and scan responses that reference cells of the
+     * block hold others; the block is checked back into the block cache,
+     * or freed, when the last one is dropped.
+     */
+    class BlockPin : public ReferenceCount {
+    public:
+      BlockPin(int file_id, const BlockInfo &block)
+        : m_file_id(file_id), m_offset(block.offset), m_base(block.base),
+          m_cached(block.cached) { }
+      virtual ~BlockPin() {
+        if (m_cached)
+          Global::block_cache->checkin(m_file_id, m_offset);
+        else
+          delete [] m_base;
+      }
+    private:
+      int m_file_id;
+      int64_t m_offset;
+      const uint8_t *m_base;
+      bool m_cached;
+    };
+    typedef intrusive_ptr<BlockPin> BlockPinPtr;
+
+    /**
+     * Puts a block just read and inflated into the block cache and checks
+     * it out.  If the cache already holds the block, the cached copy is
+     * used and block.base is freed.  If the cache has no room because its
+     * blocks are all in use, the block stays private to the scanner (not
+     * cached) and is freed when its pin is released.
+     *
+     * @param file_id block cache file id of the cell store
+     * @param block block whose base and cached fields get set
+     * @param lenp length of the block, set to the length of the cached
+     *        block if that is used instead
+     */
+    static void cache_block(int file_id, BlockInfo &block, uint32_t *lenp) {
+      uint8_t *base = (uint8_t *)block.base;
+      uint32_t len;
+
+      if (Global::block_cache->insert_and_checkout(file_id, block.offset,
+                                                   base, *lenp))
+        block.cached = true;
+      else if (Global::block_cache->checkout(file_id, block.offset, &base,
+                                             &len)) {
+        delete [] block.base;
+        block.base = base;
+        *lenp = len;
+        block.cached = true;
+      }
+      else
+        block.cached = false;
+    }
+
   };
 
 }
@@ -89,8 +89,7 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
 
 template <typename IndexT>
 CellStoreScannerIntervalBlockIndex<IndexT>::~CellStoreScannerIntervalBlockIndex() {
-  if (m_block.base != 0)
-    Global::block_cache->checkin(m_file_id, m_block.offset);
+  release_block();
   delete m_zcodec;
 }
 
@@ -157,7 +156,7 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block() {
 
   // If we're at the end of the current block, deallocate and move to next
   if (m_block.base != 0 && m_cur_key.ptr >= m_block.end) {
-    Global::block_cache->checkin(m_file_id, m_block.offset);
+    release_block();
     memset(&m_block, 0, sizeof(m_block));
     ++m_iter;
   }
@@ -184,20 +183,42 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block() {
     /**
      * Cache lookup / block read
      */
-    if (!Global::block_cache->checkout(m_file_id, (uint32_t)m_block.offset,
-                                      (uint8_t **)&m_block.base, &len)) {
+    if (Global::block_cache->checkout(m_file_id, m_block.offset,
+                                      (uint8_t **)&m_block.base, &len))
+      m_block.cached = true;
+    else {
+      DynamicBuffer buf(0);
+      uint8_t *zblock;
+      uint32_t zlen;
       bool second_try = false;
+
+      /**
+       * A block found in the compressed tier is being accessed for the
+       * second time, so it gets promoted to the inflated tier below
+       */
+      bool promote = !Global::block_cache->compressed_tier_enabled();
+      if (!promote && Global::block_cache->remove_compressed(m_file_id,
+          m_block.offset, &zblock, &zlen)) {
+        buf.base = zblock;
+        buf.ptr = zblock + zlen;
+        buf.size = zlen;
+        promote = true;
+      }
+
     try_again:
       try {
-        DynamicBuffer buf(m_block.zlength);
+        if (buf.base == 0) {
+          buf.grow(m_block.zlength);
 
-        if (second_try)
-          m_fd = m_cellstore->reopen_fd();
+          if (second_try)
+            m_fd = m_cellstore->reopen_fd();
+
+          /** Read compressed block **/
+          Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
 
-        /** Read compressed block **/
-        Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
+          buf.ptr += m_block.zlength;
+        }
 
-        buf.ptr += m_block.zlength;
         /** inflate compressed block **/
         BlockCompressionHeader header;
 
@@ -217,6 +238,7 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block() {
         if (second_try)
           throw;
         second_try = true;
+        buf.free();
         goto try_again;
       }
 
@@ -225,19 +247,22 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block() {
       m_block.base = expand_buf.release(&fill);
       len = fill;
 
-      /** Insert block into cache  **/
-      if (!Global::block_cache->insert_and_checkout(m_file_id, m_block.offset,
-                                         (uint8_t *)m_block.base, len)) {
-        delete [] m_block.base;
-
-        if (!Global::block_cache->checkout(m_file_id, m_block.offset,
-                                          (uint8_t **)&m_block.base, &len)) {
-          HT_FATALF("Problem checking out block from cache file_id=%d, "
-                    "offset=%lld", m_file_id, (Lld)m_block.offset);
-        }
+      if (promote)
+        cache_block(m_file_id, m_block, &len);
+      else {
+        /**
+         * First access: keep the raw block in the compressed tier and
+         * own the inflated copy for the lifetime of this block
+         */
+        size_t zfill;
+        uint8_t *raw = buf.release(&zfill);
+        if (!Global::block_cache->insert_compressed(m_file_id,
+            m_block.offset, raw, (uint32_t)zfill))
+          delete [] raw;
       }
     }
     m_block.end = m_block.base + len;
+    m_block_pin = new BlockPin(m_file_id, m_block);
     m_cur_key.ptr = m_block.base;
     m_cur_value.ptr = m_cur_key.ptr + m_cur_key.length();
 
@@ -247,5 +272,12 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block() {
 }
 
 
+template <typename IndexT>
+void CellStoreScannerIntervalBlockIndex<IndexT>::release_block() {
+  // the block stays around while scan responses still reference it
+  m_block_pin = 0;
+}
+
+
 template class CellStoreScannerIntervalBlockIndex<CellStoreBlockIndexMap<uint32_t> >;
 template class CellStoreScannerIntervalBlockIndex<CellStoreBlockIndexMap<int64_t> >;
@@ -44,15 +44,20 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalBlockIndex();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual ReferenceCount *get_pin() {
+      return m_iter == m_index->end() ? 0 : m_block_pin.get();
+    }
 
   private:
 
     bool fetch_next_block();
+    void release_block();
 
     CellStorePtr          m_cellstore;
     IndexT               *m_index;
     IndexIteratorT        m_iter;
     BlockInfo             m_block;
+    BlockPinPtr           m_block_pin;
     Key                   m_key;
     SerializedKey         m_cur_key;
     ByteString            m_cur_value;
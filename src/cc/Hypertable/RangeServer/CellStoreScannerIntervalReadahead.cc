@@ -43,7 +43,8 @@ template <typename IndexT>
 CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(CellStore *cellstore,
      IndexT *index, SerializedKey start_key, SerializedKey end_key, ScanContextPtr &scan_ctx) :
   m_cellstore(cellstore), m_end_key(end_key), m_zcodec(0), m_fd(-1), m_offset(0),
-  m_end_offset(0), m_check_for_range_end(false), m_eos(false), m_scan_ctx(scan_ctx) {
+  m_end_offset(0), m_check_for_range_end(false), m_eos(false), m_scan_ctx(scan_ctx),
+  m_pipeline(scan_ctx->pipeline) {
   int64_t start_offset;
 
   memset(&m_block, 0, sizeof(m_block));
@@ -137,9 +138,16 @@ CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(Cel
 template <typename IndexT>
 CellStoreScannerIntervalReadahead<IndexT>::~CellStoreScannerIntervalReadahead() {
   try {
+    // the pool may still be inflating blocks we read ahead
+    while (!m_pending.empty()) {
+      CompactionPipeline::Block *block = m_pending.front();
+      m_pending.pop_front();
+      try { m_pipeline->wait(block); }
+      catch (Exception &e) { }
+      delete block;
+    }
     if (m_fd != -1)
       Global::dfs->close(m_fd, 0);
-    delete [] m_block.base;
     delete m_zcodec;
   }
   catch (Exception &e) {
@@ -219,40 +227,27 @@ bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_readahead() {
 
   // If we're at the end of the current block, deallocate and move to next
   if (m_block.base != 0 && m_cur_key.ptr >= m_block.end) {
-    delete [] m_block.base;
+    m_block_pin = 0;
     memset(&m_block, 0, sizeof(m_block));
   }
 
+  if (m_pipeline)
+    return m_block.base == 0 ? fetch_next_block_pipelined() : false;
+
   if (m_offset >= m_end_offset)
     m_eos = true;
 
   if (m_block.base == 0 && !m_eos) {
     DynamicBuffer expand_buf(0);
     uint32_t len;
-    uint32_t nread;
 
     m_block.offset = m_offset;
 
-    /** Read header **/
     try {
       BlockCompressionHeader header;
-      DynamicBuffer input_buf( header.length() );
-
-      nread = Global::dfs->read(m_fd, input_buf.base, header.length() );
-      HT_EXPECT(nread == header.length(), Error::RANGESERVER_SHORT_CELLSTORE_READ);
-
-      size_t remaining = nread;
-
-      header.decode((const uint8_t **)&input_buf.ptr, &remaining);
-
-      input_buf.grow( input_buf.fill() + header.get_data_zlength() );
-      nread = Global::dfs->read(m_fd, input_buf.ptr,  header.get_data_zlength());
-      HT_EXPECT(nread == header.get_data_zlength(), Error::RANGESERVER_SHORT_CELLSTORE_READ);
-      input_buf.ptr +=  header.get_data_zlength();
+      DynamicBuffer input_buf(0);
 
-      if (m_offset + (int64_t)input_buf.fill() >= m_end_offset && m_end_key)
-        m_check_for_range_end = true;
-      m_offset += input_buf.fill();
+      read_block(input_buf);
 
       m_zcodec->inflate(input_buf, expand_buf, header);
 
@@ -273,6 +268,7 @@ bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_readahead() {
     len = fill;
 
     m_block.end = m_block.base + len;
+    m_block_pin = new BlockPin(-1, m_block);
     m_cur_key.ptr = m_block.base;
     m_cur_value.ptr = m_cur_key.ptr + m_cur_key.length();
 
@@ -281,5 +277,98 @@ bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_readahead() {
   return false;
 }
 
+
+/**
+ * Same as fetch_next_block_readahead(), but hands the compressed blocks to
+ * the compaction pipeline to be inflated.  Up to queue_depth() blocks are
+ * read ahead, so the pool inflates them while the merge consumes the
+ * current one.
+ */
+template <typename IndexT>
+bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_pipelined() {
+
+  try {
+    while (m_pending.size() < m_pipeline->queue_depth()
+           && m_offset < m_end_offset) {
+      CompactionPipeline::Block *block =
+        new CompactionPipeline::Block(CompactionPipeline::Block::INFLATE);
+      block->codec_type = m_zcodec->get_type();
+      try {
+        read_block(block->input);
+      }
+      catch (...) {
+        delete block;
+        throw;
+      }
+      m_pending.push_back(block);
+      m_pipeline->inflate(block);
+    }
+
+    if (m_pending.empty()) {
+      m_eos = true;
+      return false;
+    }
+
+    CompactionPipeline::Block *block = m_pending.front();
+    m_pending.pop_front();
+
+    try {
+      m_pipeline->wait(block);
+    }
+    catch (...) {
+      delete block;
+      throw;
+    }
+
+    /** take ownership of inflate buffer **/
+    size_t fill;
+    m_block.base = block->output.release(&fill);
+    m_block.end = m_block.base + fill;
+    m_block_pin = new BlockPin(-1, m_block);
+    delete block;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT <<"Error reading cell store ("
+                 << m_cellstore->get_filename() <<") block: "
+                 << e << HT_END;
+    HT_THROW2(e.code(), e, e.what());
+  }
+
+  m_cur_key.ptr = m_block.base;
+  m_cur_value.ptr = m_cur_key.ptr + m_cur_key.length();
+
+  return true;
+}
+
+
+/**
+ * Reads the compressed block at m_offset, header included, into input_buf
+ * and advances m_offset past it.
+ */
+template <typename IndexT>
+void CellStoreScannerIntervalReadahead<IndexT>::read_block(DynamicBuffer &input_buf) {
+  BlockCompressionHeader header;
+  uint32_t nread;
+
+  input_buf.grow(header.length());
+
+  /** Read header **/
+  nread = Global::dfs->read(m_fd, input_buf.base, header.length() );
+  HT_EXPECT(nread == header.length(), Error::RANGESERVER_SHORT_CELLSTORE_READ);
+
+  size_t remaining = nread;
+
+  header.decode((const uint8_t **)&input_buf.ptr, &remaining);
+
+  input_buf.grow( input_buf.fill() + header.get_data_zlength() );
+  nread = Global::dfs->read(m_fd, input_buf.ptr,  header.get_data_zlength());
+  HT_EXPECT(nread == header.get_data_zlength(), Error::RANGESERVER_SHORT_CELLSTORE_READ);
+  input_buf.ptr +=  header.get_data_zlength();
+
+  if (m_offset + (int64_t)input_buf.fill() >= m_end_offset && m_end_key)
+    m_check_for_range_end = true;
+  m_offset += input_buf.fill();
+}
+
 template class CellStoreScannerIntervalReadahead<CellStoreBlockIndexMap<uint32_t> >;
 template class CellStoreScannerIntervalReadahead<CellStoreBlockIndexMap<int64_t> >;
@@ -22,10 +22,13 @@
 #ifndef HYPERTABLE_CELLSTORESCANNERINTERVALREADAHEAD_H
 #define HYPERTABLE_CELLSTORESCANNERINTERVALREADAHEAD_H
 
+#include <deque>
+
 #include "Common/DynamicBuffer.h"
 
 #include "CellStore.h"
 #include "CellStoreScannerInterval.h"
+#include "CompactionPipeline.h"
 #include "ScanContext.h"
 
 namespace Hypertable {
@@ -44,13 +47,17 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalReadahead();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual ReferenceCount *get_pin() { return m_eos ? 0 : m_block_pin.get(); }
 
   private:
 
     bool fetch_next_block_readahead();
+    bool fetch_next_block_pipelined();
+    void read_block(DynamicBuffer &input_buf);
 
     CellStorePtr           m_cellstore;
     BlockInfo              m_block;
+    BlockPinPtr            m_block_pin;
     Key                    m_key;
     SerializedKey          m_cur_key;
     SerializedKey          m_end_key;
@@ -62,6 +69,8 @@ namespace Hypertable {
     bool                   m_check_for_range_end;
     bool                   m_eos;
     ScanContextPtr         m_scan_ctx;
+    CompactionPipelinePtr  m_pipeline;
+    std::deque<CompactionPipeline::Block *> m_pending;
 
   };
 
@@ -34,6 +34,20 @@ using namespace std;
 using namespace Hypertable;
 using namespace Serialization;
 
+namespace {
+
+  String flags_to_string(uint32_t flags) {
+    String str;
+    if (flags & CellStoreTrailerV1::INDEX_64BIT)
+      str += "|64BIT_INDEX";
+    if (flags & CellStoreTrailerV1::TIMESTAMP_RANGE)
+      str += "|TIMESTAMP_RANGE";
+    if (flags & CellStoreTrailerV1::HAS_DELETES)
+      str += "|HAS_DELETES";
+    return str.empty() ? String("0") : str.substr(1);
+  }
+
+}
 
 /**
  *
@@ -144,10 +158,7 @@ void CellStoreTrailerV1::display(std::ostream &os) {
   os << ", create_time=" << create_time;
   os << ", table_id=" << table_id;
   os << ", table_generation=" << table_generation;
-  if (flags & INDEX_64BIT)
-    os << ", flags=64BIT_INDEX";
-  else
-    os << ", flags=" << flags;
+  os << ", flags=" << flags_to_string(flags);
   os << ", compression_ratio=" << compression_ratio;
   os << ", compression_type=" << compression_type;
   os << ", version=" << version << "}";
@@ -172,10 +183,7 @@ void CellStoreTrailerV1::display_multiline(std::ostream &os) {
   os << "  create_time: " << create_time << "\n";
   os << "  table_id: " << table_id << "\n";
   os << "  table_generation: " << table_generation << "\n";
-  if (flags & INDEX_64BIT)
-    os << "  flags: 64BIT_INDEX\n";
-  else
-    os << "  flags=" << flags << "\n";
+  os << "  flags: " << flags_to_string(flags) << "\n";
   os << "  compression_ratio: " << compression_ratio << "\n";
   os << "  compression_type: " << compression_type << "\n";
   os << "  version: " << version << std::endl;
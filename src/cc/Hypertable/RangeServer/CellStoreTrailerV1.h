@@ -64,7 +64,17 @@ namespace Hypertable {
     uint16_t  compression_type;
     uint16_t  version;
 
-    enum Flags { INDEX_64BIT = 0x00000001 };
+    /**
+     * TIMESTAMP_RANGE means timestamp_min/timestamp_max cover every key in
+     * the store (older stores may carry incomplete values).  HAS_DELETES
+     * means the store contains delete records, which can suppress cells
+     * older than their own timestamp in other stores.
+     */
+    enum Flags {
+      INDEX_64BIT     = 0x00000001,
+      TIMESTAMP_RANGE = 0x00000002,
+      HAS_DELETES     = 0x00000004
+    };
 
     boost::any get(const String& prop) {
       if     (prop == "version")                return version;
@@ -163,6 +163,11 @@ CellStoreV1::create(const char *fname, size_t max_entries,
 
   m_fd = m_filesys->create(m_filename, true, -1, -1, -1);
 
+  if (m_pipeline)
+    m_pipeline->start_output(m_filesys, m_fd, m_filename,
+                             m_trailer.compression_type, m_compressor_args,
+                             &m_index_builder);
+
   m_bloom_filter_mode = props->get<BloomFilterMode>("bloom-filter-mode");
   m_max_approx_items = props->get_i32("max-approx-items");
   m_trailer.filter_false_positive_prob = props->get_f64("false-positive");
@@ -286,11 +291,25 @@ void CellStoreV1::add(const Key &key, const ByteString value) {
   if (key.timestamp != TIMESTAMP_NULL) {
     if (key.timestamp < m_trailer.timestamp_min)
       m_trailer.timestamp_min = key.timestamp;
-    else if (key.timestamp > m_trailer.timestamp_max)
+    if (key.timestamp > m_trailer.timestamp_max)
       m_trailer.timestamp_max = key.timestamp;
   }
 
-  if (m_buffer.fill() > (size_t)m_uncompressed_blocksize) {
+  if (key.flag <= FLAG_DELETE_CELL)
+    m_trailer.flags |= CellStoreTrailerV1::HAS_DELETES;
+
+  if (m_buffer.fill() > (size_t)m_uncompressed_blocksize && m_pipeline) {
+    uint64_t uncompressed, compressed;
+
+    m_pipeline->add_block(m_buffer, m_last_key.ptr - m_buffer.base);
+    m_buffer.reserve(m_trailer.blocksize*4);
+
+    m_pipeline->get_output_totals(&uncompressed, &compressed);
+    if (compressed > 0)
+      m_uncompressed_blocksize = (int64_t)(((uint64_t)m_trailer.blocksize
+          * uncompressed) / compressed);
+  }
+  else if (m_buffer.fill() > (size_t)m_uncompressed_blocksize) {
     BlockCompressionHeader header(DATA_BLOCK_MAGIC);
 
     m_index_builder.add_entry(m_last_key, m_offset);
@@ -370,7 +389,20 @@ void CellStoreV1::finalize(TableIdentifier *table_identifier) {
   StaticBuffer send_buf;
   int64_t index_memory = 0;
 
-  if (m_buffer.fill() > 0) {
+  if (m_pipeline) {
+    uint64_t uncompressed, compressed;
+
+    if (m_buffer.fill() > 0)
+      m_pipeline->add_block(m_buffer, m_last_key.ptr - m_buffer.base);
+
+    m_offset = m_pipeline->finish_output();
+
+    m_pipeline->get_output_totals(&uncompressed, &compressed);
+    m_uncompressed_data = (float)uncompressed;
+    m_compressed_data = (float)compressed;
+    m_pipeline = 0;
+  }
+  else if (m_buffer.fill() > 0) {
     BlockCompressionHeader header(DATA_BLOCK_MAGIC);
 
     m_index_builder.add_entry(m_last_key, m_offset);
@@ -484,6 +516,7 @@ void CellStoreV1::finalize(TableIdentifier *table_identifier) {
   m_index_builder.release_fixed_buf();
 
   // Add table information
+  m_trailer.flags |= CellStoreTrailerV1::TIMESTAMP_RANGE;
   m_trailer.table_id = table_identifier->id;
   m_trailer.table_generation = table_identifier->generation;
   {
@@ -712,7 +745,11 @@ void CellStoreV1::load_block_index() {
 
 bool CellStoreV1::may_contain(ScanContextPtr &scan_context) {
 
-  if (m_bloom_filter_mode == BLOOM_FILTER_DISABLED)
+  if (!may_contain_time_interval(scan_context->time_interval))
+    return false;
+
+  if (m_bloom_filter_mode == BLOOM_FILTER_DISABLED ||
+      !scan_context->single_row || scan_context->start_row == "")
     return true;
 
   if (m_bloom_filter == 0)
@@ -746,6 +783,31 @@ bool CellStoreV1::may_contain(ScanContextPtr &scan_context) {
 }
 
 
+/**
+ * A scan over [first, second) needs this store if it holds a cell inside
+ * the interval, or a delete record at or after first (a delete suppresses
+ * older cells, which may live in other stores and fall in the interval).
+ * Stores written before the timestamp range was tracked reliably are
+ * always included.
+ */
+bool CellStoreV1::may_contain_time_interval(
+    const std::pair<int64_t, int64_t> &interval) {
+
+  if (!(m_trailer.flags & CellStoreTrailerV1::TIMESTAMP_RANGE) ||
+      m_trailer.timestamp_min > m_trailer.timestamp_max)
+    return true;
+
+  if (m_trailer.timestamp_max < interval.first)
+    return false;
+
+  if (m_trailer.timestamp_min >= interval.second &&
+      !(m_trailer.flags & CellStoreTrailerV1::HAS_DELETES))
+    return false;
+
+  return true;
+}
+
+
 bool CellStoreV1::may_contain(const void *ptr, size_t len) {
 
   if (m_bloom_filter_mode == BLOOM_FILTER_DISABLED)
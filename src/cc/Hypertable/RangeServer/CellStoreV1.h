@@ -46,6 +46,7 @@
 
 #include "CellStore.h"
 #include "CellStoreTrailerV1.h"
+#include "CompactionPipeline.h"
 
 
 /**
@@ -61,10 +62,10 @@ namespace Hypertable {
 
   class CellStoreV1 : public CellStore {
 
-    class IndexBuilder {
+    class IndexBuilder : public CompactionPipeline::IndexSink {
     public:
       IndexBuilder() : m_bigint(false) { }
-      void add_entry(const SerializedKey key, int64_t offset);
+      virtual void add_entry(const SerializedKey key, int64_t offset);
       DynamicBuffer &fixed_buf() { return m_fixed; }
       DynamicBuffer &variable_buf() { return m_variable; }
       bool big_int() { return m_bigint; }
@@ -92,6 +93,8 @@ namespace Hypertable {
       return may_contain(key.data(), key.size());
     }
     virtual bool may_contain(ScanContextPtr &);
+    virtual bool
+    may_contain_time_interval(const std::pair<int64_t, int64_t> &interval);
 
     virtual uint64_t disk_usage() { return m_disk_usage; }
     virtual float compression_ratio() { return m_trailer.compression_ratio; }
@@ -125,6 +128,15 @@ namespace Hypertable {
 
     virtual CellStoreTrailer *get_trailer() { return &m_trailer; }
 
+    /**
+     * Hands the blocks added by subsequent add() calls to the given
+     * pipeline to be compressed and written, instead of compressing and
+     * writing them inline.  Must be called before create().
+     */
+    void set_compaction_pipeline(CompactionPipelinePtr &pipeline) {
+      m_pipeline = pipeline;
+    }
+
   protected:
     void record_split_row(const SerializedKey key);
     void create_bloom_filter(bool is_approx = false);
@@ -167,6 +179,7 @@ namespace Hypertable {
     uint64_t               m_bloom_filter_access_counter;
     uint64_t               m_block_index_access_counter;
     bool                   m_restricted_range;
+    CompactionPipelinePtr  m_pipeline;
   };
 
   typedef intrusive_ptr<CellStoreV1> CellStoreV1Ptr;
@@ -0,0 +1,398 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <map>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Stopwatch.h"
+
+#include "AsyncComm/Protocol.h"
+
+#include "Hypertable/Lib/CompressorFactory.h"
+
+#include "CellStore.h"
+#include "CompactionPipeline.h"
+
+using namespace Hypertable;
+
+namespace {
+  const size_t MAX_APPENDS_OUTSTANDING = 3;
+}
+
+
+CompactionPipeline::Pool::Pool(size_t threads)
+  : m_threads(threads), m_shutdown(false) {
+  HT_ASSERT(threads > 0);
+  for (size_t i=0; i<threads; i++)
+    m_workers.create_thread(WorkerThread(this));
+}
+
+
+CompactionPipeline::Pool::~Pool() {
+  {
+    ScopedLock lock(m_mutex);
+    m_shutdown = true;
+    m_work_cond.notify_all();
+  }
+  m_workers.join_all();
+}
+
+
+void CompactionPipeline::Pool::worker_loop() {
+  typedef std::map<int, BlockCompressionCodec *> CodecMap;
+  CodecMap inflaters;
+
+  while (true) {
+    Block *block;
+
+    {
+      ScopedLock lock(m_mutex);
+      while (m_work_queue.empty() && !m_shutdown)
+        m_work_cond.wait(lock);
+      if (m_shutdown)
+        break;
+      block = m_work_queue.front();
+      m_work_queue.pop_front();
+    }
+
+    CompactionPipeline *pipeline = block->owner;
+    Stopwatch stopwatch;
+
+    try {
+      if (block->type == Block::INFLATE) {
+        BlockCompressionHeader header;
+        BlockCompressionCodec *&codec = inflaters[block->codec_type];
+        if (codec == 0)
+          codec = CompressorFactory::create_block_codec(
+              (BlockCompressionCodec::Type)block->codec_type);
+        codec->inflate(block->input, block->output, header);
+        if (!header.check_magic(CellStore::DATA_BLOCK_MAGIC))
+          HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
+                   "Error inflating cell store block - magic string mismatch");
+      }
+      else {
+        BlockCompressionHeader header(CellStore::DATA_BLOCK_MAGIC);
+        BlockCompressionCodec *deflater = pipeline->checkout_deflater();
+        try { deflater->deflate(block->input, block->output, header); }
+        catch (Exception &e) {
+          pipeline->checkin_deflater(deflater);
+          throw;
+        }
+        pipeline->checkin_deflater(deflater);
+      }
+    }
+    catch (Exception &e) {
+      block->error = e.code();
+      block->error_msg = e.what();
+    }
+
+    double elapsed = stopwatch.elapsed();
+    bool write = false;
+
+    {
+      ScopedLock lock(m_mutex);
+      block->done = true;
+      if (block->type == Block::INFLATE) {
+        pipeline->m_stats.inflate.bytes += block->output.fill();
+        pipeline->m_stats.inflate.busy += elapsed;
+      }
+      else {
+        pipeline->m_stats.deflate.bytes += block->input.fill();
+        pipeline->m_stats.deflate.busy += elapsed;
+        // become the writer if this unblocked the head of the output queue
+        if (!pipeline->m_writing && pipeline->m_write_queue.front()->done) {
+          pipeline->m_writing = true;
+          write = true;
+        }
+      }
+      m_done_cond.notify_all();
+    }
+
+    // once done is set, the pipeline may only be touched by its writer
+    if (write)
+      pipeline->write_blocks();
+  }
+
+  for (CodecMap::iterator iter = inflaters.begin();
+       iter != inflaters.end(); ++iter)
+    delete iter->second;
+}
+
+
+CompactionPipeline::CompactionPipeline(PoolPtr &pool, size_t queue_depth)
+  : m_pool(pool), m_queue_depth(queue_depth ? queue_depth : 1),
+    m_abandoned(false), m_fs(0), m_fd(-1), m_codec_type(0), m_sink(0),
+    m_outstanding_appends(0), m_offset(0), m_uncompressed(0),
+    m_compressed(0), m_writing(false), m_error(Error::OK) {
+  HT_ASSERT(m_pool);
+  m_stats.threads = m_pool->threads();
+}
+
+
+CompactionPipeline::~CompactionPipeline() {
+  {
+    // blocks of a failed compaction are dropped by the writing worker
+    ScopedLock lock(m_pool->m_mutex);
+    m_abandoned = true;
+    while (!m_write_queue.empty() || m_writing)
+      m_pool->m_done_cond.wait(lock);
+  }
+
+  // don't let outstanding appends reply to a destroyed handler
+  try {
+    wait_for_appends(0);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+
+  foreach(BlockCompressionCodec *codec, m_deflaters)
+    delete codec;
+}
+
+
+void CompactionPipeline::inflate(Block *block) {
+  ScopedLock lock(m_pool->m_mutex);
+  HT_ASSERT(block->type == Block::INFLATE);
+  block->owner = this;
+  m_pool->m_work_queue.push_back(block);
+  m_pool->m_work_cond.notify_one();
+}
+
+
+void CompactionPipeline::wait(Block *block) {
+  {
+    ScopedLock lock(m_pool->m_mutex);
+    if (!block->done) {
+      Stopwatch stopwatch;
+      while (!block->done)
+        m_pool->m_done_cond.wait(lock);
+      m_stats.stall += stopwatch.elapsed();
+    }
+  }
+  if (block->error != Error::OK)
+    HT_THROW(block->error, block->error_msg);
+}
+
+
+void
+CompactionPipeline::start_output(Filesystem *fs, int32_t fd,
+    const String &fname, int codec_type,
+    const BlockCompressionCodec::Args &args, IndexSink *sink) {
+  ScopedLock lock(m_pool->m_mutex);
+  HT_ASSERT(m_fs == 0);
+  m_fs = fs;
+  m_fd = fd;
+  m_filename = fname;
+  m_codec_type = codec_type;
+  m_codec_args = args;
+  m_sink = sink;
+}
+
+
+void CompactionPipeline::add_block(DynamicBuffer &buf, size_t key_offset) {
+  Block *block = new Block(Block::DEFLATE);
+
+  block->owner = this;
+  block->input.base = buf.base;
+  block->input.ptr = buf.ptr;
+  block->input.size = buf.size;
+  block->input.own = buf.own;
+  buf.release();
+  block->key_offset = key_offset;
+
+  ScopedLock lock(m_pool->m_mutex);
+  HT_ASSERT(m_fs);
+
+  if (m_write_queue.size() >= m_queue_depth) {
+    Stopwatch stopwatch;
+    while (m_write_queue.size() >= m_queue_depth && m_error == Error::OK)
+      m_pool->m_done_cond.wait(lock);
+    m_stats.stall += stopwatch.elapsed();
+  }
+
+  if (m_error != Error::OK) {
+    delete block;
+    HT_THROW(m_error, m_error_msg);
+  }
+
+  m_write_queue.push_back(block);
+  m_pool->m_work_queue.push_back(block);
+  m_pool->m_work_cond.notify_one();
+}
+
+
+int64_t CompactionPipeline::finish_output() {
+  {
+    ScopedLock lock(m_pool->m_mutex);
+    while ((!m_write_queue.empty() || m_writing) && m_error == Error::OK)
+      m_pool->m_done_cond.wait(lock);
+    if (m_error != Error::OK)
+      HT_THROW(m_error, m_error_msg);
+  }
+
+  // no worker is writing, so the outstanding appends are ours to reap
+  wait_for_appends(0);
+
+  return m_offset;
+}
+
+
+void
+CompactionPipeline::get_output_totals(uint64_t *uncompressed,
+                                      uint64_t *compressed) {
+  ScopedLock lock(m_pool->m_mutex);
+  *uncompressed = m_uncompressed;
+  *compressed = m_compressed;
+}
+
+
+void CompactionPipeline::get_stats(Stats &stats) {
+  ScopedLock lock(m_pool->m_mutex);
+  stats = m_stats;
+}
+
+
+/**
+ * Deflaters are kept per compaction, since the codec arguments differ
+ * between access groups.  One is created for each worker that deflates
+ * a block of this compaction concurrently with another.
+ */
+BlockCompressionCodec *CompactionPipeline::checkout_deflater() {
+  {
+    ScopedLock lock(m_pool->m_mutex);
+    if (!m_deflaters.empty()) {
+      BlockCompressionCodec *codec = m_deflaters.back();
+      m_deflaters.pop_back();
+      return codec;
+    }
+  }
+  return CompressorFactory::create_block_codec(
+      (BlockCompressionCodec::Type)m_codec_type, m_codec_args);
+}
+
+
+void CompactionPipeline::checkin_deflater(BlockCompressionCodec *codec) {
+  ScopedLock lock(m_pool->m_mutex);
+  m_deflaters.push_back(codec);
+}
+
+
+/**
+ * Appends deflated blocks to the destination file in the order they were
+ * handed to add_block().  Runs on the worker that set m_writing, until the
+ * head of the queue is a block that is not yet deflated; the worker that
+ * finishes that block takes over.
+ */
+void CompactionPipeline::write_blocks() {
+
+  while (true) {
+    Block *block;
+    bool discard;
+
+    {
+      ScopedLock lock(m_pool->m_mutex);
+      if (m_write_queue.empty() || !m_write_queue.front()->done) {
+        m_writing = false;
+        m_pool->m_done_cond.notify_all();
+        return;
+      }
+      block = m_write_queue.front();
+      m_write_queue.pop_front();
+      discard = m_error != Error::OK || m_abandoned;
+    }
+
+    uint64_t uncompressed = block->input.fill();
+    uint64_t compressed = block->output.fill();
+    int error = block->error;
+    String error_msg = block->error_msg;
+    Stopwatch stopwatch;
+
+    if (error == Error::OK && !discard) {
+      try {
+        write_block(block);
+      }
+      catch (Exception &e) {
+        error = e.code();
+        error_msg = e.what();
+      }
+    }
+
+    double elapsed = stopwatch.elapsed();
+    delete block;
+
+    {
+      ScopedLock lock(m_pool->m_mutex);
+      if (error != Error::OK && m_error == Error::OK) {
+        HT_ERRORF("Problem writing cell store '%s' - %s",
+                  m_filename.c_str(), error_msg.c_str());
+        m_error = error;
+        m_error_msg = error_msg;
+      }
+      if (error == Error::OK && !discard) {
+        m_uncompressed += uncompressed;
+        m_compressed += compressed;
+        m_stats.write.bytes += uncompressed;
+        m_stats.write.busy += elapsed;
+      }
+      m_pool->m_done_cond.notify_all();
+    }
+  }
+}
+
+
+void CompactionPipeline::write_block(Block *block) {
+  size_t zlen = block->output.fill();
+
+  wait_for_appends(MAX_APPENDS_OUTSTANDING - 1);
+
+  m_sink->add_entry(SerializedKey(block->input.base + block->key_offset),
+                    m_offset);
+
+  StaticBuffer send_buf(block->output);
+
+  try { m_fs->append(m_fd, send_buf, 0, &m_sync_handler); }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Problem writing to DFS file '%s'",
+               m_filename.c_str());
+  }
+  m_outstanding_appends++;
+  m_offset += zlen;
+}
+
+
+void CompactionPipeline::wait_for_appends(size_t max_outstanding) {
+  EventPtr event_ptr;
+
+  while (m_outstanding_appends > max_outstanding) {
+    m_outstanding_appends--;
+    if (!m_sync_handler.wait_for_reply(event_ptr)) {
+      if (event_ptr->type == Event::MESSAGE)
+        HT_THROWF(Protocol::response_code(event_ptr),
+                  "Problem writing to DFS file '%s' : %s", m_filename.c_str(),
+                  Protocol::string_format_message(event_ptr).c_str());
+      HT_THROWF(event_ptr->error,
+                "Problem writing to DFS file '%s'", m_filename.c_str());
+    }
+  }
+}
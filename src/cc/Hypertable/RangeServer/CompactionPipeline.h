@@ -0,0 +1,225 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_COMPACTIONPIPELINE_H
+#define HYPERTABLE_COMPACTIONPIPELINE_H
+
+#include <deque>
+#include <vector>
+
+#include <boost/thread/condition.hpp>
+
+#include "AsyncComm/DispatchHandlerSynchronizer.h"
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+#include "Common/Thread.h"
+
+#include "Hypertable/Lib/BlockCompressionCodec.h"
+#include "Hypertable/Lib/BlockCompressionHeader.h"
+#include "Hypertable/Lib/Filesystem.h"
+#include "Hypertable/Lib/SerializedKey.h"
+
+namespace Hypertable {
+
+  /**
+   * Splits a compaction into stages that run concurrently.  Blocks of the
+   * source cell stores are inflated by a small thread pool ahead of the
+   * merge (see CellStoreScannerIntervalReadahead), the merge runs on the
+   * maintenance thread, and the blocks of the new cell store are deflated
+   * by the same pool and appended to the DFS in order.  Every stage is fed
+   * through a bounded queue, so memory use stays at a few blocks per source
+   * and per destination.  The pool is shared by all compactions of the
+   * range server (Global::compaction_pipeline_pool); a CompactionPipeline
+   * only holds the state of one compaction and starts no threads.
+   */
+  class CompactionPipeline : public ReferenceCount {
+  public:
+
+    /** Receives the block index entries of the cell store being written */
+    class IndexSink {
+    public:
+      virtual ~IndexSink() { }
+      virtual void add_entry(const SerializedKey key, int64_t offset) = 0;
+    };
+
+    /** A block being inflated or deflated by the pool */
+    struct Block {
+      enum Type { INFLATE, DEFLATE };
+      Block(Type t) : type(t), owner(0), codec_type(0), key_offset(0),
+                      done(false), error(Error::OK) { }
+      Type type;
+      CompactionPipeline *owner;
+      int codec_type;           // INFLATE only
+      DynamicBuffer input;
+      DynamicBuffer output;
+      size_t key_offset;        // DEFLATE only, offset of last key in input
+      bool done;
+      int error;
+      String error_msg;
+    };
+
+    struct StageStats {
+      StageStats() : bytes(0), busy(0.0) { }
+      uint64_t bytes;           // uncompressed bytes through the stage
+      double busy;              // seconds spent working, over all threads
+    };
+
+    struct Stats {
+      Stats() : threads(0), stall(0.0) { }
+      StageStats inflate;
+      StageStats deflate;
+      StageStats write;
+      size_t threads;
+      double stall;             // seconds the merge thread waited on the pool
+    };
+
+    /**
+     * The inflate/deflate worker threads.  The worker that deflates the
+     * block at the head of a compaction's output queue also appends it,
+     * and any blocks ready behind it, to the destination file.
+     */
+    class Pool : public ReferenceCount {
+    public:
+      /** Starts the given number of worker threads */
+      Pool(size_t threads);
+      virtual ~Pool();
+
+      size_t threads() { return m_threads; }
+
+    private:
+      friend class CompactionPipeline;
+      typedef std::deque<Block *> BlockQueue;
+
+      struct WorkerThread {
+        WorkerThread(Pool *pool) : m_pool(pool) { }
+        void operator()() { m_pool->worker_loop(); }
+        Pool *m_pool;
+      };
+
+      void worker_loop();
+
+      Mutex             m_mutex;
+      boost::condition  m_work_cond;
+      boost::condition  m_done_cond;
+      BlockQueue        m_work_queue;
+      size_t            m_threads;
+      bool              m_shutdown;
+      ThreadGroup       m_workers;
+    };
+    typedef intrusive_ptr<Pool> PoolPtr;
+
+    /**
+     * @param pool worker threads that inflate and deflate the blocks
+     * @param queue_depth maximum number of blocks in flight per source
+     *        and for the destination
+     */
+    CompactionPipeline(PoolPtr &pool, size_t queue_depth);
+
+    /**
+     * Discards the destination blocks not yet written and waits for the
+     * pool to let go of them.
+     */
+    virtual ~CompactionPipeline();
+
+    size_t queue_depth() { return m_queue_depth; }
+
+    /** Queues a source block for inflation; ownership stays with caller */
+    void inflate(Block *block);
+
+    /**
+     * Waits for a block handed to inflate() to complete.  Throws if the
+     * block could not be inflated.
+     */
+    void wait(Block *block);
+
+    /**
+     * Directs deflated blocks to the given file.  Must be called before
+     * add_block().
+     */
+    void start_output(Filesystem *fs, int32_t fd, const String &fname,
+                      int codec_type, const BlockCompressionCodec::Args &args,
+                      IndexSink *sink);
+
+    /**
+     * Hands a full block of the destination cell store to the pipeline.
+     * The contents of buf are taken over and buf is left empty.  Blocks
+     * if queue_depth() blocks are already in flight.
+     *
+     * @param buf uncompressed block
+     * @param key_offset offset of the last key of the block within buf
+     */
+    void add_block(DynamicBuffer &buf, size_t key_offset);
+
+    /**
+     * Waits for all blocks handed to add_block() to be written and
+     * acknowledged.  Throws the first error encountered by the writer.
+     *
+     * @return offset of the end of the last block written
+     */
+    int64_t finish_output();
+
+    /** Uncompressed and compressed bytes written so far */
+    void get_output_totals(uint64_t *uncompressed, uint64_t *compressed);
+
+    void get_stats(Stats &stats);
+
+  private:
+    typedef std::deque<Block *> BlockQueue;
+
+    BlockCompressionCodec *checkout_deflater();
+    void checkin_deflater(BlockCompressionCodec *codec);
+    void write_blocks();
+    void write_block(Block *block);
+    void wait_for_appends(size_t max_outstanding);
+
+    // all state below m_pool is guarded by the pool's mutex
+    PoolPtr           m_pool;
+    BlockQueue        m_write_queue;
+    size_t            m_queue_depth;
+    bool              m_abandoned;
+    Stats             m_stats;
+    std::vector<BlockCompressionCodec *> m_deflaters;
+
+    // destination, written only by the writing worker once started
+    Filesystem       *m_fs;
+    int32_t           m_fd;
+    String            m_filename;
+    int               m_codec_type;
+    BlockCompressionCodec::Args m_codec_args;
+    IndexSink        *m_sink;
+    DispatchHandlerSynchronizer m_sync_handler;
+    size_t            m_outstanding_appends;
+    int64_t           m_offset;
+    uint64_t          m_uncompressed;
+    uint64_t          m_compressed;
+    bool              m_writing;
+    int               m_error;
+    String            m_error_msg;
+  };
+
+  typedef intrusive_ptr<CompactionPipeline> CompactionPipelinePtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_COMPACTIONPIPELINE_H
@@ -36,6 +36,7 @@ extern "C" {
 #include "Hypertable/Lib/MasterClient.h"
 #include "Hypertable/Lib/RangeServerProtocol.h"
 
+#include "RequestHandlerBatch.h"
 #include "RequestHandlerCompact.h"
 #include "RequestHandlerDestroyScanner.h"
 #include "RequestHandlerDump.h"
@@ -45,6 +46,8 @@ extern "C" {
 #include "RequestHandlerUpdate.h"
 #include "RequestHandlerCreateScanner.h"
 #include "RequestHandlerFetchScanblock.h"
+#include "RequestHandlerGetCells.h"
+#include "RequestHandlerAggregateScan.h"
 #include "RequestHandlerDropTable.h"
 #include "RequestHandlerStatus.h"
 #include "RequestHandlerReplayBegin.h"
@@ -124,6 +127,18 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new RequestHandlerCreateScanner(m_comm,
             m_range_server_ptr.get(), event);
         break;
+      case RangeServerProtocol::COMMAND_GET_CELLS:
+        handler = new RequestHandlerGetCells(m_comm,
+            m_range_server_ptr.get(), event);
+        break;
+      case RangeServerProtocol::COMMAND_AGGREGATE_SCAN:
+        handler = new RequestHandlerAggregateScan(m_comm,
+            m_range_server_ptr.get(), event);
+        break;
+      case RangeServerProtocol::COMMAND_BATCH:
+        handler = new RequestHandlerBatch(m_comm, m_app_queue_ptr,
+            m_range_server_ptr.get(), event);
+        break;
       case RangeServerProtocol::COMMAND_DESTROY_SCANNER:
         handler = new RequestHandlerDestroyScanner(m_comm,
             m_range_server_ptr.get(), event);
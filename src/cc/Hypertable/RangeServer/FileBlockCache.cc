@@ -30,99 +30,289 @@ using std::pair;
 
 atomic_t FileBlockCache::ms_next_file_id = ATOMIC_INIT(0);
 
+namespace {
+
+  void add_stat(BlockCacheStat &total, const BlockCacheStat &stat,
+                uint64_t memory_used) {
+    total.max_memory += stat.max_memory;
+    total.memory_used += memory_used;
+    total.hits += stat.hits;
+    total.misses += stat.misses;
+    total.inserts += stat.inserts;
+    total.evictions += stat.evictions;
+    total.promotions += stat.promotions;
+  }
+
+}
+
+
+FileBlockCache::FileBlockCache(uint64_t max_memory,
+    uint64_t max_compressed_memory, size_t shard_count)
+  : m_max_compressed_memory(max_compressed_memory) {
+  if (shard_count == 0)
+    shard_count = 1;
+  m_shards.reserve(shard_count);
+  for (size_t i=0; i<shard_count; i++) {
+    Shard *shard = new Shard();
+    shard->inflated.set_max_memory(max_memory / shard_count);
+    shard->compressed.set_max_memory(max_compressed_memory / shard_count);
+    m_shards.push_back(shard);
+  }
+}
+
+
 FileBlockCache::~FileBlockCache() {
-  for (BlockCache::const_iterator iter = m_cache.begin();
-       iter != m_cache.end(); ++iter)
-    delete [] (*iter).block;
+  foreach(Shard *shard, m_shards) {
+    free_blocks(shard->inflated.probation);
+    free_blocks(shard->inflated.protect);
+    free_blocks(shard->compressed.probation);
+    free_blocks(shard->compressed.protect);
+    delete shard;
+  }
 }
 
+
 bool
-FileBlockCache::checkout(int file_id, uint32_t file_offset, uint8_t **blockp,
+FileBlockCache::checkout(int file_id, int64_t file_offset, uint8_t **blockp,
                          uint32_t *lengthp) {
-  ScopedLock lock(m_mutex);
-  HashIndex &hash_index = m_cache.get<1>();
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  Tier &tier = sh.inflated;
   HashIndex::iterator iter;
-  uint64_t key = ((uint64_t)file_id << 32) | file_offset;
 
-  if ((iter = hash_index.find(key)) == hash_index.end())
+  // Hit in the protected segment: move to the MRU end
+  HashIndex &protect_index = tier.protect.cache.get<1>();
+  if ((iter = protect_index.find(key)) != protect_index.end()) {
+    protect_index.modify(iter, IncrementRefCount());
+    Sequence &sequence = tier.protect.cache.get<0>();
+    sequence.relocate(sequence.end(), tier.protect.cache.project<0>(iter));
+    *blockp = (*iter).block;
+    *lengthp = (*iter).length;
+    tier.stat.hits++;
+    return true;
+  }
+
+  // Hit in the probationary segment: second access, so protect it
+  HashIndex &probation_index = tier.probation.cache.get<1>();
+  if ((iter = probation_index.find(key)) == probation_index.end()) {
+    tier.stat.misses++;
     return false;
+  }
+
+  probation_index.modify(iter, IncrementRefCount());
+  *blockp = (*iter).block;
+  *lengthp = (*iter).length;
+  move_to_protected(tier, iter);
+  tier.stat.hits++;
+  return true;
+}
 
-  BlockCacheEntry entry = *iter;
-  entry.ref_count++;
 
-  hash_index.erase(iter);
+void FileBlockCache::checkin(int file_id, int64_t file_offset) {
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  HashIndex::iterator iter;
+
+  HashIndex &protect_index = sh.inflated.protect.cache.get<1>();
+  if ((iter = protect_index.find(key)) != protect_index.end()) {
+    assert((*iter).ref_count > 0);
+    protect_index.modify(iter, DecrementRefCount());
+    return;
+  }
 
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  HashIndex &probation_index = sh.inflated.probation.cache.get<1>();
+  iter = probation_index.find(key);
+
+  assert(iter != probation_index.end() && (*iter).ref_count > 0);
+
+  probation_index.modify(iter, DecrementRefCount());
+}
+
+
+bool
+FileBlockCache::insert_and_checkout(int file_id, int64_t file_offset,
+                                    uint8_t *block, uint32_t length) {
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  Tier &tier = sh.inflated;
+  HashIndex &protect_index = tier.protect.cache.get<1>();
+  HashIndex &probation_index = tier.probation.cache.get<1>();
+
+  if (length > tier.max_memory ||
+      protect_index.find(key) != protect_index.end() ||
+      probation_index.find(key) != probation_index.end())
+    return false;
+
+  if (!make_room(tier, length))
+    return false;
+
+  BlockCacheEntry entry(file_id, file_offset);
+  entry.block = block;
+  entry.length = length;
+  entry.ref_count = 1;
+
+  pair<Sequence::iterator, bool> insert_result =
+      tier.probation.cache.push_back(entry);
   assert(insert_result.second);
 
-  *blockp = (*insert_result.first).block;
-  *lengthp = (*insert_result.first).length;
+  tier.probation.memory_used += length;
+  tier.stat.inserts++;
 
   return true;
 }
 
 
-void FileBlockCache::checkin(int file_id, uint32_t file_offset) {
-  ScopedLock lock(m_mutex);
-  HashIndex &hash_index = m_cache.get<1>();
+bool FileBlockCache::contains(int file_id, int64_t file_offset) {
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  HashIndex &protect_index = sh.inflated.protect.cache.get<1>();
+  HashIndex &probation_index = sh.inflated.probation.cache.get<1>();
+
+  return protect_index.find(key) != protect_index.end() ||
+      probation_index.find(key) != probation_index.end();
+}
+
+
+bool
+FileBlockCache::remove_compressed(int file_id, int64_t file_offset,
+                                  uint8_t **blockp, uint32_t *lengthp) {
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  Tier &tier = sh.compressed;
+  HashIndex &probation_index = tier.probation.cache.get<1>();
   HashIndex::iterator iter;
-  uint64_t key = ((uint64_t)file_id << 32) | file_offset;
 
-  iter = hash_index.find(key);
+  // compressed blocks leave the tier on their first hit, so they never
+  // reach the protected segment
+  if ((iter = probation_index.find(key)) == probation_index.end()) {
+    tier.stat.misses++;
+    return false;
+  }
+
+  *blockp = (*iter).block;
+  *lengthp = (*iter).length;
 
-  assert(iter != hash_index.end() && (*iter).ref_count > 0);
+  erase(tier.probation, iter);
 
-  hash_index.modify(iter, DecrementRefCount());
+  tier.stat.hits++;
+  tier.stat.promotions++;
+  return true;
 }
 
 
 bool
-FileBlockCache::insert_and_checkout(int file_id, uint32_t file_offset,
-                                    uint8_t *block, uint32_t length) {
-  ScopedLock lock(m_mutex);
-  HashIndex &hash_index = m_cache.get<1>();
-  uint64_t key = ((uint64_t)file_id << 32) | file_offset;
+FileBlockCache::insert_compressed(int file_id, int64_t file_offset,
+                                  uint8_t *block, uint32_t length) {
+  BlockKey key(file_id, file_offset);
+  Shard &sh = shard(key);
+  ScopedLock lock(sh.mutex);
+  Tier &tier = sh.compressed;
+  HashIndex &probation_index = tier.probation.cache.get<1>();
 
-  if (length > m_max_memory || hash_index.find(key) != hash_index.end())
+  if (length > tier.max_memory ||
+      probation_index.find(key) != probation_index.end())
     return false;
 
-  // make room
-  if (m_avail_memory < length) {
-    BlockCache::iterator iter = m_cache.begin();
-    while (iter != m_cache.end()) {
-      if ((*iter).ref_count == 0) {
-        m_avail_memory += (*iter).length;
-        delete [] (*iter).block;
-        iter = m_cache.erase(iter);
-        if (m_avail_memory >= length)
-          break;
-      }
-      else
-        ++iter;
-    }
-  }
-
-  if (m_avail_memory < length)
+  if (!make_room(tier, length))
     return false;
 
   BlockCacheEntry entry(file_id, file_offset);
   entry.block = block;
   entry.length = length;
-  entry.ref_count = 1;
 
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  pair<Sequence::iterator, bool> insert_result =
+      tier.probation.cache.push_back(entry);
   assert(insert_result.second);
 
-  m_avail_memory -= length;
+  tier.probation.memory_used += length;
+  tier.stat.inserts++;
 
   return true;
 }
 
 
-bool FileBlockCache::contains(int file_id, uint32_t file_offset) {
-  ScopedLock lock(m_mutex);
-  HashIndex &hash_index = m_cache.get<1>();
-  uint64_t key = ((uint64_t)file_id << 32) | file_offset;
+void FileBlockCache::get_stats(std::vector<BlockCacheStat> &stats) {
+  BlockCacheStat inflated, compressed;
+
+  inflated.name = "inflated";
+  compressed.name = "compressed";
+
+  foreach(Shard *shard, m_shards) {
+    ScopedLock lock(shard->mutex);
+    add_stat(inflated, shard->inflated.stat, shard->inflated.memory_used());
+    add_stat(compressed, shard->compressed.stat,
+             shard->compressed.memory_used());
+  }
+
+  stats.push_back(inflated);
+  if (compressed_tier_enabled())
+    stats.push_back(compressed);
+}
+
+
+/**
+ * Moves a probationary entry to the MRU end of the protected segment.  If
+ * that overflows the protected segment, its LRU entries are demoted back
+ * to the MRU end of the probationary segment.  Assumes the shard is locked.
+ */
+void FileBlockCache::move_to_protected(Tier &tier, HashIndex::iterator iter) {
+  BlockCacheEntry entry = *iter;
+
+  erase(tier.probation, iter);
+  tier.protect.cache.push_back(entry);
+  tier.protect.memory_used += entry.length;
+
+  while (tier.protect.memory_used > tier.max_protected_memory &&
+         tier.protect.cache.size() > 1) {
+    Sequence &sequence = tier.protect.cache.get<0>();
+    BlockCacheEntry demoted = sequence.front();
+    sequence.pop_front();
+    tier.protect.memory_used -= demoted.length;
+    tier.probation.cache.push_back(demoted);
+    tier.probation.memory_used += demoted.length;
+  }
+}
+
+
+/**
+ * Evicts unreferenced entries, least recently used first, until there is
+ * room for length bytes.  The probationary segment is drained before the
+ * protected one is touched.  Assumes the shard is locked.
+ */
+bool FileBlockCache::make_room(Tier &tier, uint32_t length) {
+  Segment *segments[2] = { &tier.probation, &tier.protect };
+
+  for (size_t i=0; i<2; i++) {
+    BlockCache::iterator iter = segments[i]->cache.begin();
+    while (tier.memory_used() + length > tier.max_memory &&
+           iter != segments[i]->cache.end()) {
+      if ((*iter).ref_count == 0) {
+        segments[i]->memory_used -= (*iter).length;
+        delete [] (*iter).block;
+        iter = segments[i]->cache.erase(iter);
+        tier.stat.evictions++;
+      }
+      else
+        ++iter;
+    }
+  }
+  return tier.memory_used() + length <= tier.max_memory;
+}
+
+
+void FileBlockCache::erase(Segment &segment, HashIndex::iterator iter) {
+  segment.memory_used -= (*iter).length;
+  segment.cache.get<1>().erase(iter);
+}
 
-  return (hash_index.find(key) != hash_index.end());
+
+void FileBlockCache::free_blocks(Segment &segment) {
+  for (BlockCache::const_iterator iter = segment.cache.begin();
+       iter != segment.cache.end(); ++iter)
+    delete [] (*iter).block;
 }
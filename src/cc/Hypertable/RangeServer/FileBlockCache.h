@@ -22,32 +22,81 @@
 #ifndef HYPERTABLE_FILEBLOCKCACHE_H
 #define HYPERTABLE_FILEBLOCKCACHE_H
 
+#include <vector>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 
 #include "Common/Mutex.h"
 #include "Common/atomic.h"
 
+#include "Hypertable/Lib/Stat.h"
+
 namespace Hypertable {
   using namespace boost::multi_index;
 
+  /**
+   * Cache of cell store blocks, organized in two tiers.  The inflated
+   * tier holds uncompressed blocks that scanners check out and read in
+   * place.  The optional compressed tier holds raw blocks as read from the
+   * filesystem; a block found there is handed back to the caller, who
+   * inflates it and promotes it into the inflated tier.  Each tier has
+   * its own memory limit; the compressed tier is disabled when its limit
+   * is zero.
+   *
+   * Blocks are keyed on (file id, 64-bit file offset) and spread over a
+   * number of independently locked shards, each of which gets an equal
+   * share of the memory limits.  Within a shard, a tier is a segmented
+   * LRU: new blocks enter a probationary segment and only move to the
+   * protected segment when they are hit again, so a single large scan
+   * cycles through the probationary segment without flushing blocks that
+   * are repeatedly looked up.
+   */
   class FileBlockCache {
 
     static atomic_t ms_next_file_id;
 
   public:
-    FileBlockCache(uint64_t max_memory)
-        : m_max_memory(max_memory), m_avail_memory(max_memory) {  }
+    /** Percentage of each tier reserved for the protected segment */
+    enum { PROTECTED_PERCENTAGE = 80 };
+
+    FileBlockCache(uint64_t max_memory, uint64_t max_compressed_memory = 0,
+                   size_t shard_count = 1);
     ~FileBlockCache();
 
-    bool checkout(int file_id, uint32_t file_offset, uint8_t **blockp,
+    bool checkout(int file_id, int64_t file_offset, uint8_t **blockp,
                   uint32_t *lengthp);
-    void checkin(int file_id, uint32_t file_offset);
-    bool insert_and_checkout(int file_id, uint32_t file_offset,
+    void checkin(int file_id, int64_t file_offset);
+    bool insert_and_checkout(int file_id, int64_t file_offset,
                              uint8_t *block, uint32_t length);
-    bool contains(int file_id, uint32_t file_offset);
+    bool contains(int file_id, int64_t file_offset);
+
+    bool compressed_tier_enabled() { return m_max_compressed_memory > 0; }
+
+    /**
+     * Removes a block from the compressed tier, transferring ownership of
+     * the block memory to the caller.  Used when a block is accessed a
+     * second time and is about to be promoted to the inflated tier.
+     *
+     * @return true if the block was found
+     */
+    bool remove_compressed(int file_id, int64_t file_offset,
+                           uint8_t **blockp, uint32_t *lengthp);
+
+    /**
+     * Inserts a compressed block, taking ownership of the block memory on
+     * success.
+     *
+     * @return true if inserted, false if the block was already cached or
+     *         no room could be made for it
+     */
+    bool insert_compressed(int file_id, int64_t file_offset,
+                           uint8_t *block, uint32_t length);
+
+    /** Appends one BlockCacheStat per tier (summed over shards) to stats */
+    void get_stats(std::vector<BlockCacheStat> &stats);
 
     static int get_next_file_id() {
       return atomic_inc_return(&ms_next_file_id);
@@ -55,30 +104,43 @@ namespace Hypertable {
 
   private:
 
+    struct BlockKey {
+      BlockKey(int id, int64_t offset) : file_id(id), file_offset(offset) { }
+      bool operator==(const BlockKey &other) const {
+        return file_id == other.file_id && file_offset == other.file_offset;
+      }
+      int     file_id;
+      int64_t file_offset;
+    };
+
+    struct HashBlockKey {
+      std::size_t operator()(const BlockKey &key) const {
+        uint64_t x = (uint64_t)key.file_offset ^
+            ((uint64_t)key.file_id * 0x9E3779B97F4A7C15ULL);
+        return (std::size_t)(x >> 32) ^ (std::size_t)x;
+      }
+    };
+
     class BlockCacheEntry {
     public:
-      BlockCacheEntry() : file_id(-1), file_offset(0), block(0), length(0),
-          ref_count(0) { return; }
-      BlockCacheEntry(int id, uint32_t offset) : file_id(id),
-          file_offset(offset), block(0), length(0), ref_count(0) { return; }
+      BlockCacheEntry(int id, int64_t offset) : key(id, offset), block(0),
+          length(0), ref_count(0) { return; }
 
-      int      file_id;
-      uint32_t file_offset;
+      BlockKey  key;
       uint8_t  *block;
-      uint32_t length;
-      uint32_t ref_count;
-      uint64_t key() const { return ((uint64_t)file_id << 32) | file_offset; }
+      uint32_t  length;
+      uint32_t  ref_count;
     };
 
-    struct DecrementRefCount {
+    struct IncrementRefCount {
       void operator()(BlockCacheEntry &entry) {
-        entry.ref_count--;
+        entry.ref_count++;
       }
     };
 
-    struct HashI64 {
-      std::size_t operator()(uint64_t x) const {
-        return (std::size_t)(x >> 32) ^ (std::size_t)x;
+    struct DecrementRefCount {
+      void operator()(BlockCacheEntry &entry) {
+        entry.ref_count--;
       }
     };
 
@@ -86,18 +148,55 @@ namespace Hypertable {
       BlockCacheEntry,
       indexed_by<
         sequenced<>,
-        hashed_unique<const_mem_fun<BlockCacheEntry, uint64_t,
-                      &BlockCacheEntry::key>, HashI64>
+        hashed_unique<member<BlockCacheEntry, BlockKey,
+                      &BlockCacheEntry::key>, HashBlockKey>
       >
     > BlockCache;
 
     typedef BlockCache::nth_index<0>::type Sequence;
     typedef BlockCache::nth_index<1>::type HashIndex;
 
-    Mutex         m_mutex;
-    BlockCache    m_cache;
-    uint64_t      m_max_memory;
-    uint64_t      m_avail_memory;
+    /** One LRU list; the front is least recently used */
+    struct Segment {
+      Segment() : memory_used(0) { }
+      BlockCache cache;
+      uint64_t   memory_used;
+    };
+
+    struct Tier {
+      Tier() : max_memory(0), max_protected_memory(0) { }
+      void set_max_memory(uint64_t max) {
+        max_memory = max;
+        max_protected_memory = max * PROTECTED_PERCENTAGE / 100;
+        stat.max_memory = max;
+      }
+      uint64_t memory_used() {
+        return probation.memory_used + protect.memory_used;
+      }
+      Segment        probation;
+      Segment        protect;
+      uint64_t       max_memory;
+      uint64_t       max_protected_memory;
+      BlockCacheStat stat;
+    };
+
+    struct Shard {
+      Mutex mutex;
+      Tier  inflated;
+      Tier  compressed;
+    };
+
+    Shard &shard(const BlockKey &key) {
+      return *m_shards[HashBlockKey()(key) % m_shards.size()];
+    }
+
+    static void move_to_protected(Tier &tier, HashIndex::iterator iter);
+    static bool make_room(Tier &tier, uint32_t length);
+    static void erase(Segment &segment, HashIndex::iterator iter);
+    static void free_blocks(Segment &segment);
+
+    std::vector<Shard *> m_shards;
+    uint64_t             m_max_compressed_memory;
   };
 
 }
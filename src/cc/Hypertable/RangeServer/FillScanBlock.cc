@@ -23,6 +23,18 @@
 #include "FillScanBlock.h"
 #include "Hypertable/Lib/Defaults.h"
 
+namespace {
+
+  /** Holds the copied portion of a segmented scan block */
+  class ScanBlockBuffer : public Hypertable::ReferenceCount {
+  public:
+    ScanBlockBuffer(size_t size) : buf(size) { }
+    Hypertable::DynamicBuffer buf;
+  };
+  typedef boost::intrusive_ptr<ScanBlockBuffer> ScanBlockBufferPtr;
+
+}
+
 namespace Hypertable {
 
   bool
@@ -73,4 +85,74 @@ namespace Hypertable {
     return more;
   }
 
+
+  bool
+  FillScanBlock(CellListScannerPtr &scanner, CommBuf::SegmentVector &segments,
+                size_t zero_copy_threshold, size_t *countp, size_t *lengthp) {
+    Key key;
+    ByteString value;
+    size_t value_len;
+    bool more = true;
+    size_t limit = DATA_TRANSFER_BLOCKSIZE;
+    size_t remaining = DATA_TRANSFER_BLOCKSIZE;
+    ScanBlockBufferPtr copy;
+    ReferenceCount *pin;
+    uint8_t *copy_start = 0;  // copied bytes not yet covered by a segment
+    uint8_t *ptr;
+
+    segments.clear();
+    *countp = 0;
+
+    while ((more = scanner->get(key, value))) {
+      value_len = value.length();
+      if (!copy) {
+        if (key.length + value_len > limit) {
+          limit = key.length + value_len;
+          remaining = limit;
+        }
+        // never grown, segments point into it
+        copy = new ScanBlockBuffer(limit+4);
+        // skip encoded length
+        copy->buf.ptr = copy->buf.base + 4;
+        copy_start = copy->buf.base;
+      }
+      if (key.length + value_len <= remaining) {
+        copy->buf.add_unchecked(key.serial.ptr, key.length);
+        if (zero_copy_threshold && value_len >= zero_copy_threshold
+            && (pin = scanner->get_pin()) != 0) {
+          segments.push_back(CommBuf::Segment(copy_start,
+              copy->buf.ptr - copy_start, copy.get()));
+          segments.push_back(CommBuf::Segment(value.ptr, value_len, pin));
+          copy_start = copy->buf.ptr;
+        }
+        else
+          copy->buf.add_unchecked(value.ptr, value_len);
+        remaining -= (key.length + value_len);
+        scanner->forward();
+        (*countp)++;
+      }
+      else
+        break;
+    }
+
+    if (!copy) {
+      copy = new ScanBlockBuffer(4);
+      copy->buf.ptr = copy->buf.base + 4;
+      copy_start = copy->buf.base;
+    }
+
+    if (copy->buf.ptr > copy_start)
+      segments.push_back(CommBuf::Segment(copy_start,
+          copy->buf.ptr - copy_start, copy.get()));
+
+    *lengthp = 0;
+    for (size_t i=0; i<segments.size(); i++)
+      *lengthp += segments[i].len;
+
+    ptr = copy->buf.base;
+    Serialization::encode_i32(&ptr, *lengthp - 4);
+
+    return more;
+  }
+
 }
@@ -24,6 +24,8 @@
 
 #include "Common/DynamicBuffer.h"
 
+#include "AsyncComm/CommBuf.h"
+
 #include "CellListScanner.h"
 
 namespace Hypertable {
@@ -31,6 +33,27 @@ namespace Hypertable {
   bool FillScanBlock(CellListScannerPtr &scanner, DynamicBuffer &dbuf,
                      size_t *countp);
 
+  /**
+   * Fills a scan block like the function above, but returns it as a chain
+   * of segments for CommBuf.  Keys and small values are copied into a
+   * buffer that the segments hold a reference on.  Values of at least
+   * zero_copy_threshold bytes are not copied if the scanner can pin their
+   * memory (see CellListScanner::get_pin); the chain references them in
+   * place instead.  The encoded block is identical in both cases.
+   *
+   * @param scanner scanner to pull cells from
+   * @param segments vector to hold the block segments
+   * @param zero_copy_threshold minimum size of a referenced value, or 0 to
+   *        copy all values
+   * @param countp address of variable to hold the number of cells
+   * @param lengthp address of variable to hold the encoded block length
+   * @return true if the scanner has more cells
+   */
+  bool FillScanBlock(CellListScannerPtr &scanner,
+                     CommBuf::SegmentVector &segments,
+                     size_t zero_copy_threshold, size_t *countp,
+                     size_t *lengthp);
+
 }
 
 #endif // HYPERTABLE_FILLSCANBLOCK_H
@@ -40,6 +40,7 @@
 #include "Hypertable/Lib/Client.h"
 #include "Hypertable/Lib/Types.h"
 
+#include "CompactionPipeline.h"
 #include "FileBlockCache.h"
 #include "MaintenanceQueue.h"
 #include "MemoryTracker.h"
@@ -69,6 +70,8 @@ namespace Hypertable {
     static int32_t        access_group_max_files;
     static int32_t        access_group_merge_files;
     static int32_t        access_group_max_mem;
+    static CompactionPipeline::PoolPtr compaction_pipeline_pool;
+    static int32_t        compaction_pipeline_queue_depth;
     static ScannerMap     scanner_map;
     static Hypertable::FileBlockCache *block_cache;
     static TablePtr       metadata_table;
@@ -20,6 +20,7 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <cassert>
 
 #include "Common/Logger.h"
@@ -33,14 +34,24 @@ using namespace Hypertable;
 
 MergeScanner::MergeScanner(ScanContextPtr &scan_ctx, bool return_deletes)
   : CellListScanner(scan_ctx), m_done(false), m_initialized(false),
-    m_scanners(), m_queue(), m_delete_present(false), m_deleted_row(0),
+    m_scanners(), m_runner_up(NONE), m_delete_present(false), m_deleted_row(0),
     m_deleted_column_family(0), m_deleted_cell(0),
     m_return_deletes(return_deletes), m_row_count(0), m_row_limit(0),
-    m_cell_count(0), m_cell_limit(0), m_cell_cutoff(0), m_prev_key(0) {
+    m_cell_count(0), m_cell_limit(0), m_cell_cutoff(0), m_prev_key(0),
+    m_filter(0), m_filter_keys_only(false), m_filter_row_count(0),
+    m_filter_row_limit(0), m_filter_row(0) {
 
   if (scan_ctx->spec != 0)
     m_row_limit = scan_ctx->spec->row_limit;
 
+  // rows without matching cells don't count towards the limit
+  if (!return_deletes && scan_ctx->filter) {
+    m_filter = scan_ctx->filter.get();
+    m_filter_keys_only = scan_ctx->spec->keys_only && !scan_ctx->keys_only;
+    m_filter_row_limit = m_row_limit;
+    m_row_limit = 0;
+  }
+
   m_start_timestamp = scan_ctx->time_interval.first;
   m_end_timestamp = scan_ctx->time_interval.second;
   m_revision = scan_ctx->revision;
@@ -66,89 +77,112 @@ MergeScanner::~MergeScanner() {
 
 
 void MergeScanner::forward() {
-  ScannerState sstate;
-  Key key;
+  merge_forward();
+  if (m_filter)
+    skip_filtered();
+}
+
+
+/**
+ * Moves past the cells rejected by the scan filter and applies the row
+ * limit to the rows that have matching cells.
+ */
+void MergeScanner::skip_filtered() {
+  while (!queue_empty() && !m_done) {
+    ScannerState &sstate = top();
+    if (m_filter->matches(sstate.key, sstate.value)) {
+      if (m_filter_row_limit && (m_filter_row.fill() == 0
+          || strcmp(sstate.key.row, (const char *)m_filter_row.base))) {
+        if (++m_filter_row_count > m_filter_row_limit) {
+          m_done = true;
+          return;
+        }
+        m_filter_row.set(sstate.key.row, strlen(sstate.key.row) + 1);
+      }
+      return;
+    }
+    merge_forward();
+  }
+}
+
+
+void MergeScanner::merge_forward() {
+  ScannerState *sstate;
   size_t len;
 
-  if (m_queue.empty())
+  if (queue_empty())
     return;
 
-  sstate = m_queue.top();
-
   /**
-   * Pop the top element, forward it, re-insert it back into the queue;
+   * Forward the top input and let it find its new place in the tree
    */
   while (true) {
     while (true) {
-      m_queue.pop();
-      sstate.scanner->forward();
-
-      if (sstate.scanner->get(sstate.key, sstate.value))
-        m_queue.push(sstate);
+      advance_top();
 
-      if (m_queue.empty())
+      if (queue_empty())
         return;
 
-      sstate = m_queue.top();
+      sstate = &top();
       m_cell_cutoff = m_scan_context_ptr->family_info[
-          sstate.key.column_family_code].cutoff_time;
+          sstate->key.column_family_code].cutoff_time;
 
-      if(sstate.key.timestamp < m_cell_cutoff )
+      if(sstate->key.timestamp < m_cell_cutoff )
         continue;
 
-      if (sstate.key.timestamp < m_start_timestamp && !m_return_deletes) {
+      if (sstate->key.timestamp < m_start_timestamp && !m_return_deletes) {
         continue;
       }
-      else if (sstate.key.revision > m_revision
-          || (sstate.key.timestamp >= m_end_timestamp && !m_return_deletes)) {
+      else if (sstate->key.revision > m_revision
+          || (sstate->key.timestamp >= m_end_timestamp && !m_return_deletes)) {
         continue;
       }
-      else if (sstate.key.flag == FLAG_DELETE_ROW) {
-        len = sstate.key.len_row();
-        if (matches_deleted_row(sstate.key)) {
-          if (m_deleted_row_timestamp < sstate.key.timestamp)
-            m_deleted_row_timestamp = sstate.key.timestamp;
+      else if (sstate->key.flag == FLAG_DELETE_ROW) {
+        len = sstate->key.len_row();
+        if (matches_deleted_row(sstate->key)) {
+          if (m_deleted_row_timestamp < sstate->key.timestamp)
+            m_deleted_row_timestamp = sstate->key.timestamp;
         }
         else {
           m_deleted_row.clear();
           m_deleted_row.ensure(len);
-          memcpy(m_deleted_row.base, sstate.key.row, len);
+          memcpy(m_deleted_row.base, sstate->key.row, len);
           m_deleted_row.ptr = m_deleted_row.base + len;
-          m_deleted_row_timestamp = sstate.key.timestamp;
+          m_deleted_row_timestamp = sstate->key.timestamp;
           m_delete_present = true;
         }
         if (m_return_deletes)
           break;
       }
-      else if (sstate.key.flag == FLAG_DELETE_COLUMN_FAMILY) {
-        len = sstate.key.len_column_family();
-        if (matches_deleted_column_family(sstate.key)) {
-          if (m_deleted_column_family_timestamp < sstate.key.timestamp)
-            m_deleted_column_family_timestamp = sstate.key.timestamp;
+      else if (sstate->key.flag == FLAG_DELETE_COLUMN_FAMILY) {
+        len = sstate->key.len_column_family();
+        if (matches_deleted_column_family(sstate->key)) {
+          if (m_deleted_column_family_timestamp < sstate->key.timestamp)
+            m_deleted_column_family_timestamp = sstate->key.timestamp;
         }
         else {
           m_deleted_column_family.clear();
           m_deleted_column_family.ensure(len);
-          memcpy(m_deleted_column_family.base, sstate.key.row, len);
+          memcpy(m_deleted_column_family.base, sstate->key.row, len);
           m_deleted_column_family.ptr = m_deleted_column_family.base + len;
-          m_deleted_column_family_timestamp = sstate.key.timestamp;
+          m_deleted_column_family_timestamp = sstate->key.timestamp;
           m_delete_present = true;
         }
         if (m_return_deletes)
           break;
       }
-      else if (sstate.key.flag == FLAG_DELETE_CELL) {
-        len = sstate.key.len_cell();
-        if (matches_deleted_cell(sstate.key)) {
-          if (m_deleted_cell_timestamp < sstate.key.timestamp)
-            m_deleted_cell_timestamp = sstate.key.timestamp;
+      else if (sstate->key.flag == FLAG_DELETE_CELL) {
+        len = sstate->key.len_cell();
+        if (matches_deleted_cell(sstate->key)) {
+          if (m_deleted_cell_timestamp < sstate->key.timestamp)
+            m_deleted_cell_timestamp = sstate->key.timestamp;
         }
         else {
           m_deleted_cell.clear();
           m_deleted_cell.ensure(len);
-          memcpy(m_deleted_cell.base, sstate.key.row, len);
+          memcpy(m_deleted_cell.base, sstate->key.row, len);
           m_deleted_cell.ptr = m_deleted_cell.base + len;
-          m_deleted_cell_timestamp = sstate.key.timestamp;
+          m_deleted_cell_timestamp = sstate->key.timestamp;
           m_delete_present = true;
         }
         if (m_return_deletes)
@@ -159,26 +193,26 @@ void MergeScanner::forward() {
         // revision intervals.
         if (m_delete_present) {
           if (m_deleted_cell.fill() > 0) {
-            if(!matches_deleted_cell(sstate.key))
+            if(!matches_deleted_cell(sstate->key))
               // we wont see the previously seen deleted cell again
               m_deleted_cell.clear();
-            else if (sstate.key.timestamp < m_deleted_cell_timestamp)
+            else if (sstate->key.timestamp < m_deleted_cell_timestamp)
               // apply previously seen delete cell to this cell
               continue;
           }
           if (m_deleted_column_family.fill() > 0) {
-            if(!matches_deleted_column_family(sstate.key))
+            if(!matches_deleted_column_family(sstate->key))
               // we wont see the previously seen deleted column family again
               m_deleted_column_family.clear();
-            else if (sstate.key.timestamp < m_deleted_column_family_timestamp)
+            else if (sstate->key.timestamp < m_deleted_column_family_timestamp)
               // apply previously seen delete column family to this cell
               continue;
           }
           if (m_deleted_row.fill() > 0) {
-            if(!matches_deleted_row(sstate.key))
+            if(!matches_deleted_row(sstate->key))
               // we wont see the previously seen deleted row family again
               m_deleted_row.clear();
-            else if (sstate.key.timestamp < m_deleted_row_timestamp)
+            else if (sstate->key.timestamp < m_deleted_row_timestamp)
               // apply previously seen delete row family to this cell
               continue;
           }
@@ -190,13 +224,13 @@ void MergeScanner::forward() {
       }
     }
 
-    const uint8_t *prev_key = (const uint8_t *)sstate.key.row;
-    size_t prev_key_len = sstate.key.flag_ptr
-                          - (const uint8_t *)sstate.key.row + 1;
+    const uint8_t *prev_key = (const uint8_t *)sstate->key.row;
+    size_t prev_key_len = sstate->key.flag_ptr
+                          - (const uint8_t *)sstate->key.row + 1;
 
     if (m_prev_key.fill() != 0) {
       if (m_row_limit) {
-        if (strcmp(sstate.key.row, (const char *)m_prev_key.base)) {
+        if (strcmp(sstate->key.row, (const char *)m_prev_key.base)) {
           m_row_count++;
           if (!m_return_deletes && m_row_count >= m_row_limit) {
             m_done = true;
@@ -204,7 +238,7 @@ void MergeScanner::forward() {
           }
           m_prev_key.set(prev_key, prev_key_len);
           m_cell_limit = m_scan_context_ptr->family_info[
-              sstate.key.column_family_code].max_versions;
+              sstate->key.column_family_code].max_versions;
           m_cell_count = 0;
           return;
         }
@@ -222,7 +256,7 @@ void MergeScanner::forward() {
       else {
         m_prev_key.set(prev_key, prev_key_len);
         m_cell_limit = m_scan_context_ptr->family_info[
-            sstate.key.column_family_code].max_versions;
+            sstate->key.column_family_code].max_versions;
         m_cell_count = 0;
       }
 
@@ -230,7 +264,7 @@ void MergeScanner::forward() {
     else {
       m_prev_key.set(prev_key, prev_key_len);
       m_cell_limit = m_scan_context_ptr->family_info[
-          sstate.key.column_family_code].max_versions;
+          sstate->key.column_family_code].max_versions;
       m_cell_count = 0;
     }
     break;
@@ -238,95 +272,94 @@ void MergeScanner::forward() {
 }
 
 bool MergeScanner::get(Key &key, ByteString &value) {
-  if (!m_initialized)
+  if (!m_initialized) {
     initialize();
+    if (m_filter)
+      skip_filtered();
+  }
 
-  if (!m_queue.empty() && !m_done) {
-    const ScannerState &sstate = m_queue.top();
+  if (!queue_empty() && !m_done) {
+    const ScannerState &sstate = top();
     // check for row or cell limit
     key = sstate.key;
-    value = sstate.value;
+    if (m_filter_keys_only)
+      value = 0;
+    else
+      value = sstate.value;
     return true;
   }
   return false;
 }
 
 void MergeScanner::initialize() {
-  ScannerState sstate;
-
-  while (!m_queue.empty())
-    m_queue.pop();
+  ScannerState *sstate;
 
+  m_states.resize(m_scanners.size());
   for (size_t i=0; i<m_scanners.size(); i++) {
-    if (m_scanners[i]->get(sstate.key, sstate.value)) {
-      sstate.scanner = m_scanners[i];
-      m_queue.push(sstate);
-    }
+    m_states[i].scanner = m_scanners[i];
+    m_states[i].valid = m_scanners[i]->get(m_states[i].key,
+                                           m_states[i].value);
   }
-  while (!m_queue.empty()) {
-    sstate = m_queue.top();
+  build_tree();
+
+  while (!queue_empty()) {
+    sstate = &top();
 
     m_cell_cutoff = m_scan_context_ptr->family_info[
-        sstate.key.column_family_code].cutoff_time;
-
-    if (sstate.key.timestamp < m_cell_cutoff
-        || (sstate.key.timestamp < m_start_timestamp && !m_return_deletes)) {
-      m_queue.pop();
-      sstate.scanner->forward();
-      if (sstate.scanner->get(sstate.key, sstate.value))
-        m_queue.push(sstate);
+        sstate->key.column_family_code].cutoff_time;
+
+    if (sstate->key.timestamp < m_cell_cutoff
+        || (sstate->key.timestamp < m_start_timestamp && !m_return_deletes)) {
+      advance_top();
       continue;
     }
 
-    if (sstate.key.flag == FLAG_DELETE_ROW) {
-      size_t len = sstate.key.len_row();
+    if (sstate->key.flag == FLAG_DELETE_ROW) {
+      size_t len = sstate->key.len_row();
       m_deleted_row.clear();
       m_deleted_row.ensure(len);
-      memcpy(m_deleted_row.base, sstate.key.row, len);
+      memcpy(m_deleted_row.base, sstate->key.row, len);
       m_deleted_row.ptr = m_deleted_row.base + len;
-      m_deleted_row_timestamp = sstate.key.timestamp;
+      m_deleted_row_timestamp = sstate->key.timestamp;
       m_delete_present = true;
       if (!m_return_deletes)
-        forward();
+        merge_forward();
     }
-    else if (sstate.key.flag == FLAG_DELETE_COLUMN_FAMILY) {
-      size_t len = sstate.key.len_column_family();
+    else if (sstate->key.flag == FLAG_DELETE_COLUMN_FAMILY) {
+      size_t len = sstate->key.len_column_family();
       m_deleted_column_family.clear();
       m_deleted_column_family.ensure(len);
-      memcpy(m_deleted_column_family.base, sstate.key.row, len);
+      memcpy(m_deleted_column_family.base, sstate->key.row, len);
       m_deleted_column_family.ptr = m_deleted_column_family.base + len;
-      m_deleted_column_family_timestamp = sstate.key.timestamp;
+      m_deleted_column_family_timestamp = sstate->key.timestamp;
       m_delete_present = true;
       if (!m_return_deletes)
-        forward();
+        merge_forward();
     }
-    else if (sstate.key.flag == FLAG_DELETE_CELL) {
-      size_t len = sstate.key.len_cell();
+    else if (sstate->key.flag == FLAG_DELETE_CELL) {
+      size_t len = sstate->key.len_cell();
       m_deleted_cell.clear();
       m_deleted_cell.ensure(len);
-      memcpy(m_deleted_cell.base, sstate.key.row, len);
+      memcpy(m_deleted_cell.base, sstate->key.row, len);
       m_deleted_cell.ptr = m_deleted_cell.base + len;
-      m_deleted_cell_timestamp = sstate.key.timestamp;
+      m_deleted_cell_timestamp = sstate->key.timestamp;
       m_delete_present = true;
       if (!m_return_deletes)
-        forward();
+        merge_forward();
     }
     else {
-      if (sstate.key.revision > m_revision
-          || (sstate.key.timestamp >= m_end_timestamp && !m_return_deletes)) {
-        m_queue.pop();
-        sstate.scanner->forward();
-        if (sstate.scanner->get(sstate.key, sstate.value))
-          m_queue.push(sstate);
+      if (sstate->key.revision > m_revision
+          || (sstate->key.timestamp >= m_end_timestamp && !m_return_deletes)) {
+        advance_top();
         continue;
       }
       m_delete_present = false;
-      m_prev_key.set(sstate.key.row, sstate.key.flag_ptr
-                     - (const uint8_t *)sstate.key.row + 1);
+      m_prev_key.set(sstate->key.row, sstate->key.flag_ptr
+                     - (const uint8_t *)sstate->key.row + 1);
       m_cell_limit = m_scan_context_ptr->family_info[
-          sstate.key.column_family_code].max_versions;
+          sstate->key.column_family_code].max_versions;
       m_cell_cutoff = m_scan_context_ptr->family_info[
-          sstate.key.column_family_code].cutoff_time;
+          sstate->key.column_family_code].cutoff_time;
       m_cell_count = 0;
     }
     break;
@@ -334,3 +367,83 @@ void MergeScanner::initialize() {
   m_initialized = true;
 }
 
+
+
+/**
+ * Builds the loser tree over m_states.  Input i is leaf n+i of an implicit
+ * binary tree whose internal nodes 1..n-1 hold the loser of the match
+ * between the winners of their two subtrees.  m_tree[0] holds the overall
+ * winner.
+ */
+void MergeScanner::build_tree() {
+  size_t n = m_states.size();
+
+  m_tree.clear();
+  m_runner_up = NONE;
+
+  if (n == 0)
+    return;
+
+  std::vector<size_t> winners(2*n);
+
+  m_tree.resize(n);
+  for (size_t i=0; i<n; i++)
+    winners[n+i] = i;
+
+  for (size_t node=n-1; node>0; node--) {
+    size_t winner = winners[2*node];
+    size_t loser = winners[2*node+1];
+    if (less(loser, winner))
+      std::swap(winner, loser);
+    winners[node] = winner;
+    m_tree[node] = loser;
+  }
+  m_tree[0] = (n == 1) ? 0 : winners[1];
+
+  update_runner_up();
+}
+
+
+/**
+ * Replays the matches on the path from the given input's leaf to the
+ * root.  Called after that input, the previous winner, changed.
+ */
+void MergeScanner::replay(size_t winner) {
+  size_t n = m_states.size();
+
+  for (size_t node=(n+winner)/2; node>0; node/=2) {
+    if (less(m_tree[node], winner))
+      std::swap(m_tree[node], winner);
+  }
+  m_tree[0] = winner;
+
+  update_runner_up();
+}
+
+
+/**
+ * The runner-up is the smallest of the losers on the winner's path; as
+ * long as the winner's next cell sorts before it, the tree is unchanged.
+ */
+void MergeScanner::update_runner_up() {
+  size_t n = m_states.size();
+  size_t winner = m_tree[0];
+
+  m_runner_up = NONE;
+  for (size_t node=(n+winner)/2; node>0; node/=2) {
+    if (less(m_tree[node], m_runner_up))
+      m_runner_up = m_tree[node];
+  }
+}
+
+
+void MergeScanner::advance_top() {
+  size_t winner = m_tree[0];
+  ScannerState &sstate = m_states[winner];
+
+  sstate.scanner->forward();
+  sstate.valid = sstate.scanner->get(sstate.key, sstate.value);
+
+  if (!less(winner, m_runner_up))
+    replay(winner);
+}
@@ -22,7 +22,6 @@
 #ifndef HYPERTABLE_MERGESCANNER_H
 #define HYPERTABLE_MERGESCANNER_H
 
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -35,24 +34,37 @@
 
 namespace Hypertable {
 
+  /**
+   * Merges the cells of several CellListScanners into a single sorted
+   * stream, applying deletes, time/revision intervals and version limits.
+   * A scanner that does not return deletes also applies the scan's cell
+   * predicates, after the version limits.
+   *
+   * The inputs are merged with a loser tree (tournament tree) of input
+   * indices.  Each input's current cell lives in a fixed ScannerState slot
+   * and is refreshed in place when the input is forwarded, so cells are
+   * never copied around a heap.  Replacing the top costs one comparison
+   * per tree level; in addition, the best cell among the other inputs (the
+   * runner-up) is remembered, so while the same input keeps supplying the
+   * smallest cell, forward() needs a single comparison.
+   */
   class MergeScanner : public CellListScanner {
   public:
     struct ScannerState {
+      ScannerState() : scanner(0), valid(false) { }
       CellListScanner *scanner;
       Key key;
       ByteString value;
-    };
-
-    struct LtScannerState {
-      bool operator()(const ScannerState &ss1, const ScannerState &ss2) const {
-        return !(ss1.key.serial < ss2.key.serial);
-      }
+      bool valid;               // false once the scanner is exhausted
     };
 
     MergeScanner(ScanContextPtr &scan_ctx, bool return_everything=true);
     virtual ~MergeScanner();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual ReferenceCount *get_pin() {
+      return queue_empty() ? 0 : top().scanner->get_pin();
+    }
     void add_scanner(CellListScanner *scanner);
 
     void install_release_callback(CellStoreReleaseCallback &cb) {
@@ -60,7 +72,32 @@ namespace Hypertable {
     }
 
   private:
+    static const size_t NONE = (size_t)-1;
+
     void initialize();
+
+    /** Returns true if input a sorts before input b (NONE sorts last) */
+    inline bool less(size_t a, size_t b) const {
+      if (a == NONE || !m_states[a].valid)
+        return false;
+      if (b == NONE || !m_states[b].valid)
+        return true;
+      int cmp = m_states[a].key.serial.compare(m_states[b].key.serial);
+      return cmp < 0 || (cmp == 0 && a < b);
+    }
+
+    bool queue_empty() const {
+      return m_tree.empty() || !m_states[m_tree[0]].valid;
+    }
+
+    ScannerState &top() { return m_states[m_tree[0]]; }
+
+    void merge_forward();
+    void skip_filtered();
+    void build_tree();
+    void replay(size_t winner);
+    void update_runner_up();
+    void advance_top();
     inline bool matches_deleted_row(const Key& key) const {
       size_t len = key.len_row();
 
@@ -99,8 +136,9 @@ namespace Hypertable {
     bool          m_done;
     bool          m_initialized;
     std::vector<CellListScanner *>  m_scanners;
-    std::priority_queue<ScannerState, std::vector<ScannerState>,
-        LtScannerState> m_queue;
+    std::vector<ScannerState> m_states;
+    std::vector<size_t> m_tree;     // [0] is the winner, [1..n) the losers
+    size_t        m_runner_up;
     bool          m_delete_present;
     DynamicBuffer m_deleted_row;
     int64_t       m_deleted_row_timestamp;
@@ -120,6 +158,11 @@ namespace Hypertable {
     int64_t       m_end_timestamp;
     int64_t       m_revision;
     DynamicBuffer m_prev_key;
+    ScanFilter   *m_filter;
+    bool          m_filter_keys_only;   // drop values kept for the filter
+    int32_t       m_filter_row_count;
+    int32_t       m_filter_row_limit;
+    DynamicBuffer m_filter_row;
     CellStoreReleaseCallback m_release_callback;
   };
 
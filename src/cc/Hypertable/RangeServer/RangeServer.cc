@@ -34,11 +34,16 @@ extern "C" {
 #include <sys/resource.h>
 }
 
+#include "Common/Checksum.h"
 #include "Common/FileUtils.h"
 #include "Common/md5.h"
 #include "Common/StringExt.h"
 #include "Common/SystemInfo.h"
+#include "Common/Time.h"
 
+#include "AsyncComm/ReactorFactory.h"
+
+#include "Hypertable/Lib/BlockCompressionHeader.h"
 #include "Hypertable/Lib/CommitLog.h"
 #include "Hypertable/Lib/Defaults.h"
 #include "Hypertable/Lib/Key.h"
@@ -77,15 +82,31 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   SubProperties cfg(props, "Hypertable.RangeServer.");
 
   m_verbose = props->get_bool("verbose");
+  boost::xtime_get(&m_last_dump_time, boost::TIME_UTC);
   Global::range_metadata_split_size = cfg.get_i64("Range.MetadataSplitSize", 0);
   Global::range_split_size = cfg.get_i64("Range.SplitSize");
   Global::range_maximum_size = cfg.get_i64("Range.MaximumSize");
   Global::access_group_max_files = cfg.get_i32("AccessGroup.MaxFiles");
   Global::access_group_merge_files = cfg.get_i32("AccessGroup.MergeFiles");
   Global::access_group_max_mem = cfg.get_i64("AccessGroup.MaxMemory");
+  int32_t pipeline_threads = cfg.get_i32("Compaction.Pipeline.Threads");
+  if (pipeline_threads > 0)
+    Global::compaction_pipeline_pool =
+        new CompactionPipeline::Pool(pipeline_threads);
+  Global::compaction_pipeline_queue_depth =
+      cfg.get_i32("Compaction.Pipeline.QueueDepth");
   maintenance_threads = cfg.get_i32("MaintenanceThreads", maintenance_threads);
   port = cfg.get_i16("Port");
   m_scanner_ttl = (time_t)cfg.get_i32("Scanner.Ttl");
+  m_scanner_zero_copy_threshold = cfg.get_i32("Scanner.ZeroCopyThreshold");
+  m_aggregate_scan_max_bytes = cfg.get_i32("AggregateScan.MaxBytes");
+
+  String block_checksum = cfg.get_str("BlockChecksum");
+  int block_checksum_type = checksum_type(block_checksum.c_str());
+  if (block_checksum_type < 0)
+    HT_THROWF(Error::CONFIG_BAD_VALUE, "Unknown block checksum algorithm "
+              "'%s'", block_checksum.c_str());
+  BlockCompressionHeader::set_default_data_checksum_type(block_checksum_type);
 
   if (Global::access_group_merge_files > Global::access_group_max_files)
     Global::access_group_merge_files = Global::access_group_max_files;
@@ -108,9 +129,13 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   m_update_delay = cfg.get_i32("UpdateDelay", 0);
 
   uint64_t block_cacheMemory = cfg.get_i64("BlockCache.MaxMemory");
-  Global::block_cache = new FileBlockCache(block_cacheMemory);
+  uint64_t compressed_block_cacheMemory =
+      cfg.get_i64("BlockCache.Compressed.MaxMemory");
+  Global::block_cache = new FileBlockCache(block_cacheMemory,
+                                           compressed_block_cacheMemory,
+                                           cfg.get_i32("BlockCache.Shards"));
 
-  Global::memory_tracker.add(block_cacheMemory);
+  Global::memory_tracker.add(block_cacheMemory + compressed_block_cacheMemory);
 
   Global::protocol = new Hypertable::RangeServerProtocol();
 
@@ -218,6 +243,7 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
 
 
 RangeServer::~RangeServer() {
+  Global::compaction_pipeline_pool = 0;
   delete Global::block_cache;
   delete Global::protocol;
   m_hyperspace = 0;
@@ -622,7 +648,7 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
     wait_for_recovery_finish(table, range_spec);
 
   try {
-    DynamicBuffer rbuf;
+    CommBuf::SegmentVector segments;
 
     if (scan_spec->row_intervals.size() > 0) {
       if (scan_spec->row_intervals.size() > 1)
@@ -671,8 +697,9 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
     range->decrement_scan_counter();
     decrement_needed = false;
 
-    size_t count;
-    more = FillScanBlock(scanner, rbuf, &count);
+    size_t count, length;
+    more = FillScanBlock(scanner, segments, m_scanner_zero_copy_threshold,
+                         &count, &length);
 
     id = (more) ? Global::scanner_map.put(scanner, range, table) : 0;
 
@@ -684,8 +711,7 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
      */
     {
       short moreflag = more ? 0 : 1;
-      StaticBuffer ext(rbuf);
-      if ((error = cb->response(moreflag, id, ext)) != Error::OK) {
+      if ((error = cb->response(moreflag, id, segments)) != Error::OK) {
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
       }
     }
@@ -719,7 +745,7 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
   CellListScannerPtr scanner;
   RangePtr range;
   bool more = true;
-  DynamicBuffer rbuf;
+  CommBuf::SegmentVector segments;
   TableInfoPtr table_info;
   TableIdentifierManaged scanner_table;
   SchemaPtr schema;
@@ -732,6 +758,13 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
       HT_THROW(Error::RANGESERVER_INVALID_SCANNER_ID,
                format("scanner ID %d", scanner_id));
 
+    // readahead request that arrived after the last block was sent
+    if (!scanner) {
+      if ((error = cb->response_exhausted(scanner_id)) != Error::OK)
+        HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+      return;
+    }
+
     m_live_map->get(&scanner_table, table_info);
 
     schema = table_info->get_schema();
@@ -745,26 +778,26 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
                       schema->get_generation(), scanner_table.generation));
     }
 
-    range->add_bytes_read( rbuf.fill() );
+    size_t count, length;
+    more = FillScanBlock(scanner, segments, m_scanner_zero_copy_threshold,
+                         &count, &length);
 
-    size_t count;
-    more = FillScanBlock(scanner, rbuf, &count);
+    range->add_bytes_read(length);
 
     if (!more)
-      Global::scanner_map.remove(scanner_id);
+      Global::scanner_map.mark_exhausted(scanner_id);
 
     /**
      *  Send back data
      */
     {
       short moreflag = more ? 0 : 1;
-      StaticBuffer ext(rbuf);
 
-      if ((error = cb->response(moreflag, scanner_id, ext)) != Error::OK)
+      if ((error = cb->response(moreflag, scanner_id, segments)) != Error::OK)
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
 
       HT_DEBUGF("Successfully fetched %u bytes (%d k/v pairs) of scan data",
-                ext.size-4, (int)count);
+                (unsigned)length-4, (int)count);
     }
 
   }
@@ -776,6 +809,291 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
 }
 
 
+/**
+ * Looks up the row intervals in scan_spec (each must name a single row)
+ * in order and returns the matching cells in one scan block.  A
+ * short-lived scanner is created per row so the access groups can consult
+ * their CellStore bloom filters and block indexes, and nothing is
+ * registered in the scanner map.  Once the block holds
+ * DATA_TRANSFER_BLOCKSIZE bytes, no further rows are looked up (a row is
+ * never split).  The scanner id field of the response then holds the
+ * number of rows answered and the eos flag is clear, so the client can
+ * send the remaining rows again.
+ */
+void
+RangeServer::get_cells(ResponseCallbackFetchScanblock *cb,
+    const TableIdentifier *table, const RangeSpec *range_spec,
+    const ScanSpec *scan_spec) {
+  int error = Error::OK;
+  TableInfoPtr table_info;
+  RangePtr range;
+  SchemaPtr schema;
+  bool decrement_needed=false;
+
+  HT_DEBUG_OUT <<"Getting cells:\n"<< *table << *range_spec
+               << *scan_spec << HT_END;
+
+  if (!m_replay_finished)
+    wait_for_recovery_finish(table, range_spec);
+
+  try {
+    DynamicBuffer dbuf(DATA_TRANSFER_BLOCKSIZE);
+    ScanSpec row_spec;
+    CellListScannerPtr scanner;
+    ScanContextPtr scan_ctx;
+    Key key;
+    ByteString value;
+    size_t value_len, count = 0, rows_answered = 0;
+    uint8_t *ptr;
+    short moreflag;
+
+    if (scan_spec->cell_intervals.size() > 0)
+      HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
+               "get cells does not take cell intervals");
+
+    foreach(const RowInterval &ri, scan_spec->row_intervals) {
+      if (!ri.start_inclusive || !ri.end_inclusive || strcmp(ri.start, ri.end))
+        HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC,
+                  "get cells row interval is not a single row (%s..%s)",
+                  ri.start, ri.end);
+    }
+
+    m_live_map->get(table, table_info);
+
+    if (!table_info->get_range(range_spec, range))
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "(a) %s[%s..%s]",
+                table->name, range_spec->start_row, range_spec->end_row);
+
+    schema = table_info->get_schema();
+
+    // verify schema
+    if (schema->get_generation() != table->generation) {
+      HT_THROW(Error::RANGESERVER_GENERATION_MISMATCH,
+               (String)"RangeServer Schema generation for table '"
+               + table_info->get_name() + "' is " +
+               schema->get_generation() + " but supplied is "
+               + table->generation);
+    }
+
+    range->increment_scan_counter();
+    decrement_needed = true;
+
+    // Check to see if range just shrunk
+    if (strcmp(range->start_row().c_str(), range_spec->start_row) ||
+        strcmp(range->end_row().c_str(), range_spec->end_row))
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "(b) %s[%s..%s]",
+                table->name, range_spec->start_row, range_spec->end_row);
+
+    // skip encoded length
+    dbuf.ptr = dbuf.base + 4;
+
+    scan_spec->base_copy(row_spec);
+    row_spec.row_intervals.resize(1);
+
+    foreach(const RowInterval &ri, scan_spec->row_intervals) {
+      if (dbuf.fill() >= DATA_TRANSFER_BLOCKSIZE)
+        break;
+      row_spec.row_intervals[0] = ri;
+      scan_ctx = new ScanContext(range->get_scan_revision(),
+                                 &row_spec, range_spec, schema);
+      scanner = range->create_scanner(scan_ctx);
+      while (scanner->get(key, value)) {
+        value_len = value.length();
+        dbuf.ensure(key.length + value_len);
+        dbuf.add_unchecked(key.serial.ptr, key.length);
+        dbuf.add_unchecked(value.ptr, value_len);
+        scanner->forward();
+        count++;
+      }
+      rows_answered++;
+    }
+    scanner = 0;
+    moreflag = rows_answered < scan_spec->row_intervals.size() ? 0 : 1;
+
+    range->decrement_scan_counter();
+    decrement_needed = false;
+
+    range->add_bytes_read(dbuf.fill());
+
+    ptr = dbuf.base;
+    Serialization::encode_i32(&ptr, dbuf.fill() - 4);
+
+    HT_DEBUGF("Successfully got %d k/v pairs for %d of %d rows from table "
+              "'%s'", (int)count, (int)rows_answered,
+              (int)scan_spec->row_intervals.size(), table->name);
+
+    /**
+     *  Send back data
+     */
+    {
+      StaticBuffer ext(dbuf);
+      if ((error = cb->response(moreflag, rows_answered, ext)) != Error::OK)
+        HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+    }
+  }
+  catch (Hypertable::Exception &e) {
+    if (decrement_needed)
+      range->decrement_scan_counter();
+    if (e.code() == Error::RANGESERVER_RANGE_NOT_FOUND)
+      HT_INFO_OUT << e << HT_END;
+    else
+      HT_ERROR_OUT << e << HT_END;
+    if ((error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+}
+
+
+/**
+ * Scans the part of the range selected by scan_spec, starting at
+ * resume_row if it is not empty, and returns the ScanAggregate of the
+ * cells (counts and numeric sum/min/max of the values) instead of the
+ * cells.  Nothing is registered in the scanner map.  The scan stops at the
+ * first row boundary after Hypertable.RangeServer.AggregateScan.MaxBytes
+ * of keys and values have been read, and that row is returned for the
+ * client to resume from.  With keys_only, values are not read and only
+ * cells and rows are counted.
+ */
+void
+RangeServer::aggregate_scan(ResponseCallbackAggregateScan *cb,
+    const TableIdentifier *table, const RangeSpec *range_spec,
+    const ScanSpec *scan_spec, const char *resume_row) {
+  int error = Error::OK;
+  TableInfoPtr table_info;
+  RangePtr range;
+  SchemaPtr schema;
+  bool decrement_needed=false;
+
+  HT_DEBUG_OUT <<"Aggregate scan:\n"<< *table << *range_spec
+               << *scan_spec << HT_END;
+
+  if (!m_replay_finished)
+    wait_for_recovery_finish(table, range_spec);
+
+  try {
+    ScanAggregate result;
+    CellListScannerPtr scanner;
+    ScanContextPtr scan_ctx;
+    ScanSpec resumed_spec;
+    String first_column;
+    String last_row;
+    String next_row;
+    Key key;
+    ByteString value;
+    const uint8_t *value_ptr;
+    size_t value_len;
+    uint64_t bytes_scanned = 0;
+
+    if (scan_spec->row_intervals.size() + scan_spec->cell_intervals.size() > 1)
+      HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
+               "aggregate scan takes at most one row or cell interval");
+
+    m_live_map->get(table, table_info);
+
+    if (!table_info->get_range(range_spec, range))
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "(a) %s[%s..%s]",
+                table->name, range_spec->start_row, range_spec->end_row);
+
+    schema = table_info->get_schema();
+
+    // verify schema
+    if (schema->get_generation() != table->generation) {
+      HT_THROW(Error::RANGESERVER_GENERATION_MISMATCH,
+               (String)"RangeServer Schema generation for table '"
+               + table_info->get_name() + "' is " +
+               schema->get_generation() + " but supplied is "
+               + table->generation);
+    }
+
+    range->increment_scan_counter();
+    decrement_needed = true;
+
+    // Check to see if range just shrunk
+    if (strcmp(range->start_row().c_str(), range_spec->start_row) ||
+        strcmp(range->end_row().c_str(), range_spec->end_row))
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "(b) %s[%s..%s]",
+                table->name, range_spec->start_row, range_spec->end_row);
+
+    // start the interval at the resume row
+    if (*resume_row) {
+      scan_spec->base_copy(resumed_spec);
+      if (!scan_spec->cell_intervals.empty()) {
+        CellInterval ci = scan_spec->cell_intervals[0];
+        // an empty start column would also drop the start row, so start
+        // at the family that sorts first
+        for (size_t id=1; id<=schema->get_max_column_family_id(); id++) {
+          Schema::ColumnFamily *cf = schema->get_column_family(id);
+          if (cf) {
+            first_column = cf->name;
+            break;
+          }
+        }
+        ci.start_row = resume_row;
+        ci.start_column = first_column.c_str();
+        ci.start_inclusive = true;
+        resumed_spec.cell_intervals.push_back(ci);
+      }
+      else {
+        RowInterval ri("", true, "", true);
+        if (!scan_spec->row_intervals.empty())
+          ri = scan_spec->row_intervals[0];
+        ri.start = resume_row;
+        ri.start_inclusive = true;
+        resumed_spec.row_intervals.push_back(ri);
+      }
+      scan_spec = &resumed_spec;
+    }
+
+    scan_ctx = new ScanContext(range->get_scan_revision(), scan_spec,
+                               range_spec, schema);
+    scanner = range->create_scanner(scan_ctx);
+
+    while (scanner->get(key, value)) {
+      if (result.rows == 0 || strcmp(key.row, last_row.c_str())) {
+        if (bytes_scanned >= m_aggregate_scan_max_bytes) {
+          next_row = key.row;
+          break;
+        }
+        last_row = key.row;
+        result.rows++;
+      }
+      result.cells++;
+      bytes_scanned += key.length;
+      if (value.ptr) {
+        value_len = value.decode_length(&value_ptr);
+        result.add_value(value_ptr, value_len);
+        bytes_scanned += value_len;
+      }
+      scanner->forward();
+    }
+    scanner = 0;
+
+    range->decrement_scan_counter();
+    decrement_needed = false;
+
+    range->add_bytes_read(bytes_scanned);
+
+    HT_DEBUG_OUT <<"Aggregate scan of "<< table->name <<"["
+                 << range_spec->start_row <<".."<< range_spec->end_row
+                 <<"] from '"<< resume_row <<"' to '"<< next_row <<"' - "
+                 << result << HT_END;
+
+    if ((error = cb->response(result, next_row)) != Error::OK)
+      HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+  }
+  catch (Hypertable::Exception &e) {
+    if (decrement_needed)
+      range->decrement_scan_counter();
+    if (e.code() == Error::RANGESERVER_RANGE_NOT_FOUND)
+      HT_INFO_OUT << e << HT_END;
+    else
+      HT_ERROR_OUT << e << HT_END;
+    if ((error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+}
+
+
 void
 RangeServer::load_range(ResponseCallback *cb, const TableIdentifier *table,
     const RangeSpec *range_spec, const char *transfer_log_dir,
@@ -1161,6 +1479,8 @@ RangeServer::update(ResponseCallbackUpdate *cb, const TableIdentifier *table,
   ByteString value;
   bool a_locked = false;
   bool b_locked = false;
+  CommitLog *turn_log = 0;
+  uint64_t turn_ticket = 0;
   vector<SendBackRec> send_back_vector;
   SendBackRec send_back;
   uint32_t total_added = 0;
@@ -1462,7 +1782,25 @@ RangeServer::update(ResponseCallbackUpdate *cb, const TableIdentifier *table,
       else
         log = Global::user_log;
 
-      if ((error = log->write(go_buf, last_revision, sync)) != Error::OK)
+      if (log->group_commit_enabled()) {
+        // Enqueue while holding m_update_mutex_b to keep the log in revision
+        // order, then let the next update proceed while this block gets
+        // committed as part of a group.  The updates are applied below in
+        // ticket order, as they would be under m_update_mutex_b, so that the
+        // revision a range reaches never gets ahead of an update still
+        // to be applied to it (compactions use that revision to decide
+        // which commit log fragments can be purged)
+        turn_ticket = log->enqueue(go_buf, last_revision, sync);
+        m_update_mutex_b.unlock();
+        b_locked = false;
+        error = log->wait_for_commit(turn_ticket);
+        log->wait_for_turn(turn_ticket);
+        turn_log = log;
+      }
+      else
+        error = log->write(go_buf, last_revision, sync);
+
+      if (error != Error::OK)
         HT_THROWF(error, "Problem writing %d bytes to commit log (%s)",
                   (int)go_buf.fill(), log->get_log_dir().c_str());
     }
@@ -1508,6 +1846,9 @@ RangeServer::update(ResponseCallbackUpdate *cb, const TableIdentifier *table,
     errmsg = e.what();
   }
 
+  if (turn_log)
+    turn_log->end_turn(turn_ticket);
+
   // decrement usage counters for all referenced ranges
   foreach(Range *range, reference_set)
     range->decrement_update_counter();
@@ -1671,6 +2012,62 @@ void RangeServer::dump(ResponseCallback *cb, const char *outfile,
 
     out << str;
 
+    out << "\nApplication Queue Info\n";
+    ApplicationQueue::Stats aq_stats;
+    m_app_queue->get_stats(aq_stats);
+    out << "app-queue\turgent-depth\t" << aq_stats.urgent_depth << "\n";
+    out << "app-queue\tdepth\t" << aq_stats.depth << "\n";
+    out << "app-queue\tgroups\t" << aq_stats.groups << "\n";
+    out << "app-queue\tdispatched\t" << aq_stats.dispatched << "\n";
+    out << "app-queue\texpired\t" << aq_stats.expired << "\n";
+    for (size_t i=0; i<ApplicationQueue::HISTOGRAM_BUCKETS; i++) {
+      if (aq_stats.depth_histogram.buckets[i])
+        out << "app-queue-depth[<" << (1ULL << i) << "]\tcount\t"
+            << aq_stats.depth_histogram.buckets[i] << "\n";
+    }
+    for (size_t i=0; i<ApplicationQueue::HISTOGRAM_BUCKETS; i++) {
+      if (aq_stats.wait_histogram.buckets[i])
+        out << "app-queue-wait-us[<" << (1ULL << i) << "]\tcount\t"
+            << aq_stats.wait_histogram.buckets[i] << "\n";
+    }
+
+    out << "\nReceive Buffer Pool Info\n";
+    BufferPool::Stats pool_stats;
+    boost::xtime now;
+    ReactorFactory::get_receive_pool_stats(pool_stats);
+    boost::xtime_get(&now, boost::TIME_UTC);
+    out << "receive-pool\tallocations\t" << pool_stats.allocations << "\n";
+    out << "receive-pool\thits\t" << pool_stats.hits << "\n";
+    out << "receive-pool\toversized\t" << pool_stats.oversized << "\n";
+    out << "receive-pool\tpooled-buffers\t" << pool_stats.pooled_buffers
+        << "\n";
+    out << "receive-pool\tpooled-bytes\t" << pool_stats.pooled_bytes << "\n";
+    {
+      // rates are over the interval since the previous dump
+      ScopedLock lock(m_mutex);
+      uint64_t allocations = pool_stats.allocations
+                             - m_last_receive_pool_stats.allocations;
+      uint64_t hits = pool_stats.hits - m_last_receive_pool_stats.hits;
+      int64_t elapsed_millis = xtime_diff_millis(m_last_dump_time, now);
+      if (elapsed_millis > 0)
+        out << "receive-pool\tallocations/s\t"
+            << (allocations * 1000 / elapsed_millis) << "\n";
+      if (allocations)
+        out << "receive-pool\thit-rate\t" << ((double)hits / allocations)
+            << "\n";
+      m_last_receive_pool_stats = pool_stats;
+      m_last_dump_time = now;
+    }
+
+    out << "\nComm Send Info\n";
+    Reactor::SendStats send_stats;
+    ReactorFactory::get_send_stats(send_stats);
+    out << "comm-send\tmessages\t" << send_stats.messages << "\n";
+    out << "comm-send\tsyscalls\t" << send_stats.syscalls << "\n";
+    if (send_stats.messages)
+      out << "comm-send\tsyscalls/message\t"
+          << ((double)send_stats.syscalls / send_stats.messages) << "\n";
+
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -1703,6 +2100,8 @@ void RangeServer::get_statistics(ResponseCallbackGetStatistics *cb) {
     }
   }
 
+  Global::block_cache->get_stats(stat.block_cache_stats);
+
   StaticBuffer ext(stat.encoded_length());
   uint8_t *bufp = ext.base;
   stat.encode(&bufp);
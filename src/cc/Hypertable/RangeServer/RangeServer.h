@@ -41,6 +41,7 @@
 
 #include "Global.h"
 #include "MaintenanceScheduler.h"
+#include "ResponseCallbackAggregateScan.h"
 #include "ResponseCallbackCreateScanner.h"
 #include "ResponseCallbackFetchScanblock.h"
 #include "ResponseCallbackGetStatistics.h"
@@ -69,6 +70,11 @@ namespace Hypertable {
                         const  RangeSpec *, const ScanSpec *);
     void destroy_scanner(ResponseCallback *cb, uint32_t scanner_id);
     void fetch_scanblock(ResponseCallbackFetchScanblock *, uint32_t scanner_id);
+    void get_cells(ResponseCallbackFetchScanblock *, const TableIdentifier *,
+                   const RangeSpec *, const ScanSpec *);
+    void aggregate_scan(ResponseCallbackAggregateScan *,
+                        const TableIdentifier *, const RangeSpec *,
+                        const ScanSpec *, const char *resume_row);
     void load_range(ResponseCallback *, const TableIdentifier *,
                     const RangeSpec *, const char *transfer_log_dir,
                     const RangeState *);
@@ -143,6 +149,8 @@ namespace Hypertable {
     MasterClientPtr        m_master_client;
     Hyperspace::SessionPtr m_hyperspace;
     uint32_t               m_scanner_ttl;
+    size_t                 m_scanner_zero_copy_threshold;
+    uint64_t               m_aggregate_scan_max_bytes;
     int32_t                m_max_clock_skew;
     uint64_t               m_bytes_loaded;
     uint64_t               m_log_roll_limit;
@@ -152,6 +160,8 @@ namespace Hypertable {
     MaintenanceSchedulerPtr m_maintenance_scheduler;
     TimerInterface        *m_timer_handler;
     uint32_t               m_update_delay;
+    BufferPool::Stats      m_last_receive_pool_stats;
+    boost::xtime           m_last_dump_time;
   };
 
   typedef intrusive_ptr<RangeServer> RangeServerPtr;
@@ -0,0 +1,214 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "AsyncComm/Protocol.h"
+#include "AsyncComm/ResponseCallback.h"
+
+#include "Hypertable/Lib/RangeServerProtocol.h"
+#include "Hypertable/Lib/Types.h"
+
+#include "BatchResponse.h"
+#include "RangeServer.h"
+#include "RequestHandlerBatch.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+namespace {
+
+  /**
+   * Carries out one request of a batch.
+   */
+  class RequestHandlerBatchPart : public ApplicationHandler {
+  public:
+    RequestHandlerBatchPart(Comm *comm, RangeServer *rs,
+        BatchResponse *batch, size_t index, uint64_t command,
+        const uint8_t *payload, size_t len, bool urgent)
+      : ApplicationHandler(urgent), m_comm(comm), m_range_server(rs),
+        m_batch(batch), m_index(index), m_command(command),
+        m_payload(payload), m_payload_len(len) { }
+
+    virtual void run();
+
+  private:
+    Comm             *m_comm;
+    RangeServer      *m_range_server;
+    BatchResponsePtr  m_batch;
+    size_t            m_index;
+    uint64_t          m_command;
+    const uint8_t    *m_payload;
+    size_t            m_payload_len;
+  };
+
+  void RequestHandlerBatchPart::run() {
+    const uint8_t *decode_ptr = m_payload;
+    size_t decode_remain = m_payload_len;
+
+    switch (m_command) {
+
+    case RangeServerProtocol::COMMAND_UPDATE: {
+        BatchPartCallback<ResponseCallbackUpdate> cb(m_comm, m_batch.get(),
+                                                     m_index);
+        TableIdentifier table;
+        StaticBuffer mods;
+        try {
+          table.decode(&decode_ptr, &decode_remain);
+          uint32_t count = decode_i32(&decode_ptr, &decode_remain);
+          uint32_t flags = decode_i32(&decode_ptr, &decode_remain);
+          mods.base = (uint8_t *)decode_ptr;
+          mods.size = decode_remain;
+          mods.own = false;
+          m_range_server->update(&cb, &table, count, mods, flags);
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << e << HT_END;
+          cb.error(Error::PROTOCOL_ERROR, "Error handling Update message");
+        }
+      }
+      break;
+
+    case RangeServerProtocol::COMMAND_CREATE_SCANNER: {
+        BatchPartCallback<ResponseCallbackCreateScanner> cb(m_comm,
+            m_batch.get(), m_index);
+        TableIdentifier table;
+        RangeSpec range;
+        ScanSpec scan_spec;
+        try {
+          table.decode(&decode_ptr, &decode_remain);
+          range.decode(&decode_ptr, &decode_remain);
+          scan_spec.decode(&decode_ptr, &decode_remain);
+          m_range_server->create_scanner(&cb, &table, &range, &scan_spec);
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << e << HT_END;
+          cb.error(Error::PROTOCOL_ERROR,
+                   "Error handling create scanner message");
+        }
+      }
+      break;
+
+    case RangeServerProtocol::COMMAND_FETCH_SCANBLOCK: {
+        BatchPartCallback<ResponseCallbackFetchScanblock> cb(m_comm,
+            m_batch.get(), m_index);
+        try {
+          uint32_t scanner_id = decode_i32(&decode_ptr, &decode_remain);
+          m_range_server->fetch_scanblock(&cb, scanner_id);
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << e << HT_END;
+          cb.error(e.code(), "Error handling FetchScanblock message");
+        }
+      }
+      break;
+
+    case RangeServerProtocol::COMMAND_GET_CELLS: {
+        BatchPartCallback<ResponseCallbackFetchScanblock> cb(m_comm,
+            m_batch.get(), m_index);
+        TableIdentifier table;
+        RangeSpec range;
+        ScanSpec scan_spec;
+        try {
+          table.decode(&decode_ptr, &decode_remain);
+          range.decode(&decode_ptr, &decode_remain);
+          scan_spec.decode(&decode_ptr, &decode_remain);
+          m_range_server->get_cells(&cb, &table, &range, &scan_spec);
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << e << HT_END;
+          cb.error(Error::PROTOCOL_ERROR, "Error handling get cells message");
+        }
+      }
+      break;
+
+    case RangeServerProtocol::COMMAND_DESTROY_SCANNER: {
+        BatchPartCallback<ResponseCallback> cb(m_comm, m_batch.get(),
+                                               m_index);
+        try {
+          uint32_t scanner_id = decode_i32(&decode_ptr, &decode_remain);
+          m_range_server->destroy_scanner(&cb, scanner_id);
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << e << HT_END;
+          cb.error(e.code(), "Error handling DestroyScanner message");
+        }
+      }
+      break;
+
+    default: {
+        BatchPartCallback<ResponseCallback> cb(m_comm, m_batch.get(),
+                                               m_index);
+        cb.error(Error::PROTOCOL_ERROR, format("Command (%llu) cannot be "
+                 "batched", (Llu)m_command));
+      }
+    }
+  }
+
+} // local namespace
+
+
+/**
+ *
+ */
+void RequestHandlerBatch::run() {
+  const uint8_t *decode_ptr = m_event_ptr->payload;
+  size_t decode_remain = m_event_ptr->payload_len;
+  std::vector<uint64_t> commands;
+  std::vector<uint32_t> lengths;
+  size_t total = 0;
+
+  try {
+    commands.resize(decode_i32(&decode_ptr, &decode_remain));
+    lengths.resize(commands.size());
+    for (size_t i=0; i<commands.size(); i++) {
+      commands[i] = decode_i64(&decode_ptr, &decode_remain);
+      lengths[i] = decode_i32(&decode_ptr, &decode_remain);
+      total += lengths[i];
+    }
+    if (total != decode_remain)
+      HT_THROWF(Error::PROTOCOL_ERROR, "Batch payload length mismatch "
+                "(%lu != %lu)", (Lu)total, (Lu)decode_remain);
+  }
+  catch (Exception &e) {
+    ResponseCallback cb(m_comm, m_event_ptr);
+    HT_ERROR_OUT << e << HT_END;
+    cb.error(Error::PROTOCOL_ERROR, "Error handling Batch message");
+    return;
+  }
+
+  if (commands.empty()) {
+    ResponseCallback cb(m_comm, m_event_ptr);
+    cb.error(Error::PROTOCOL_ERROR, "Empty batch");
+    return;
+  }
+
+  BatchResponsePtr batch = new BatchResponse(m_comm, m_event_ptr,
+                                             commands.size());
+  for (size_t i=0; i<commands.size(); i++) {
+    m_app_queue->add(new RequestHandlerBatchPart(m_comm, m_range_server,
+        batch.get(), i, commands[i], decode_ptr, lengths[i], is_urgent()));
+    decode_ptr += lengths[i];
+  }
+}
@@ -0,0 +1,39 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Serialization.h"
+
+#include "ResponseCallbackAggregateScan.h"
+
+using namespace Hypertable;
+
+int ResponseCallbackAggregateScan::response(const ScanAggregate &result,
+                                            const String &resume_row) {
+  CommHeader header;
+  header.initialize_from_request_header(m_event_ptr->header);
+  CommBufPtr cbp(new CommBuf(header, 4 + result.encoded_length()
+      + Serialization::encoded_length_str16(resume_row)));
+  cbp->append_i32(Error::OK);
+  result.encode(cbp->get_data_ptr_address());
+  cbp->append_str16(resume_row);
+  return send_response(cbp);
+}
@@ -0,0 +1,53 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_RESPONSECALLBACKAGGREGATESCAN_H
+#define HYPERTABLE_RESPONSECALLBACKAGGREGATESCAN_H
+
+#include "Common/Error.h"
+
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/ResponseCallback.h"
+
+#include "Hypertable/Lib/ScanAggregate.h"
+
+namespace Hypertable {
+
+  class ResponseCallbackAggregateScan : public ResponseCallback {
+  public:
+    ResponseCallbackAggregateScan(Comm *comm, EventPtr &event_ptr)
+      : ResponseCallback(comm, event_ptr) { }
+
+    /**
+     * Sends the aggregate of the cells scanned by the request.
+     *
+     * @param result aggregate of the scanned cells
+     * @param resume_row row the next request continues from, empty if the
+     *        scan of the range is complete
+     * @return Error::OK on success or error code on failure
+     */
+    int response(const ScanAggregate &result, const String &resume_row);
+  };
+
+}
+
+
+#endif // HYPERTABLE_RESPONSECALLBACKAGGREGATESCAN_H
@@ -33,5 +33,18 @@ ResponseCallbackCreateScanner::response(short moreflag, int32_t id,
   cbp->append_i32(Error::OK);
   cbp->append_i16(moreflag);
   cbp->append_i32(id);   // scanner ID
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
+}
+
+
+int
+ResponseCallbackCreateScanner::response(short moreflag, int32_t id,
+                                        CommBuf::SegmentVector &ext) {
+  CommHeader header;
+  header.initialize_from_request_header(m_event_ptr->header);
+  CommBufPtr cbp(new CommBuf( header, 10, ext));
+  cbp->append_i32(Error::OK);
+  cbp->append_i16(moreflag);
+  cbp->append_i32(id);   // scanner ID
+  return send_response(cbp);
 }
@@ -35,6 +35,7 @@ namespace Hypertable {
       : ResponseCallback(comm, event_ptr) { }
 
     int response(short moreflag, int32_t id, StaticBuffer &ext);
+    int response(short moreflag, int32_t id, CommBuf::SegmentVector &ext);
   };
 
 }
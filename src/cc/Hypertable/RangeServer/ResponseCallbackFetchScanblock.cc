@@ -20,6 +20,8 @@
  */
 
 #include "Common/Compat.h"
+#include "Common/Serialization.h"
+
 #include "ResponseCallbackFetchScanblock.h"
 
 using namespace Hypertable;
@@ -33,6 +35,27 @@ ResponseCallbackFetchScanblock::response(short moreflag, int32_t id,
   cbp->append_i32(Error::OK);
   cbp->append_i16(moreflag);
   cbp->append_i32(id);   // scanner ID
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
 
+
+int
+ResponseCallbackFetchScanblock::response(short moreflag, int32_t id,
+                                         CommBuf::SegmentVector &ext) {
+  CommHeader header;
+  header.initialize_from_request_header(m_event_ptr->header);
+  CommBufPtr cbp(new CommBuf( header, 10, ext));
+  cbp->append_i32(Error::OK);
+  cbp->append_i16(moreflag);
+  cbp->append_i32(id);   // scanner ID
+  return send_response(cbp);
+}
+
+
+int
+ResponseCallbackFetchScanblock::response_exhausted(int32_t id) {
+  StaticBuffer ext(4);
+  uint8_t *ptr = ext.base;
+  Serialization::encode_i32(&ptr, 0);
+  return response(1, id, ext);
+}
@@ -35,6 +35,16 @@ namespace Hypertable {
       : ResponseCallback(comm, event_ptr) { }
 
     int response(short moreflag, int32_t id, StaticBuffer &ext);
+    int response(short moreflag, int32_t id, CommBuf::SegmentVector &ext);
+
+    /**
+     * Sends an empty final block, the answer to a fetch for a scanner that
+     * has already returned its last block.
+     *
+     * @param id scanner id
+     * @return Error::OK on success or error code on failure
+     */
+    int response_exhausted(int32_t id);
   };
 
 }
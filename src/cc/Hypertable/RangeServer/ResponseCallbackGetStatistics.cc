@@ -30,5 +30,5 @@ int ResponseCallbackGetStatistics::response(StaticBuffer &ext) {
   header.initialize_from_request_header(m_event_ptr->header);
   CommBufPtr cbp(new CommBuf( header, 4, ext));
   cbp->append_i32(Error::OK);
-  return m_comm->send_response(m_event_ptr->addr, cbp);
+  return send_response(cbp);
 }
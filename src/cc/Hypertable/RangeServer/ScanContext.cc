@@ -60,6 +60,15 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
   spec = ss;
   range = range_spec;
 
+  // value predicates need the values, the MergeScanner drops them instead
+  keys_only = spec ? spec->keys_only : false;
+  filter = 0;
+  if (spec && !spec->predicates.empty()) {
+    filter = new ScanFilter(spec->predicates);
+    if (filter->uses_value())
+      keys_only = false;
+  }
+
   if (spec == 0)
     memset(family_mask, true, 256*sizeof(bool));
   else {
@@ -147,7 +156,8 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
   if (spec) {
     const char *ptr = 0;
 
-    if (spec->row_limit == 1)
+    // with a cell filter the first row may have no matching cells
+    if (spec->row_limit == 1 && spec->predicates.empty())
       single_row = true;
 
     if (!spec->row_intervals.empty()) {
@@ -34,6 +34,9 @@
 #include "Hypertable/Lib/ScanSpec.h"
 #include "Hypertable/Lib/Types.h"
 
+#include "CompactionPipeline.h"
+#include "ScanFilter.h"
+
 namespace Hypertable {
 
   struct CellFilterInfo {
@@ -63,6 +66,9 @@ namespace Hypertable {
     std::pair<int64_t, int64_t> time_interval;
     bool family_mask[256];
     CellFilterInfo family_info[256];
+    CompactionPipelinePtr pipeline;   // set for pipelined compactions
+    ScanFilterPtr filter;             // set if spec has cell predicates
+    bool keys_only;                   // leaf scanners drop values
 
     /**
      * Constructor.
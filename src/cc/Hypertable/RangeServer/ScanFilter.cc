@@ -0,0 +1,205 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "ScanFilter.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  bool has_prefix(const uint8_t *data, size_t len, const String &prefix) {
+    return len >= prefix.length()
+        && !memcmp(data, prefix.data(), prefix.length());
+  }
+
+  int compare(const uint8_t *data, size_t len, const String &str) {
+    int cmp = memcmp(data, str.data(), std::min(len, str.length()));
+    if (cmp == 0)
+      return (len < str.length()) ? -1 : (len > str.length()) ? 1 : 0;
+    return cmp;
+  }
+
+}
+
+
+ScanFilter::ScanFilter(const std::vector<CellPredicate> &predicates)
+  : m_uses_value(false) {
+  m_nodes.reserve(predicates.size());
+  try {
+    for (size_t i=0; i<predicates.size(); )
+      i = compile(predicates, i, 1);
+  }
+  catch (Exception &e) {
+    foreach(Node &node, m_nodes) {
+      if (node.regex) {
+        regfree(node.regex);
+        delete node.regex;
+      }
+    }
+    throw;
+  }
+}
+
+
+ScanFilter::~ScanFilter() {
+  foreach(Node &node, m_nodes) {
+    if (node.regex) {
+      regfree(node.regex);
+      delete node.regex;
+    }
+  }
+}
+
+
+/**
+ * Appends node i, at the given depth of its tree, and its operands to
+ * m_nodes.  Returns the index of the predicate following the subtree.
+ */
+size_t
+ScanFilter::compile(const std::vector<CellPredicate> &predicates, size_t i,
+                    uint32_t depth) {
+  const CellPredicate &cp = predicates[i];
+  size_t node_index = m_nodes.size();
+  Node node;
+  int error;
+
+  if (depth > MAX_DEPTH)
+    HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC, "cell predicates nested "
+              "deeper than %u", (unsigned)MAX_DEPTH);
+
+  if (cp.op < CellPredicate::AND || cp.op >= CellPredicate::OP_MAX)
+    HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC, "bad cell predicate "
+              "operator %d", (int)cp.op);
+
+  if ((cp.op == CellPredicate::NOT && cp.children != 1)
+      || (cp.op > CellPredicate::NOT && cp.children != 0))
+    HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC, "bad cell predicate operand "
+              "count %u", (unsigned)cp.children);
+
+  node.op = cp.op;
+  node.children = cp.children;
+  node.operand = cp.operand ? cp.operand : "";
+  node.has_start = cp.has_start;
+  node.start_inclusive = cp.start_inclusive;
+  node.end_operand = cp.end_operand ? cp.end_operand : "";
+  node.has_end = cp.has_end;
+  node.end_inclusive = cp.end_inclusive;
+  node.regex = 0;
+  node.next = 0;
+
+  if (cp.op >= CellPredicate::VALUE_EQUAL)
+    m_uses_value = true;
+
+  if (cp.op == CellPredicate::ROW_REGEX
+      || cp.op == CellPredicate::QUALIFIER_REGEX
+      || cp.op == CellPredicate::VALUE_REGEX) {
+    node.regex = new regex_t;
+    if ((error = regcomp(node.regex, node.operand.c_str(),
+                         REG_EXTENDED|REG_NOSUB)) != 0) {
+      char errbuf[256];
+      regerror(error, node.regex, errbuf, sizeof(errbuf));
+      delete node.regex;
+      HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC, "bad regular expression "
+                "'%s' - %s", node.operand.c_str(), errbuf);
+    }
+  }
+
+  m_nodes.push_back(node);
+
+  i++;
+  for (uint32_t c=0; c<cp.children; c++) {
+    if (i >= predicates.size())
+      HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
+               "cell predicate is missing operands");
+    i = compile(predicates, i, depth + 1);
+  }
+
+  m_nodes[node_index].next = m_nodes.size();
+  return i;
+}
+
+
+bool ScanFilter::eval(size_t i, const Key &key, const uint8_t *value,
+                      size_t value_len) {
+  const Node &node = m_nodes[i];
+  size_t child;
+  uint32_t c;
+
+  switch (node.op) {
+  case CellPredicate::AND:
+    for (c=0, child=i+1; c<node.children; c++, child=m_nodes[child].next)
+      if (!eval(child, key, value, value_len))
+        return false;
+    return true;
+  case CellPredicate::OR:
+    for (c=0, child=i+1; c<node.children; c++, child=m_nodes[child].next)
+      if (eval(child, key, value, value_len))
+        return true;
+    return false;
+  case CellPredicate::NOT:
+    return !eval(i+1, key, value, value_len);
+  case CellPredicate::ROW_PREFIX:
+    return !strncmp(key.row, node.operand.c_str(), node.operand.length());
+  case CellPredicate::ROW_REGEX:
+    return regexec(node.regex, key.row, 0, 0, 0) == 0;
+  case CellPredicate::QUALIFIER_EQUAL:
+    return node.operand == key.column_qualifier;
+  case CellPredicate::QUALIFIER_PREFIX:
+    return !strncmp(key.column_qualifier, node.operand.c_str(),
+                    node.operand.length());
+  case CellPredicate::QUALIFIER_REGEX:
+    return regexec(node.regex, key.column_qualifier, 0, 0, 0) == 0;
+  case CellPredicate::VALUE_EQUAL:
+    return value_len == node.operand.length()
+        && !memcmp(value, node.operand.data(), value_len);
+  case CellPredicate::VALUE_PREFIX:
+    return has_prefix(value, value_len, node.operand);
+  case CellPredicate::VALUE_RANGE:
+    if (node.has_start) {
+      int cmp = compare(value, value_len, node.operand);
+      if (cmp < 0 || (cmp == 0 && !node.start_inclusive))
+        return false;
+    }
+    if (node.has_end) {
+      int cmp = compare(value, value_len, node.end_operand);
+      if (cmp > 0 || (cmp == 0 && !node.end_inclusive))
+        return false;
+    }
+    return true;
+  case CellPredicate::VALUE_CONTAINS:
+    return std::search(value, value + value_len,
+                       (const uint8_t *)node.operand.data(),
+                       (const uint8_t *)node.operand.data()
+                       + node.operand.length()) != value + value_len
+        || node.operand.empty();
+  case CellPredicate::VALUE_REGEX:
+    m_value_str.assign((const char *)value, value_len);
+    return regexec(node.regex, m_value_str.c_str(), 0, 0, 0) == 0;
+  }
+  return false;
+}
@@ -0,0 +1,110 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_SCANFILTER_H
+#define HYPERTABLE_SCANFILTER_H
+
+#include <regex.h>
+
+#include <vector>
+
+#include "Common/ByteString.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanSpec.h"
+
+namespace Hypertable {
+
+  /**
+   * Evaluates the cell predicates of a ScanSpec against the cells of a
+   * scan.  The predicate trees are validated and their regular
+   * expressions compiled once, when the filter is constructed.
+   */
+  class ScanFilter : public ReferenceCount {
+  public:
+    /**
+     * Constructor.  Throws RANGESERVER_BAD_SCAN_SPEC if the predicates do
+     * not form well-formed trees, nest deeper than MAX_DEPTH or a regular
+     * expression does not compile.
+     *
+     * @param predicates predicate trees flattened in prefix order
+     */
+    ScanFilter(const std::vector<CellPredicate> &predicates);
+    ~ScanFilter();
+
+    /**
+     * Tests a cell.  Deletes always match so that they keep masking older
+     * cells.
+     *
+     * @param key key of the cell
+     * @param value value of the cell (null for keys only scans)
+     * @return true if the cell satisfies every top level predicate
+     */
+    bool matches(const Key &key, const ByteString &value) {
+      if (key.flag != FLAG_INSERT)
+        return true;
+
+      const uint8_t *vptr = 0;
+      size_t vlen = value.ptr ? value.decode_length(&vptr) : 0;
+
+      for (size_t i=0; i<m_nodes.size(); i=m_nodes[i].next)
+        if (!eval(i, key, vptr, vlen))
+          return false;
+      return true;
+    }
+
+    /** Returns true if some predicate looks at cell values */
+    bool uses_value() const { return m_uses_value; }
+
+    /** Maximum nesting depth of a predicate tree (eval() recurses) */
+    static const uint32_t MAX_DEPTH = 64;
+
+  private:
+    struct Node {
+      uint8_t op;
+      uint32_t children;
+      String operand;
+      bool has_start;
+      bool start_inclusive;
+      String end_operand;
+      bool has_end;
+      bool end_inclusive;
+      regex_t *regex;
+      size_t next;              // index of the node following the subtree
+    };
+
+    size_t compile(const std::vector<CellPredicate> &predicates, size_t i,
+                   uint32_t depth);
+    bool eval(size_t i, const Key &key, const uint8_t *value,
+              size_t value_len);
+
+    std::vector<Node> m_nodes;
+    String m_value_str;         // null terminated value for regexec()
+    bool m_uses_value;
+  };
+
+  typedef intrusive_ptr<ScanFilter> ScanFilterPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_SCANFILTER_H
@@ -70,6 +70,23 @@ bool ScannerMap::remove(uint32_t id) {
 }
 
 
+/**
+ * Drops the references to the scanner and range right away, so an
+ * exhausted scanner no longer pins the range, its cell caches or cell
+ * stores.  The entry itself is erased by remove() when the client sends
+ * destroy_scanner after draining its outstanding readahead requests, or
+ * by purge_expired() if it never does.
+ */
+void ScannerMap::mark_exhausted(uint32_t id) {
+  ScopedLock lock(m_mutex);
+  CellListScannerMap::iterator iter = m_scanner_map.find(id);
+  if (iter != m_scanner_map.end()) {
+    (*iter).second.scanner_ptr = 0;
+    (*iter).second.range_ptr = 0;
+  }
+}
+
+
 void ScannerMap::purge_expired(uint32_t max_idle_millis) {
   ScopedLock lock(m_mutex);
   uint64_t now_millis = get_timestamp_millis();
@@ -78,6 +95,11 @@ void ScannerMap::purge_expired(uint32_t max_idle_millis) {
   while (iter != m_scanner_map.end()) {
     if ((now_millis - (*iter).second.last_access_millis) > max_idle_millis) {
       CellListScannerMap::iterator tmp_iter = iter;
+      if (!(*iter).second.scanner_ptr) {
+        ++iter;
+        m_scanner_map.erase(tmp_iter);
+        continue;
+      }
       HT_WARNF("Destroying scanner %d because it has not been used in %u "
                "milliseconds", (*iter).first, max_idle_millis);
       ++iter;
@@ -56,7 +56,8 @@ namespace Hypertable {
     /**
      * This method retrieves the scanner and range mapped to the given scanner
      * id.  It also updates the 'last_access_millis' member of this scanner map
-     * entry.
+     * entry.  If the scanner has been marked exhausted, scanner_ptr and
+     * range_ptr are set to null and true is returned.
      *
      * @param id scanner id
      * @param scanner_ptr smart pointer to returned scanner object
@@ -75,6 +76,19 @@ namespace Hypertable {
      */
     bool remove(uint32_t id);
 
+    /**
+     * This method releases the scanner and range mapped to the given id but
+     * keeps the id itself until it is removed or purged.  Clients may have
+     * several fetch requests pending for one scanner; the ones that arrive
+     * after the scanner has reached the end then get an empty final block
+     * rather than an invalid scanner id error.  Once the client has
+     * received those replies it destroys the scanner, which removes the
+     * id.
+     *
+     * @param id scanner id
+     */
+    void mark_exhausted(uint32_t id);
+
     /**
      * This method iterates through the scanner map purging mappings that have
      * not been referenced for max_idle_ms or greater milliseconds.
@@ -36,6 +36,8 @@
 #include "AsyncComm/ConnectionManager.h"
 #include "AsyncComm/ReactorRunner.h"
 
+#include "Hypertable/Lib/BlockCodecCommCompressor.h"
+
 #include "Config.h"
 #include "ConnectionHandler.h"
 #include "Global.h"
@@ -67,6 +69,7 @@ int main(int argc, char **argv) {
     }
 
     Comm *comm = Comm::instance();
+    BlockCodecCommCompressor::install(comm, properties);
     ConnectionManagerPtr conn_manager= new ConnectionManager(comm);
 
     int worker_count = get_i32("Hypertable.RangeServer.Workers");
@@ -0,0 +1,212 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Serialization.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "AsyncComm/ResponseCallback.h"
+
+#include "Hypertable/Lib/RangeServerProtocol.h"
+
+#include "Hypertable/RangeServer/BatchResponse.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+using namespace std;
+
+namespace {
+
+  /**
+   * Copies the payload of a message into an event, as if it had been
+   * received.
+   */
+  EventPtr to_event(CommBufPtr &cbp) {
+    CommBuf::SegmentVector segments;
+    size_t len = 0;
+
+    cbp->get_payload_segments(segments);
+    foreach(const CommBuf::Segment &segment, segments)
+      len += segment.len;
+
+    Event *event = new Event(Event::MESSAGE);
+    uint8_t *payload = new uint8_t [len];
+    event->header = cbp->header;
+    event->payload = payload;
+    event->payload_len = len;
+    foreach(const CommBuf::Segment &segment, segments) {
+      memcpy(payload, segment.base, segment.len);
+      payload += segment.len;
+    }
+    return event;
+  }
+
+  /**
+   * Batch response that keeps the assembled message instead of sending it.
+   */
+  class TestBatchResponse : public BatchResponse {
+  public:
+    TestBatchResponse(EventPtr &event, size_t count)
+      : BatchResponse(0, event, count), sent(0) { }
+
+    CommBufPtr response;
+    int sent;
+
+  protected:
+    virtual int send_response(CommBufPtr &cbp) {
+      response = cbp;
+      sent++;
+      return Error::OK;
+    }
+  };
+
+  typedef BatchPartCallback<ResponseCallback> PartCallback;
+
+  int failures = 0;
+
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      cout << "FAILED: " << what << endl;
+      failures++;
+    }
+  }
+
+  void test_create_request_batch() {
+    std::vector<CommBufPtr> requests;
+    CommBufPtr cbp;
+
+    requests.push_back(RangeServerProtocol::create_request_fetch_scanblock(7));
+    cbp = RangeServerProtocol::create_request_destroy_scanner(9);
+    cbp->header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    requests.push_back(cbp);
+
+    cbp = RangeServerProtocol::create_request_batch(requests);
+    check(cbp->header.command == RangeServerProtocol::COMMAND_BATCH,
+          "batch command");
+    check(cbp->header.flags & CommHeader::FLAGS_BIT_URGENT,
+          "urgent flag propagated");
+
+    EventPtr event = to_event(cbp);
+    const uint8_t *ptr = event->payload;
+    size_t remain = event->payload_len;
+
+    check(decode_i32(&ptr, &remain) == 2, "request count");
+    check(decode_i64(&ptr, &remain)
+          == RangeServerProtocol::COMMAND_FETCH_SCANBLOCK, "first command");
+    check(decode_i32(&ptr, &remain) == 4, "first length");
+    check(decode_i64(&ptr, &remain)
+          == RangeServerProtocol::COMMAND_DESTROY_SCANNER, "second command");
+    check(decode_i32(&ptr, &remain) == 4, "second length");
+    check(remain == 8, "payload length");
+    check(decode_i32(&ptr, &remain) == 7, "first payload");
+    check(decode_i32(&ptr, &remain) == 9, "second payload");
+  }
+
+  void test_mixed_responses() {
+    EventPtr request(new Event(Event::MESSAGE));
+    request->header.command = RangeServerProtocol::COMMAND_BATCH;
+    request->header.id = 42;
+    TestBatchResponse *batch = new TestBatchResponse(request, 3);
+    BatchResponsePtr batch_ptr(batch);
+
+    {
+      PartCallback ok_cb(0, batch, 0);
+      PartCallback error_cb(0, batch, 1);
+      PartCallback silent_cb(0, batch, 2);
+
+      ok_cb.response_ok();
+      error_cb.error(Error::RANGESERVER_RANGE_NOT_FOUND, "no such range");
+      // a second response to the same request is dropped
+      error_cb.response_ok();
+      check(batch->sent == 0, "batch sent before all parts answered");
+    }
+    check(batch->sent == 1, "batch sent exactly once");
+    if (batch->sent != 1)
+      return;
+    check(batch->response->header.id == 42, "response id");
+
+    EventPtr event = to_event(batch->response);
+    std::vector<EventPtr> responses;
+    RangeServerProtocol::decode_batch_response(event, responses);
+
+    check(responses.size() == 3, "response count");
+    if (responses.size() != 3)
+      return;
+    check(Protocol::response_code(responses[0]) == Error::OK, "ok part");
+    check(Protocol::response_code(responses[1])
+          == Error::RANGESERVER_RANGE_NOT_FOUND, "error part");
+    check(Protocol::string_format_message(responses[1]) == "no such range",
+          "error part message");
+    check(Protocol::response_code(responses[2]) == Error::FAILED_EXPECTATION,
+          "unanswered part");
+    check(Protocol::string_format_message(responses[2])
+          == "No response to batched request", "unanswered part message");
+  }
+
+  void test_decode_errors() {
+    CommHeader header;
+    std::vector<EventPtr> responses;
+
+    CommBufPtr cbp(Protocol::create_error_message(header,
+        Error::REQUEST_TIMEOUT, "timed out"));
+    EventPtr event = to_event(cbp);
+    try {
+      RangeServerProtocol::decode_batch_response(event, responses);
+      check(false, "error response not thrown");
+    }
+    catch (Exception &e) {
+      check(e.code() == Error::REQUEST_TIMEOUT, "error response code");
+    }
+
+    cbp = new CommBuf(header, 16);
+    cbp->append_i32(Error::OK);
+    cbp->append_i32(1);
+    cbp->append_i32(100);
+    cbp->append_i32(0);
+    event = to_event(cbp);
+    try {
+      RangeServerProtocol::decode_batch_response(event, responses);
+      check(false, "truncated response not thrown");
+    }
+    catch (Exception &e) {
+      check(e.code() == Error::PROTOCOL_ERROR, "truncated response code");
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  test_create_request_batch();
+  test_mixed_responses();
+  test_decode_errors();
+
+  if (failures)
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,223 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/Thread.h"
+#include "Common/Time.h"
+#include "Common/Usage.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../CellCache.h"
+#include "../Config.h"
+#include "../ScanContext.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>column</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const char *usage[] = {
+    "usage: CellCache_benchmark",
+    "",
+    "  Compares insert and scan throughput of the std::map and skip list",
+    "  CellCache implementations with 1, 4 and 16 threads.  The insert phase",
+    "  has every thread add cells (serialized on the cache lock, as",
+    "  AccessGroup::add does).  The mixed phase has one thread insert while",
+    "  the remaining threads repeatedly scan the cache.",
+    (const char *)0
+  };
+
+  /**
+   * Pre-serialized keys and a shared value, so that the timed loops
+   * measure only the cell cache.
+   */
+  struct Workload {
+    Workload(size_t count) : key_buf(count * 40) {
+      char row[32];
+      for (size_t i=0; i<count; i++) {
+        // scatter rows so inserts land all over the map
+        sprintf(row, "%010u", (unsigned)((i * 2654435761UL) % 4294967291UL));
+        offsets.push_back(key_buf.fill());
+        create_key_and_append(key_buf, FLAG_INSERT, row, 1, "",
+                              (int64_t)i + 1, (int64_t)i + 1);
+      }
+      append_as_byte_string(value_buf, "value-data-0123456789");
+      value = ByteString(value_buf.base);
+    }
+
+    void get_key(size_t i, Key &key) {
+      key.load(SerializedKey(key_buf.base + offsets[i]));
+    }
+
+    DynamicBuffer key_buf;
+    DynamicBuffer value_buf;
+    ByteString value;
+    std::vector<size_t> offsets;
+  };
+
+  struct Inserter {
+    Inserter(CellCachePtr &cache, Workload &work, size_t begin, size_t end,
+             volatile bool *done = 0)
+      : cache(cache), work(work), begin(begin), end(end), done(done) { }
+    void operator()() {
+      Key key;
+      for (size_t i=begin; i<end; i++) {
+        work.get_key(i, key);
+        cache->lock();
+        cache->add(key, work.value);
+        cache->unlock();
+      }
+      if (done)
+        *done = true;
+    }
+    CellCachePtr cache;
+    Workload &work;
+    size_t begin, end;
+    volatile bool *done;
+  };
+
+  struct Scanner {
+    Scanner(CellCachePtr &cache, SchemaPtr &schema, volatile bool *done,
+            uint64_t *cells)
+      : cache(cache), schema(schema), done(done), cells(cells) { }
+    void operator()() {
+      ScanContextPtr scan_ctx = new ScanContext(schema);
+      Key key;
+      ByteString value;
+      uint64_t count = 0;
+      do {
+        CellListScannerPtr scanner = cache->create_scanner(scan_ctx);
+        while (scanner->get(key, value)) {
+          count++;
+          scanner->forward();
+        }
+      } while (!*done);
+      *cells = count;
+    }
+    CellCachePtr cache;
+    SchemaPtr schema;
+    volatile bool *done;
+    uint64_t *cells;
+  };
+
+  double rate(uint64_t count, boost::xtime &start, boost::xtime &finish) {
+    int64_t millis = xtime_diff_millis(start, finish);
+    return (double)count * 1000.0 / (double)(millis ? millis : 1);
+  }
+
+  void run_insert(CellCache::MapType type, int nthreads, Workload &work) {
+    CellCachePtr cache = new CellCache(type);
+    ThreadGroup threads;
+    size_t count = work.offsets.size();
+    boost::xtime start, finish;
+
+    boost::xtime_get(&start, TIME_UTC);
+    for (int i=0; i<nthreads; i++) {
+      threads.create_thread(Inserter(cache, work, count * i / nthreads,
+                                     count * (i + 1) / nthreads));
+    }
+    threads.join_all();
+    boost::xtime_get(&finish, TIME_UTC);
+
+    HT_ASSERT(cache->size() == count);
+    printf("  insert  threads=%-2d  %12.0f inserts/s\n", nthreads,
+           rate(count, start, finish));
+  }
+
+  void run_mixed(CellCache::MapType type, int nthreads, Workload &work,
+                 SchemaPtr &schema) {
+    CellCachePtr cache = new CellCache(type);
+    ThreadGroup threads;
+    size_t count = work.offsets.size();
+    volatile bool done = false;
+    std::vector<uint64_t> cells(nthreads, 0);
+    boost::xtime start, finish;
+    uint64_t total_scanned = 0;
+
+    // with a single thread there is nobody to scan concurrently, so the
+    // writer finishes first and the scan runs over the full cache
+    boost::xtime_get(&start, TIME_UTC);
+    threads.create_thread(Inserter(cache, work, 0, count, &done));
+    for (int i=1; i<nthreads; i++)
+      threads.create_thread(Scanner(cache, schema, &done, &cells[i]));
+    if (nthreads == 1) {
+      threads.join_all();
+      Scanner(cache, schema, &done, &cells[0])();
+    }
+    else
+      threads.join_all();
+    boost::xtime_get(&finish, TIME_UTC);
+
+    for (int i=0; i<nthreads; i++)
+      total_scanned += cells[i];
+
+    printf("  mixed   threads=%-2d  %12.0f inserts/s %12.0f scanned cells/s\n",
+           nthreads, rate(count, start, finish),
+           rate(total_scanned, start, finish));
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  if (Config::has("help"))
+    Usage::dump_and_exit(usage);
+
+  size_t count = 500000;
+  SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str), true);
+  if (!schema->is_valid()) {
+    HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+    exit(1);
+  }
+
+  Workload work(count);
+  int thread_counts[] = { 1, 4, 16 };
+  const char *names[] = { "map", "skiplist" };
+  CellCache::MapType types[] = { CellCache::MAP, CellCache::SKIPLIST };
+
+  for (size_t t=0; t<2; t++) {
+    printf("%s (%lu cells)\n", names[t], (unsigned long)count);
+    for (size_t i=0; i<sizeof(thread_counts)/sizeof(int); i++) {
+      run_insert(types[t], thread_counts[i], work);
+      run_mixed(types[t], thread_counts[i], work, schema);
+    }
+  }
+
+  return 0;
+}
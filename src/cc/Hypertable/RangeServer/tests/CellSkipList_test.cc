@@ -0,0 +1,307 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/Thread.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../CellCache.h"
+#include "../CellCacheSkipList.h"
+#include "../Config.h"
+#include "../ScanContext.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>a</Name>\n"
+  "    </ColumnFamily>\n"
+  "    <ColumnFamily id=\"2\">\n"
+  "      <Name>b</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  typedef std::map<const SerializedKey, uint32_t> RefMap;
+
+  int failures = 0;
+
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      cout << "FAILED: " << what << endl;
+      failures++;
+    }
+  }
+
+  /**
+   * Serialized keys drawn from a small key space, so that some of them
+   * collide.  Each key is serialized separately, so colliding keys have
+   * equal bytes at different addresses.
+   */
+  struct Keys {
+    Keys(size_t count, unsigned rows) : buf(count * 32) {
+      char row[32], qualifier[8];
+      for (size_t i=0; i<count; i++) {
+        sprintf(row, "%05u", (unsigned)(random() % rows));
+        sprintf(qualifier, "%u", (unsigned)(random() % 3));
+        offsets.push_back(buf.fill());
+        create_key_and_append(buf, FLAG_INSERT, row, 1 + random() % 2,
+                              qualifier, 1 + random() % 2, 0);
+        lengths.push_back(buf.fill() - offsets.back());
+      }
+    }
+    CellSkipList::value_type operator[](size_t i) const {
+      return CellSkipList::value_type(SerializedKey(buf.base + offsets[i]),
+                                      lengths[i]);
+    }
+    size_t size() const { return offsets.size(); }
+
+    DynamicBuffer buf;
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> lengths;
+  };
+
+  void test_ordering() {
+    CellCachePool pool;
+    CellSkipList list(pool);
+    RefMap ref;
+    Keys keys(20000, 2000);
+    Keys probes(2000, 2100);
+    size_t duplicates = 0;
+
+    check(list.empty() && list.begin() == list.end(), "new list is empty");
+
+    for (size_t i=0; i<keys.size(); i++) {
+      std::pair<CellSkipList::iterator, bool> r1 = list.insert(keys[i]);
+      std::pair<RefMap::iterator, bool> r2 = ref.insert(keys[i]);
+      if (r1.second != r2.second) {
+        check(false, "insert reports a duplicate like std::map");
+        break;
+      }
+      if (!r1.second)
+        duplicates++;
+      // a duplicate leaves the first entry in place and returns it
+      check(r1.first->first.ptr == r2.first->first.ptr
+            && r1.first->second == r2.first->second, "insert iterator");
+    }
+    check(duplicates > 0, "workload has duplicates");
+    check(list.size() == ref.size(), "size matches std::map");
+
+    CellSkipList::iterator iter = list.begin();
+    RefMap::iterator ref_iter = ref.begin();
+    for (; iter != list.end() && ref_iter != ref.end(); ++iter, ++ref_iter)
+      if (iter->first.ptr != ref_iter->first.ptr) {
+        check(false, "iteration order matches std::map");
+        break;
+      }
+    check(iter == list.end() && ref_iter == ref.end(), "iteration length");
+
+    for (size_t i=0; i<probes.size(); i++) {
+      iter = list.lower_bound(probes[i].first);
+      ref_iter = ref.lower_bound(probes[i].first);
+      if ((iter == list.end()) != (ref_iter == ref.end())
+          || (iter != list.end() && iter->first.ptr != ref_iter->first.ptr)) {
+        check(false, "lower_bound matches std::map");
+        break;
+      }
+    }
+  }
+
+  struct Writer {
+    Writer(CellSkipList &list, Keys &keys, volatile bool *done)
+      : list(list), keys(keys), done(done) { }
+    void operator()() {
+      for (size_t i=0; i<keys.size(); i++)
+        list.insert(keys[i]);
+      *done = true;
+    }
+    CellSkipList &list;
+    Keys &keys;
+    volatile bool *done;
+  };
+
+  /**
+   * Walks the list while it is being written.  Every walk must be strictly
+   * ordered and see at least the entries counted before it started.
+   */
+  struct Reader {
+    Reader(CellSkipList &list, Keys &keys, volatile bool *done, bool *ok)
+      : list(list), keys(keys), done(done), ok(ok) { }
+    void operator()() {
+      bool last;
+      *ok = true;
+      do {
+        last = *done;
+        size_t before = list.size();
+        size_t seen = 0;
+        CellSkipList::iterator prev = list.end();
+        for (CellSkipList::iterator iter = list.begin(); iter != list.end();
+             ++iter, seen++) {
+          if (prev != list.end() && prev->first.compare(iter->first) >= 0)
+            *ok = false;
+          prev = iter;
+        }
+        if (seen < before || (last && seen != list.size()))
+          *ok = false;
+        size_t i = random() % keys.size();
+        CellSkipList::iterator found = list.lower_bound(keys[i].first);
+        if (found != list.end() && found->first.compare(keys[i].first) < 0)
+          *ok = false;
+      } while (!last && *ok);
+    }
+    CellSkipList &list;
+    Keys &keys;
+    volatile bool *done;
+    bool *ok;
+  };
+
+  void test_concurrent_readers() {
+    CellCachePool pool;
+    CellSkipList list(pool);
+    Keys keys(200000, 100000);
+    volatile bool done = false;
+    bool ok[4];
+    ThreadGroup threads;
+
+    for (int i=0; i<4; i++)
+      threads.create_thread(Reader(list, keys, &done, &ok[i]));
+    threads.create_thread(Writer(list, keys, &done));
+    threads.join_all();
+
+    for (int i=0; i<4; i++)
+      check(ok[i], "concurrent reader saw an ordered, complete list");
+  }
+
+  /** Returns the rows (with family codes) a scan of the cache returns */
+  String scan(CellCachePtr &cache, SchemaPtr &schema, const char *column,
+              const char *start, bool start_inclusive, const char *end,
+              bool end_inclusive) {
+    ScanSpecBuilder ssb;
+    RangeSpec range;
+    Key key;
+    ByteString value;
+    String result;
+
+    range.start_row = "";
+    range.end_row = Key::END_ROW_MARKER;
+    if (column)
+      ssb.add_column(column);
+    ssb.add_row_interval(start, start_inclusive, end, end_inclusive);
+    ScanContextPtr scan_ctx = new ScanContext(TIMESTAMP_MAX, &ssb.get(),
+                                              &range, schema);
+    CellListScannerPtr scanner = cache->create_scanner(scan_ctx);
+    while (scanner->get(key, value)) {
+      result += format("%s/%d ", key.row, (int)key.column_family_code);
+      scanner->forward();
+    }
+    return result;
+  }
+
+  void test_scanner_bounds(SchemaPtr &schema) {
+    CellCachePtr caches[2];
+    DynamicBuffer buf;
+    char row[32];
+
+    caches[0] = new CellCache(CellCache::MAP);
+    caches[1] = new CellCache(CellCache::SKIPLIST);
+
+    append_as_byte_string(buf, "value");
+    ByteString value(buf.base);
+
+    // rows r00 .. r19, inserted out of order, with a cell in each family
+    for (int i=0; i<20; i++) {
+      DynamicBuffer key_buf;
+      Key key;
+      sprintf(row, "r%02d", (i * 7) % 20);
+      for (int cf=1; cf<=2; cf++) {
+        key_buf.clear();
+        create_key_and_append(key_buf, FLAG_INSERT, row, cf, "", 1, 1);
+        key.load(SerializedKey(key_buf.base));
+        for (int c=0; c<2; c++)
+          caches[c]->add(key, value);
+      }
+    }
+
+    for (int c=0; c<2; c++) {
+      const char *type = c ? "skiplist" : "map";
+      String out;
+
+      out = scan(caches[c], schema, "a", "r05", true, "r08", true);
+      check(out == "r05/1 r06/1 r07/1 r08/1 ", format("%s [r05..r08]",
+            type).c_str());
+      out = scan(caches[c], schema, "a", "r05", false, "r08", false);
+      check(out == "r06/1 r07/1 ", format("%s (r05..r08)", type).c_str());
+      out = scan(caches[c], schema, 0, "r18", true, "r99", true);
+      check(out == "r18/1 r18/2 r19/1 r19/2 ",
+            format("%s scan to past the last row", type).c_str());
+      out = scan(caches[c], schema, "b", "", true, "r01", true);
+      check(out == "r00/2 r01/2 ",
+            format("%s scan from the first row", type).c_str());
+      out = scan(caches[c], schema, 0, "r10", true, "r10", true);
+      check(out == "r10/1 r10/2 ", format("%s single row", type).c_str());
+      out = scan(caches[c], schema, 0, "r105", true, "r109", true);
+      check(out == "", format("%s empty interval", type).c_str());
+      out = scan(caches[c], schema, 0, "s", true, "t", true);
+      check(out == "", format("%s after the last row", type).c_str());
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str), true);
+  if (!schema->is_valid()) {
+    HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+    exit(1);
+  }
+
+  srandom(1);
+
+  test_ordering();
+  test_concurrent_readers();
+  test_scanner_bounds(schema);
+
+  if (failures)
+    return 1;
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
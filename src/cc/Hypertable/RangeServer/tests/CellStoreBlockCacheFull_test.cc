@@ -0,0 +1,124 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+#include "Common/System.h"
+
+#include <vector>
+
+#include "Hypertable/RangeServer/CellStoreScannerInterval.h"
+#include "Hypertable/RangeServer/FileBlockCache.h"
+#include "Hypertable/RangeServer/Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const uint32_t BLOCK_SIZE = 65536;
+  const int BLOCK_COUNT = 4;
+
+  /**
+   * Gives access to the block caching of cell store scanners
+   */
+  class TestInterval : public CellStoreScannerInterval {
+  public:
+    virtual void forward() { }
+    virtual bool get(Key &key, ByteString &value) { return false; }
+
+    /** Caches a new block at offset, returns its pin */
+    static ReferenceCount *load(int file_id, int64_t offset, bool *cachedp,
+                                const uint8_t **basep) {
+      BlockInfo block;
+      uint32_t len = BLOCK_SIZE;
+      memset(&block, 0, sizeof(block));
+      block.offset = offset;
+      block.base = new uint8_t [BLOCK_SIZE];
+      cache_block(file_id, block, &len);
+      *cachedp = block.cached;
+      *basep = block.base;
+      return new BlockPin(file_id, block);
+    }
+  };
+
+}
+
+
+int main(int argc, char **argv) {
+  vector<intrusive_ptr<ReferenceCount> > pins;
+  const uint8_t *base;
+  uint8_t *cached_base;
+  uint32_t len;
+  bool cached;
+
+  System::initialize(System::locate_install_dir(argv[0]));
+
+  Global::block_cache = new FileBlockCache(BLOCK_COUNT * BLOCK_SIZE, 0, 1);
+
+  /**
+   * Fill the only shard with blocks that are all checked out
+   */
+  for (int i=0; i<BLOCK_COUNT; i++) {
+    pins.push_back(TestInterval::load(0, i * BLOCK_SIZE, &cached, &base));
+    if (!cached) {
+      HT_ERRORF("Block %d not cached", i);
+      return 1;
+    }
+  }
+
+  /**
+   * A block that does not fit is kept private instead of aborting
+   */
+  pins.push_back(TestInterval::load(1, 0, &cached, &base));
+  if (cached || base == 0 || Global::block_cache->contains(1, 0)) {
+    HT_ERROR("Block cached although all blocks are in use");
+    return 1;
+  }
+
+  /**
+   * A block that is already cached is shared
+   */
+  pins.push_back(TestInterval::load(0, 0, &cached, &base));
+  Global::block_cache->checkout(0, 0, &cached_base, &len);
+  Global::block_cache->checkin(0, 0);
+  if (!cached || base != cached_base) {
+    HT_ERROR("Cached block not shared");
+    return 1;
+  }
+
+  /**
+   * Once the pins are released the blocks can be evicted again
+   */
+  pins.clear();
+  pins.push_back(TestInterval::load(2, 0, &cached, &base));
+  if (!cached) {
+    HT_ERROR("Block not cached after the pins were released");
+    return 1;
+  }
+  pins.clear();
+
+  delete Global::block_cache;
+  Global::block_cache = 0;
+
+  return 0;
+}
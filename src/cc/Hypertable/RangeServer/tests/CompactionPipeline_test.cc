@@ -0,0 +1,270 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+#include "Common/System.h"
+#include "Common/Thread.h"
+#include "Common/Usage.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+
+#include "../CellStoreTrailerV1.h"
+#include "../CellStoreV1.h"
+#include "../CompactionPipeline.h"
+#include "../FileBlockCache.h"
+#include "../Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const uint16_t DEFAULT_DFSBROKER_PORT = 38030;
+  const char *usage[] = {
+    "usage: CompactionPipeline_test",
+    "",
+    "  This program writes the same cells to cell stores with and without",
+    "  the compaction pipeline and checks that the resulting files, i.e.",
+    "  data blocks, block index and trailer, are identical.",
+    (const char *)0
+  };
+
+  const size_t CELL_COUNT = 2000;
+  const size_t VALUE_LENGTH = 480;
+
+  /**
+   * The pipelined path adapts the target block size to the compression
+   * ratio of the blocks already written, which lags behind the blocks cut
+   * by the inline path.  With equally sized cells of random values, the
+   * ratio stays close to 1 and, with a block size just past a cell
+   * boundary, both cut blocks at the same cells.
+   */
+  size_t cell_length() {
+    DynamicBuffer dbuf;
+    create_key_and_append(dbuf, FLAG_INSERT, "row000000", 1, "", 1, 1);
+    return dbuf.fill() + Serialization::encoded_length_vi32(VALUE_LENGTH)
+        + VALUE_LENGTH;
+  }
+
+  struct Writer {
+    Writer(const String &fname, CompactionPipeline::PoolPtr pool)
+      : m_fname(fname), m_pool(pool), m_ok(false) { }
+
+    void operator()() {
+      try {
+        write();
+        m_ok = true;
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << m_fname << ": " << e << HT_END;
+      }
+    }
+
+    void write() {
+      CellStoreV1 *cs = new CellStoreV1(Global::dfs);
+      CellStorePtr cs_ptr = cs;
+      PropertiesPtr props = new Properties();
+      TableIdentifier table_id;
+      DynamicBuffer dbuf;
+      DynamicBuffer vbuf;
+      char rowbuf[32];
+      Key key;
+
+      props->set("blocksize", (uint32_t)(cell_length() * 20
+                                         + cell_length() / 5));
+      props->set("compressor", String("zlib"));
+
+      if (m_pool) {
+        CompactionPipelinePtr pipeline = new CompactionPipeline(m_pool, 4);
+        cs->set_compaction_pipeline(pipeline);
+      }
+
+      cs->create(m_fname.c_str(), CELL_COUNT, props);
+
+      // same pseudo random values for every store
+      uint32_t seed = 1;
+      for (size_t i=0; i<CELL_COUNT; i++) {
+        sprintf(rowbuf, "row%06d", (int)i);
+        dbuf.clear();
+        create_key_and_append(dbuf, FLAG_INSERT, rowbuf, 1, "", i+1, i+1);
+        key.load(SerializedKey(dbuf.base));
+
+        vbuf.clear();
+        vbuf.ensure(VALUE_LENGTH + 8);
+        Serialization::encode_vi32(&vbuf.ptr, VALUE_LENGTH);
+        for (size_t j=0; j<VALUE_LENGTH; j++) {
+          seed = seed * 1103515245 + 12345;
+          *vbuf.ptr++ = (uint8_t)(seed >> 16);
+        }
+
+        cs->add(key, ByteString(vbuf.base));
+      }
+
+      cs->finalize(&table_id);
+
+      m_trailer = *dynamic_cast<CellStoreTrailerV1 *>(cs->get_trailer());
+    }
+
+    String m_fname;
+    CompactionPipeline::PoolPtr m_pool;
+    CellStoreTrailerV1 m_trailer;
+    bool m_ok;
+  };
+
+  void read_file(const String &fname, vector<uint8_t> &contents) {
+    int64_t length = Global::dfs->length(fname);
+    int32_t fd = Global::dfs->open(fname);
+
+    contents.resize(length);
+    if (Global::dfs->pread(fd, &contents[0], length, 0) != (size_t)length)
+      HT_THROWF(Error::DFSBROKER_EOF, "Short read of '%s'", fname.c_str());
+    Global::dfs->close(fd);
+  }
+
+  /**
+   * Compares everything but the creation time of the trailer
+   */
+  bool same_cellstore(Writer &expected, Writer &actual) {
+    vector<uint8_t> expected_file, actual_file;
+    uint8_t expected_trailer[112], actual_trailer[112];
+    size_t data_length;
+
+    read_file(expected.m_fname, expected_file);
+    read_file(actual.m_fname, actual_file);
+
+    if (expected_file.size() != actual_file.size()) {
+      HT_ERRORF("%s is %llu bytes, expected %llu", actual.m_fname.c_str(),
+                (Llu)actual_file.size(), (Llu)expected_file.size());
+      return false;
+    }
+
+    HT_ASSERT(expected.m_trailer.size() == sizeof(expected_trailer));
+    data_length = expected_file.size() - expected.m_trailer.size();
+    if (memcmp(&expected_file[0], &actual_file[0], data_length)) {
+      HT_ERRORF("Data or index of %s differs", actual.m_fname.c_str());
+      return false;
+    }
+
+    actual.m_trailer.create_time = expected.m_trailer.create_time;
+    expected.m_trailer.serialize(expected_trailer);
+    actual.m_trailer.serialize(actual_trailer);
+    if (memcmp(expected_trailer, actual_trailer, sizeof(expected_trailer))) {
+      HT_ERRORF("Trailer of %s differs", actual.m_fname.c_str());
+      return false;
+    }
+    return true;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+    CompactionPipeline::PoolPtr pool;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    System::initialize(System::locate_install_dir(argv[0]));
+    ReactorFactory::initialize(2);
+
+    InetAddr::initialize(&addr, "localhost", DEFAULT_DFSBROKER_PORT);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs;
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(20000000LL);
+
+    String testdir = "/CompactionPipeline_test";
+    client->mkdirs(testdir);
+
+    pool = new CompactionPipeline::Pool(3);
+
+    Writer inline_store(testdir + "/cs0", 0);
+    Writer pipelined_store(testdir + "/cs1", pool);
+
+    inline_store.write();
+    pipelined_store.write();
+
+    if (inline_store.m_trailer.fix_index_offset
+        < 10 * inline_store.m_trailer.blocksize) {
+      HT_ERROR("Less than 10 blocks written");
+      return 1;
+    }
+
+    if (!same_cellstore(inline_store, pipelined_store))
+      return 1;
+
+    /**
+     * Concurrent compactions share the pool
+     */
+    {
+      vector<Writer> writers;
+      ThreadGroup threads;
+
+      for (int i=0; i<3; i++)
+        writers.push_back(Writer(testdir + format("/cs%d", i+2), pool));
+      for (size_t i=0; i<writers.size(); i++)
+        threads.create_thread(boost::ref(writers[i]));
+      threads.join_all();
+
+      for (size_t i=0; i<writers.size(); i++) {
+        if (!writers[i].m_ok || !same_cellstore(inline_store, writers[i]))
+          return 1;
+      }
+    }
+
+    pool = 0;
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  catch (...) {
+    HT_ERROR_OUT << "unexpected exception caught" << HT_END;
+    return 1;
+  }
+  return 0;
+}
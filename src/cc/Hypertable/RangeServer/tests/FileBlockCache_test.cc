@@ -23,7 +23,6 @@
 #include <cstdlib>
 #include <cstdio>
 #include <iostream>
-#include <list>
 #include <vector>
 
 extern "C" {
@@ -48,17 +47,6 @@ namespace {
     uint32_t file_offset;
     uint32_t length;
   };
-  struct LtBufferRecord {
-    bool operator()(const struct BufferRecord &br1,
-                    const struct BufferRecord &br2) const {
-      if (br1.file_id == br2.file_id) {
-        if (br1.file_offset == br2.file_offset)
-          return br1.length < br2.length;
-        return br1.file_offset < br2.file_offset;
-      }
-      return br1.file_id < br2.file_id;
-    }
-  };
 }
 
 #define MAX_MEMORY 50000000
@@ -70,7 +58,6 @@ namespace {
 int main(int argc, char **argv) {
   FileBlockCache *cache;
   vector<BufferRecord> input_data;
-  list<BufferRecord> history;
   BufferRecord rec;
   unsigned long seed = (unsigned long)getpid();
   uint64_t total_alloc = 0;
@@ -80,7 +67,6 @@ int main(int argc, char **argv) {
   uint8_t *block;
   uint32_t length;
   int index;
-  set<BufferRecord, LtBufferRecord> lru;
 
   System::initialize(System::locate_install_dir(argv[0]));
 
@@ -129,51 +115,102 @@ int main(int argc, char **argv) {
       total_alloc += length;
       cache->checkin(file_id, file_offset);
     }
-    history.push_front(input_data[index]);
   }
 
   /**
-   * Now verify that our idea of LRU is actually in the cache
+   * Verify that the cache stays within its memory limit
    */
   total_alloc = 0;
-  list<BufferRecord>::iterator history_iter = history.begin();
-  while (total_alloc < MAX_MEMORY) {
-    rec.file_id = (*history_iter).file_id;
-    rec.file_offset = (*history_iter).file_offset;
-    rec.length = (*history_iter).length;
-    if (lru.find(rec) == lru.end()) {
-      if (total_alloc + (*history_iter).length > MAX_MEMORY)
-        break;
-      lru.insert(rec);
-      total_alloc += rec.length;
-      if (!cache->contains(rec.file_id, rec.file_offset)) {
-        HT_ERRORF("computed LRU does not match cache's (id=%d, offset=%u)",
-                  rec.file_id, rec.file_offset);
-        return 1;
+  for (size_t i=0; i<input_data.size(); i++) {
+    if (cache->contains(input_data[i].file_id, input_data[i].file_offset))
+      total_alloc += input_data[i].length;
+  }
+  if (total_alloc > MAX_MEMORY) {
+    HT_ERRORF("Cache holds %llu bytes, limit is %llu",
+              (Llu)total_alloc, (Llu)MAX_MEMORY);
+    return 1;
+  }
+
+  delete cache;
+
+  /**
+   * Scan resistance: a working set that has been hit more than once must
+   * survive a one-pass scan over many times the cache size
+   */
+  cache = new FileBlockCache(MAX_MEMORY);
+  int working_set = (MAX_MEMORY / 2) / TARGET_BUFSIZE;
+
+  for (int pass=0; pass<2; pass++) {
+    for (int i=0; i<working_set; i++) {
+      if (!cache->checkout(0, i, &block, &length)) {
+        block = new uint8_t [ TARGET_BUFSIZE ];
+        HT_EXPECT(cache->insert_and_checkout(0, i, block, TARGET_BUFSIZE),
+                  Error::FAILED_EXPECTATION);
       }
+      cache->checkin(0, i);
+    }
+  }
+
+  // scan offsets beyond 4GB to exercise 64-bit keys
+  int64_t scan_base = 0x100000000LL;
+  int64_t scan_blocks = 10 * (MAX_MEMORY / TARGET_BUFSIZE);
+  for (int64_t i=0; i<scan_blocks; i++) {
+    block = new uint8_t [ TARGET_BUFSIZE ];
+    HT_EXPECT(cache->insert_and_checkout(0, scan_base + i, block,
+              TARGET_BUFSIZE), Error::FAILED_EXPECTATION);
+    cache->checkin(0, scan_base + i);
+  }
+
+  for (int i=0; i<working_set; i++) {
+    if (!cache->contains(0, i)) {
+      HT_ERRORF("Working set block (offset=%d) flushed by scan", i);
+      return 1;
     }
-    ++history_iter;
   }
 
+  // offsets that differ only above bit 32 must not alias
+  if (!cache->contains(0, scan_base + scan_blocks - 1) ||
+      cache->contains(0, scan_blocks - 1)) {
+    HT_ERROR("Cache returned an aliased block");
+    return 1;
+  }
+
+  delete cache;
+
   /**
-   * Now verify that all of the remaining items that
-   * should *not* be in our LRU are, indeed, not in the cache
+   * Compressed tier: blocks are handed back (and dropped from the tier) on
+   * removal, and LRU eviction is confined to the tier
    */
-  if (cache->contains(rec.file_id, rec.file_offset)) {
-    HT_ERROR("computed LRU does not match cache's");
+  cache = new FileBlockCache(MAX_MEMORY, 3 * TARGET_BUFSIZE);
+
+  for (int i=0; i<4; i++) {
+    block = new uint8_t [ TARGET_BUFSIZE ];
+    HT_EXPECT(cache->insert_compressed(0, i, block, TARGET_BUFSIZE),
+              Error::FAILED_EXPECTATION);
+  }
+  if (cache->remove_compressed(0, 0, &block, &length)) {
+    HT_ERROR("Compressed tier did not evict least recently used block");
     return 1;
   }
-  while (history_iter != history.end()) {
-    rec.file_id = (*history_iter).file_id;
-    rec.file_offset = (*history_iter).file_offset;
-    rec.length = (*history_iter).length;
-    if (lru.find(rec) == lru.end()) {
-      if (cache->contains(rec.file_id, rec.file_offset)) {
-        HT_ERROR("computed LRU does not match cache's");
-        return 1;
-      }
-    }
-    ++history_iter;
+  if (!cache->remove_compressed(0, 3, &block, &length) ||
+      length != TARGET_BUFSIZE) {
+    HT_ERROR("Compressed tier lost most recently inserted block");
+    return 1;
+  }
+  delete [] block;
+  if (cache->remove_compressed(0, 3, &block, &length) ||
+      cache->contains(0, 3)) {
+    HT_ERROR("Promoted block still present in compressed tier");
+    return 1;
+  }
+
+  vector<BlockCacheStat> stats;
+  cache->get_stats(stats);
+  if (stats.size() != 2 || stats[1].inserts != 4 || stats[1].evictions != 1
+      || stats[1].hits != 1 || stats[1].misses != 2
+      || stats[1].memory_used != 2 * TARGET_BUFSIZE) {
+    HT_ERROR("Unexpected compressed tier statistics");
+    return 1;
   }
 
   delete cache;
@@ -0,0 +1,141 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/Stopwatch.h"
+#include "Common/Usage.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "../CellCache.h"
+#include "../Config.h"
+#include "../MergeScanner.h"
+#include "../ScanContext.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>column</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const char *usage[] = {
+    "usage: MergeScanner_benchmark",
+    "",
+    "  Measures MergeScanner throughput (cells/s) when merging 2, 8 and 32",
+    "  cell caches.  In the 'interleaved' layout consecutive cells come from",
+    "  different inputs; in the 'runs' layout each input supplies runs of",
+    "  256 consecutive cells, so the same input stays minimal for a while.",
+    (const char *)0
+  };
+
+  const size_t CELL_COUNT = 1000000;
+  const size_t RUN_LENGTH = 256;
+
+  void
+  run(SchemaPtr &schema, size_t inputs, bool runs, DynamicBuffer &key_buf,
+      vector<size_t> &offsets, ByteString value) {
+    vector<CellCachePtr> caches;
+    Key key;
+
+    for (size_t i=0; i<inputs; i++)
+      caches.push_back(new CellCache());
+
+    for (size_t i=0; i<offsets.size(); i++) {
+      size_t input = runs ? (i / RUN_LENGTH) % inputs : i % inputs;
+      key.load(SerializedKey(key_buf.base + offsets[i]));
+      caches[input]->add(key, value);
+    }
+
+    ScanContextPtr scan_ctx = new ScanContext(schema);
+    MergeScanner *mscanner = new MergeScanner(scan_ctx);
+    CellListScannerPtr scanner = mscanner;
+    for (size_t i=0; i<inputs; i++)
+      mscanner->add_scanner(caches[i]->create_scanner(scan_ctx));
+
+    ByteString cell_value;
+    size_t count = 0;
+    Stopwatch stopwatch;
+
+    while (scanner->get(key, cell_value)) {
+      count++;
+      scanner->forward();
+    }
+
+    double elapsed = stopwatch.elapsed();
+
+    HT_ASSERT(count == offsets.size());
+    printf("  inputs=%-3lu %-11s %12.0f cells/s\n", (unsigned long)inputs,
+           runs ? "runs" : "interleaved",
+           elapsed > 0.0 ? (double)count / elapsed : 0.0);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  if (Config::has("help"))
+    Usage::dump_and_exit(usage);
+
+  SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str), true);
+  if (!schema->is_valid()) {
+    HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+    exit(1);
+  }
+
+  DynamicBuffer key_buf(CELL_COUNT * 32);
+  DynamicBuffer value_buf;
+  vector<size_t> offsets;
+  char row[32];
+
+  for (size_t i=0; i<CELL_COUNT; i++) {
+    sprintf(row, "%010lu", (unsigned long)i);
+    offsets.push_back(key_buf.fill());
+    create_key_and_append(key_buf, FLAG_INSERT, row, 1, "",
+                          (int64_t)i + 1, (int64_t)i + 1);
+  }
+  append_as_byte_string(value_buf, "value-data-0123456789");
+  ByteString value(value_buf.base);
+
+  printf("MergeScanner (%lu cells)\n", (unsigned long)CELL_COUNT);
+
+  size_t input_counts[] = { 2, 8, 32 };
+  for (size_t i=0; i<sizeof(input_counts)/sizeof(size_t); i++) {
+    run(schema, input_counts[i], false, key_buf, offsets, value);
+    run(schema, input_counts[i], true, key_buf, offsets, value);
+  }
+
+  return 0;
+}
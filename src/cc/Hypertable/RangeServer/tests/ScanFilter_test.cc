@@ -0,0 +1,301 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include <cstring>
+#include <iostream>
+
+#include "Common/Error.h"
+#include "Common/Serialization.h"
+
+#include "Hypertable/RangeServer/ScanFilter.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  typedef CellPredicate CP;
+
+  int failures = 0;
+
+  /** Tests a cell with the given row, qualifier and value (0 for none) */
+  bool matches(const std::vector<CellPredicate> &predicates, const char *row,
+               const char *qualifier, const char *value,
+               uint8_t flag=FLAG_INSERT) {
+    uint8_t buf[256];
+    uint8_t *ptr = buf;
+    ByteString bs;
+    Key key;
+
+    key.row = row;
+    key.row_len = strlen(row);
+    key.column_qualifier = qualifier;
+    key.column_qualifier_len = strlen(qualifier);
+    key.flag = flag;
+    if (value) {
+      Serialization::encode_vi32(&ptr, strlen(value));
+      memcpy(ptr, value, strlen(value));
+      bs.ptr = buf;
+    }
+    ScanFilter filter(predicates);
+    return filter.matches(key, bs);
+  }
+
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      cout << "FAILED: " << what << endl;
+      failures++;
+    }
+  }
+
+  void check_throws(const std::vector<CellPredicate> &predicates,
+                    const char *what) {
+    try {
+      ScanFilter filter(predicates);
+      cout << "FAILED: " << what << " did not throw" << endl;
+      failures++;
+    }
+    catch (Exception &e) {
+      if (e.code() != Error::RANGESERVER_BAD_SCAN_SPEC) {
+        cout << "FAILED: " << what << " threw " << e << endl;
+        failures++;
+      }
+    }
+  }
+
+  void test_groups() {
+    std::vector<CellPredicate> p;
+
+    // (row =^ 'a' OR NOT (value = 'x' AND qualifier = 'q')) AND value =^ 'x'
+    p.push_back(CP(CP::AND, 2, 0));
+    p.push_back(CP(CP::OR, 2, 0));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::AND, 2, 0));
+    p.push_back(CP(CP::VALUE_EQUAL, 0, "x"));
+    p.push_back(CP(CP::QUALIFIER_EQUAL, 0, "q"));
+    p.push_back(CP(CP::VALUE_PREFIX, 0, "x"));
+
+    check(matches(p, "abc", "q", "x"), "nested: row prefix branch");
+    check(!matches(p, "bcd", "q", "x"), "nested: NOT of true AND");
+    check(matches(p, "bcd", "r", "x"), "nested: NOT of false AND");
+    check(matches(p, "bcd", "q", "xy"), "nested: NOT of false leaf");
+    check(!matches(p, "abc", "q", "y"), "nested: outer AND");
+
+    // several top level trees are ANDed
+    p.clear();
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    p.push_back(CP(CP::OR, 2, 0));
+    p.push_back(CP(CP::QUALIFIER_PREFIX, 0, "x"));
+    p.push_back(CP(CP::QUALIFIER_PREFIX, 0, "y"));
+    p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "ab"));
+    check(matches(p, "ac", "y1", "v"), "top level trees");
+    check(!matches(p, "ab", "y1", "v"), "top level NOT");
+    check(!matches(p, "ac", "z1", "v"), "top level OR");
+    check(!matches(p, "bc", "x1", "v"), "top level leaf");
+
+    // NOT of NOT, one operand groups
+    p.clear();
+    p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::OR, 1, 0));
+    p.push_back(CP(CP::AND, 1, 0));
+    p.push_back(CP(CP::QUALIFIER_EQUAL, 0, "q"));
+    check(matches(p, "r", "q", 0), "double NOT");
+    check(!matches(p, "r", "qq", 0), "double NOT false");
+
+    // deletes always match
+    check(matches(p, "r", "qq", 0, FLAG_DELETE_CELL), "deletes match");
+    check(matches(p, "r", "qq", 0, FLAG_DELETE_ROW), "row deletes match");
+  }
+
+  void test_value_range() {
+    std::vector<CellPredicate> p(1);
+
+    p[0] = CP(CP::VALUE_RANGE, 0, "b", true, "d", true);
+    check(!matches(p, "r", "", "a"), "[b..d] below");
+    check(matches(p, "r", "", "b"), "[b..d] start");
+    check(matches(p, "r", "", "c"), "[b..d] inside");
+    check(matches(p, "r", "", "d"), "[b..d] end");
+    check(!matches(p, "r", "", "da"), "[b..d] above");
+
+    p[0] = CP(CP::VALUE_RANGE, 0, "b", false, "d", false);
+    check(!matches(p, "r", "", "b"), "(b..d) start");
+    check(matches(p, "r", "", "ba"), "(b..d) after start");
+    check(matches(p, "r", "", "cz"), "(b..d) before end");
+    check(!matches(p, "r", "", "d"), "(b..d) end");
+
+    p[0] = CP(CP::VALUE_RANGE, 0, 0, true, "m", false);
+    check(matches(p, "r", "", ""), "(..m) empty value");
+    check(matches(p, "r", "", "a"), "(..m) low");
+    check(!matches(p, "r", "", "m"), "(..m) end");
+
+    p[0] = CP(CP::VALUE_RANGE, 0, "m", true, 0, true);
+    check(!matches(p, "r", "", "l"), "[m..) below");
+    check(matches(p, "r", "", "m"), "[m..) start");
+    check(matches(p, "r", "", "zzz"), "[m..) high");
+
+    p[0] = CP(CP::VALUE_RANGE, 0, 0, true, 0, true);
+    check(matches(p, "r", "", "anything"), "unbounded range");
+
+    // an empty bound is a bound, not an open end
+    p[0] = CP(CP::VALUE_RANGE, 0, 0, true, "", false);
+    check(!matches(p, "r", "", ""), "value < '' empty value");
+    check(!matches(p, "r", "", "a"), "value < '' matches nothing");
+    p[0] = CP(CP::VALUE_RANGE, 0, 0, true, "", true);
+    check(matches(p, "r", "", ""), "value <= '' empty value");
+    check(!matches(p, "r", "", "a"), "value <= '' non-empty value");
+    p[0] = CP(CP::VALUE_RANGE, 0, "", false, 0, true);
+    check(!matches(p, "r", "", ""), "value > '' empty value");
+    check(matches(p, "r", "", "a"), "value > '' non-empty value");
+
+    // the bounds survive serialization
+    uint8_t buf[64];
+    uint8_t *ptr = buf;
+    const uint8_t *dptr = buf;
+    size_t remain;
+    CP(CP::VALUE_RANGE, 0, 0, true, "", false).encode(&ptr);
+    remain = ptr - buf;
+    p[0] = CP(&dptr, &remain);
+    check(!p[0].has_start && p[0].has_end, "decoded bounds");
+    check(!matches(p, "r", "", "a"), "decoded value < ''");
+
+    // bytes compare unsigned, prefixes sort first
+    p[0] = CP(CP::VALUE_RANGE, 0, "ab", true, "\x80", false);
+    check(!matches(p, "r", "", "a"), "prefix sorts before");
+    check(matches(p, "r", "", "abc"), "longer sorts after");
+    check(matches(p, "r", "", "\x7f"), "0x7f below 0x80");
+    check(!matches(p, "r", "", "\x80"), "0x80 excluded");
+  }
+
+  void test_contains() {
+    std::vector<CellPredicate> p(1);
+
+    p[0] = CP(CP::VALUE_CONTAINS, 0, "");
+    check(matches(p, "r", "", "abc"), "empty contains");
+    check(matches(p, "r", "", ""), "empty contains empty value");
+
+    p[0] = CP(CP::VALUE_CONTAINS, 0, "bc");
+    check(matches(p, "r", "", "abcd"), "contains middle");
+    check(matches(p, "r", "", "bc"), "contains whole");
+    check(!matches(p, "r", "", "acbd"), "does not contain");
+    check(!matches(p, "r", "", "b"), "shorter value");
+    check(!matches(p, "r", "", ""), "empty value");
+  }
+
+  void test_regex() {
+    std::vector<CellPredicate> p(1);
+
+    p[0] = CP(CP::ROW_REGEX, 0, "^a[0-9]+$");
+    check(matches(p, "a12", "", 0), "row regex");
+    check(!matches(p, "a12b", "", 0), "row regex anchored");
+
+    p[0] = CP(CP::QUALIFIER_REGEX, 0, "x|y");
+    check(matches(p, "r", "zy", 0), "qualifier regex");
+
+    p[0] = CP(CP::VALUE_REGEX, 0, "^(foo|bar)$");
+    check(matches(p, "r", "", "bar"), "value regex");
+    check(!matches(p, "r", "", "barn"), "value regex mismatch");
+
+    p[0] = CP(CP::ROW_REGEX, 0, "a(b");
+    check_throws(p, "unbalanced row regex");
+    p[0] = CP(CP::QUALIFIER_REGEX, 0, "[z-a]");
+    check_throws(p, "bad qualifier regex range");
+    p[0] = CP(CP::VALUE_REGEX, 0, "*{");
+    check_throws(p, "bad value regex");
+
+    // a bad regex after a good one frees the good one
+    p.clear();
+    p.push_back(CP(CP::OR, 2, 0));
+    p.push_back(CP(CP::ROW_REGEX, 0, "ok"));
+    p.push_back(CP(CP::VALUE_REGEX, 0, "(("));
+    check_throws(p, "bad regex in group");
+  }
+
+  void test_malformed() {
+    std::vector<CellPredicate> p;
+
+    p.push_back(CP(CP::AND, 2, 0));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    check_throws(p, "missing operand");
+
+    p.clear();
+    p.push_back(CP(CP::NOT, 2, 0));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "b"));
+    check_throws(p, "NOT with two operands");
+
+    p.clear();
+    p.push_back(CP(CP::ROW_PREFIX, 1, "a"));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "b"));
+    check_throws(p, "leaf with operands");
+
+    p.clear();
+    p.push_back(CP(CP::OP_MAX, 0, "a"));
+    check_throws(p, "bad operator");
+
+    p.clear();
+    p.push_back(CP(0, 0, "a"));
+    check_throws(p, "zero operator");
+
+    // trees nest at most MAX_DEPTH deep
+    p.clear();
+    for (uint32_t i=1; i<ScanFilter::MAX_DEPTH; i++)
+      p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    check(matches(p, "a", "", 0) == (ScanFilter::MAX_DEPTH % 2 == 1),
+          "MAX_DEPTH nesting");
+    p.insert(p.begin(), CP(CP::NOT, 1, 0));
+    check_throws(p, "nesting deeper than MAX_DEPTH");
+  }
+
+  void test_uses_value() {
+    std::vector<CellPredicate> p;
+
+    p.push_back(CP(CP::ROW_PREFIX, 0, "a"));
+    p.push_back(CP(CP::QUALIFIER_REGEX, 0, "b"));
+    check(!ScanFilter(p).uses_value(), "key predicates do not use value");
+    p.push_back(CP(CP::NOT, 1, 0));
+    p.push_back(CP(CP::VALUE_CONTAINS, 0, "c"));
+    check(ScanFilter(p).uses_value(), "value predicate uses value");
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  test_groups();
+  test_value_range();
+  test_contains();
+  test_regex();
+  test_malformed();
+  test_uses_value();
+
+  if (failures)
+    return 1;
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
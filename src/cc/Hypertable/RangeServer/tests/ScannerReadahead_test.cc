@@ -0,0 +1,249 @@
+/** -*- c++ -*-
+ * Copyright (C) 2009 Doug Judd (Zvents, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+}
+
+#include "Hypertable/Lib/IntervalScanner.h"
+#include "Hypertable/Lib/ScanBlock.h"
+
+#include "Hypertable/RangeServer/ResponseCallbackFetchScanblock.h"
+#include "Hypertable/RangeServer/ScannerMap.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const int64_t BLOCK_SIZE = 65536;
+  const int64_t LIMIT = 16 * BLOCK_SIZE;
+  const uint32_t MAX_DEPTH = 8;
+
+  int failures = 0;
+
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      cout << "FAILED: " << what << endl;
+      failures++;
+    }
+  }
+
+  uint32_t adjust(uint32_t depth, bool stalled, int64_t total) {
+    return IntervalScanner::adjust_readahead_depth(depth, MAX_DEPTH, stalled,
+                                                   total, BLOCK_SIZE, LIMIT);
+  }
+
+  /**
+   * The depth doubles every time the consumer stalls, up to the maximum,
+   * and stays put while blocks are already there when needed
+   */
+  void test_adaptive_depth() {
+    uint32_t depth = 1;
+    uint32_t expected[] = { 2, 4, 8, 8 };
+
+    for (size_t i=0; i<sizeof(expected)/sizeof(uint32_t); i++) {
+      depth = adjust(depth, true, depth * BLOCK_SIZE);
+      check(depth == expected[i], "depth doubles on stall");
+    }
+    check(adjust(4, false, 4 * BLOCK_SIZE) == 4, "no growth without stall");
+    check(adjust(1, false, 0) == 1, "no growth without stall at depth 1");
+
+    // doubling would request more than the memory limit
+    check(adjust(4, true, LIMIT - 3 * BLOCK_SIZE) == 4,
+          "no growth past the memory limit");
+    check(adjust(4, true, LIMIT - 4 * BLOCK_SIZE) == 8,
+          "growth up to the memory limit");
+  }
+
+  /**
+   * While the bytes requested ahead by all scanners exceed the limit, the
+   * depth halves on every block, down to one
+   */
+  void test_memory_limit() {
+    uint32_t depth = MAX_DEPTH;
+    uint32_t expected[] = { 4, 2, 1, 1 };
+
+    for (size_t i=0; i<sizeof(expected)/sizeof(uint32_t); i++) {
+      depth = adjust(depth, true, LIMIT + 1);
+      check(depth == expected[i], "depth halves above the memory limit");
+    }
+    check(adjust(8, false, LIMIT) == 8, "no halving at the memory limit");
+
+    /**
+     * Several scanners that always stall share the limit.  They grow
+     * until the limit stops them, and when the limit is lowered (as if
+     * other scanners had taken up the memory) they back off below it.
+     */
+    const size_t SCANNERS = 3;
+    vector<uint32_t> depths(SCANNERS, 1);
+    int64_t limit = LIMIT;
+    int64_t total = SCANNERS * BLOCK_SIZE;
+
+    for (int round=0; round<20; round++) {
+      if (round == 10)
+        limit = LIMIT / 4;
+      for (size_t i=0; i<SCANNERS; i++) {
+        total -= depths[i] * BLOCK_SIZE;
+        depths[i] = IntervalScanner::adjust_readahead_depth(depths[i],
+            MAX_DEPTH, true, total + depths[i] * BLOCK_SIZE, BLOCK_SIZE,
+            limit);
+        total += depths[i] * BLOCK_SIZE;
+      }
+      if (round == 9) {
+        check(total <= LIMIT, "shared limit respected");
+        check(total > LIMIT / 2, "shared limit used");
+      }
+    }
+    check(total <= limit, "depths backed off below the lowered limit");
+    foreach(uint32_t d, depths)
+      check(d >= 1, "depth never drops below one");
+  }
+
+  class TestScanner : public CellListScanner {
+  public:
+    TestScanner(bool &destroyed) : m_destroyed(destroyed) { }
+    virtual ~TestScanner() { m_destroyed = true; }
+    virtual void forward() { }
+    virtual bool get(Key &key, ByteString &value) { return false; }
+  private:
+    bool &m_destroyed;
+  };
+
+  /**
+   * Fetch response callback that keeps the response instead of sending it
+   */
+  class TestCallback : public ResponseCallbackFetchScanblock {
+  public:
+    TestCallback(EventPtr &event)
+      : ResponseCallbackFetchScanblock(0, event) { }
+
+    CommBufPtr response;
+
+  protected:
+    virtual int send_response(CommBufPtr &cbp) {
+      response = cbp;
+      return Error::OK;
+    }
+  };
+
+  /**
+   * Copies the payload of a message into an event, as if it had been
+   * received.
+   */
+  EventPtr to_event(CommBufPtr &cbp) {
+    CommBuf::SegmentVector segments;
+    size_t len = 0;
+
+    cbp->get_payload_segments(segments);
+    foreach(const CommBuf::Segment &segment, segments)
+      len += segment.len;
+
+    Event *event = new Event(Event::MESSAGE);
+    uint8_t *payload = new uint8_t [len];
+    event->header = cbp->header;
+    event->payload = payload;
+    event->payload_len = len;
+    foreach(const CommBuf::Segment &segment, segments) {
+      memcpy(payload, segment.base, segment.len);
+      payload += segment.len;
+    }
+    return event;
+  }
+
+  /**
+   * An exhausted scanner releases the scanner right away, answers late
+   * fetches with an empty final block and goes away on destroy_scanner
+   * or after it idled too long
+   */
+  void test_late_fetch() {
+    ScannerMap scanner_map;
+    TableIdentifier table;
+    TableIdentifierManaged scanner_table;
+    CellListScannerPtr scanner;
+    RangePtr range;
+    bool destroyed = false;
+
+    table.name = "ScannerReadahead";
+    scanner = new TestScanner(destroyed);
+    uint32_t id = scanner_map.put(scanner, range, &table);
+    scanner = 0;
+
+    check(scanner_map.get(id, scanner, range, scanner_table) && scanner,
+          "scanner mapped");
+    scanner = 0;
+
+    scanner_map.mark_exhausted(id);
+    check(destroyed, "exhausted scanner released");
+    check(scanner_map.get(id, scanner, range, scanner_table),
+          "exhausted scanner id kept");
+    check(!scanner && !range, "no scanner for exhausted id");
+
+    EventPtr request(new Event(Event::MESSAGE));
+    TestCallback cb(request);
+    check(cb.response_exhausted(id) == Error::OK, "late fetch answered");
+    check(cb.response, "late fetch response sent");
+    if (!cb.response)
+      return;
+
+    EventPtr event = to_event(cb.response);
+    ScanBlock scanblock;
+    check(scanblock.load(event) == Error::OK, "late fetch response loads");
+    check(scanblock.eos(), "late fetch response is final");
+    check(scanblock.size() == 0 && !scanblock.more(),
+          "late fetch response is empty");
+    check(scanblock.get_scanner_id() == (int)id, "late fetch scanner id");
+
+    check(scanner_map.remove(id), "destroy removes exhausted id");
+    check(!scanner_map.get(id, scanner, range, scanner_table),
+          "destroyed id unknown");
+
+    // a client that never destroys the scanner leaves it to be purged
+    id = scanner_map.put(scanner, range, &table);
+    scanner_map.mark_exhausted(id);
+    poll(0, 0, 5);
+    scanner_map.purge_expired(1);
+    check(!scanner_map.get(id, scanner, range, scanner_table),
+          "exhausted id purged");
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  test_adaptive_depth();
+  test_memory_limit();
+  test_late_fetch();
+
+  if (failures)
+    return 1;
+
+  return 0;
+}
@@ -102,6 +102,89 @@ struct CellInterval {
   6: optional bool end_inclusive = 1
 }
 
+/** Operators of a cell filter predicate
+ *
+ * Note for maintainers: the definition must be sync'ed with the
+ * CellPredicate operators in src/cc/Hypertable/Lib/ScanSpec.h
+ *
+ * AND, OR: true if all/any of the following <code>children</code> subtrees
+ * are true
+ *
+ * NOT: true if the following subtree is false
+ *
+ * ROW_PREFIX, ROW_REGEX: row key starts with/matches operand
+ *
+ * QUALIFIER_EQUAL, QUALIFIER_PREFIX, QUALIFIER_REGEX: column qualifier
+ * equals/starts with/matches operand
+ *
+ * VALUE_EQUAL, VALUE_PREFIX, VALUE_CONTAINS, VALUE_REGEX: cell value
+ * equals/starts with/contains/matches operand
+ *
+ * VALUE_RANGE: cell value lies between operand and end_operand; either
+ * bound can be left open with has_start/has_end
+ */
+enum CellPredicateOp {
+  AND = 1,
+  OR = 2,
+  NOT = 3,
+  ROW_PREFIX = 4,
+  ROW_REGEX = 5,
+  QUALIFIER_EQUAL = 6,
+  QUALIFIER_PREFIX = 7,
+  QUALIFIER_REGEX = 8,
+  VALUE_EQUAL = 9,
+  VALUE_PREFIX = 10,
+  VALUE_RANGE = 11,
+  VALUE_CONTAINS = 12,
+  VALUE_REGEX = 13
+}
+
+/** Specifies one node of a cell filter
+ *
+ * A filter is a tree flattened in prefix order: an AND, OR or NOT node is
+ * immediately followed by its children.  Several top level trees are
+ * ANDed.  Filters are evaluated by the range server, so only matching
+ * cells are returned.  Regular expressions are POSIX extended.
+ *
+ * <dl>
+ *   <dt>op</dt>
+ *   <dd>The operator (see CellPredicateOp)</dd>
+ *
+ *   <dt>children</dt>
+ *   <dd>Number of child subtrees of an AND or OR node</dd>
+ *
+ *   <dt>operand</dt>
+ *   <dd>The operand of a leaf (start of the range for VALUE_RANGE)</dd>
+ *
+ *   <dt>start_inclusive</dt>
+ *   <dd>Whether the start of a VALUE_RANGE is included (default: true)</dd>
+ *
+ *   <dt>end_operand</dt>
+ *   <dd>The end of the range for VALUE_RANGE</dd>
+ *
+ *   <dt>end_inclusive</dt>
+ *   <dd>Whether the end of a VALUE_RANGE is included (default: true)</dd>
+ *
+ *   <dt>has_start</dt>
+ *   <dd>Whether a VALUE_RANGE has a lower bound; false leaves it open
+ *   (default: true)</dd>
+ *
+ *   <dt>has_end</dt>
+ *   <dd>Whether a VALUE_RANGE has an upper bound; false leaves it open
+ *   (default: true)</dd>
+ * </dl>
+ */
+struct CellPredicate {
+  1: optional CellPredicateOp op
+  2: optional i32 children = 0
+  3: optional string operand
+  4: optional bool start_inclusive = 1
+  5: optional string end_operand
+  6: optional bool end_inclusive = 1
+  7: optional bool has_start = 1
+  8: optional bool has_end = 1
+}
+
 /** Specifies options for a scan
  *
  * <dl>
@@ -131,6 +214,17 @@ struct CellInterval {
  *
  *   <dt>columns</dt>
  *   <dd>Specifies the names of the columns to return</dd>
+ *
+ *   <dt>parallel</dt>
+ *   <dd>Specifies the number of ranges to scan concurrently (0 or 1 scans
+ *   one range at a time)</dd>
+ *
+ *   <dt>unordered</dt>
+ *   <dd>With parallel scans, return whole ranges in the order they respond
+ *   instead of in row key order</dd>
+ *
+ *   <dt>predicates</dt>
+ *   <dd>A cell filter evaluated by the range servers (see CellPredicate)</dd>
  * </dl>
  */
 struct ScanSpec {
@@ -142,6 +236,9 @@ struct ScanSpec {
   6: optional i64 start_time
   7: optional i64 end_time
   8: optional list<string> columns
+  9: optional i32 parallel = 0
+  10: optional bool unordered = 0
+  11: optional list<CellPredicate> predicates
 }
 
 /** State flags for a table cell
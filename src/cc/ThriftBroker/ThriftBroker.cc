@@ -113,6 +113,12 @@ convert_scan_spec(const ThriftGen::ScanSpec &tss, Hypertable::ScanSpec &hss) {
   if (tss.__isset.return_deletes)
     hss.return_deletes = tss.return_deletes;
 
+  if (tss.__isset.parallel && tss.parallel > 0)
+    hss.parallel = tss.parallel;
+
+  if (tss.__isset.unordered)
+    hss.unordered = tss.unordered;
+
   // shallow copy
   foreach(const ThriftGen::RowInterval &ri, tss.row_intervals)
     hss.row_intervals.push_back(Hypertable::RowInterval(ri.start_row.c_str(),
@@ -125,6 +131,12 @@ convert_scan_spec(const ThriftGen::ScanSpec &tss, Hypertable::ScanSpec &hss) {
 
   foreach(const std::string &col, tss.columns)
     hss.columns.push_back(col.c_str());
+
+  foreach(const ThriftGen::CellPredicate &cp, tss.predicates)
+    hss.predicates.push_back(Hypertable::CellPredicate(
+        cp.__isset.op ? cp.op : 0, cp.children,
+        cp.has_start ? cp.operand.c_str() : 0, cp.start_inclusive,
+        cp.has_end ? cp.end_operand.c_str() : 0, cp.end_inclusive));
 }
 
 void convert_cell(const ThriftGen::Cell &tcell, Hypertable::Cell &hcell) {
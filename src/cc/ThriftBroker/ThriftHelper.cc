@@ -125,6 +125,36 @@ std::ostream &operator<<(std::ostream &out, const CellInterval &ci) {
   return out <<"}";
 }
 
+std::ostream &operator<<(std::ostream &out, const CellPredicate &cp) {
+  out <<"{CellPredicate:";
+
+  if (cp.__isset.op)
+    out <<" op="<< cp.op;
+
+  if (cp.__isset.children)
+    out <<" children="<< cp.children;
+
+  if (cp.__isset.operand)
+    out <<" operand='"<< cp.operand <<"'";
+
+  if (cp.__isset.start_inclusive)
+    out <<" start_inclusive="<< cp.start_inclusive;
+
+  if (cp.__isset.end_operand)
+    out <<" end_operand='"<< cp.end_operand <<"'";
+
+  if (cp.__isset.end_inclusive)
+    out <<" end_inclusive="<< cp.end_inclusive;
+
+  if (cp.__isset.has_start)
+    out <<" has_start="<< cp.has_start;
+
+  if (cp.__isset.has_end)
+    out <<" has_end="<< cp.has_end;
+
+  return out <<"}";
+}
+
 std::ostream &operator<<(std::ostream &out, const ScanSpec &ss) {
   out <<"{ScanSpec:";
 
@@ -140,6 +170,12 @@ std::ostream &operator<<(std::ostream &out, const ScanSpec &ss) {
       out <<"  "<< ci <<"\n";
     out <<"  ]\n";
   }
+  if (ss.__isset.predicates) {
+    out <<" predicates=[\n";
+    foreach(const CellPredicate &cp, ss.predicates)
+      out <<"  "<< cp <<"\n";
+    out <<"  ]\n";
+  }
   if (ss.__isset.columns) {
     out <<" columns=[\n";
     foreach(const std::string &col, ss.columns)
@@ -161,6 +197,12 @@ std::ostream &operator<<(std::ostream &out, const ScanSpec &ss) {
   if (ss.__isset.end_time)
     out <<" end_time="<< ss.end_time;
 
+  if (ss.__isset.parallel)
+    out <<" parallel="<< ss.parallel;
+
+  if (ss.__isset.unordered)
+    out <<" unordered="<< ss.unordered;
+
   return out <<'}';
 }
 
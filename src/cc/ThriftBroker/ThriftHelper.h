@@ -29,6 +29,7 @@ std::ostream &operator<<(std::ostream &, const RowInterval &);
 std::ostream &operator<<(std::ostream &, const Cell &);
 std::ostream &operator<<(std::ostream &, const CellAsArray &);
 std::ostream &operator<<(std::ostream &, const CellInterval &);
+std::ostream &operator<<(std::ostream &, const CellPredicate &);
 std::ostream &operator<<(std::ostream &, const ScanSpec &);
 std::ostream &operator<<(std::ostream &, const HqlResult &);
 std::ostream &operator<<(std::ostream &, const HqlResult2 &);
@@ -223,8 +223,157 @@ uint32_t CellInterval::write(apache::thrift::protocol::TProtocol* oprot) const {
   return xfer;
 }
 
-const char* ScanSpec::ascii_fingerprint = "AAC6EAC7CCF976D9159BC1D44D2DABF3";
-const uint8_t ScanSpec::binary_fingerprint[16] = {0xAA,0xC6,0xEA,0xC7,0xCC,0xF9,0x76,0xD9,0x15,0x9B,0xC1,0xD4,0x4D,0x2D,0xAB,0xF3};
+const char* CellPredicate::ascii_fingerprint = "CE1A14B51E45BF0A1B56663C2FA3545B";
+const uint8_t CellPredicate::binary_fingerprint[16] = {0xCE,0x1A,0x14,0xB5,0x1E,0x45,0xBF,0x0A,0x1B,0x56,0x66,0x3C,0x2F,0xA3,0x54,0x5B};
+
+uint32_t CellPredicate::read(apache::thrift::protocol::TProtocol* iprot) {
+
+  uint32_t xfer = 0;
+  std::string fname;
+  apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == apache::thrift::protocol::T_I32) {
+          int32_t ecast0;
+          xfer += iprot->readI32(ecast0);
+          this->op = (CellPredicateOp)ecast0;
+          this->__isset.op = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 2:
+        if (ftype == apache::thrift::protocol::T_I32) {
+          xfer += iprot->readI32(this->children);
+          this->__isset.children = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 3:
+        if (ftype == apache::thrift::protocol::T_STRING) {
+          xfer += iprot->readString(this->operand);
+          this->__isset.operand = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 4:
+        if (ftype == apache::thrift::protocol::T_BOOL) {
+          xfer += iprot->readBool(this->start_inclusive);
+          this->__isset.start_inclusive = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 5:
+        if (ftype == apache::thrift::protocol::T_STRING) {
+          xfer += iprot->readString(this->end_operand);
+          this->__isset.end_operand = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 6:
+        if (ftype == apache::thrift::protocol::T_BOOL) {
+          xfer += iprot->readBool(this->end_inclusive);
+          this->__isset.end_inclusive = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 7:
+        if (ftype == apache::thrift::protocol::T_BOOL) {
+          xfer += iprot->readBool(this->has_start);
+          this->__isset.has_start = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 8:
+        if (ftype == apache::thrift::protocol::T_BOOL) {
+          xfer += iprot->readBool(this->has_end);
+          this->__isset.has_end = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t CellPredicate::write(apache::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  xfer += oprot->writeStructBegin("CellPredicate");
+  if (this->__isset.op) {
+    xfer += oprot->writeFieldBegin("op", apache::thrift::protocol::T_I32, 1);
+    xfer += oprot->writeI32((int32_t)this->op);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.children) {
+    xfer += oprot->writeFieldBegin("children", apache::thrift::protocol::T_I32, 2);
+    xfer += oprot->writeI32(this->children);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.operand) {
+    xfer += oprot->writeFieldBegin("operand", apache::thrift::protocol::T_STRING, 3);
+    xfer += oprot->writeString(this->operand);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.start_inclusive) {
+    xfer += oprot->writeFieldBegin("start_inclusive", apache::thrift::protocol::T_BOOL, 4);
+    xfer += oprot->writeBool(this->start_inclusive);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.end_operand) {
+    xfer += oprot->writeFieldBegin("end_operand", apache::thrift::protocol::T_STRING, 5);
+    xfer += oprot->writeString(this->end_operand);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.end_inclusive) {
+    xfer += oprot->writeFieldBegin("end_inclusive", apache::thrift::protocol::T_BOOL, 6);
+    xfer += oprot->writeBool(this->end_inclusive);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.has_start) {
+    xfer += oprot->writeFieldBegin("has_start", apache::thrift::protocol::T_BOOL, 7);
+    xfer += oprot->writeBool(this->has_start);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.has_end) {
+    xfer += oprot->writeFieldBegin("has_end", apache::thrift::protocol::T_BOOL, 8);
+    xfer += oprot->writeBool(this->has_end);
+    xfer += oprot->writeFieldEnd();
+  }
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+const char* ScanSpec::ascii_fingerprint = "CD30E573D806B3C1A92A9CB354DBD956";
+const uint8_t ScanSpec::binary_fingerprint[16] = {0xCD,0x30,0xE5,0x73,0xD8,0x06,0xB3,0xC1,0xA9,0x2A,0x9C,0xB3,0x54,0xDB,0xD9,0x56};
 
 uint32_t ScanSpec::read(apache::thrift::protocol::TProtocol* iprot) {
 
@@ -250,14 +399,14 @@ uint32_t ScanSpec::read(apache::thrift::protocol::TProtocol* iprot) {
         if (ftype == apache::thrift::protocol::T_LIST) {
           {
             this->row_intervals.clear();
-            uint32_t _size0;
-            apache::thrift::protocol::TType _etype3;
-            iprot->readListBegin(_etype3, _size0);
-            this->row_intervals.resize(_size0);
-            uint32_t _i4;
-            for (_i4 = 0; _i4 < _size0; ++_i4)
+            uint32_t _size1;
+            apache::thrift::protocol::TType _etype4;
+            iprot->readListBegin(_etype4, _size1);
+            this->row_intervals.resize(_size1);
+            uint32_t _i5;
+            for (_i5 = 0; _i5 < _size1; ++_i5)
             {
-              xfer += this->row_intervals[_i4].read(iprot);
+              xfer += this->row_intervals[_i5].read(iprot);
             }
             iprot->readListEnd();
           }
@@ -270,14 +419,14 @@ uint32_t ScanSpec::read(apache::thrift::protocol::TProtocol* iprot) {
         if (ftype == apache::thrift::protocol::T_LIST) {
           {
             this->cell_intervals.clear();
-            uint32_t _size5;
-            apache::thrift::protocol::TType _etype8;
-            iprot->readListBegin(_etype8, _size5);
-            this->cell_intervals.resize(_size5);
-            uint32_t _i9;
-            for (_i9 = 0; _i9 < _size5; ++_i9)
+            uint32_t _size6;
+            apache::thrift::protocol::TType _etype9;
+            iprot->readListBegin(_etype9, _size6);
+            this->cell_intervals.resize(_size6);
+            uint32_t _i10;
+            for (_i10 = 0; _i10 < _size6; ++_i10)
             {
-              xfer += this->cell_intervals[_i9].read(iprot);
+              xfer += this->cell_intervals[_i10].read(iprot);
             }
             iprot->readListEnd();
           }
@@ -330,14 +479,14 @@ uint32_t ScanSpec::read(apache::thrift::protocol::TProtocol* iprot) {
         if (ftype == apache::thrift::protocol::T_LIST) {
           {
             this->columns.clear();
-            uint32_t _size10;
-            apache::thrift::protocol::TType _etype13;
-            iprot->readListBegin(_etype13, _size10);
-            this->columns.resize(_size10);
-            uint32_t _i14;
-            for (_i14 = 0; _i14 < _size10; ++_i14)
+            uint32_t _size11;
+            apache::thrift::protocol::TType _etype14;
+            iprot->readListBegin(_etype14, _size11);
+            this->columns.resize(_size11);
+            uint32_t _i15;
+            for (_i15 = 0; _i15 < _size11; ++_i15)
             {
-              xfer += iprot->readString(this->columns[_i14]);
+              xfer += iprot->readString(this->columns[_i15]);
             }
             iprot->readListEnd();
           }
@@ -346,6 +495,42 @@ uint32_t ScanSpec::read(apache::thrift::protocol::TProtocol* iprot) {
           xfer += iprot->skip(ftype);
         }
         break;
+      case 9:
+        if (ftype == apache::thrift::protocol::T_I32) {
+          xfer += iprot->readI32(this->parallel);
+          this->__isset.parallel = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 10:
+        if (ftype == apache::thrift::protocol::T_BOOL) {
+          xfer += iprot->readBool(this->unordered);
+          this->__isset.unordered = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 11:
+        if (ftype == apache::thrift::protocol::T_LIST) {
+          {
+            this->predicates.clear();
+            uint32_t _size16;
+            apache::thrift::protocol::TType _etype19;
+            iprot->readListBegin(_etype19, _size16);
+            this->predicates.resize(_size16);
+            uint32_t _i20;
+            for (_i20 = 0; _i20 < _size16; ++_i20)
+            {
+              xfer += this->predicates[_i20].read(iprot);
+            }
+            iprot->readListEnd();
+          }
+          this->__isset.predicates = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
       default:
         xfer += iprot->skip(ftype);
         break;
@@ -365,10 +550,10 @@ uint32_t ScanSpec::write(apache::thrift::protocol::TProtocol* oprot) const {
     xfer += oprot->writeFieldBegin("row_intervals", apache::thrift::protocol::T_LIST, 1);
     {
       xfer += oprot->writeListBegin(apache::thrift::protocol::T_STRUCT, this->row_intervals.size());
-      std::vector<RowInterval> ::const_iterator _iter15;
-      for (_iter15 = this->row_intervals.begin(); _iter15 != this->row_intervals.end(); ++_iter15)
+      std::vector<RowInterval> ::const_iterator _iter21;
+      for (_iter21 = this->row_intervals.begin(); _iter21 != this->row_intervals.end(); ++_iter21)
       {
-        xfer += (*_iter15).write(oprot);
+        xfer += (*_iter21).write(oprot);
       }
       xfer += oprot->writeListEnd();
     }
@@ -378,10 +563,10 @@ uint32_t ScanSpec::write(apache::thrift::protocol::TProtocol* oprot) const {
     xfer += oprot->writeFieldBegin("cell_intervals", apache::thrift::protocol::T_LIST, 2);
     {
       xfer += oprot->writeListBegin(apache::thrift::protocol::T_STRUCT, this->cell_intervals.size());
-      std::vector<CellInterval> ::const_iterator _iter16;
-      for (_iter16 = this->cell_intervals.begin(); _iter16 != this->cell_intervals.end(); ++_iter16)
+      std::vector<CellInterval> ::const_iterator _iter22;
+      for (_iter22 = this->cell_intervals.begin(); _iter22 != this->cell_intervals.end(); ++_iter22)
       {
-        xfer += (*_iter16).write(oprot);
+        xfer += (*_iter22).write(oprot);
       }
       xfer += oprot->writeListEnd();
     }
@@ -416,10 +601,33 @@ uint32_t ScanSpec::write(apache::thrift::protocol::TProtocol* oprot) const {
     xfer += oprot->writeFieldBegin("columns", apache::thrift::protocol::T_LIST, 8);
     {
       xfer += oprot->writeListBegin(apache::thrift::protocol::T_STRING, this->columns.size());
-      std::vector<std::string> ::const_iterator _iter17;
-      for (_iter17 = this->columns.begin(); _iter17 != this->columns.end(); ++_iter17)
+      std::vector<std::string> ::const_iterator _iter23;
+      for (_iter23 = this->columns.begin(); _iter23 != this->columns.end(); ++_iter23)
+      {
+        xfer += oprot->writeString((*_iter23));
+      }
+      xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.parallel) {
+    xfer += oprot->writeFieldBegin("parallel", apache::thrift::protocol::T_I32, 9);
+    xfer += oprot->writeI32(this->parallel);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.unordered) {
+    xfer += oprot->writeFieldBegin("unordered", apache::thrift::protocol::T_BOOL, 10);
+    xfer += oprot->writeBool(this->unordered);
+    xfer += oprot->writeFieldEnd();
+  }
+  if (this->__isset.predicates) {
+    xfer += oprot->writeFieldBegin("predicates", apache::thrift::protocol::T_LIST, 11);
+    {
+      xfer += oprot->writeListBegin(apache::thrift::protocol::T_STRUCT, this->predicates.size());
+      std::vector<CellPredicate> ::const_iterator _iter24;
+      for (_iter24 = this->predicates.begin(); _iter24 != this->predicates.end(); ++_iter24)
       {
-        xfer += oprot->writeString((*_iter17));
+        xfer += (*_iter24).write(oprot);
       }
       xfer += oprot->writeListEnd();
     }
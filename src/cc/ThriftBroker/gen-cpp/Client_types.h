@@ -25,6 +25,22 @@ enum MutatorFlag {
   NO_LOG_SYNC = 1
 };
 
+enum CellPredicateOp {
+  AND = 1,
+  OR = 2,
+  NOT = 3,
+  ROW_PREFIX = 4,
+  ROW_REGEX = 5,
+  QUALIFIER_EQUAL = 6,
+  QUALIFIER_PREFIX = 7,
+  QUALIFIER_REGEX = 8,
+  VALUE_EQUAL = 9,
+  VALUE_PREFIX = 10,
+  VALUE_RANGE = 11,
+  VALUE_CONTAINS = 12,
+  VALUE_REGEX = 13
+};
+
 typedef int64_t Scanner;
 
 typedef int64_t Mutator;
@@ -155,13 +171,92 @@ class CellInterval {
 
 };
 
+class CellPredicate {
+ public:
+
+  static const char* ascii_fingerprint; // = "CE1A14B51E45BF0A1B56663C2FA3545B";
+  static const uint8_t binary_fingerprint[16]; // = {0xCE,0x1A,0x14,0xB5,0x1E,0x45,0xBF,0x0A,0x1B,0x56,0x66,0x3C,0x2F,0xA3,0x54,0x5B};
+
+  CellPredicate() : children(0), operand(""), start_inclusive(true), end_operand(""), end_inclusive(true), has_start(true), has_end(true) {
+  }
+
+  virtual ~CellPredicate() throw() {}
+
+  CellPredicateOp op;
+  int32_t children;
+  std::string operand;
+  bool start_inclusive;
+  std::string end_operand;
+  bool end_inclusive;
+  bool has_start;
+  bool has_end;
+
+  struct __isset {
+    __isset() : op(false), children(false), operand(false), start_inclusive(false), end_operand(false), end_inclusive(false), has_start(false), has_end(false) {}
+    bool op;
+    bool children;
+    bool operand;
+    bool start_inclusive;
+    bool end_operand;
+    bool end_inclusive;
+    bool has_start;
+    bool has_end;
+  } __isset;
+
+  bool operator == (const CellPredicate & rhs) const
+  {
+    if (__isset.op != rhs.__isset.op)
+      return false;
+    else if (__isset.op && !(op == rhs.op))
+      return false;
+    if (__isset.children != rhs.__isset.children)
+      return false;
+    else if (__isset.children && !(children == rhs.children))
+      return false;
+    if (__isset.operand != rhs.__isset.operand)
+      return false;
+    else if (__isset.operand && !(operand == rhs.operand))
+      return false;
+    if (__isset.start_inclusive != rhs.__isset.start_inclusive)
+      return false;
+    else if (__isset.start_inclusive && !(start_inclusive == rhs.start_inclusive))
+      return false;
+    if (__isset.end_operand != rhs.__isset.end_operand)
+      return false;
+    else if (__isset.end_operand && !(end_operand == rhs.end_operand))
+      return false;
+    if (__isset.end_inclusive != rhs.__isset.end_inclusive)
+      return false;
+    else if (__isset.end_inclusive && !(end_inclusive == rhs.end_inclusive))
+      return false;
+    if (__isset.has_start != rhs.__isset.has_start)
+      return false;
+    else if (__isset.has_start && !(has_start == rhs.has_start))
+      return false;
+    if (__isset.has_end != rhs.__isset.has_end)
+      return false;
+    else if (__isset.has_end && !(has_end == rhs.has_end))
+      return false;
+    return true;
+  }
+  bool operator != (const CellPredicate &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const CellPredicate & ) const;
+
+  uint32_t read(apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
 class ScanSpec {
  public:
 
-  static const char* ascii_fingerprint; // = "AAC6EAC7CCF976D9159BC1D44D2DABF3";
-  static const uint8_t binary_fingerprint[16]; // = {0xAA,0xC6,0xEA,0xC7,0xCC,0xF9,0x76,0xD9,0x15,0x9B,0xC1,0xD4,0x4D,0x2D,0xAB,0xF3};
+  static const char* ascii_fingerprint; // = "CD30E573D806B3C1A92A9CB354DBD956";
+  static const uint8_t binary_fingerprint[16]; // = {0xCD,0x30,0xE5,0x73,0xD8,0x06,0xB3,0xC1,0xA9,0x2A,0x9C,0xB3,0x54,0xDB,0xD9,0x56};
 
-  ScanSpec() : return_deletes(false), revs(0), row_limit(0), start_time(0), end_time(0) {
+  ScanSpec() : return_deletes(false), revs(0), row_limit(0), start_time(0), end_time(0), parallel(0), unordered(false) {
   }
 
   virtual ~ScanSpec() throw() {}
@@ -174,9 +269,12 @@ class ScanSpec {
   int64_t start_time;
   int64_t end_time;
   std::vector<std::string>  columns;
+  int32_t parallel;
+  bool unordered;
+  std::vector<CellPredicate>  predicates;
 
   struct __isset {
-    __isset() : row_intervals(false), cell_intervals(false), return_deletes(false), revs(false), row_limit(false), start_time(false), end_time(false), columns(false) {}
+    __isset() : row_intervals(false), cell_intervals(false), return_deletes(false), revs(false), row_limit(false), start_time(false), end_time(false), columns(false), parallel(false), unordered(false), predicates(false) {}
     bool row_intervals;
     bool cell_intervals;
     bool return_deletes;
@@ -185,6 +283,9 @@ class ScanSpec {
     bool start_time;
     bool end_time;
     bool columns;
+    bool parallel;
+    bool unordered;
+    bool predicates;
   } __isset;
 
   bool operator == (const ScanSpec & rhs) const
@@ -221,6 +322,18 @@ class ScanSpec {
       return false;
     else if (__isset.columns && !(columns == rhs.columns))
       return false;
+    if (__isset.parallel != rhs.__isset.parallel)
+      return false;
+    else if (__isset.parallel && !(parallel == rhs.parallel))
+      return false;
+    if (__isset.unordered != rhs.__isset.unordered)
+      return false;
+    else if (__isset.unordered && !(unordered == rhs.unordered))
+      return false;
+    if (__isset.predicates != rhs.__isset.predicates)
+      return false;
+    else if (__isset.predicates && !(predicates == rhs.predicates))
+      return false;
     return true;
   }
   bool operator != (const ScanSpec &rhs) const {
@@ -0,0 +1,803 @@
+/**
+ * Autogenerated by Thrift
+ *
+ * DO NOT EDIT UNLESS YOU ARE SURE THAT YOU KNOW WHAT YOU ARE DOING
+ */
+package org.hypertable.thriftgen;
+
+import java.util.List;
+import java.util.ArrayList;
+import java.util.Map;
+import java.util.HashMap;
+import java.util.Set;
+import java.util.HashSet;
+import java.util.Collections;
+import org.apache.log4j.Logger;
+
+import org.apache.thrift.*;
+import org.apache.thrift.meta_data.*;
+import org.apache.thrift.protocol.*;
+
+/**
+ * Specifies one node of a cell filter
+ * 
+ * A filter is a tree flattened in prefix order: an AND, OR or NOT node is
+ * immediately followed by its children.  Several top level trees are
+ * ANDed.  Filters are evaluated by the range server, so only matching
+ * cells are returned.  Regular expressions are POSIX extended.
+ * 
+ * <dl>
+ *   <dt>op</dt>
+ *   <dd>The operator (see CellPredicateOp)</dd>
+ * 
+ *   <dt>children</dt>
+ *   <dd>Number of child subtrees of an AND or OR node</dd>
+ * 
+ *   <dt>operand</dt>
+ *   <dd>The operand of a leaf (start of the range for VALUE_RANGE)</dd>
+ * 
+ *   <dt>start_inclusive</dt>
+ *   <dd>Whether the start of a VALUE_RANGE is included (default: true)</dd>
+ * 
+ *   <dt>end_operand</dt>
+ *   <dd>The end of the range for VALUE_RANGE</dd>
+ * 
+ *   <dt>end_inclusive</dt>
+ *   <dd>Whether the end of a VALUE_RANGE is included (default: true)</dd>
+ * 
+ *   <dt>has_start</dt>
+ *   <dd>Whether a VALUE_RANGE has a lower bound; false leaves it open
+ *   (default: true)</dd>
+ * 
+ *   <dt>has_end</dt>
+ *   <dd>Whether a VALUE_RANGE has an upper bound; false leaves it open
+ *   (default: true)</dd>
+ * </dl>
+ */
+public class CellPredicate implements TBase, java.io.Serializable, Cloneable {
+  private static final TStruct STRUCT_DESC = new TStruct("CellPredicate");
+  private static final TField OP_FIELD_DESC = new TField("op", TType.I32, (short)1);
+  private static final TField CHILDREN_FIELD_DESC = new TField("children", TType.I32, (short)2);
+  private static final TField OPERAND_FIELD_DESC = new TField("operand", TType.STRING, (short)3);
+  private static final TField START_INCLUSIVE_FIELD_DESC = new TField("start_inclusive", TType.BOOL, (short)4);
+  private static final TField END_OPERAND_FIELD_DESC = new TField("end_operand", TType.STRING, (short)5);
+  private static final TField END_INCLUSIVE_FIELD_DESC = new TField("end_inclusive", TType.BOOL, (short)6);
+  private static final TField HAS_START_FIELD_DESC = new TField("has_start", TType.BOOL, (short)7);
+  private static final TField HAS_END_FIELD_DESC = new TField("has_end", TType.BOOL, (short)8);
+
+  public int op;
+  public static final int OP = 1;
+  public int children;
+  public static final int CHILDREN = 2;
+  public String operand;
+  public static final int OPERAND = 3;
+  public boolean start_inclusive;
+  public static final int START_INCLUSIVE = 4;
+  public String end_operand;
+  public static final int END_OPERAND = 5;
+  public boolean end_inclusive;
+  public static final int END_INCLUSIVE = 6;
+  public boolean has_start;
+  public static final int HAS_START = 7;
+  public boolean has_end;
+  public static final int HAS_END = 8;
+
+  private final Isset __isset = new Isset();
+  private static final class Isset implements java.io.Serializable {
+    public boolean op = false;
+    public boolean children = false;
+    public boolean start_inclusive = false;
+    public boolean end_inclusive = false;
+    public boolean has_start = false;
+    public boolean has_end = false;
+  }
+
+  public static final Map<Integer, FieldMetaData> metaDataMap = Collections.unmodifiableMap(new HashMap<Integer, FieldMetaData>() {{
+    put(OP, new FieldMetaData("op", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.I32)));
+    put(CHILDREN, new FieldMetaData("children", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.I32)));
+    put(OPERAND, new FieldMetaData("operand", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.STRING)));
+    put(START_INCLUSIVE, new FieldMetaData("start_inclusive", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.BOOL)));
+    put(END_OPERAND, new FieldMetaData("end_operand", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.STRING)));
+    put(END_INCLUSIVE, new FieldMetaData("end_inclusive", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.BOOL)));
+    put(HAS_START, new FieldMetaData("has_start", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.BOOL)));
+    put(HAS_END, new FieldMetaData("has_end", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.BOOL)));
+  }});
+
+  static {
+    FieldMetaData.addStructMetaDataMap(CellPredicate.class, metaDataMap);
+  }
+
+  public CellPredicate() {
+    this.children = 0;
+
+    this.start_inclusive = true;
+
+    this.end_inclusive = true;
+
+    this.has_start = true;
+
+    this.has_end = true;
+
+  }
+
+  public CellPredicate(
+    int op,
+    int children,
+    String operand,
+    boolean start_inclusive,
+    String end_operand,
+    boolean end_inclusive,
+    boolean has_start,
+    boolean has_end)
+  {
+    this();
+    this.op = op;
+    this.__isset.op = true;
+    this.children = children;
+    this.__isset.children = true;
+    this.operand = operand;
+    this.start_inclusive = start_inclusive;
+    this.__isset.start_inclusive = true;
+    this.end_operand = end_operand;
+    this.end_inclusive = end_inclusive;
+    this.__isset.end_inclusive = true;
+    this.has_start = has_start;
+    this.__isset.has_start = true;
+    this.has_end = has_end;
+    this.__isset.has_end = true;
+  }
+
+  /**
+   * Performs a deep copy on <i>other</i>.
+   */
+  public CellPredicate(CellPredicate other) {
+    __isset.op = other.__isset.op;
+    this.op = other.op;
+    __isset.children = other.__isset.children;
+    this.children = other.children;
+    if (other.isSetOperand()) {
+      this.operand = other.operand;
+    }
+    __isset.start_inclusive = other.__isset.start_inclusive;
+    this.start_inclusive = other.start_inclusive;
+    if (other.isSetEnd_operand()) {
+      this.end_operand = other.end_operand;
+    }
+    __isset.end_inclusive = other.__isset.end_inclusive;
+    this.end_inclusive = other.end_inclusive;
+    __isset.has_start = other.__isset.has_start;
+    this.has_start = other.has_start;
+    __isset.has_end = other.__isset.has_end;
+    this.has_end = other.has_end;
+  }
+
+  @Override
+  public CellPredicate clone() {
+    return new CellPredicate(this);
+  }
+
+  public int getOp() {
+    return this.op;
+  }
+
+  public void setOp(int op) {
+    this.op = op;
+    this.__isset.op = true;
+  }
+
+  public void unsetOp() {
+    this.__isset.op = false;
+  }
+
+  // Returns true if field op is set (has been asigned a value) and false otherwise
+  public boolean isSetOp() {
+    return this.__isset.op;
+  }
+
+  public void setOpIsSet(boolean value) {
+    this.__isset.op = value;
+  }
+
+  public int getChildren() {
+    return this.children;
+  }
+
+  public void setChildren(int children) {
+    this.children = children;
+    this.__isset.children = true;
+  }
+
+  public void unsetChildren() {
+    this.__isset.children = false;
+  }
+
+  // Returns true if field children is set (has been asigned a value) and false otherwise
+  public boolean isSetChildren() {
+    return this.__isset.children;
+  }
+
+  public void setChildrenIsSet(boolean value) {
+    this.__isset.children = value;
+  }
+
+  public String getOperand() {
+    return this.operand;
+  }
+
+  public void setOperand(String operand) {
+    this.operand = operand;
+  }
+
+  public void unsetOperand() {
+    this.operand = null;
+  }
+
+  // Returns true if field operand is set (has been asigned a value) and false otherwise
+  public boolean isSetOperand() {
+    return this.operand != null;
+  }
+
+  public void setOperandIsSet(boolean value) {
+    if (!value) {
+      this.operand = null;
+    }
+  }
+
+  public boolean isStart_inclusive() {
+    return this.start_inclusive;
+  }
+
+  public void setStart_inclusive(boolean start_inclusive) {
+    this.start_inclusive = start_inclusive;
+    this.__isset.start_inclusive = true;
+  }
+
+  public void unsetStart_inclusive() {
+    this.__isset.start_inclusive = false;
+  }
+
+  // Returns true if field start_inclusive is set (has been asigned a value) and false otherwise
+  public boolean isSetStart_inclusive() {
+    return this.__isset.start_inclusive;
+  }
+
+  public void setStart_inclusiveIsSet(boolean value) {
+    this.__isset.start_inclusive = value;
+  }
+
+  public String getEnd_operand() {
+    return this.end_operand;
+  }
+
+  public void setEnd_operand(String end_operand) {
+    this.end_operand = end_operand;
+  }
+
+  public void unsetEnd_operand() {
+    this.end_operand = null;
+  }
+
+  // Returns true if field end_operand is set (has been asigned a value) and false otherwise
+  public boolean isSetEnd_operand() {
+    return this.end_operand != null;
+  }
+
+  public void setEnd_operandIsSet(boolean value) {
+    if (!value) {
+      this.end_operand = null;
+    }
+  }
+
+  public boolean isEnd_inclusive() {
+    return this.end_inclusive;
+  }
+
+  public void setEnd_inclusive(boolean end_inclusive) {
+    this.end_inclusive = end_inclusive;
+    this.__isset.end_inclusive = true;
+  }
+
+  public void unsetEnd_inclusive() {
+    this.__isset.end_inclusive = false;
+  }
+
+  // Returns true if field end_inclusive is set (has been asigned a value) and false otherwise
+  public boolean isSetEnd_inclusive() {
+    return this.__isset.end_inclusive;
+  }
+
+  public void setEnd_inclusiveIsSet(boolean value) {
+    this.__isset.end_inclusive = value;
+  }
+
+  public boolean isHas_start() {
+    return this.has_start;
+  }
+
+  public void setHas_start(boolean has_start) {
+    this.has_start = has_start;
+    this.__isset.has_start = true;
+  }
+
+  public void unsetHas_start() {
+    this.__isset.has_start = false;
+  }
+
+  // Returns true if field has_start is set (has been asigned a value) and false otherwise
+  public boolean isSetHas_start() {
+    return this.__isset.has_start;
+  }
+
+  public void setHas_startIsSet(boolean value) {
+    this.__isset.has_start = value;
+  }
+
+  public boolean isHas_end() {
+    return this.has_end;
+  }
+
+  public void setHas_end(boolean has_end) {
+    this.has_end = has_end;
+    this.__isset.has_end = true;
+  }
+
+  public void unsetHas_end() {
+    this.__isset.has_end = false;
+  }
+
+  // Returns true if field has_end is set (has been asigned a value) and false otherwise
+  public boolean isSetHas_end() {
+    return this.__isset.has_end;
+  }
+
+  public void setHas_endIsSet(boolean value) {
+    this.__isset.has_end = value;
+  }
+
+  public void setFieldValue(int fieldID, Object value) {
+    switch (fieldID) {
+    case OP:
+      if (value == null) {
+        unsetOp();
+      } else {
+        setOp((Integer)value);
+      }
+      break;
+
+    case CHILDREN:
+      if (value == null) {
+        unsetChildren();
+      } else {
+        setChildren((Integer)value);
+      }
+      break;
+
+    case OPERAND:
+      if (value == null) {
+        unsetOperand();
+      } else {
+        setOperand((String)value);
+      }
+      break;
+
+    case START_INCLUSIVE:
+      if (value == null) {
+        unsetStart_inclusive();
+      } else {
+        setStart_inclusive((Boolean)value);
+      }
+      break;
+
+    case END_OPERAND:
+      if (value == null) {
+        unsetEnd_operand();
+      } else {
+        setEnd_operand((String)value);
+      }
+      break;
+
+    case END_INCLUSIVE:
+      if (value == null) {
+        unsetEnd_inclusive();
+      } else {
+        setEnd_inclusive((Boolean)value);
+      }
+      break;
+
+    case HAS_START:
+      if (value == null) {
+        unsetHas_start();
+      } else {
+        setHas_start((Boolean)value);
+      }
+      break;
+
+    case HAS_END:
+      if (value == null) {
+        unsetHas_end();
+      } else {
+        setHas_end((Boolean)value);
+      }
+      break;
+
+    default:
+      throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
+    }
+  }
+
+  public Object getFieldValue(int fieldID) {
+    switch (fieldID) {
+    case OP:
+      return new Integer(getOp());
+
+    case CHILDREN:
+      return new Integer(getChildren());
+
+    case OPERAND:
+      return getOperand();
+
+    case START_INCLUSIVE:
+      return new Boolean(isStart_inclusive());
+
+    case END_OPERAND:
+      return getEnd_operand();
+
+    case END_INCLUSIVE:
+      return new Boolean(isEnd_inclusive());
+
+    case HAS_START:
+      return new Boolean(isHas_start());
+
+    case HAS_END:
+      return new Boolean(isHas_end());
+
+    default:
+      throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
+    }
+  }
+
+  // Returns true if field corresponding to fieldID is set (has been asigned a value) and false otherwise
+  public boolean isSet(int fieldID) {
+    switch (fieldID) {
+    case OP:
+      return isSetOp();
+    case CHILDREN:
+      return isSetChildren();
+    case OPERAND:
+      return isSetOperand();
+    case START_INCLUSIVE:
+      return isSetStart_inclusive();
+    case END_OPERAND:
+      return isSetEnd_operand();
+    case END_INCLUSIVE:
+      return isSetEnd_inclusive();
+    case HAS_START:
+      return isSetHas_start();
+    case HAS_END:
+      return isSetHas_end();
+    default:
+      throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
+    }
+  }
+
+  @Override
+  public boolean equals(Object that) {
+    if (that == null)
+      return false;
+    if (that instanceof CellPredicate)
+      return this.equals((CellPredicate)that);
+    return false;
+  }
+
+  public boolean equals(CellPredicate that) {
+    if (that == null)
+      return false;
+
+    boolean this_present_op = true && this.isSetOp();
+    boolean that_present_op = true && that.isSetOp();
+    if (this_present_op || that_present_op) {
+      if (!(this_present_op && that_present_op))
+        return false;
+      if (this.op != that.op)
+        return false;
+    }
+
+    boolean this_present_children = true && this.isSetChildren();
+    boolean that_present_children = true && that.isSetChildren();
+    if (this_present_children || that_present_children) {
+      if (!(this_present_children && that_present_children))
+        return false;
+      if (this.children != that.children)
+        return false;
+    }
+
+    boolean this_present_operand = true && this.isSetOperand();
+    boolean that_present_operand = true && that.isSetOperand();
+    if (this_present_operand || that_present_operand) {
+      if (!(this_present_operand && that_present_operand))
+        return false;
+      if (!this.operand.equals(that.operand))
+        return false;
+    }
+
+    boolean this_present_start_inclusive = true && this.isSetStart_inclusive();
+    boolean that_present_start_inclusive = true && that.isSetStart_inclusive();
+    if (this_present_start_inclusive || that_present_start_inclusive) {
+      if (!(this_present_start_inclusive && that_present_start_inclusive))
+        return false;
+      if (this.start_inclusive != that.start_inclusive)
+        return false;
+    }
+
+    boolean this_present_end_operand = true && this.isSetEnd_operand();
+    boolean that_present_end_operand = true && that.isSetEnd_operand();
+    if (this_present_end_operand || that_present_end_operand) {
+      if (!(this_present_end_operand && that_present_end_operand))
+        return false;
+      if (!this.end_operand.equals(that.end_operand))
+        return false;
+    }
+
+    boolean this_present_end_inclusive = true && this.isSetEnd_inclusive();
+    boolean that_present_end_inclusive = true && that.isSetEnd_inclusive();
+    if (this_present_end_inclusive || that_present_end_inclusive) {
+      if (!(this_present_end_inclusive && that_present_end_inclusive))
+        return false;
+      if (this.end_inclusive != that.end_inclusive)
+        return false;
+    }
+
+    boolean this_present_has_start = true && this.isSetHas_start();
+    boolean that_present_has_start = true && that.isSetHas_start();
+    if (this_present_has_start || that_present_has_start) {
+      if (!(this_present_has_start && that_present_has_start))
+        return false;
+      if (this.has_start != that.has_start)
+        return false;
+    }
+
+    boolean this_present_has_end = true && this.isSetHas_end();
+    boolean that_present_has_end = true && that.isSetHas_end();
+    if (this_present_has_end || that_present_has_end) {
+      if (!(this_present_has_end && that_present_has_end))
+        return false;
+      if (this.has_end != that.has_end)
+        return false;
+    }
+
+    return true;
+  }
+
+  @Override
+  public int hashCode() {
+    return 0;
+  }
+
+  public void read(TProtocol iprot) throws TException {
+    TField field;
+    iprot.readStructBegin();
+    while (true)
+    {
+      field = iprot.readFieldBegin();
+      if (field.type == TType.STOP) { 
+        break;
+      }
+      switch (field.id)
+      {
+        case OP:
+          if (field.type == TType.I32) {
+            this.op = iprot.readI32();
+            this.__isset.op = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case CHILDREN:
+          if (field.type == TType.I32) {
+            this.children = iprot.readI32();
+            this.__isset.children = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case OPERAND:
+          if (field.type == TType.STRING) {
+            this.operand = iprot.readString();
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case START_INCLUSIVE:
+          if (field.type == TType.BOOL) {
+            this.start_inclusive = iprot.readBool();
+            this.__isset.start_inclusive = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case END_OPERAND:
+          if (field.type == TType.STRING) {
+            this.end_operand = iprot.readString();
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case END_INCLUSIVE:
+          if (field.type == TType.BOOL) {
+            this.end_inclusive = iprot.readBool();
+            this.__isset.end_inclusive = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case HAS_START:
+          if (field.type == TType.BOOL) {
+            this.has_start = iprot.readBool();
+            this.__isset.has_start = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case HAS_END:
+          if (field.type == TType.BOOL) {
+            this.has_end = iprot.readBool();
+            this.__isset.has_end = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        default:
+          TProtocolUtil.skip(iprot, field.type);
+          break;
+      }
+      iprot.readFieldEnd();
+    }
+    iprot.readStructEnd();
+
+
+    // check for required fields of primitive type, which can't be checked in the validate method
+    validate();
+  }
+
+  public void write(TProtocol oprot) throws TException {
+    validate();
+
+    oprot.writeStructBegin(STRUCT_DESC);
+    if (isSetOp()) {
+      oprot.writeFieldBegin(OP_FIELD_DESC);
+      oprot.writeI32(this.op);
+      oprot.writeFieldEnd();
+    }
+    if (isSetChildren()) {
+      oprot.writeFieldBegin(CHILDREN_FIELD_DESC);
+      oprot.writeI32(this.children);
+      oprot.writeFieldEnd();
+    }
+    if (this.operand != null) {
+      if (isSetOperand()) {
+        oprot.writeFieldBegin(OPERAND_FIELD_DESC);
+        oprot.writeString(this.operand);
+        oprot.writeFieldEnd();
+      }
+    }
+    if (isSetStart_inclusive()) {
+      oprot.writeFieldBegin(START_INCLUSIVE_FIELD_DESC);
+      oprot.writeBool(this.start_inclusive);
+      oprot.writeFieldEnd();
+    }
+    if (this.end_operand != null) {
+      if (isSetEnd_operand()) {
+        oprot.writeFieldBegin(END_OPERAND_FIELD_DESC);
+        oprot.writeString(this.end_operand);
+        oprot.writeFieldEnd();
+      }
+    }
+    if (isSetEnd_inclusive()) {
+      oprot.writeFieldBegin(END_INCLUSIVE_FIELD_DESC);
+      oprot.writeBool(this.end_inclusive);
+      oprot.writeFieldEnd();
+    }
+    if (isSetHas_start()) {
+      oprot.writeFieldBegin(HAS_START_FIELD_DESC);
+      oprot.writeBool(this.has_start);
+      oprot.writeFieldEnd();
+    }
+    if (isSetHas_end()) {
+      oprot.writeFieldBegin(HAS_END_FIELD_DESC);
+      oprot.writeBool(this.has_end);
+      oprot.writeFieldEnd();
+    }
+    oprot.writeFieldStop();
+    oprot.writeStructEnd();
+  }
+
+  @Override
+  public String toString() {
+    StringBuilder sb = new StringBuilder("CellPredicate(");
+    boolean first = true;
+
+    if (isSetOp()) {
+      sb.append("op:");
+      String op_name = CellPredicateOp.VALUES_TO_NAMES.get(this.op);
+      if (op_name != null) {
+        sb.append(op_name);
+        sb.append(" (");
+      }
+      sb.append(this.op);
+      if (op_name != null) {
+        sb.append(")");
+      }
+      first = false;
+    }
+    if (isSetChildren()) {
+      if (!first) sb.append(", ");
+      sb.append("children:");
+      sb.append(this.children);
+      first = false;
+    }
+    if (isSetOperand()) {
+      if (!first) sb.append(", ");
+      sb.append("operand:");
+      if (this.operand == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.operand);
+      }
+      first = false;
+    }
+    if (isSetStart_inclusive()) {
+      if (!first) sb.append(", ");
+      sb.append("start_inclusive:");
+      sb.append(this.start_inclusive);
+      first = false;
+    }
+    if (isSetEnd_operand()) {
+      if (!first) sb.append(", ");
+      sb.append("end_operand:");
+      if (this.end_operand == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.end_operand);
+      }
+      first = false;
+    }
+    if (isSetEnd_inclusive()) {
+      if (!first) sb.append(", ");
+      sb.append("end_inclusive:");
+      sb.append(this.end_inclusive);
+      first = false;
+    }
+    if (isSetHas_start()) {
+      if (!first) sb.append(", ");
+      sb.append("has_start:");
+      sb.append(this.has_start);
+      first = false;
+    }
+    if (isSetHas_end()) {
+      if (!first) sb.append(", ");
+      sb.append("has_end:");
+      sb.append(this.has_end);
+      first = false;
+    }
+    sb.append(")");
+    return sb.toString();
+  }
+
+  public void validate() throws TException {
+    // check for required fields
+    // check that fields of type enum have valid values
+    if (isSetOp() && !CellPredicateOp.VALID_VALUES.contains(op)){
+      throw new TProtocolException("The field 'op' has been assigned the invalid value " + op);
+    }
+  }
+
+}
+
@@ -0,0 +1,61 @@
+/**
+ * Autogenerated by Thrift
+ *
+ * DO NOT EDIT UNLESS YOU ARE SURE THAT YOU KNOW WHAT YOU ARE DOING
+ */
+package org.hypertable.thriftgen;
+
+
+import java.util.Set;
+import java.util.HashSet;
+import java.util.Collections;
+import org.apache.thrift.IntRangeSet;
+import java.util.Map;
+import java.util.HashMap;
+
+public class CellPredicateOp {
+  public static final int AND = 1;
+  public static final int OR = 2;
+  public static final int NOT = 3;
+  public static final int ROW_PREFIX = 4;
+  public static final int ROW_REGEX = 5;
+  public static final int QUALIFIER_EQUAL = 6;
+  public static final int QUALIFIER_PREFIX = 7;
+  public static final int QUALIFIER_REGEX = 8;
+  public static final int VALUE_EQUAL = 9;
+  public static final int VALUE_PREFIX = 10;
+  public static final int VALUE_RANGE = 11;
+  public static final int VALUE_CONTAINS = 12;
+  public static final int VALUE_REGEX = 13;
+
+  public static final IntRangeSet VALID_VALUES = new IntRangeSet(
+    AND, 
+    OR, 
+    NOT, 
+    ROW_PREFIX, 
+    ROW_REGEX, 
+    QUALIFIER_EQUAL, 
+    QUALIFIER_PREFIX, 
+    QUALIFIER_REGEX, 
+    VALUE_EQUAL, 
+    VALUE_PREFIX, 
+    VALUE_RANGE, 
+    VALUE_CONTAINS, 
+    VALUE_REGEX );
+
+  public static final Map<Integer, String> VALUES_TO_NAMES = new HashMap<Integer, String>() {{
+    put(AND, "AND");
+    put(OR, "OR");
+    put(NOT, "NOT");
+    put(ROW_PREFIX, "ROW_PREFIX");
+    put(ROW_REGEX, "ROW_REGEX");
+    put(QUALIFIER_EQUAL, "QUALIFIER_EQUAL");
+    put(QUALIFIER_PREFIX, "QUALIFIER_PREFIX");
+    put(QUALIFIER_REGEX, "QUALIFIER_REGEX");
+    put(VALUE_EQUAL, "VALUE_EQUAL");
+    put(VALUE_PREFIX, "VALUE_PREFIX");
+    put(VALUE_RANGE, "VALUE_RANGE");
+    put(VALUE_CONTAINS, "VALUE_CONTAINS");
+    put(VALUE_REGEX, "VALUE_REGEX");
+  }};
+}
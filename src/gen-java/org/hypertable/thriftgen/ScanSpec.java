@@ -48,6 +48,17 @@ import org.apache.thrift.protocol.*;
  * 
  *   <dt>columns</dt>
  *   <dd>Specifies the names of the columns to return</dd>
+ * 
+ *   <dt>parallel</dt>
+ *   <dd>Specifies the number of ranges to scan concurrently (0 or 1 scans
+ *   one range at a time)</dd>
+ * 
+ *   <dt>unordered</dt>
+ *   <dd>With parallel scans, return whole ranges in the order they respond
+ *   instead of in row key order</dd>
+ * 
+ *   <dt>predicates</dt>
+ *   <dd>A cell filter evaluated by the range servers (see CellPredicate)</dd>
  * </dl>
  */
 public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
@@ -60,6 +71,9 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
   private static final TField START_TIME_FIELD_DESC = new TField("start_time", TType.I64, (short)6);
   private static final TField END_TIME_FIELD_DESC = new TField("end_time", TType.I64, (short)7);
   private static final TField COLUMNS_FIELD_DESC = new TField("columns", TType.LIST, (short)8);
+  private static final TField PARALLEL_FIELD_DESC = new TField("parallel", TType.I32, (short)9);
+  private static final TField UNORDERED_FIELD_DESC = new TField("unordered", TType.BOOL, (short)10);
+  private static final TField PREDICATES_FIELD_DESC = new TField("predicates", TType.LIST, (short)11);
 
   public List<RowInterval> row_intervals;
   public static final int ROW_INTERVALS = 1;
@@ -77,6 +91,12 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
   public static final int END_TIME = 7;
   public List<String> columns;
   public static final int COLUMNS = 8;
+  public int parallel;
+  public static final int PARALLEL = 9;
+  public boolean unordered;
+  public static final int UNORDERED = 10;
+  public List<CellPredicate> predicates;
+  public static final int PREDICATES = 11;
 
   private final Isset __isset = new Isset();
   private static final class Isset implements java.io.Serializable {
@@ -85,6 +105,8 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     public boolean row_limit = false;
     public boolean start_time = false;
     public boolean end_time = false;
+    public boolean parallel = false;
+    public boolean unordered = false;
   }
 
   public static final Map<Integer, FieldMetaData> metaDataMap = Collections.unmodifiableMap(new HashMap<Integer, FieldMetaData>() {{
@@ -107,6 +129,13 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     put(COLUMNS, new FieldMetaData("columns", TFieldRequirementType.OPTIONAL, 
         new ListMetaData(TType.LIST, 
             new FieldValueMetaData(TType.STRING))));
+    put(PARALLEL, new FieldMetaData("parallel", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.I32)));
+    put(UNORDERED, new FieldMetaData("unordered", TFieldRequirementType.OPTIONAL, 
+        new FieldValueMetaData(TType.BOOL)));
+    put(PREDICATES, new FieldMetaData("predicates", TFieldRequirementType.OPTIONAL, 
+        new ListMetaData(TType.LIST, 
+            new StructMetaData(TType.STRUCT, CellPredicate.class))));
   }});
 
   static {
@@ -120,6 +149,10 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
 
     this.row_limit = 0;
 
+    this.parallel = 0;
+
+    this.unordered = false;
+
   }
 
   public ScanSpec(
@@ -130,7 +163,10 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     int row_limit,
     long start_time,
     long end_time,
-    List<String> columns)
+    List<String> columns,
+    int parallel,
+    boolean unordered,
+    List<CellPredicate> predicates)
   {
     this();
     this.row_intervals = row_intervals;
@@ -146,6 +182,11 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     this.end_time = end_time;
     this.__isset.end_time = true;
     this.columns = columns;
+    this.parallel = parallel;
+    this.__isset.parallel = true;
+    this.unordered = unordered;
+    this.__isset.unordered = true;
+    this.predicates = predicates;
   }
 
   /**
@@ -183,6 +224,17 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
       }
       this.columns = __this__columns;
     }
+    __isset.parallel = other.__isset.parallel;
+    this.parallel = other.parallel;
+    __isset.unordered = other.__isset.unordered;
+    this.unordered = other.unordered;
+    if (other.isSetPredicates()) {
+      List<CellPredicate> __this__predicates = new ArrayList<CellPredicate>();
+      for (CellPredicate other_element : other.predicates) {
+        __this__predicates.add(new CellPredicate(other_element));
+      }
+      this.predicates = __this__predicates;
+    }
   }
 
   @Override
@@ -414,6 +466,88 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     }
   }
 
+  public int getParallel() {
+    return this.parallel;
+  }
+
+  public void setParallel(int parallel) {
+    this.parallel = parallel;
+    this.__isset.parallel = true;
+  }
+
+  public void unsetParallel() {
+    this.__isset.parallel = false;
+  }
+
+  // Returns true if field parallel is set (has been asigned a value) and false otherwise
+  public boolean isSetParallel() {
+    return this.__isset.parallel;
+  }
+
+  public void setParallelIsSet(boolean value) {
+    this.__isset.parallel = value;
+  }
+
+  public boolean isUnordered() {
+    return this.unordered;
+  }
+
+  public void setUnordered(boolean unordered) {
+    this.unordered = unordered;
+    this.__isset.unordered = true;
+  }
+
+  public void unsetUnordered() {
+    this.__isset.unordered = false;
+  }
+
+  // Returns true if field unordered is set (has been asigned a value) and false otherwise
+  public boolean isSetUnordered() {
+    return this.__isset.unordered;
+  }
+
+  public void setUnorderedIsSet(boolean value) {
+    this.__isset.unordered = value;
+  }
+
+  public int getPredicatesSize() {
+    return (this.predicates == null) ? 0 : this.predicates.size();
+  }
+
+  public java.util.Iterator<CellPredicate> getPredicatesIterator() {
+    return (this.predicates == null) ? null : this.predicates.iterator();
+  }
+
+  public void addToPredicates(CellPredicate elem) {
+    if (this.predicates == null) {
+      this.predicates = new ArrayList<CellPredicate>();
+    }
+    this.predicates.add(elem);
+  }
+
+  public List<CellPredicate> getPredicates() {
+    return this.predicates;
+  }
+
+  public void setPredicates(List<CellPredicate> predicates) {
+    this.predicates = predicates;
+  }
+
+  public void unsetPredicates() {
+    this.predicates = null;
+  }
+
+  // Returns true if field predicates is set (has been asigned a value) and false otherwise
+  public boolean isSetPredicates() {
+    return this.predicates != null;
+  }
+
+  public void setPredicatesIsSet(boolean value) {
+    if (!value) {
+      this.predicates = null;
+    }
+  }
+
   public void setFieldValue(int fieldID, Object value) {
     switch (fieldID) {
     case ROW_INTERVALS:
@@ -480,6 +614,30 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
       }
       break;
 
+    case PARALLEL:
+      if (value == null) {
+        unsetParallel();
+      } else {
+        setParallel((Integer)value);
+      }
+      break;
+
+    case UNORDERED:
+      if (value == null) {
+        unsetUnordered();
+      } else {
+        setUnordered((Boolean)value);
+      }
+      break;
+
+    case PREDICATES:
+      if (value == null) {
+        unsetPredicates();
+      } else {
+        setPredicates((List<CellPredicate>)value);
+      }
+      break;
+
     default:
       throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
     }
@@ -511,6 +669,15 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
     case COLUMNS:
       return getColumns();
 
+    case PARALLEL:
+      return new Integer(getParallel());
+
+    case UNORDERED:
+      return new Boolean(isUnordered());
+
+    case PREDICATES:
+      return getPredicates();
+
     default:
       throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
     }
@@ -535,6 +702,12 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
       return isSetEnd_time();
     case COLUMNS:
       return isSetColumns();
+    case PARALLEL:
+      return isSetParallel();
+    case UNORDERED:
+      return isSetUnordered();
+    case PREDICATES:
+      return isSetPredicates();
     default:
       throw new IllegalArgumentException("Field " + fieldID + " doesn't exist!");
     }
@@ -625,6 +798,33 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
         return false;
     }
 
+    boolean this_present_parallel = true && this.isSetParallel();
+    boolean that_present_parallel = true && that.isSetParallel();
+    if (this_present_parallel || that_present_parallel) {
+      if (!(this_present_parallel && that_present_parallel))
+        return false;
+      if (this.parallel != that.parallel)
+        return false;
+    }
+
+    boolean this_present_unordered = true && this.isSetUnordered();
+    boolean that_present_unordered = true && that.isSetUnordered();
+    if (this_present_unordered || that_present_unordered) {
+      if (!(this_present_unordered && that_present_unordered))
+        return false;
+      if (this.unordered != that.unordered)
+        return false;
+    }
+
+    boolean this_present_predicates = true && this.isSetPredicates();
+    boolean that_present_predicates = true && that.isSetPredicates();
+    if (this_present_predicates || that_present_predicates) {
+      if (!(this_present_predicates && that_present_predicates))
+        return false;
+      if (!this.predicates.equals(that.predicates))
+        return false;
+    }
+
     return true;
   }
 
@@ -737,6 +937,40 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
             TProtocolUtil.skip(iprot, field.type);
           }
           break;
+        case PARALLEL:
+          if (field.type == TType.I32) {
+            this.parallel = iprot.readI32();
+            this.__isset.parallel = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case UNORDERED:
+          if (field.type == TType.BOOL) {
+            this.unordered = iprot.readBool();
+            this.__isset.unordered = true;
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
+        case PREDICATES:
+          if (field.type == TType.LIST) {
+            {
+              TList _list9 = iprot.readListBegin();
+              this.predicates = new ArrayList<CellPredicate>(_list9.size);
+              for (int _i10 = 0; _i10 < _list9.size; ++_i10)
+              {
+                CellPredicate _elem11;
+                _elem11 = new CellPredicate();
+                _elem11.read(iprot);
+                this.predicates.add(_elem11);
+              }
+              iprot.readListEnd();
+            }
+          } else { 
+            TProtocolUtil.skip(iprot, field.type);
+          }
+          break;
         default:
           TProtocolUtil.skip(iprot, field.type);
           break;
@@ -759,8 +993,8 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
         oprot.writeFieldBegin(ROW_INTERVALS_FIELD_DESC);
         {
           oprot.writeListBegin(new TList(TType.STRUCT, this.row_intervals.size()));
-          for (RowInterval _iter9 : this.row_intervals)          {
-            _iter9.write(oprot);
+          for (RowInterval _iter12 : this.row_intervals)          {
+            _iter12.write(oprot);
           }
           oprot.writeListEnd();
         }
@@ -772,8 +1006,8 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
         oprot.writeFieldBegin(CELL_INTERVALS_FIELD_DESC);
         {
           oprot.writeListBegin(new TList(TType.STRUCT, this.cell_intervals.size()));
-          for (CellInterval _iter10 : this.cell_intervals)          {
-            _iter10.write(oprot);
+          for (CellInterval _iter13 : this.cell_intervals)          {
+            _iter13.write(oprot);
           }
           oprot.writeListEnd();
         }
@@ -810,8 +1044,31 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
         oprot.writeFieldBegin(COLUMNS_FIELD_DESC);
         {
           oprot.writeListBegin(new TList(TType.STRING, this.columns.size()));
-          for (String _iter11 : this.columns)          {
-            oprot.writeString(_iter11);
+          for (String _iter14 : this.columns)          {
+            oprot.writeString(_iter14);
+          }
+          oprot.writeListEnd();
+        }
+        oprot.writeFieldEnd();
+      }
+    }
+    if (isSetParallel()) {
+      oprot.writeFieldBegin(PARALLEL_FIELD_DESC);
+      oprot.writeI32(this.parallel);
+      oprot.writeFieldEnd();
+    }
+    if (isSetUnordered()) {
+      oprot.writeFieldBegin(UNORDERED_FIELD_DESC);
+      oprot.writeBool(this.unordered);
+      oprot.writeFieldEnd();
+    }
+    if (this.predicates != null) {
+      if (isSetPredicates()) {
+        oprot.writeFieldBegin(PREDICATES_FIELD_DESC);
+        {
+          oprot.writeListBegin(new TList(TType.STRUCT, this.predicates.size()));
+          for (CellPredicate _iter15 : this.predicates)          {
+            _iter15.write(oprot);
           }
           oprot.writeListEnd();
         }
@@ -886,6 +1143,28 @@ public class ScanSpec implements TBase, java.io.Serializable, Cloneable {
       }
       first = false;
     }
+    if (isSetParallel()) {
+      if (!first) sb.append(", ");
+      sb.append("parallel:");
+      sb.append(this.parallel);
+      first = false;
+    }
+    if (isSetUnordered()) {
+      if (!first) sb.append(", ");
+      sb.append("unordered:");
+      sb.append(this.unordered);
+      first = false;
+    }
+    if (isSetPredicates()) {
+      if (!first) sb.append(", ");
+      sb.append("predicates:");
+      if (this.predicates == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.predicates);
+      }
+      first = false;
+    }
     sb.append(")");
     return sb.toString();
   }
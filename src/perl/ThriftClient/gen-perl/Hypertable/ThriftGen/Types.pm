@@ -8,6 +8,20 @@ use strict;
 use warnings;
 use Thrift;
 
+package Hypertable::ThriftGen::CellPredicateOp;
+use constant AND => 1;
+use constant OR => 2;
+use constant NOT => 3;
+use constant ROW_PREFIX => 4;
+use constant ROW_REGEX => 5;
+use constant QUALIFIER_EQUAL => 6;
+use constant QUALIFIER_PREFIX => 7;
+use constant QUALIFIER_REGEX => 8;
+use constant VALUE_EQUAL => 9;
+use constant VALUE_PREFIX => 10;
+use constant VALUE_RANGE => 11;
+use constant VALUE_CONTAINS => 12;
+use constant VALUE_REGEX => 13;
 package Hypertable::ThriftGen::CellFlag;
 use constant DELETE_ROW => 0;
 use constant DELETE_CF => 1;
@@ -267,10 +281,181 @@ sub write {
   return $xfer;
 }
 
+package Hypertable::ThriftGen::CellPredicate;
+use Class::Accessor;
+use base('Class::Accessor');
+Hypertable::ThriftGen::CellPredicate->mk_accessors( qw( op children operand start_inclusive end_operand end_inclusive has_start has_end ) );
+sub new {
+my $classname = shift;
+my $self      = {};
+my $vals      = shift || {};
+$self->{op} = undef;
+$self->{children} = 0;
+$self->{operand} = undef;
+$self->{start_inclusive} = 1;
+$self->{end_operand} = undef;
+$self->{end_inclusive} = 1;
+$self->{has_start} = 1;
+$self->{has_end} = 1;
+  if (UNIVERSAL::isa($vals,'HASH')) {
+    if (defined $vals->{op}) {
+      $self->{op} = $vals->{op};
+    }
+    if (defined $vals->{children}) {
+      $self->{children} = $vals->{children};
+    }
+    if (defined $vals->{operand}) {
+      $self->{operand} = $vals->{operand};
+    }
+    if (defined $vals->{start_inclusive}) {
+      $self->{start_inclusive} = $vals->{start_inclusive};
+    }
+    if (defined $vals->{end_operand}) {
+      $self->{end_operand} = $vals->{end_operand};
+    }
+    if (defined $vals->{end_inclusive}) {
+      $self->{end_inclusive} = $vals->{end_inclusive};
+    }
+    if (defined $vals->{has_start}) {
+      $self->{has_start} = $vals->{has_start};
+    }
+    if (defined $vals->{has_end}) {
+      $self->{has_end} = $vals->{has_end};
+    }
+  }
+return bless($self,$classname);
+}
+
+sub getName {
+  return 'CellPredicate';
+}
+
+sub read {
+  my $self  = shift;
+  my $input = shift;
+  my $xfer  = 0;
+  my $fname;
+  my $ftype = 0;
+  my $fid   = 0;
+  $xfer += $input->readStructBegin(\$fname);
+  while (1) 
+  {
+    $xfer += $input->readFieldBegin(\$fname, \$ftype, \$fid);
+    if ($ftype == TType::STOP) {
+      last;
+    }
+    SWITCH: for($fid)
+    {
+      /^1$/ && do{      if ($ftype == TType::I32) {
+        $xfer += $input->readI32(\$self->{op});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^2$/ && do{      if ($ftype == TType::I32) {
+        $xfer += $input->readI32(\$self->{children});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^3$/ && do{      if ($ftype == TType::STRING) {
+        $xfer += $input->readString(\$self->{operand});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^4$/ && do{      if ($ftype == TType::BOOL) {
+        $xfer += $input->readBool(\$self->{start_inclusive});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^5$/ && do{      if ($ftype == TType::STRING) {
+        $xfer += $input->readString(\$self->{end_operand});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^6$/ && do{      if ($ftype == TType::BOOL) {
+        $xfer += $input->readBool(\$self->{end_inclusive});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^7$/ && do{      if ($ftype == TType::BOOL) {
+        $xfer += $input->readBool(\$self->{has_start});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^8$/ && do{      if ($ftype == TType::BOOL) {
+        $xfer += $input->readBool(\$self->{has_end});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+        $xfer += $input->skip($ftype);
+    }
+    $xfer += $input->readFieldEnd();
+  }
+  $xfer += $input->readStructEnd();
+  return $xfer;
+}
+
+sub write {
+  my $self   = shift;
+  my $output = shift;
+  my $xfer   = 0;
+  $xfer += $output->writeStructBegin('CellPredicate');
+  if (defined $self->{op}) {
+    $xfer += $output->writeFieldBegin('op', TType::I32, 1);
+    $xfer += $output->writeI32($self->{op});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{children}) {
+    $xfer += $output->writeFieldBegin('children', TType::I32, 2);
+    $xfer += $output->writeI32($self->{children});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{operand}) {
+    $xfer += $output->writeFieldBegin('operand', TType::STRING, 3);
+    $xfer += $output->writeString($self->{operand});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{start_inclusive}) {
+    $xfer += $output->writeFieldBegin('start_inclusive', TType::BOOL, 4);
+    $xfer += $output->writeBool($self->{start_inclusive});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{end_operand}) {
+    $xfer += $output->writeFieldBegin('end_operand', TType::STRING, 5);
+    $xfer += $output->writeString($self->{end_operand});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{end_inclusive}) {
+    $xfer += $output->writeFieldBegin('end_inclusive', TType::BOOL, 6);
+    $xfer += $output->writeBool($self->{end_inclusive});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{has_start}) {
+    $xfer += $output->writeFieldBegin('has_start', TType::BOOL, 7);
+    $xfer += $output->writeBool($self->{has_start});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{has_end}) {
+    $xfer += $output->writeFieldBegin('has_end', TType::BOOL, 8);
+    $xfer += $output->writeBool($self->{has_end});
+    $xfer += $output->writeFieldEnd();
+  }
+  $xfer += $output->writeFieldStop();
+  $xfer += $output->writeStructEnd();
+  return $xfer;
+}
+
 package Hypertable::ThriftGen::ScanSpec;
 use Class::Accessor;
 use base('Class::Accessor');
-Hypertable::ThriftGen::ScanSpec->mk_accessors( qw( row_intervals cell_intervals return_deletes revs row_limit start_time end_time columns ) );
+Hypertable::ThriftGen::ScanSpec->mk_accessors( qw( row_intervals cell_intervals return_deletes revs row_limit start_time end_time columns parallel unordered predicates ) );
 sub new {
 my $classname = shift;
 my $self      = {};
@@ -283,6 +468,9 @@ $self->{row_limit} = 0;
 $self->{start_time} = undef;
 $self->{end_time} = undef;
 $self->{columns} = undef;
+$self->{parallel} = 0;
+$self->{unordered} = 0;
+$self->{predicates} = undef;
   if (UNIVERSAL::isa($vals,'HASH')) {
     if (defined $vals->{row_intervals}) {
       $self->{row_intervals} = $vals->{row_intervals};
@@ -308,6 +496,15 @@ $self->{columns} = undef;
     if (defined $vals->{columns}) {
       $self->{columns} = $vals->{columns};
     }
+    if (defined $vals->{parallel}) {
+      $self->{parallel} = $vals->{parallel};
+    }
+    if (defined $vals->{unordered}) {
+      $self->{unordered} = $vals->{unordered};
+    }
+    if (defined $vals->{predicates}) {
+      $self->{predicates} = $vals->{predicates};
+    }
   }
 return bless($self,$classname);
 }
@@ -417,6 +614,37 @@ sub read {
       } else {
         $xfer += $input->skip($ftype);
       }
+      last; };
+      /^9$/ && do{      if ($ftype == TType::I32) {
+        $xfer += $input->readI32(\$self->{parallel});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^10$/ && do{      if ($ftype == TType::BOOL) {
+        $xfer += $input->readBool(\$self->{unordered});
+      } else {
+        $xfer += $input->skip($ftype);
+      }
+      last; };
+      /^11$/ && do{      if ($ftype == TType::LIST) {
+        {
+          my $_size18 = 0;
+          $self->{predicates} = [];
+          my $_etype21 = 0;
+          $xfer += $input->readListBegin(\$_etype21, \$_size18);
+          for (my $_i22 = 0; $_i22 < $_size18; ++$_i22)
+          {
+            my $elem23 = undef;
+            $elem23 = new Hypertable::ThriftGen::CellPredicate();
+            $xfer += $elem23->read($input);
+            push(@{$self->{predicates}},$elem23);
+          }
+          $xfer += $input->readListEnd();
+        }
+      } else {
+        $xfer += $input->skip($ftype);
+      }
       last; };
         $xfer += $input->skip($ftype);
     }
@@ -436,9 +664,9 @@ sub write {
     {
       $output->writeListBegin(TType::STRUCT, scalar(@{$self->{row_intervals}}));
       {
-        foreach my $iter18 (@{$self->{row_intervals}}) 
+        foreach my $iter24 (@{$self->{row_intervals}}) 
         {
-          $xfer += ${iter18}->write($output);
+          $xfer += ${iter24}->write($output);
         }
       }
       $output->writeListEnd();
@@ -450,9 +678,9 @@ sub write {
     {
       $output->writeListBegin(TType::STRUCT, scalar(@{$self->{cell_intervals}}));
       {
-        foreach my $iter19 (@{$self->{cell_intervals}}) 
+        foreach my $iter25 (@{$self->{cell_intervals}}) 
         {
-          $xfer += ${iter19}->write($output);
+          $xfer += ${iter25}->write($output);
         }
       }
       $output->writeListEnd();
@@ -489,9 +717,33 @@ sub write {
     {
       $output->writeListBegin(TType::STRING, scalar(@{$self->{columns}}));
       {
-        foreach my $iter20 (@{$self->{columns}}) 
+        foreach my $iter26 (@{$self->{columns}}) 
+        {
+          $xfer += $output->writeString($iter26);
+        }
+      }
+      $output->writeListEnd();
+    }
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{parallel}) {
+    $xfer += $output->writeFieldBegin('parallel', TType::I32, 9);
+    $xfer += $output->writeI32($self->{parallel});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{unordered}) {
+    $xfer += $output->writeFieldBegin('unordered', TType::BOOL, 10);
+    $xfer += $output->writeBool($self->{unordered});
+    $xfer += $output->writeFieldEnd();
+  }
+  if (defined $self->{predicates}) {
+    $xfer += $output->writeFieldBegin('predicates', TType::LIST, 11);
+    {
+      $output->writeListBegin(TType::STRUCT, scalar(@{$self->{predicates}}));
+      {
+        foreach my $iter27 (@{$self->{predicates}}) 
         {
-          $xfer += $output->writeString($iter20);
+          $xfer += ${iter27}->write($output);
         }
       }
       $output->writeListEnd();
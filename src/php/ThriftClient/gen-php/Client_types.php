@@ -7,6 +7,53 @@
 include_once $GLOBALS['THRIFT_ROOT'].'/Thrift.php';
 
 
+$GLOBALS['Hypertable_ThriftGen_E_CellPredicateOp'] = array(
+  'AND' => 1,
+  'OR' => 2,
+  'NOT' => 3,
+  'ROW_PREFIX' => 4,
+  'ROW_REGEX' => 5,
+  'QUALIFIER_EQUAL' => 6,
+  'QUALIFIER_PREFIX' => 7,
+  'QUALIFIER_REGEX' => 8,
+  'VALUE_EQUAL' => 9,
+  'VALUE_PREFIX' => 10,
+  'VALUE_RANGE' => 11,
+  'VALUE_CONTAINS' => 12,
+  'VALUE_REGEX' => 13,
+);
+
+final class Hypertable_ThriftGen_CellPredicateOp {
+  const AND = 1;
+  const OR = 2;
+  const NOT = 3;
+  const ROW_PREFIX = 4;
+  const ROW_REGEX = 5;
+  const QUALIFIER_EQUAL = 6;
+  const QUALIFIER_PREFIX = 7;
+  const QUALIFIER_REGEX = 8;
+  const VALUE_EQUAL = 9;
+  const VALUE_PREFIX = 10;
+  const VALUE_RANGE = 11;
+  const VALUE_CONTAINS = 12;
+  const VALUE_REGEX = 13;
+  static public $__names = array(
+    1 => 'AND',
+    2 => 'OR',
+    3 => 'NOT',
+    4 => 'ROW_PREFIX',
+    5 => 'ROW_REGEX',
+    6 => 'QUALIFIER_EQUAL',
+    7 => 'QUALIFIER_PREFIX',
+    8 => 'QUALIFIER_REGEX',
+    9 => 'VALUE_EQUAL',
+    10 => 'VALUE_PREFIX',
+    11 => 'VALUE_RANGE',
+    12 => 'VALUE_CONTAINS',
+    13 => 'VALUE_REGEX',
+  );
+}
+
 $GLOBALS['Hypertable_ThriftGen_E_CellFlag'] = array(
   'DELETE_ROW' => 0,
   'DELETE_CF' => 1,
@@ -342,6 +389,218 @@ class Hypertable_ThriftGen_CellInterval {
 
 }
 
+class Hypertable_ThriftGen_CellPredicate {
+  static $_TSPEC;
+
+  public $op = null;
+  public $children = 0;
+  public $operand = null;
+  public $start_inclusive = true;
+  public $end_operand = null;
+  public $end_inclusive = true;
+  public $has_start = true;
+  public $has_end = true;
+
+  public function __construct($vals=null) {
+    if (!isset(self::$_TSPEC)) {
+      self::$_TSPEC = array(
+        1 => array(
+          'var' => 'op',
+          'type' => TType::I32,
+          ),
+        2 => array(
+          'var' => 'children',
+          'type' => TType::I32,
+          ),
+        3 => array(
+          'var' => 'operand',
+          'type' => TType::STRING,
+          ),
+        4 => array(
+          'var' => 'start_inclusive',
+          'type' => TType::BOOL,
+          ),
+        5 => array(
+          'var' => 'end_operand',
+          'type' => TType::STRING,
+          ),
+        6 => array(
+          'var' => 'end_inclusive',
+          'type' => TType::BOOL,
+          ),
+        7 => array(
+          'var' => 'has_start',
+          'type' => TType::BOOL,
+          ),
+        8 => array(
+          'var' => 'has_end',
+          'type' => TType::BOOL,
+          ),
+        );
+    }
+    if (is_array($vals)) {
+      if (isset($vals['op'])) {
+        $this->op = $vals['op'];
+      }
+      if (isset($vals['children'])) {
+        $this->children = $vals['children'];
+      }
+      if (isset($vals['operand'])) {
+        $this->operand = $vals['operand'];
+      }
+      if (isset($vals['start_inclusive'])) {
+        $this->start_inclusive = $vals['start_inclusive'];
+      }
+      if (isset($vals['end_operand'])) {
+        $this->end_operand = $vals['end_operand'];
+      }
+      if (isset($vals['end_inclusive'])) {
+        $this->end_inclusive = $vals['end_inclusive'];
+      }
+      if (isset($vals['has_start'])) {
+        $this->has_start = $vals['has_start'];
+      }
+      if (isset($vals['has_end'])) {
+        $this->has_end = $vals['has_end'];
+      }
+    }
+  }
+
+  public function getName() {
+    return 'CellPredicate';
+  }
+
+  public function read($input)
+  {
+    $xfer = 0;
+    $fname = null;
+    $ftype = 0;
+    $fid = 0;
+    $xfer += $input->readStructBegin($fname);
+    while (true)
+    {
+      $xfer += $input->readFieldBegin($fname, $ftype, $fid);
+      if ($ftype == TType::STOP) {
+        break;
+      }
+      switch ($fid)
+      {
+        case 1:
+          if ($ftype == TType::I32) {
+            $xfer += $input->readI32($this->op);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 2:
+          if ($ftype == TType::I32) {
+            $xfer += $input->readI32($this->children);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 3:
+          if ($ftype == TType::STRING) {
+            $xfer += $input->readString($this->operand);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 4:
+          if ($ftype == TType::BOOL) {
+            $xfer += $input->readBool($this->start_inclusive);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 5:
+          if ($ftype == TType::STRING) {
+            $xfer += $input->readString($this->end_operand);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 6:
+          if ($ftype == TType::BOOL) {
+            $xfer += $input->readBool($this->end_inclusive);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 7:
+          if ($ftype == TType::BOOL) {
+            $xfer += $input->readBool($this->has_start);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 8:
+          if ($ftype == TType::BOOL) {
+            $xfer += $input->readBool($this->has_end);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        default:
+          $xfer += $input->skip($ftype);
+          break;
+      }
+      $xfer += $input->readFieldEnd();
+    }
+    $xfer += $input->readStructEnd();
+    return $xfer;
+  }
+
+  public function write($output) {
+    $xfer = 0;
+    $xfer += $output->writeStructBegin('CellPredicate');
+    if ($this->op !== null) {
+      $xfer += $output->writeFieldBegin('op', TType::I32, 1);
+      $xfer += $output->writeI32($this->op);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->children !== null) {
+      $xfer += $output->writeFieldBegin('children', TType::I32, 2);
+      $xfer += $output->writeI32($this->children);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->operand !== null) {
+      $xfer += $output->writeFieldBegin('operand', TType::STRING, 3);
+      $xfer += $output->writeString($this->operand);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->start_inclusive !== null) {
+      $xfer += $output->writeFieldBegin('start_inclusive', TType::BOOL, 4);
+      $xfer += $output->writeBool($this->start_inclusive);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->end_operand !== null) {
+      $xfer += $output->writeFieldBegin('end_operand', TType::STRING, 5);
+      $xfer += $output->writeString($this->end_operand);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->end_inclusive !== null) {
+      $xfer += $output->writeFieldBegin('end_inclusive', TType::BOOL, 6);
+      $xfer += $output->writeBool($this->end_inclusive);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->has_start !== null) {
+      $xfer += $output->writeFieldBegin('has_start', TType::BOOL, 7);
+      $xfer += $output->writeBool($this->has_start);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->has_end !== null) {
+      $xfer += $output->writeFieldBegin('has_end', TType::BOOL, 8);
+      $xfer += $output->writeBool($this->has_end);
+      $xfer += $output->writeFieldEnd();
+    }
+    $xfer += $output->writeFieldStop();
+    $xfer += $output->writeStructEnd();
+    return $xfer;
+  }
+
+}
+
 class Hypertable_ThriftGen_ScanSpec {
   static $_TSPEC;
 
@@ -353,6 +612,9 @@ class Hypertable_ThriftGen_ScanSpec {
   public $start_time = null;
   public $end_time = null;
   public $columns = null;
+  public $parallel = 0;
+  public $unordered = false;
+  public $predicates = null;
 
   public function __construct($vals=null) {
     if (!isset(self::$_TSPEC)) {
@@ -403,6 +665,23 @@ class Hypertable_ThriftGen_ScanSpec {
             'type' => TType::STRING,
             ),
           ),
+        9 => array(
+          'var' => 'parallel',
+          'type' => TType::I32,
+          ),
+        10 => array(
+          'var' => 'unordered',
+          'type' => TType::BOOL,
+          ),
+        11 => array(
+          'var' => 'predicates',
+          'type' => TType::LST,
+          'etype' => TType::STRUCT,
+          'elem' => array(
+            'type' => TType::STRUCT,
+            'class' => 'Hypertable_ThriftGen_CellPredicate',
+            ),
+          ),
         );
     }
     if (is_array($vals)) {
@@ -430,6 +709,15 @@ class Hypertable_ThriftGen_ScanSpec {
       if (isset($vals['columns'])) {
         $this->columns = $vals['columns'];
       }
+      if (isset($vals['parallel'])) {
+        $this->parallel = $vals['parallel'];
+      }
+      if (isset($vals['unordered'])) {
+        $this->unordered = $vals['unordered'];
+      }
+      if (isset($vals['predicates'])) {
+        $this->predicates = $vals['predicates'];
+      }
     }
   }
 
@@ -540,6 +828,38 @@ class Hypertable_ThriftGen_ScanSpec {
             $xfer += $input->skip($ftype);
           }
           break;
+        case 9:
+          if ($ftype == TType::I32) {
+            $xfer += $input->readI32($this->parallel);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 10:
+          if ($ftype == TType::BOOL) {
+            $xfer += $input->readBool($this->unordered);
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
+        case 11:
+          if ($ftype == TType::LST) {
+            $this->predicates = array();
+            $_size18 = 0;
+            $_etype21 = 0;
+            $xfer += $input->readListBegin($_etype21, $_size18);
+            for ($_i22 = 0; $_i22 < $_size18; ++$_i22)
+            {
+              $elem23 = null;
+              $elem23 = new Hypertable_ThriftGen_CellPredicate();
+              $xfer += $elem23->read($input);
+              $this->predicates []= $elem23;
+            }
+            $xfer += $input->readListEnd();
+          } else {
+            $xfer += $input->skip($ftype);
+          }
+          break;
         default:
           $xfer += $input->skip($ftype);
           break;
@@ -561,9 +881,9 @@ class Hypertable_ThriftGen_ScanSpec {
       {
         $output->writeListBegin(TType::STRUCT, count($this->row_intervals));
         {
-          foreach ($this->row_intervals as $iter18)
+          foreach ($this->row_intervals as $iter24)
           {
-            $xfer += $iter18->write($output);
+            $xfer += $iter24->write($output);
           }
         }
         $output->writeListEnd();
@@ -578,9 +898,9 @@ class Hypertable_ThriftGen_ScanSpec {
       {
         $output->writeListBegin(TType::STRUCT, count($this->cell_intervals));
         {
-          foreach ($this->cell_intervals as $iter19)
+          foreach ($this->cell_intervals as $iter25)
           {
-            $xfer += $iter19->write($output);
+            $xfer += $iter25->write($output);
           }
         }
         $output->writeListEnd();
@@ -620,9 +940,36 @@ class Hypertable_ThriftGen_ScanSpec {
       {
         $output->writeListBegin(TType::STRING, count($this->columns));
         {
-          foreach ($this->columns as $iter20)
+          foreach ($this->columns as $iter26)
+          {
+            $xfer += $output->writeString($iter26);
+          }
+        }
+        $output->writeListEnd();
+      }
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->parallel !== null) {
+      $xfer += $output->writeFieldBegin('parallel', TType::I32, 9);
+      $xfer += $output->writeI32($this->parallel);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->unordered !== null) {
+      $xfer += $output->writeFieldBegin('unordered', TType::BOOL, 10);
+      $xfer += $output->writeBool($this->unordered);
+      $xfer += $output->writeFieldEnd();
+    }
+    if ($this->predicates !== null) {
+      if (!is_array($this->predicates)) {
+        throw new TProtocolException('Bad type in structure.', TProtocolException::INVALID_DATA);
+      }
+      $xfer += $output->writeFieldBegin('predicates', TType::LST, 11);
+      {
+        $output->writeListBegin(TType::STRUCT, count($this->predicates));
+        {
+          foreach ($this->predicates as $iter27)
           {
-            $xfer += $output->writeString($iter20);
+            $xfer += $iter27->write($output);
           }
         }
         $output->writeListEnd();
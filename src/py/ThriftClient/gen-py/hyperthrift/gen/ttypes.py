@@ -14,6 +14,43 @@ except:
   fastbinary = None
 
 
+class CellPredicateOp:
+  """
+  Operators of a cell filter predicate
+  
+  Note for maintainers: the definition must be sync'ed with the
+  CellPredicate operators in src/cc/Hypertable/Lib/ScanSpec.h
+  
+  AND, OR: true if all/any of the following <code>children</code> subtrees
+  are true
+  
+  NOT: true if the following subtree is false
+  
+  ROW_PREFIX, ROW_REGEX: row key starts with/matches operand
+  
+  QUALIFIER_EQUAL, QUALIFIER_PREFIX, QUALIFIER_REGEX: column qualifier
+  equals/starts with/matches operand
+  
+  VALUE_EQUAL, VALUE_PREFIX, VALUE_CONTAINS, VALUE_REGEX: cell value
+  equals/starts with/contains/matches operand
+  
+  VALUE_RANGE: cell value lies between operand and end_operand; either
+  bound can be left open with has_start/has_end
+  """
+  AND = 1
+  OR = 2
+  NOT = 3
+  ROW_PREFIX = 4
+  ROW_REGEX = 5
+  QUALIFIER_EQUAL = 6
+  QUALIFIER_PREFIX = 7
+  QUALIFIER_REGEX = 8
+  VALUE_EQUAL = 9
+  VALUE_PREFIX = 10
+  VALUE_RANGE = 11
+  VALUE_CONTAINS = 12
+  VALUE_REGEX = 13
+
 class CellFlag:
   """
   State flags for a table cell
@@ -290,6 +327,181 @@ class CellInterval:
   def __ne__(self, other):
     return not (self == other)
 
+class CellPredicate:
+  """
+  Specifies one node of a cell filter
+  
+  A filter is a tree flattened in prefix order: an AND, OR or NOT node is
+  immediately followed by its children.  Several top level trees are
+  ANDed.  Filters are evaluated by the range server, so only matching
+  cells are returned.  Regular expressions are POSIX extended.
+  
+  <dl>
+    <dt>op</dt>
+    <dd>The operator (see CellPredicateOp)</dd>
+  
+    <dt>children</dt>
+    <dd>Number of child subtrees of an AND or OR node</dd>
+  
+    <dt>operand</dt>
+    <dd>The operand of a leaf (start of the range for VALUE_RANGE)</dd>
+  
+    <dt>start_inclusive</dt>
+    <dd>Whether the start of a VALUE_RANGE is included (default: true)</dd>
+  
+    <dt>end_operand</dt>
+    <dd>The end of the range for VALUE_RANGE</dd>
+  
+    <dt>end_inclusive</dt>
+    <dd>Whether the end of a VALUE_RANGE is included (default: true)</dd>
+  
+    <dt>has_start</dt>
+    <dd>Whether a VALUE_RANGE has a lower bound; false leaves it open
+    (default: true)</dd>
+  
+    <dt>has_end</dt>
+    <dd>Whether a VALUE_RANGE has an upper bound; false leaves it open
+    (default: true)</dd>
+  </dl>
+  
+  Attributes:
+   - op
+   - children
+   - operand
+   - start_inclusive
+   - end_operand
+   - end_inclusive
+   - has_start
+   - has_end
+  """
+
+  thrift_spec = (
+    None, # 0
+    (1, TType.I32, 'op', None, None, ), # 1
+    (2, TType.I32, 'children', None, 0, ), # 2
+    (3, TType.STRING, 'operand', None, None, ), # 3
+    (4, TType.BOOL, 'start_inclusive', None, True, ), # 4
+    (5, TType.STRING, 'end_operand', None, None, ), # 5
+    (6, TType.BOOL, 'end_inclusive', None, True, ), # 6
+    (7, TType.BOOL, 'has_start', None, True, ), # 7
+    (8, TType.BOOL, 'has_end', None, True, ), # 8
+  )
+
+  def __init__(self, op=None, children=thrift_spec[2][4], operand=None, start_inclusive=thrift_spec[4][4], end_operand=None, end_inclusive=thrift_spec[6][4], has_start=thrift_spec[7][4], has_end=thrift_spec[8][4],):
+    self.op = op
+    self.children = children
+    self.operand = operand
+    self.start_inclusive = start_inclusive
+    self.end_operand = end_operand
+    self.end_inclusive = end_inclusive
+    self.has_start = has_start
+    self.has_end = has_end
+
+  def read(self, iprot):
+    if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
+      fastbinary.decode_binary(self, iprot.trans, (self.__class__, self.thrift_spec))
+      return
+    iprot.readStructBegin()
+    while True:
+      (fname, ftype, fid) = iprot.readFieldBegin()
+      if ftype == TType.STOP:
+        break
+      if fid == 1:
+        if ftype == TType.I32:
+          self.op = iprot.readI32();
+        else:
+          iprot.skip(ftype)
+      elif fid == 2:
+        if ftype == TType.I32:
+          self.children = iprot.readI32();
+        else:
+          iprot.skip(ftype)
+      elif fid == 3:
+        if ftype == TType.STRING:
+          self.operand = iprot.readString();
+        else:
+          iprot.skip(ftype)
+      elif fid == 4:
+        if ftype == TType.BOOL:
+          self.start_inclusive = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 5:
+        if ftype == TType.STRING:
+          self.end_operand = iprot.readString();
+        else:
+          iprot.skip(ftype)
+      elif fid == 6:
+        if ftype == TType.BOOL:
+          self.end_inclusive = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 7:
+        if ftype == TType.BOOL:
+          self.has_start = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 8:
+        if ftype == TType.BOOL:
+          self.has_end = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      else:
+        iprot.skip(ftype)
+      iprot.readFieldEnd()
+    iprot.readStructEnd()
+
+  def write(self, oprot):
+    if oprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and self.thrift_spec is not None and fastbinary is not None:
+      oprot.trans.write(fastbinary.encode_binary(self, (self.__class__, self.thrift_spec)))
+      return
+    oprot.writeStructBegin('CellPredicate')
+    if self.op != None:
+      oprot.writeFieldBegin('op', TType.I32, 1)
+      oprot.writeI32(self.op)
+      oprot.writeFieldEnd()
+    if self.children != None:
+      oprot.writeFieldBegin('children', TType.I32, 2)
+      oprot.writeI32(self.children)
+      oprot.writeFieldEnd()
+    if self.operand != None:
+      oprot.writeFieldBegin('operand', TType.STRING, 3)
+      oprot.writeString(self.operand)
+      oprot.writeFieldEnd()
+    if self.start_inclusive != None:
+      oprot.writeFieldBegin('start_inclusive', TType.BOOL, 4)
+      oprot.writeBool(self.start_inclusive)
+      oprot.writeFieldEnd()
+    if self.end_operand != None:
+      oprot.writeFieldBegin('end_operand', TType.STRING, 5)
+      oprot.writeString(self.end_operand)
+      oprot.writeFieldEnd()
+    if self.end_inclusive != None:
+      oprot.writeFieldBegin('end_inclusive', TType.BOOL, 6)
+      oprot.writeBool(self.end_inclusive)
+      oprot.writeFieldEnd()
+    if self.has_start != None:
+      oprot.writeFieldBegin('has_start', TType.BOOL, 7)
+      oprot.writeBool(self.has_start)
+      oprot.writeFieldEnd()
+    if self.has_end != None:
+      oprot.writeFieldBegin('has_end', TType.BOOL, 8)
+      oprot.writeBool(self.has_end)
+      oprot.writeFieldEnd()
+    oprot.writeFieldStop()
+    oprot.writeStructEnd()
+
+  def __repr__(self):
+    L = ['%s=%r' % (key, value)
+      for key, value in self.__dict__.iteritems()]
+    return '%s(%s)' % (self.__class__.__name__, ', '.join(L))
+
+  def __eq__(self, other):
+    return isinstance(other, self.__class__) and self.__dict__ == other.__dict__
+
+  def __ne__(self, other):
+    return not (self == other)
+
 class ScanSpec:
   """
   Specifies options for a scan
@@ -321,6 +533,17 @@ class ScanSpec:
   
     <dt>columns</dt>
     <dd>Specifies the names of the columns to return</dd>
+  
+    <dt>parallel</dt>
+    <dd>Specifies the number of ranges to scan concurrently (0 or 1 scans
+    one range at a time)</dd>
+  
+    <dt>unordered</dt>
+    <dd>With parallel scans, return whole ranges in the order they respond
+    instead of in row key order</dd>
+  
+    <dt>predicates</dt>
+    <dd>A cell filter evaluated by the range servers (see CellPredicate)</dd>
   </dl>
   
   Attributes:
@@ -332,6 +555,9 @@ class ScanSpec:
    - start_time
    - end_time
    - columns
+   - parallel
+   - unordered
+   - predicates
   """
 
   thrift_spec = (
@@ -344,9 +570,12 @@ class ScanSpec:
     (6, TType.I64, 'start_time', None, None, ), # 6
     (7, TType.I64, 'end_time', None, None, ), # 7
     (8, TType.LIST, 'columns', (TType.STRING,None), None, ), # 8
+    (9, TType.I32, 'parallel', None, 0, ), # 9
+    (10, TType.BOOL, 'unordered', None, False, ), # 10
+    (11, TType.LIST, 'predicates', (TType.STRUCT,(CellPredicate, CellPredicate.thrift_spec)), None, ), # 11
   )
 
-  def __init__(self, row_intervals=None, cell_intervals=None, return_deletes=thrift_spec[3][4], revs=thrift_spec[4][4], row_limit=thrift_spec[5][4], start_time=None, end_time=None, columns=None,):
+  def __init__(self, row_intervals=None, cell_intervals=None, return_deletes=thrift_spec[3][4], revs=thrift_spec[4][4], row_limit=thrift_spec[5][4], start_time=None, end_time=None, columns=None, parallel=thrift_spec[9][4], unordered=thrift_spec[10][4], predicates=None,):
     self.row_intervals = row_intervals
     self.cell_intervals = cell_intervals
     self.return_deletes = return_deletes
@@ -355,6 +584,9 @@ class ScanSpec:
     self.start_time = start_time
     self.end_time = end_time
     self.columns = columns
+    self.parallel = parallel
+    self.unordered = unordered
+    self.predicates = predicates
 
   def read(self, iprot):
     if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
@@ -422,6 +654,27 @@ class ScanSpec:
           iprot.readListEnd()
         else:
           iprot.skip(ftype)
+      elif fid == 9:
+        if ftype == TType.I32:
+          self.parallel = iprot.readI32();
+        else:
+          iprot.skip(ftype)
+      elif fid == 10:
+        if ftype == TType.BOOL:
+          self.unordered = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 11:
+        if ftype == TType.LIST:
+          self.predicates = []
+          (_etype21, _size18) = iprot.readListBegin()
+          for _i22 in xrange(_size18):
+            _elem23 = CellPredicate()
+            _elem23.read(iprot)
+            self.predicates.append(_elem23)
+          iprot.readListEnd()
+        else:
+          iprot.skip(ftype)
       else:
         iprot.skip(ftype)
       iprot.readFieldEnd()
@@ -435,15 +688,15 @@ class ScanSpec:
     if self.row_intervals != None:
       oprot.writeFieldBegin('row_intervals', TType.LIST, 1)
       oprot.writeListBegin(TType.STRUCT, len(self.row_intervals))
-      for iter18 in self.row_intervals:
-        iter18.write(oprot)
+      for iter24 in self.row_intervals:
+        iter24.write(oprot)
       oprot.writeListEnd()
       oprot.writeFieldEnd()
     if self.cell_intervals != None:
       oprot.writeFieldBegin('cell_intervals', TType.LIST, 2)
       oprot.writeListBegin(TType.STRUCT, len(self.cell_intervals))
-      for iter19 in self.cell_intervals:
-        iter19.write(oprot)
+      for iter25 in self.cell_intervals:
+        iter25.write(oprot)
       oprot.writeListEnd()
       oprot.writeFieldEnd()
     if self.return_deletes != None:
@@ -469,8 +722,23 @@ class ScanSpec:
     if self.columns != None:
       oprot.writeFieldBegin('columns', TType.LIST, 8)
       oprot.writeListBegin(TType.STRING, len(self.columns))
-      for iter20 in self.columns:
-        oprot.writeString(iter20)
+      for iter26 in self.columns:
+        oprot.writeString(iter26)
+      oprot.writeListEnd()
+      oprot.writeFieldEnd()
+    if self.parallel != None:
+      oprot.writeFieldBegin('parallel', TType.I32, 9)
+      oprot.writeI32(self.parallel)
+      oprot.writeFieldEnd()
+    if self.unordered != None:
+      oprot.writeFieldBegin('unordered', TType.BOOL, 10)
+      oprot.writeBool(self.unordered)
+      oprot.writeFieldEnd()
+    if self.predicates != None:
+      oprot.writeFieldBegin('predicates', TType.LIST, 11)
+      oprot.writeListBegin(TType.STRUCT, len(self.predicates))
+      for iter27 in self.predicates:
+        iter27.write(oprot)
       oprot.writeListEnd()
       oprot.writeFieldEnd()
     oprot.writeFieldStop()
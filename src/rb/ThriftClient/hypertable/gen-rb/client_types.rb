@@ -7,6 +7,24 @@
 
 module Hypertable
   module ThriftGen
+        module CellPredicateOp
+          AND = 1
+          OR = 2
+          NOT = 3
+          ROW_PREFIX = 4
+          ROW_REGEX = 5
+          QUALIFIER_EQUAL = 6
+          QUALIFIER_PREFIX = 7
+          QUALIFIER_REGEX = 8
+          VALUE_EQUAL = 9
+          VALUE_PREFIX = 10
+          VALUE_RANGE = 11
+          VALUE_CONTAINS = 12
+          VALUE_REGEX = 13
+          VALUE_MAP = {1 => "AND", 2 => "OR", 3 => "NOT", 4 => "ROW_PREFIX", 5 => "ROW_REGEX", 6 => "QUALIFIER_EQUAL", 7 => "QUALIFIER_PREFIX", 8 => "QUALIFIER_REGEX", 9 => "VALUE_EQUAL", 10 => "VALUE_PREFIX", 11 => "VALUE_RANGE", 12 => "VALUE_CONTAINS", 13 => "VALUE_REGEX"}
+          VALID_VALUES = Set.new([AND, OR, NOT, ROW_PREFIX, ROW_REGEX, QUALIFIER_EQUAL, QUALIFIER_PREFIX, QUALIFIER_REGEX, VALUE_EQUAL, VALUE_PREFIX, VALUE_RANGE, VALUE_CONTAINS, VALUE_REGEX]).freeze
+        end
+
         module CellFlag
           DELETE_ROW = 0
           DELETE_CF = 1
@@ -108,6 +126,73 @@ module Hypertable
 
         end
 
+        # Specifies one node of a cell filter
+        # 
+        # A filter is a tree flattened in prefix order: an AND, OR or NOT node is
+        # immediately followed by its children.  Several top level trees are
+        # ANDed.  Filters are evaluated by the range server, so only matching
+        # cells are returned.  Regular expressions are POSIX extended.
+        # 
+        # <dl>
+        #   <dt>op</dt>
+        #   <dd>The operator (see CellPredicateOp)</dd>
+        # 
+        #   <dt>children</dt>
+        #   <dd>Number of child subtrees of an AND or OR node</dd>
+        # 
+        #   <dt>operand</dt>
+        #   <dd>The operand of a leaf (start of the range for VALUE_RANGE)</dd>
+        # 
+        #   <dt>start_inclusive</dt>
+        #   <dd>Whether the start of a VALUE_RANGE is included (default: true)</dd>
+        # 
+        #   <dt>end_operand</dt>
+        #   <dd>The end of the range for VALUE_RANGE</dd>
+        # 
+        #   <dt>end_inclusive</dt>
+        #   <dd>Whether the end of a VALUE_RANGE is included (default: true)</dd>
+        # 
+        #   <dt>has_start</dt>
+        #   <dd>Whether a VALUE_RANGE has a lower bound; false leaves it open
+        #   (default: true)</dd>
+        # 
+        #   <dt>has_end</dt>
+        #   <dd>Whether a VALUE_RANGE has an upper bound; false leaves it open
+        #   (default: true)</dd>
+        # </dl>
+        class CellPredicate
+          include ::Thrift::Struct
+          OP = 1
+          CHILDREN = 2
+          OPERAND = 3
+          START_INCLUSIVE = 4
+          END_OPERAND = 5
+          END_INCLUSIVE = 6
+          HAS_START = 7
+          HAS_END = 8
+
+          ::Thrift::Struct.field_accessor self, :op, :children, :operand, :start_inclusive, :end_operand, :end_inclusive, :has_start, :has_end
+          FIELDS = {
+            OP => {:type => ::Thrift::Types::I32, :name => 'op', :optional => true, :enum_class => Hypertable::ThriftGen::CellPredicateOp},
+            CHILDREN => {:type => ::Thrift::Types::I32, :name => 'children', :default => 0, :optional => true},
+            OPERAND => {:type => ::Thrift::Types::STRING, :name => 'operand', :optional => true},
+            START_INCLUSIVE => {:type => ::Thrift::Types::BOOL, :name => 'start_inclusive', :default => true, :optional => true},
+            END_OPERAND => {:type => ::Thrift::Types::STRING, :name => 'end_operand', :optional => true},
+            END_INCLUSIVE => {:type => ::Thrift::Types::BOOL, :name => 'end_inclusive', :default => true, :optional => true},
+            HAS_START => {:type => ::Thrift::Types::BOOL, :name => 'has_start', :default => true, :optional => true},
+            HAS_END => {:type => ::Thrift::Types::BOOL, :name => 'has_end', :default => true, :optional => true}
+          }
+
+          def struct_fields; FIELDS; end
+
+          def validate
+            unless @op.nil? || Hypertable::ThriftGen::CellPredicateOp::VALID_VALUES.include?(@op)
+              raise ::Thrift::ProtocolException.new(::Thrift::ProtocolException::UNKNOWN, 'Invalid value of field op!')
+            end
+          end
+
+        end
+
         # Specifies options for a scan
         # 
         # <dl>
@@ -137,6 +222,17 @@ module Hypertable
         # 
         #   <dt>columns</dt>
         #   <dd>Specifies the names of the columns to return</dd>
+        # 
+        #   <dt>parallel</dt>
+        #   <dd>Specifies the number of ranges to scan concurrently (0 or 1 scans
+        #   one range at a time)</dd>
+        # 
+        #   <dt>unordered</dt>
+        #   <dd>With parallel scans, return whole ranges in the order they respond
+        #   instead of in row key order</dd>
+        # 
+        #   <dt>predicates</dt>
+        #   <dd>A cell filter evaluated by the range servers (see CellPredicate)</dd>
         # </dl>
         class ScanSpec
           include ::Thrift::Struct
@@ -148,8 +244,11 @@ module Hypertable
           START_TIME = 6
           END_TIME = 7
           COLUMNS = 8
+          PARALLEL = 9
+          UNORDERED = 10
+          PREDICATES = 11
 
-          ::Thrift::Struct.field_accessor self, :row_intervals, :cell_intervals, :return_deletes, :revs, :row_limit, :start_time, :end_time, :columns
+          ::Thrift::Struct.field_accessor self, :row_intervals, :cell_intervals, :return_deletes, :revs, :row_limit, :start_time, :end_time, :columns, :parallel, :unordered, :predicates
           FIELDS = {
             ROW_INTERVALS => {:type => ::Thrift::Types::LIST, :name => 'row_intervals', :element => {:type => ::Thrift::Types::STRUCT, :class => Hypertable::ThriftGen::RowInterval}, :optional => true},
             CELL_INTERVALS => {:type => ::Thrift::Types::LIST, :name => 'cell_intervals', :element => {:type => ::Thrift::Types::STRUCT, :class => Hypertable::ThriftGen::CellInterval}, :optional => true},
@@ -158,7 +257,10 @@ module Hypertable
             ROW_LIMIT => {:type => ::Thrift::Types::I32, :name => 'row_limit', :default => 0, :optional => true},
             START_TIME => {:type => ::Thrift::Types::I64, :name => 'start_time', :optional => true},
             END_TIME => {:type => ::Thrift::Types::I64, :name => 'end_time', :optional => true},
-            COLUMNS => {:type => ::Thrift::Types::LIST, :name => 'columns', :element => {:type => ::Thrift::Types::STRING}, :optional => true}
+            COLUMNS => {:type => ::Thrift::Types::LIST, :name => 'columns', :element => {:type => ::Thrift::Types::STRING}, :optional => true},
+            PARALLEL => {:type => ::Thrift::Types::I32, :name => 'parallel', :default => 0, :optional => true},
+            UNORDERED => {:type => ::Thrift::Types::BOOL, :name => 'unordered', :default => false, :optional => true},
+            PREDICATES => {:type => ::Thrift::Types::LIST, :name => 'predicates', :element => {:type => ::Thrift::Types::STRUCT, :class => Hypertable::ThriftGen::CellPredicate}, :optional => true}
           }
 
           def struct_fields; FIELDS; end
@@ -0,0 +1,80 @@
+#!/bin/sh
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+NUM_ROWS=${NUM_ROWS:-"40000"}
+LIMIT=5000
+
+fail() {
+  echo "Test failed: $1"
+  exit 1
+}
+
+hql() {
+  $HT_HOME/bin/hypertable --batch
+}
+
+$HT_HOME/bin/start-test-servers.sh --clear --no-thriftbroker \
+    --Hypertable.RangeServer.Range.SplitSize=200K \
+    --Hypertable.RangeServer.Maintenance.Interval=100
+
+$HT_HOME/bin/hypertable --no-prompt < $SCRIPT_DIR/create-table.hql
+
+awk -v n=$NUM_ROWS 'BEGIN {
+  print "#row\tcolumn\tvalue";
+  for (i=0; i<n; i++)
+    printf("row%06d\tField\tvalue-%06d-%s\n", i, i,
+           "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx");
+}' > parallel-scan.tsv
+
+echo "load data infile \"`pwd`/parallel-scan.tsv\" into table ParallelScan;" \
+    | hql || fail "unable to load ParallelScan"
+
+# wait for the table to split into a handful of ranges
+i=0
+while [ $i -lt 60 ]; do
+  ranges=`echo "select StartRow from METADATA;" | hql | wc -l`
+  [ $ranges -ge 8 ] && break
+  sleep 1
+  i=`expr $i + 1`
+done
+[ $ranges -ge 8 ] || fail "ParallelScan did not split ($ranges ranges)"
+
+WHERE="where row >= 'row010000' and row < 'row030000'"
+
+hql <<END || fail "select failed"
+select * from ParallelScan into file "`pwd`/serial.out";
+select * from ParallelScan parallel 4 into file "`pwd`/parallel.out";
+select * from ParallelScan parallel 4 unordered
+    into file "`pwd`/unordered.out";
+select * from ParallelScan $WHERE into file "`pwd`/serial-where.out";
+select * from ParallelScan $WHERE parallel 4
+    into file "`pwd`/parallel-where.out";
+select * from ParallelScan limit $LIMIT parallel 4
+    into file "`pwd`/parallel-limit.out";
+select * from ParallelScan limit $LIMIT parallel 4 unordered
+    into file "`pwd`/unordered-limit.out";
+END
+
+# every row exactly once, in key order unless UNORDERED was given
+[ `wc -l < serial.out` -eq `expr $NUM_ROWS + 1` ] \
+    || fail "serial scan returned the wrong number of cells"
+cmp serial.out parallel.out || fail "PARALLEL 4"
+sort serial.out > serial.sorted
+sort unordered.out | cmp serial.sorted - || fail "PARALLEL 4 UNORDERED"
+
+# a row interval that spans several ranges
+cmp serial-where.out parallel-where.out || fail "PARALLEL 4 with row interval"
+
+# LIMIT counts rows across the ranges only once
+head -n `expr $LIMIT + 1` serial.out | cmp - parallel-limit.out \
+    || fail "PARALLEL 4 LIMIT $LIMIT"
+[ `wc -l < unordered-limit.out` -eq `expr $LIMIT + 1` ] \
+    || fail "PARALLEL 4 UNORDERED LIMIT $LIMIT returned the wrong count"
+[ `sort -u unordered-limit.out | wc -l` -eq `expr $LIMIT + 1` ] \
+    || fail "PARALLEL 4 UNORDERED LIMIT $LIMIT returned duplicates"
+sort unordered-limit.out | comm -23 - serial.sorted | grep -q . \
+    && fail "PARALLEL 4 UNORDERED LIMIT $LIMIT returned unknown cells"
+
+echo "Test passed."
+exit 0